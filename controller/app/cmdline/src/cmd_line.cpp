@@ -30,6 +30,7 @@
 #include <assert.h>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <iomanip>
 #include <string>
 #include <sstream>
@@ -96,7 +97,7 @@ cmd_line::cmd_line(void (*notification_callback)(void *, int32_t, uint64_t, uint
     : test_mode(test_mode), output_redirected(false)
 {
     cout_buf = std::cout.rdbuf();
-    current_end_station = 0;
+    current_end_station_entity_id = 0;
 
     // Start non-zero so as not to be confused with commands without notification
     notification_id = 1;
@@ -287,14 +288,38 @@ int cmd_line::print_interfaces_and_select(char * interface)
 
 int cmd_line::get_current_end_station(avdecc_lib::end_station ** end_station) const
 {
-    if (current_end_station >= controller_obj->get_end_station_count())
+    // The selection is kept by Entity ID, as the indexes of End Stations change when End Stations are evicted
+    if (!current_end_station_entity_id)
+        *end_station = controller_obj->get_end_station_count() ? controller_obj->get_end_station_by_index(0) : NULL;
+    else
+        *end_station = controller_obj->get_end_station_by_entity_id(current_end_station_entity_id);
+
+    if (!*end_station)
     {
-        atomic_cout << "No End Stations available" << std::endl;
-        *end_station = NULL;
+        if (current_end_station_entity_id)
+            atomic_cout << "Selected End Station 0x" << std::setw(16) << std::hex << std::setfill('0')
+                        << current_end_station_entity_id << " is no longer available" << std::endl;
+        else
+            atomic_cout << "No End Stations available" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int cmd_line::get_current_end_station_index(uint32_t & end_station_index) const
+{
+    avdecc_lib::end_station * end_station;
+
+    if (get_current_end_station(&end_station))
+        return 1;
+
+    if (!controller_obj->is_end_station_found_by_entity_id(end_station->entity_id(), end_station_index))
+    {
+        atomic_cout << "Selected End Station has been evicted" << std::endl;
         return 1;
     }
 
-    *end_station = controller_obj->get_end_station_by_index(current_end_station);
     return 0;
 }
 
@@ -499,6 +524,30 @@ void cmd_line::cmd_line_commands_init()
                                                      log_level_help));
     log_level_cmd->add_format(log_level_fmt);
 
+    // trace
+    cli_command * trace_cmd = new cli_command();
+    commands.add_sub_command("trace", trace_cmd);
+
+    // trace start
+    cli_command * trace_start_cmd = new cli_command();
+    trace_cmd->add_sub_command("start", trace_start_cmd);
+
+    cli_command_format * trace_start_fmt = new cli_command_format(
+        "Record command lifecycle trace events to a file in Chrome trace format.\n"
+        "The file can be viewed in chrome://tracing or the Perfetto UI.",
+        &cmd_line::cmd_trace_start);
+    trace_start_fmt->add_argument(new cli_argument_string(this, "f_n", "the trace file name"));
+    trace_start_cmd->add_format(trace_start_fmt);
+
+    // trace stop
+    cli_command * trace_stop_cmd = new cli_command();
+    trace_cmd->add_sub_command("stop", trace_stop_cmd);
+
+    cli_command_format * trace_stop_fmt = new cli_command_format(
+        "Stop recording command lifecycle trace events and close the trace file.",
+        &cmd_line::cmd_trace_stop);
+    trace_stop_cmd->add_format(trace_stop_fmt);
+
     // unlog
     cli_command * unlog_cmd = new cli_command();
     commands.add_sub_command("unlog", unlog_cmd);
@@ -1181,6 +1230,42 @@ void cmd_line::cmd_line_commands_init()
         &cmd_line::cmd_firmware_upgrade);
     upgrade_cmd_fmt->add_argument(new cli_argument_string(this, "upgrade_image_path", "the path to the upgrade image file"));
     upgrade_cmd->add_format(upgrade_cmd_fmt);
+
+    // upgrade rollout
+    cli_command * upgrade_rollout_cmd = new cli_command();
+    upgrade_cmd->add_sub_command("rollout", upgrade_rollout_cmd);
+
+    cli_command_format * upgrade_rollout_fmt = new cli_command_format(
+        "Upgrade a firmware image on several End Stations in the background, erasing, uploading and\n"
+        "rebooting up to w_s End Stations at once. Progress is recorded in the state file, and a\n"
+        "rollout started again with the same image and state file continues where it stopped.",
+        &cmd_line::cmd_firmware_rollout);
+    upgrade_rollout_fmt->add_argument(new cli_argument_string(this, "upgrade_image_path", "the path to the upgrade image file"));
+    upgrade_rollout_fmt->add_argument(new cli_argument_string(this, "state_file_path", "the path to the rollout state file"));
+    upgrade_rollout_fmt->add_argument(new cli_argument_int(this, "w_s", "the number of End Stations upgraded at once, or 0 for all"));
+    upgrade_rollout_fmt->add_argument(new cli_argument_int(this, "kbps", "the upload bandwidth over all End Stations in kilobytes per second, or 0 for no limit"));
+    upgrade_rollout_fmt->add_argument(new cli_argument_end_station(this, "e_s_i", END_STATION_HELP,
+                                                                   "To see a list of valid End Stations, enter \"list\" command.",
+                                                                   1, UINT_MAX));
+    upgrade_rollout_cmd->add_format(upgrade_rollout_fmt);
+
+    // upgrade status
+    cli_command * upgrade_status_cmd = new cli_command();
+    upgrade_cmd->add_sub_command("status", upgrade_status_cmd);
+
+    cli_command_format * upgrade_status_fmt = new cli_command_format(
+        "Display the progress of each End Station in the current or last firmware rollout.",
+        &cmd_line::cmd_firmware_rollout_status);
+    upgrade_status_cmd->add_format(upgrade_status_fmt);
+
+    // upgrade abort
+    cli_command * upgrade_abort_cmd = new cli_command();
+    upgrade_cmd->add_sub_command("abort", upgrade_abort_cmd);
+
+    cli_command_format * upgrade_abort_fmt = new cli_command_format(
+        "Stop the firmware rollout once the End Stations being upgraded have finished.",
+        &cmd_line::cmd_firmware_rollout_abort);
+    upgrade_abort_cmd->add_format(upgrade_abort_fmt);
 }
 
 int cmd_line::cmd_help_all(int total_matched, std::vector<cli_argument *> args)
@@ -1348,7 +1433,8 @@ int cmd_line::cmd_show_select(int total_matched, std::vector<cli_argument *> arg
 {
     avdecc_lib::end_station * end_station;
     avdecc_lib::entity_descriptor_response * entity_desc_resp;
-    if (get_current_end_station(&end_station))
+    uint32_t current_end_station;
+    if (get_current_end_station(&end_station) || get_current_end_station_index(current_end_station))
         return 0;
 
     uint16_t current_entity = end_station->get_current_entity_index();
@@ -1384,11 +1470,13 @@ int cmd_line::do_select(uint32_t new_end_station, uint16_t new_entity, uint16_t
         uint16_t current_entity = end_station->get_current_entity_index();
         uint16_t current_config = end_station->get_current_config_index();
         avdecc_lib::entity_descriptor_response * entity_desc_resp = end_station->get_entity_desc_by_index(current_entity)->get_entity_response();
+        bool is_same_end_station = (current_end_station_entity_id == end_station->entity_id()) ||
+                                   (!current_end_station_entity_id && (new_end_station == 0));
 
-        if ((current_end_station == new_end_station) && (current_entity == new_entity) && (current_config == new_config))
+        if (is_same_end_station && (current_entity == new_entity) && (current_config == new_config))
         {
             atomic_cout << "Same selection" << std::endl;
-            atomic_cout << "\tEnd Station Index:   " << std::dec << current_end_station << std::endl;
+            atomic_cout << "\tEnd Station Index:   " << std::dec << new_end_station << std::endl;
             atomic_cout << "\tEnd Station:         " << entity_desc_resp->entity_name()
                         << " (0x" << std::setw(16) << std::hex << std::setfill('0') << end_station->entity_id()
                         << ")" << std::endl;
@@ -1397,7 +1485,7 @@ int cmd_line::do_select(uint32_t new_end_station, uint16_t new_entity, uint16_t
         }
         else
         {
-            current_end_station = new_end_station;
+            current_end_station_entity_id = end_station->entity_id();
             end_station->set_current_entity_index(new_entity);
             end_station->set_current_config_index(new_config);
             atomic_cout << "New selection" << std::endl;
@@ -1433,6 +1521,24 @@ int cmd_line::cmd_log_level(int total_matched, std::vector<cli_argument *> args)
     return 0;
 }
 
+int cmd_line::cmd_trace_start(int total_matched, std::vector<cli_argument *> args)
+{
+    std::string trace_file = args[0]->get_value_str();
+
+    if (controller_obj->enable_command_trace(trace_file.c_str()) != 0)
+    {
+        atomic_cout << "Unable to start command trace to " << trace_file << std::endl;
+    }
+
+    return 0;
+}
+
+int cmd_line::cmd_trace_stop(int total_matched, std::vector<cli_argument *> args)
+{
+    controller_obj->disable_command_trace();
+    return 0;
+}
+
 int cmd_line::cmd_log(int total_matched, std::vector<cli_argument *> args)
 {
     std::string file = log_path + "/" + args[0]->get_value_str() + ".txt";
@@ -1785,13 +1891,11 @@ int cmd_line::cmd_view_all(int total_matched, std::vector<cli_argument *> args)
 
 int cmd_line::cmd_view_details(int total_matched, std::vector<cli_argument *> args)
 {
-    uint32_t end_station_index = current_end_station;
-
-    avdecc_lib::end_station * end_station = controller_obj->get_end_station_by_index(end_station_index);
+    avdecc_lib::end_station * end_station;
     avdecc_lib::entity_descriptor * entity;
     avdecc_lib::configuration_descriptor * configuration;
 
-    if (get_current_entity_and_descriptor(end_station, &entity, &configuration))
+    if (get_current_end_station(&end_station) || get_current_entity_and_descriptor(end_station, &entity, &configuration))
         return 0;
     avdecc_lib::entity_descriptor_response * entity_resp_ref = entity->get_entity_response();
 
@@ -3056,34 +3160,7 @@ int cmd_line::cmd_disconnect_tx(int total_matched, std::vector<cli_argument *> a
 
 int cmd_line::cmd_show_connections(int total_matched, std::vector<cli_argument *> args)
 {
-    for (uint32_t i = 0; i < controller_obj->get_end_station_count(); i++)
-    {
-        avdecc_lib::end_station * end_station = controller_obj->get_end_station_by_index(i);
-        avdecc_lib::entity_descriptor * entity;
-        avdecc_lib::configuration_descriptor * configuration;
-        if (get_current_entity_and_descriptor(end_station, &entity, &configuration))
-            continue;
-
-        size_t stream_input_desc_count = configuration->stream_input_desc_count();
-        for (uint32_t j = 0; j < stream_input_desc_count; j++)
-        {
-            avdecc_lib::stream_input_descriptor * instream = configuration->get_stream_input_desc_by_index(j);
-            intptr_t cmd_notification_id = get_next_notification_id();
-            sys->set_wait_for_next_cmd((void *)cmd_notification_id);
-            instream->send_get_rx_state_cmd((void *)cmd_notification_id);
-        }
-
-        size_t stream_output_desc_count = configuration->stream_output_desc_count();
-
-        for (uint32_t j = 0; j < stream_output_desc_count; j++)
-        {
-            avdecc_lib::stream_output_descriptor * outstream = configuration->get_stream_output_desc_by_index(j);
-            intptr_t cmd_notification_id = get_next_notification_id();
-            sys->set_wait_for_next_cmd((void *)cmd_notification_id);
-            outstream->send_get_tx_state_cmd((void *)cmd_notification_id);
-        }
-    }
-
+    // The controller maintains the connection graph from ACMP traffic, so no commands need to be sent.
     for (uint32_t in_index = 0; in_index < controller_obj->get_end_station_count(); in_index++)
     {
         avdecc_lib::end_station * in_end_station = controller_obj->get_end_station_by_index(in_index);
@@ -3096,45 +3173,30 @@ int cmd_line::cmd_show_connections(int total_matched, std::vector<cli_argument *
         for (uint32_t in_stream_index = 0; in_stream_index < stream_input_desc_count; in_stream_index++)
         {
             avdecc_lib::stream_input_descriptor * instream = in_descriptor->get_stream_input_desc_by_index(in_stream_index);
-            avdecc_lib::stream_input_get_rx_state_response * stream_input_resp_ref = instream->get_stream_input_get_rx_state_response();
-            if (!stream_input_resp_ref->get_rx_state_connection_count())
-            {
-                delete stream_input_resp_ref;
+            avdecc_lib::stream_connection connection;
+            uint32_t out_index;
+
+            if (!controller_obj->get_listener_connection(in_end_station->entity_id(), instream->descriptor_index(), connection) ||
+                !controller_obj->is_end_station_found_by_entity_id(connection.talker_entity_id, out_index))
                 continue;
-            }
-            delete stream_input_resp_ref;
 
-            for (uint32_t out_index = 0; out_index < controller_obj->get_end_station_count(); out_index++)
+            avdecc_lib::end_station * out_end_station = controller_obj->get_end_station_by_index(out_index);
+            avdecc_lib::entity_descriptor * out_entity;
+            avdecc_lib::configuration_descriptor * out_descriptor;
+            if (get_current_entity_and_descriptor(out_end_station, &out_entity, &out_descriptor))
+                continue;
+
+            size_t stream_output_desc_count = out_descriptor->stream_output_desc_count();
+            for (uint32_t out_stream_index = 0; out_stream_index < stream_output_desc_count; out_stream_index++)
             {
-                avdecc_lib::end_station * out_end_station = controller_obj->get_end_station_by_index(out_index);
-                avdecc_lib::entity_descriptor * out_entity;
-                avdecc_lib::configuration_descriptor * out_descriptor;
-                if (get_current_entity_and_descriptor(out_end_station, &out_entity, &out_descriptor))
+                avdecc_lib::stream_output_descriptor * outstream = out_descriptor->get_stream_output_desc_by_index(out_stream_index);
+                if (outstream->descriptor_index() != connection.talker_unique_id)
                     continue;
 
-                size_t stream_output_desc_count = out_descriptor->stream_output_desc_count();
-                for (uint32_t out_stream_index = 0; out_stream_index < stream_output_desc_count; out_stream_index++)
-                {
-                    avdecc_lib::stream_input_get_rx_state_response * stream_input_resp_ref = instream->get_stream_input_get_rx_state_response();
-                    avdecc_lib::stream_output_descriptor * outstream = out_descriptor->get_stream_output_desc_by_index(out_stream_index);
-                    avdecc_lib::stream_output_get_tx_state_response * stream_output_resp_ref = outstream->get_stream_output_get_tx_state_response();
-                    if (!stream_output_resp_ref->get_tx_state_connection_count() ||
-                        (stream_input_resp_ref->get_rx_state_stream_id() != stream_output_resp_ref->get_tx_state_stream_id()))
-                    {
-                        delete stream_input_resp_ref;
-                        delete stream_output_resp_ref;
-
-                        continue;
-                    }
-
-                    atomic_cout << "0x" << std::setw(16) << std::hex << std::setfill('0') << out_end_station->entity_id()
-                                << "[" << out_stream_index << "] -> "
-                                << "0x" << std::setw(16) << std::hex << std::setfill('0') << in_end_station->entity_id()
-                                << "[" << in_stream_index << "]" << std::endl;
-
-                    delete stream_input_resp_ref;
-                    delete stream_output_resp_ref;
-                }
+                atomic_cout << "0x" << std::setw(16) << std::hex << std::setfill('0') << out_end_station->entity_id()
+                            << "[" << out_stream_index << "] -> "
+                            << "0x" << std::setw(16) << std::hex << std::setfill('0') << in_end_station->entity_id()
+                            << "[" << in_stream_index << "]" << std::endl;
             }
         }
     }
@@ -3467,6 +3529,10 @@ int cmd_line::cmd_reboot(int total_matched, std::vector<cli_argument *> args)
 
 int cmd_line::cmd_controller_avail(int total_matched, std::vector<cli_argument *> args)
 {
+    uint32_t current_end_station;
+    if (get_current_end_station_index(current_end_station))
+        return 0;
+
     intptr_t cmd_notification_id = get_next_notification_id();
 
     sys->set_wait_for_next_cmd((void *)cmd_notification_id);
@@ -5008,6 +5074,77 @@ int cmd_line::cmd_firmware_upgrade(int total_matched, std::vector<cli_argument *
     return 0;
 }
 
+int cmd_line::cmd_firmware_rollout(int total_matched, std::vector<cli_argument *> args)
+{
+    std::string image_file_path = args[0]->get_value_str();
+    std::string state_file_path = args[1]->get_value_str();
+    std::vector<uint32_t> end_station_indexes = args[4]->get_all_value_uint();
+    std::vector<uint64_t> entity_ids;
+
+    for (size_t i = 0; i < end_station_indexes.size(); i++)
+    {
+        if (end_station_indexes[i] >= controller_obj->get_end_station_count())
+        {
+            atomic_cout << "Invalid End Station index " << end_station_indexes[i] << std::endl;
+            return 0;
+        }
+        entity_ids.push_back(controller_obj->get_end_station_by_index(end_station_indexes[i])->entity_id());
+    }
+
+    avdecc_lib::firmware_rollout_config config;
+    config.image_path = image_file_path.c_str();
+    config.state_file_path = state_file_path.c_str();
+    config.memory_object_index = 0;
+    config.wave_size = std::max(args[2]->get_value_int(), 0);
+    config.per_entity_window = 16;
+    config.max_bytes_per_sec = std::max(args[3]->get_value_int(), 0) * 1000;
+    config.max_packets_per_sec = 0;
+    config.reboot = true;
+    config.stop_on_wave_failure = true;
+
+    intptr_t cmd_notification_id = get_next_notification_id();
+    if (controller_obj->start_firmware_rollout(&entity_ids[0], entity_ids.size(), config, (void *)cmd_notification_id) != 0)
+    {
+        atomic_cout << "Error: Unable to start firmware rollout." << std::endl;
+        return 0;
+    }
+
+    atomic_cout << "Started firmware rollout on " << entity_ids.size() << " End Stations, enter \"upgrade status\" to see its progress." << std::endl;
+    return 0;
+}
+
+int cmd_line::cmd_firmware_rollout_status(int total_matched, std::vector<cli_argument *> args)
+{
+    std::vector<avdecc_lib::firmware_rollout_entity_status> entity_status(controller_obj->get_firmware_rollout_status(NULL, 0));
+
+    if (entity_status.empty())
+    {
+        atomic_cout << "No firmware rollout" << std::endl;
+        return 0;
+    }
+
+    size_t count = controller_obj->get_firmware_rollout_status(&entity_status[0], entity_status.size());
+    entity_status.resize(std::min(count, entity_status.size()));
+
+    atomic_cout << "\n" << std::setw(20) << "Entity ID" << "  " << std::setw(10) << "State"
+                << "  " << std::setw(8) << "Percent" << "  " << "Status" << std::endl;
+    for (size_t i = 0; i < entity_status.size(); i++)
+    {
+        atomic_cout << "0x" << std::setw(18) << std::setfill('0') << std::hex << entity_status[i].entity_id << std::setfill(' ')
+                    << "  " << std::setw(10) << avdecc_lib::utility::firmware_rollout_state_value_to_name(entity_status[i].state)
+                    << "  " << std::setw(8) << std::dec << entity_status[i].percent_complete
+                    << "  " << avdecc_lib::utility::aem_cmd_status_value_to_name(entity_status[i].status) << std::endl;
+    }
+
+    return 0;
+}
+
+int cmd_line::cmd_firmware_rollout_abort(int total_matched, std::vector<cli_argument *> args)
+{
+    controller_obj->abort_firmware_rollout();
+    return 0;
+}
+
 int cmd_line::cmd_identify_on(int total_matched, std::vector<cli_argument *> args)
 {
     uint32_t end_station_index = args[0]->get_value_uint();
@@ -77,7 +77,7 @@ private:
 
     cli_command commands;
 
-    uint32_t current_end_station;
+    uint64_t current_end_station_entity_id; // The selected End Station, or 0 for the first End Station
     intptr_t notification_id;
 
     bool test_mode;
@@ -104,6 +104,7 @@ public:
 private:
     int print_interfaces_and_select(char * interface);
     int get_current_end_station(avdecc_lib::end_station ** end_station) const;
+    int get_current_end_station_index(uint32_t & end_station_index) const;
     int get_current_entity_and_descriptor(avdecc_lib::end_station * end_station,
                                           avdecc_lib::entity_descriptor ** entity, avdecc_lib::configuration_descriptor ** descriptor);
     int get_current_end_station_entity_and_descriptor(avdecc_lib::end_station ** end_station,
@@ -188,6 +189,16 @@ private:
     ///
     int cmd_log_level(int total_matched, std::vector<cli_argument *> args);
 
+    ///
+    /// Start recording command lifecycle trace events to a file.
+    ///
+    int cmd_trace_start(int total_matched, std::vector<cli_argument *> args);
+
+    ///
+    /// Stop recording command lifecycle trace events.
+    ///
+    int cmd_trace_stop(int total_matched, std::vector<cli_argument *> args);
+
     ///
     /// Re-direct logging to a file.
     ///
@@ -422,6 +433,21 @@ private:
 
     int cmd_firmware_upgrade(int total_matched, std::vector<cli_argument *> args);
 
+    ///
+    /// Start upgrading a firmware image on several End Stations in the background.
+    ///
+    int cmd_firmware_rollout(int total_matched, std::vector<cli_argument *> args);
+
+    ///
+    /// Display the progress of the firmware rollout.
+    ///
+    int cmd_firmware_rollout_status(int total_matched, std::vector<cli_argument *> args);
+
+    ///
+    /// Skip the End Stations the firmware rollout has not started on.
+    ///
+    int cmd_firmware_rollout_abort(int total_matched, std::vector<cli_argument *> args);
+
     ///
     /// Send a IDENTIFY command to enable identification.
     ///
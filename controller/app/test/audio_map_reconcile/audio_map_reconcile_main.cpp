@@ -0,0 +1,145 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * audio_map_reconcile_main.cpp
+ *
+ * Testing the audio map diff used to reconcile a Stream Port with its desired mappings
+ */
+
+#include <iostream>
+#include <vector>
+#include "audio_map_reconcile.h"
+
+static struct avdecc_lib::audio_map_mapping make_mapping(uint16_t stream_index, uint16_t stream_channel,
+                                                         uint16_t cluster_offset, uint16_t cluster_channel)
+{
+    struct avdecc_lib::audio_map_mapping mapping;
+
+    mapping.stream_index = stream_index;
+    mapping.stream_channel = stream_channel;
+    mapping.cluster_offset = cluster_offset;
+    mapping.cluster_channel = cluster_channel;
+
+    return mapping;
+}
+
+static bool same_mapping(const struct avdecc_lib::audio_map_mapping & a, const struct avdecc_lib::audio_map_mapping & b)
+{
+    return a.stream_index == b.stream_index && a.stream_channel == b.stream_channel &&
+           a.cluster_offset == b.cluster_offset && a.cluster_channel == b.cluster_channel;
+}
+
+static bool check_mappings(const char * name, const std::vector<struct avdecc_lib::audio_map_mapping> & got,
+                           const struct avdecc_lib::audio_map_mapping * expected, size_t expected_count)
+{
+    if (got.size() != expected_count)
+    {
+        std::cout << "ERROR: " << name << " count, Expected: " << expected_count << ", Got: " << got.size() << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < expected_count; i++)
+    {
+        if (!same_mapping(got[i], expected[i]))
+        {
+            std::cout << "ERROR: " << name << " mapping " << i << " differs" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    std::vector<struct avdecc_lib::audio_map_mapping> desired;
+    std::vector<struct avdecc_lib::audio_map_mapping> to_remove;
+    std::vector<struct avdecc_lib::audio_map_mapping> to_add;
+
+    // Ordered by stream index, stream channel, cluster offset, then cluster channel
+    if (!avdecc_lib::audio_map_reconcile::mapping_less(make_mapping(0, 1, 9, 9), make_mapping(1, 0, 0, 0)) ||
+        !avdecc_lib::audio_map_reconcile::mapping_less(make_mapping(1, 0, 9, 9), make_mapping(1, 1, 0, 0)) ||
+        !avdecc_lib::audio_map_reconcile::mapping_less(make_mapping(1, 1, 0, 9), make_mapping(1, 1, 1, 0)) ||
+        !avdecc_lib::audio_map_reconcile::mapping_less(make_mapping(1, 1, 1, 0), make_mapping(1, 1, 1, 1)) ||
+        avdecc_lib::audio_map_reconcile::mapping_less(make_mapping(1, 1, 1, 1), make_mapping(1, 1, 1, 1)))
+    {
+        std::cout << "ERROR: mapping_less order" << std::endl;
+        return 1;
+    }
+
+    // The desired mappings are sorted and unique
+    desired.push_back(make_mapping(0, 0, 0, 0));
+    desired.push_back(make_mapping(0, 1, 0, 1));
+    desired.push_back(make_mapping(1, 0, 1, 0));
+    desired.push_back(make_mapping(1, 1, 1, 1));
+
+    // The current map is unordered, has a duplicate, two unwanted mappings and lacks two desired ones
+    struct avdecc_lib::audio_map_mapping current[] = {
+        make_mapping(2, 0, 0, 0),
+        make_mapping(1, 1, 1, 1),
+        make_mapping(0, 0, 0, 0),
+        make_mapping(0, 1, 0, 2),
+        make_mapping(1, 1, 1, 1),
+    };
+    struct avdecc_lib::audio_map_mapping expected_remove[] = {
+        make_mapping(0, 1, 0, 2),
+        make_mapping(2, 0, 0, 0),
+    };
+    struct avdecc_lib::audio_map_mapping expected_add[] = {
+        make_mapping(0, 1, 0, 1),
+        make_mapping(1, 0, 1, 0),
+    };
+
+    avdecc_lib::audio_map_reconcile::diff(desired, current, sizeof(current) / sizeof(current[0]), to_remove, to_add);
+    if (!check_mappings("remove", to_remove, expected_remove, sizeof(expected_remove) / sizeof(expected_remove[0])) ||
+        !check_mappings("add", to_add, expected_add, sizeof(expected_add) / sizeof(expected_add[0])))
+        return 1;
+
+    // A map already in the desired state needs no commands, whatever its order
+    struct avdecc_lib::audio_map_mapping reordered[] = {
+        make_mapping(1, 1, 1, 1),
+        make_mapping(1, 0, 1, 0),
+        make_mapping(0, 1, 0, 1),
+        make_mapping(0, 0, 0, 0),
+    };
+    avdecc_lib::audio_map_reconcile::diff(desired, reordered, sizeof(reordered) / sizeof(reordered[0]), to_remove, to_add);
+    if (!to_remove.empty() || !to_add.empty())
+    {
+        std::cout << "ERROR: a map in the desired state differs" << std::endl;
+        return 1;
+    }
+
+    // An empty map gets every desired mapping, and an empty desired map removes every current one
+    avdecc_lib::audio_map_reconcile::diff(desired, NULL, 0, to_remove, to_add);
+    if (!check_mappings("add to empty", to_add, &desired[0], desired.size()) || !to_remove.empty())
+        return 1;
+
+    std::vector<struct avdecc_lib::audio_map_mapping> none;
+    avdecc_lib::audio_map_reconcile::diff(none, &desired[0], desired.size(), to_remove, to_add);
+    if (!check_mappings("remove all", to_remove, &desired[0], desired.size()) || !to_add.empty())
+        return 1;
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
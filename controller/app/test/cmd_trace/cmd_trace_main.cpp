@@ -0,0 +1,128 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_trace_main.cpp
+ *
+ * Testing the command trace event ring and JSON writer
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cmd_trace.h"
+
+static const char * trace_path = "test_cmd_trace.json";
+
+enum
+{
+    THREAD_COUNT = 4,
+    EVENTS_PER_THREAD = 2000
+};
+
+static void post_events(avdecc_lib::cmd_trace * trace, uint64_t thread_index)
+{
+    for (uint64_t i = 0; i < EVENTS_PER_THREAD; i++)
+        trace->post_trace_event(avdecc_lib::cmd_trace::TRACE_ASYNC_BEGIN, "aecp", "test", thread_index * EVENTS_PER_THREAD + i, thread_index, (int64_t)i);
+}
+
+static size_t count_of(const std::string & text, const char * pattern)
+{
+    size_t count = 0;
+
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+        count++;
+
+    return count;
+}
+
+int main()
+{
+    avdecc_lib::cmd_trace trace;
+
+    // Events posted while tracing is disabled are not recorded
+    trace.post_trace_event(avdecc_lib::cmd_trace::TRACE_INSTANT, "aecp", "before", 0);
+
+    if (trace.start(trace_path) != 0)
+    {
+        std::cout << "ERROR: start " << trace_path << std::endl;
+        return 1;
+    }
+
+    if (trace.start(trace_path) == 0)
+    {
+        std::cout << "ERROR: started twice" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < THREAD_COUNT; t++)
+        threads.push_back(std::thread(post_events, &trace, t));
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+
+    trace.stop();
+    trace.post_trace_event(avdecc_lib::cmd_trace::TRACE_INSTANT, "aecp", "after", 0);
+
+    std::ifstream in(trace_path);
+    std::stringstream text;
+    text << in.rdbuf();
+    std::string json = text.str();
+    remove(trace_path);
+
+    if (json.compare(0, strlen("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"), "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n") != 0 ||
+        json.size() < 4 || json.compare(json.size() - 4, 4, "\n]}\n") != 0)
+    {
+        std::cout << "ERROR: the trace is not a complete JSON document" << std::endl;
+        return 1;
+    }
+
+    size_t written = count_of(json, "\"name\":\"test\"");
+    if (written + trace.missed_trace_event_count() != THREAD_COUNT * EVENTS_PER_THREAD)
+    {
+        std::cout << "ERROR: events, Expected: " << THREAD_COUNT * EVENTS_PER_THREAD << ", Got: " << written
+                  << " written and " << trace.missed_trace_event_count() << " dropped" << std::endl;
+        return 1;
+    }
+
+    if (count_of(json, "\"before\"") || count_of(json, "\"after\""))
+    {
+        std::cout << "ERROR: events recorded while tracing is disabled" << std::endl;
+        return 1;
+    }
+
+    // Every written event is complete, with its id and arguments
+    if (count_of(json, "\"id\":\"0x") != written || count_of(json, "\"args\":{\"entity_id\":\"0x") != written)
+    {
+        std::cout << "ERROR: incomplete events" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * counter_poller_main.cpp
+ *
+ * Testing the counter deltas and rates of GET_COUNTERS samples
+ */
+
+#include <math.h>
+#include <iostream>
+#include "counter_poller.h"
+
+struct delta_test
+{
+    uint32_t previous_counter;
+    uint32_t counter;
+    uint32_t delta;
+};
+
+static const struct delta_test delta_tests[] =
+{
+    {0, 0, 0},
+    {0, 1, 1},
+    {100, 250, 150},
+    {0x7FFFFFFF, 0x80000000, 1},
+    // A counter that wrapped around since the previous sample
+    {0xFFFFFFFF, 0, 1},
+    {0xFFFFFFF0, 0x10, 0x20},
+    {0x80000000, 0x7FFFFFFF, 0xFFFFFFFF},
+    // A full wrap is indistinguishable from no change
+    {1234, 1234, 0},
+};
+
+struct rate_test
+{
+    uint32_t delta;
+    uint32_t interval_ms;
+    float rate;
+};
+
+static const struct rate_test rate_tests[] =
+{
+    // The first sample has no interval
+    {100, 0, 0.0f},
+    {0, 1000, 0.0f},
+    {100, 1000, 100.0f},
+    {100, 250, 400.0f},
+    {3, 2000, 1.5f},
+    {0xFFFFFFFF, 1000, 4294967295.0f},
+};
+
+int main()
+{
+    for (size_t i = 0; i < sizeof(delta_tests) / sizeof(delta_tests[0]); i++)
+    {
+        const struct delta_test & t = delta_tests[i];
+        uint32_t delta = avdecc_lib::counter_poller::counter_delta(t.counter, t.previous_counter);
+
+        if (delta != t.delta)
+        {
+            std::cout << "ERROR: delta " << t.previous_counter << " -> " << t.counter
+                      << ", Expected: " << t.delta << ", Got: " << delta << std::endl;
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(rate_tests) / sizeof(rate_tests[0]); i++)
+    {
+        const struct rate_test & t = rate_tests[i];
+        float rate = avdecc_lib::counter_poller::counter_rate(t.delta, t.interval_ms);
+
+        if (fabsf(rate - t.rate) > t.rate * 1e-6f)
+        {
+            std::cout << "ERROR: rate of " << t.delta << " in " << t.interval_ms << " ms"
+                      << ", Expected: " << t.rate << ", Got: " << rate << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * entity_farm_main.cpp
+ *
+ * Testing discovery and enumeration of a virtual entity farm through a transport network interface
+ */
+
+#include <stdlib.h>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include "net_interface.h"
+#include "controller.h"
+#include "system.h"
+#include "end_station.h"
+#include "entity_descriptor.h"
+#include "configuration_descriptor.h"
+#include "enumeration.h"
+#include "entity_farm.h"
+
+enum
+{
+    DEFAULT_ENTITY_COUNT = 64,
+    ENUMERATION_TIMEOUT_S = 60
+};
+
+static const uint64_t first_entity_id = UINT64_C(0x0200010000000000);
+
+static const avdecc_lib::virtual_entity_template entity_templates[] =
+{
+    {UINT64_C(0x0200010000000001), "farm listener", 4, 0},
+    {UINT64_C(0x0200010000000002), "farm talker", 0, 4},
+    {UINT64_C(0x0200010000000003), "farm bridge", 2, 2},
+};
+
+static std::mutex enumerated_lock;
+static std::condition_variable enumerated_cv;
+static std::set<uint64_t> enumerated; // The End Stations that have completed enumeration
+
+static void notification_callback(void * user_obj, int32_t notification_type, uint64_t entity_id, uint32_t msg_type,
+                                  uint16_t cmd_type, uint16_t desc_type, uint16_t desc_index, uint32_t cmd_status,
+                                  void * notification_id)
+{
+    if (notification_type != avdecc_lib::END_STATION_READ_COMPLETED)
+        return;
+
+    std::lock_guard<std::mutex> guard(enumerated_lock);
+    enumerated.insert(entity_id);
+    enumerated_cv.notify_all();
+}
+
+static void acmp_notification_callback(void * user_obj, int32_t notification_type, uint16_t cmd_type,
+                                       uint64_t talker_entity_id, uint16_t talker_unique_id,
+                                       uint64_t listener_entity_id, uint16_t listener_unique_id,
+                                       uint32_t cmd_status, void * notification_id)
+{
+}
+
+static void log_callback(void * user_obj, int32_t log_level, const char * log_msg, int32_t time_stamp_ms)
+{
+    std::cout << "[LOG] " << log_msg << std::endl;
+}
+
+static bool check_end_stations(avdecc_lib::controller * controller_obj, avdecc_lib::entity_farm * farm)
+{
+    std::set<uint64_t> farm_ids;
+
+    for (uint32_t i = 0; i < farm->entity_count(); i++)
+        farm_ids.insert(farm->entity_id_by_index(i));
+
+    if (controller_obj->get_end_station_count() != farm->entity_count())
+    {
+        std::cout << "ERROR: end stations, Expected: " << farm->entity_count() << ", Got: " << controller_obj->get_end_station_count() << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < controller_obj->get_end_station_count(); i++)
+    {
+        avdecc_lib::end_station * end_station = controller_obj->get_end_station_by_index(i);
+        uint64_t entity_id = end_station->entity_id();
+
+        if (!farm_ids.erase(entity_id))
+        {
+            std::cout << "ERROR: unexpected end station 0x" << std::hex << entity_id << std::dec << std::endl;
+            return false;
+        }
+
+        // The entities are assigned the templates in turn
+        const avdecc_lib::virtual_entity_template & t =
+            entity_templates[(entity_id - first_entity_id) % (sizeof(entity_templates) / sizeof(entity_templates[0]))];
+        avdecc_lib::entity_descriptor * entity = end_station->entity_desc_count() ? end_station->get_entity_desc_by_index(0) : NULL;
+        avdecc_lib::configuration_descriptor * config = (entity && entity->config_desc_count()) ? entity->get_config_desc_by_index(0) : NULL;
+
+        if (!config ||
+            (config->stream_input_desc_count() != t.stream_input_count) ||
+            (config->stream_output_desc_count() != t.stream_output_count))
+        {
+            std::cout << "ERROR: descriptors of end station 0x" << std::hex << entity_id << std::dec << " do not match its template" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t entity_count = (argc > 1) ? (uint32_t)atoi(argv[1]) : (uint32_t)DEFAULT_ENTITY_COUNT;
+    avdecc_lib::entity_farm_config config;
+
+    config.entity_count = entity_count;
+    config.first_entity_id = first_entity_id;
+    config.templates = entity_templates;
+    config.template_count = sizeof(entity_templates) / sizeof(entity_templates[0]);
+    config.advertise_interval_ms = 2000;
+    config.latency_min_ms = 1;
+    config.latency_max_ms = 5;
+    config.loss_percent = 0;
+    config.reorder_percent = 0;
+    config.seed = 1;
+    config.clock = NULL;
+
+    avdecc_lib::entity_farm * farm = avdecc_lib::create_entity_farm(config);
+    if (!farm)
+    {
+        std::cout << "ERROR: create_entity_farm" << std::endl;
+        return 1;
+    }
+
+    avdecc_lib::net_interface * netif = avdecc_lib::create_net_interface_with_transport(farm);
+    if (!netif)
+    {
+        std::cout << "ERROR: create_net_interface_with_transport" << std::endl;
+        farm->destroy();
+        return 1;
+    }
+
+    avdecc_lib::controller * controller_obj = avdecc_lib::create_controller(netif, notification_callback, acmp_notification_callback,
+                                                                            log_callback, avdecc_lib::LOGGING_LEVEL_ERROR);
+    avdecc_lib::system * sys = avdecc_lib::create_system(avdecc_lib::system::LAYER2_MULTITHREADED_CALLBACK, netif, controller_obj);
+    netif->select_interface_by_num(1);
+    farm->start();
+    sys->process_start();
+
+    size_t enumerated_count;
+    {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(ENUMERATION_TIMEOUT_S);
+        std::unique_lock<std::mutex> lock(enumerated_lock);
+
+        while (enumerated.size() < entity_count)
+        {
+            if (enumerated_cv.wait_until(lock, deadline) == std::cv_status::timeout)
+                break;
+        }
+        enumerated_count = enumerated.size();
+    }
+
+    bool is_passed = (enumerated_count == entity_count) && check_end_stations(controller_obj, farm);
+    if (enumerated_count != entity_count)
+        std::cout << "ERROR: enumerated end stations, Expected: " << entity_count << ", Got: " << enumerated_count << std::endl;
+
+    sys->process_close();
+    sys->destroy();
+    controller_obj->destroy();
+    netif->destroy();
+    farm->destroy();
+
+    if (!is_passed)
+        return 1;
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
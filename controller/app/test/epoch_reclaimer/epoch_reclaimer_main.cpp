@@ -0,0 +1,130 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * epoch_reclaimer_main.cpp
+ *
+ * Testing that retired objects are only freed once no reader can hold them and their hold time has passed
+ */
+
+#include <iostream>
+#include "controller_context.h"
+#include "virtual_clock_imp.h"
+#include "epoch_reclaimer.h"
+
+static avdecc_lib::virtual_clock_imp * test_clock;
+
+static void free_counted(void * obj)
+{
+    (*(int *)obj)++;
+}
+
+// The hold timers run on the virtual clock, so each reclaim is made a millisecond later
+static void reclaim_later(avdecc_lib::epoch_reclaimer & reclaimer, uint32_t ms)
+{
+    test_clock->advance(ms);
+    reclaimer.reclaim();
+}
+
+static int expect_freed(const char * test, int freed, int expected)
+{
+    if (freed != expected)
+    {
+        std::cout << "ERROR: " << test << ", Expected: freed " << expected << " times, Got: " << freed << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    test_clock = new avdecc_lib::virtual_clock_imp();
+    avdecc_lib::controller_context::default_context()->clock_obj = test_clock;
+
+    avdecc_lib::epoch_reclaimer * reclaimer = new avdecc_lib::epoch_reclaimer();
+    int freed = 0;
+
+    // Without readers an object is freed once the epoch is two ahead of the epoch it was retired in
+    reclaimer->retire(free_counted, &freed, 0);
+    reclaim_later(*reclaimer, 1);
+    if (expect_freed("retired without readers, one reclaim", freed, 0))
+        return 1;
+    reclaim_later(*reclaimer, 1);
+    if (expect_freed("retired without readers, two reclaims", freed, 1))
+        return 1;
+
+    // A reader that entered before the object was retired keeps it until the reader leaves
+    freed = 0;
+    {
+        avdecc_lib::epoch_guard guard(*reclaimer);
+
+        reclaimer->retire(free_counted, &freed, 0);
+        for (int i = 0; i < 10; i++)
+            reclaim_later(*reclaimer, 1);
+        if (expect_freed("retired while a reader is entered", freed, 0))
+            return 1;
+    }
+    reclaim_later(*reclaimer, 1);
+    reclaim_later(*reclaimer, 1);
+    if (expect_freed("retired once the reader has left", freed, 1))
+        return 1;
+
+    // A reader that entered after the object was retired cannot hold it, and does not keep it
+    freed = 0;
+    reclaimer->retire(free_counted, &freed, 0);
+    reclaim_later(*reclaimer, 1);
+    {
+        avdecc_lib::epoch_guard guard(*reclaimer);
+
+        reclaim_later(*reclaimer, 1);
+        if (expect_freed("retired before a reader entered", freed, 1))
+            return 1;
+    }
+
+    // An object is held for its hold time, even once no reader can hold it
+    freed = 0;
+    reclaimer->retire(free_counted, &freed, 100);
+    reclaim_later(*reclaimer, 50);
+    reclaim_later(*reclaimer, 50);
+    if (expect_freed("retired with a hold time, before the hold time", freed, 0))
+        return 1;
+    reclaim_later(*reclaimer, 1);
+    if (expect_freed("retired with a hold time, after the hold time", freed, 1))
+        return 1;
+
+    // The objects left are freed with the reclaimer
+    freed = 0;
+    reclaimer->retire(free_counted, &freed, 0);
+    reclaimer->retire(free_counted, &freed, 100000);
+    delete reclaimer;
+    if (expect_freed("retired when the reclaimer is deleted", freed, 2))
+        return 1;
+
+    avdecc_lib::controller_context::default_context()->clock_obj = NULL;
+    delete test_clock;
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,271 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * frame_recorder_main.cpp
+ *
+ * Testing the pcapng file written by the frame recorder
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "pcapng.h"
+#include "frame_recorder.h"
+
+static const char * capture_path = "test_frame_recorder.pcapng";
+static const uint64_t controller_mac = UINT64_C(0x0200000000AB);
+
+enum
+{
+    MAX_FRAME_LEN = 1522,
+    RING_FRAMES = 64,
+    SMALL_RING_FRAMES = 2,
+    BURST_FRAMES = 500
+};
+
+struct captured_frame
+{
+    uint32_t direction;
+    std::vector<uint8_t> data;
+};
+
+static uint16_t get_u16(const std::vector<uint8_t> & file, size_t offset)
+{
+    uint16_t value;
+    memcpy(&value, &file[offset], sizeof(value));
+    return value;
+}
+
+static uint32_t get_u32(const std::vector<uint8_t> & file, size_t offset)
+{
+    uint32_t value;
+    memcpy(&value, &file[offset], sizeof(value));
+    return value;
+}
+
+static void make_frame(uint8_t * frame, size_t frame_len, uint32_t seed)
+{
+    for (size_t i = 0; i < frame_len; i++)
+        frame[i] = (uint8_t)(seed * 7 + i);
+}
+
+///
+/// Check the section header and interface description blocks, and read the enhanced packet blocks.
+///
+static bool parse_capture(std::vector<captured_frame> & frames)
+{
+    std::ifstream in(capture_path, std::ios::binary);
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t offset = 0;
+    bool has_tsresol = false;
+    bool has_mac = false;
+
+    in.close();
+    remove(capture_path);
+    frames.clear();
+
+    if ((file.size() < 28) || (get_u32(file, 0) != avdecc_lib::pcapng::SECTION_HEADER_BLOCK) ||
+        (get_u32(file, 8) != avdecc_lib::pcapng::BYTE_ORDER_MAGIC) ||
+        (get_u16(file, 12) != avdecc_lib::pcapng::VERSION_MAJOR))
+    {
+        std::cout << "ERROR: no section header block" << std::endl;
+        return false;
+    }
+
+    while (offset < file.size())
+    {
+        if (offset + 12 > file.size())
+        {
+            std::cout << "ERROR: truncated block at " << offset << std::endl;
+            return false;
+        }
+
+        uint32_t block_type = get_u32(file, offset);
+        uint32_t block_len = get_u32(file, offset + 4);
+        if ((block_len % 4) || (block_len < 12) || (offset + block_len > file.size()) ||
+            (get_u32(file, offset + block_len - 4) != block_len))
+        {
+            std::cout << "ERROR: block length " << block_len << " at " << offset << std::endl;
+            return false;
+        }
+
+        if (block_type == avdecc_lib::pcapng::INTERFACE_DESCRIPTION_BLOCK)
+        {
+            if (get_u16(file, offset + 8) != avdecc_lib::pcapng::LINKTYPE_ETHERNET)
+            {
+                std::cout << "ERROR: link type" << std::endl;
+                return false;
+            }
+
+            // Options, up to the block trailer
+            for (size_t opt = offset + 16; opt + 4 <= offset + block_len - 4;)
+            {
+                uint16_t code = get_u16(file, opt);
+                uint16_t len = get_u16(file, opt + 2);
+
+                if (code == avdecc_lib::pcapng::OPT_ENDOFOPT)
+                    break;
+                if ((code == avdecc_lib::pcapng::IF_TSRESOL) && (len == 1) && (file[opt + 4] == 9))
+                    has_tsresol = true;
+                if ((code == avdecc_lib::pcapng::IF_MACADDR) && (len == 6) &&
+                    (file[opt + 4] == 0x02) && (file[opt + 9] == 0xAB))
+                    has_mac = true;
+                opt += 4 + avdecc_lib::pcapng::padded_len(len);
+            }
+        }
+        else if (block_type == avdecc_lib::pcapng::ENHANCED_PACKET_BLOCK)
+        {
+            uint32_t captured_len = get_u32(file, offset + 20);
+            uint32_t original_len = get_u32(file, offset + 24);
+            size_t options = offset + 28 + avdecc_lib::pcapng::padded_len(captured_len);
+            captured_frame frame;
+
+            if ((captured_len != original_len) || (options + 12 > offset + block_len) ||
+                (get_u16(file, options) != avdecc_lib::pcapng::EPB_FLAGS) || (get_u16(file, options + 2) != 4))
+            {
+                std::cout << "ERROR: enhanced packet block at " << offset << std::endl;
+                return false;
+            }
+
+            frame.direction = get_u32(file, options + 4) & avdecc_lib::pcapng::DIRECTION_MASK;
+            frame.data.assign(file.begin() + offset + 28, file.begin() + offset + 28 + captured_len);
+            frames.push_back(frame);
+        }
+        else if (block_type != avdecc_lib::pcapng::SECTION_HEADER_BLOCK)
+        {
+            std::cout << "ERROR: unexpected block type " << block_type << std::endl;
+            return false;
+        }
+
+        offset += block_len;
+    }
+
+    if (!has_tsresol || !has_mac)
+    {
+        std::cout << "ERROR: interface description block options" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    avdecc_lib::frame_recorder recorder;
+    std::vector<captured_frame> frames;
+    uint8_t frame[2048];
+
+    // Frames of every padding length, the longest frame, and a longer frame that is truncated
+    const size_t frame_lens[] = {60, 61, 62, 63, 64, MAX_FRAME_LEN, 2000};
+    const size_t frame_count = sizeof(frame_lens) / sizeof(frame_lens[0]);
+
+    // Frames recorded while not recording are ignored
+    recorder.record(avdecc_lib::frame_recorder::RX, frame, 60);
+
+    if (recorder.start(capture_path, RING_FRAMES, controller_mac) != 0)
+    {
+        std::cout << "ERROR: start " << capture_path << std::endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < frame_count; i++)
+    {
+        make_frame(frame, frame_lens[i], (uint32_t)i);
+        recorder.record((i % 2) ? avdecc_lib::frame_recorder::TX : avdecc_lib::frame_recorder::RX, frame, frame_lens[i]);
+    }
+
+    if (recorder.stop() != 0)
+    {
+        std::cout << "ERROR: frames dropped with a ring that is large enough" << std::endl;
+        return 1;
+    }
+
+    if (!parse_capture(frames))
+        return 1;
+
+    if (frames.size() != frame_count)
+    {
+        std::cout << "ERROR: frames, Expected: " << frame_count << ", Got: " << frames.size() << std::endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < frame_count; i++)
+    {
+        size_t expected_len = (frame_lens[i] < (size_t)MAX_FRAME_LEN) ? frame_lens[i] : (size_t)MAX_FRAME_LEN;
+        uint32_t expected_direction = (i % 2) ? avdecc_lib::pcapng::DIRECTION_OUTBOUND : avdecc_lib::pcapng::DIRECTION_INBOUND;
+
+        make_frame(frame, expected_len, (uint32_t)i);
+        if ((frames[i].data.size() != expected_len) || memcmp(&frames[i].data[0], frame, expected_len) ||
+            (frames[i].direction != expected_direction))
+        {
+            std::cout << "ERROR: frame " << i << " differs" << std::endl;
+            return 1;
+        }
+    }
+
+    // A burst into a small ring drops frames instead of waiting, and keeps the order of the others
+    if (recorder.start(capture_path, SMALL_RING_FRAMES, controller_mac) != 0)
+    {
+        std::cout << "ERROR: restart " << capture_path << std::endl;
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < BURST_FRAMES; i++)
+    {
+        memset(frame, 0, 60);
+        memcpy(frame, &i, sizeof(i));
+        recorder.record(avdecc_lib::frame_recorder::RX, frame, 60);
+    }
+
+    uint64_t dropped = recorder.stop();
+    if (!parse_capture(frames))
+        return 1;
+
+    if (frames.size() + dropped != BURST_FRAMES)
+    {
+        std::cout << "ERROR: burst frames, Expected: " << BURST_FRAMES << ", Got: " << frames.size()
+                  << " written and " << dropped << " dropped" << std::endl;
+        return 1;
+    }
+
+    for (size_t i = 1; i < frames.size(); i++)
+    {
+        uint32_t previous;
+        uint32_t current;
+
+        memcpy(&previous, &frames[i - 1].data[0], sizeof(previous));
+        memcpy(&current, &frames[i].data[0], sizeof(current));
+        if (current <= previous)
+        {
+            std::cout << "ERROR: burst frames out of order" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
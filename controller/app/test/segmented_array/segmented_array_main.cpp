@@ -0,0 +1,128 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * segmented_array_main.cpp
+ *
+ * Testing the segment and offset of each element of the segmented array holding the End Stations
+ */
+
+#include <iostream>
+#include "segmented_array.h"
+
+typedef avdecc_lib::segmented_array<size_t> test_array;
+
+struct segment_test
+{
+    size_t index;
+    size_t segment;
+    size_t offset;
+};
+
+static const struct segment_test segment_tests[] =
+{
+    {0, 0, 0},
+    {15, 0, 15},
+    {16, 1, 0},
+    {47, 1, 31},
+    {48, 2, 0},
+    {111, 2, 63},
+    {112, 3, 0},
+    {1000, 5, 504},
+    // The last element of the last segment, and the first element past it
+    {((size_t)test_array::FIRST_SEGMENT_SIZE << test_array::MAX_SEGMENTS) - test_array::FIRST_SEGMENT_SIZE - 1,
+     test_array::MAX_SEGMENTS - 1, ((size_t)test_array::FIRST_SEGMENT_SIZE << (test_array::MAX_SEGMENTS - 1)) - 1},
+    {((size_t)test_array::FIRST_SEGMENT_SIZE << test_array::MAX_SEGMENTS) - test_array::FIRST_SEGMENT_SIZE,
+     test_array::MAX_SEGMENTS, 0},
+};
+
+int main()
+{
+    for (size_t i = 0; i < sizeof(segment_tests) / sizeof(segment_tests[0]); i++)
+    {
+        const struct segment_test & t = segment_tests[i];
+        size_t offset;
+        size_t segment = test_array::segment_of(t.index, offset);
+
+        if (segment != t.segment || offset != t.offset)
+        {
+            std::cout << "ERROR: index " << t.index << ", Expected: segment " << t.segment << " offset " << t.offset
+                      << ", Got: segment " << segment << " offset " << offset << std::endl;
+            return 1;
+        }
+    }
+
+    // Every index maps to the next free slot, and no two indexes share one
+    size_t expected_segment = 0;
+    size_t expected_offset = 0;
+    for (size_t i = 0; i < 100000; i++)
+    {
+        size_t offset;
+        size_t segment = test_array::segment_of(i, offset);
+
+        if (segment != expected_segment || offset != expected_offset)
+        {
+            std::cout << "ERROR: index " << i << " is in segment " << segment << " offset " << offset << std::endl;
+            return 1;
+        }
+
+        if (++expected_offset == ((size_t)test_array::FIRST_SEGMENT_SIZE << expected_segment))
+        {
+            expected_segment++;
+            expected_offset = 0;
+        }
+    }
+
+    test_array elements;
+    for (size_t i = 0; i < 5000; i++)
+        elements.push_back(new size_t(i));
+
+    if (elements.size() != 5000)
+    {
+        std::cout << "ERROR: Expected 5000 elements, Got: " << elements.size() << std::endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+        if (*elements.at(i) != i)
+        {
+            std::cout << "ERROR: element " << i << " holds " << *elements.at(i) << std::endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        elements.at(elements.size());
+        std::cout << "ERROR: Expected out_of_range past the last element" << std::endl;
+        return 1;
+    }
+    catch (const std::out_of_range &)
+    {
+    }
+
+    std::cout << "Passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * entity_farm.h
+ *
+ * Public virtual entity farm class, which simulates a network of AVDECC entities in-process
+ * for testing and benchmarking the library without network access.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "net_interface.h"
+#include "virtual_clock.h"
+
+namespace avdecc_lib
+{
+///
+/// The AEM model of a group of virtual entities.
+///
+struct virtual_entity_template
+{
+    uint64_t entity_model_id;
+    const char * entity_name;
+    uint16_t stream_input_count;
+    uint16_t stream_output_count;
+};
+
+///
+/// The configuration of a virtual entity farm.
+///
+struct entity_farm_config
+{
+    uint32_t entity_count;                     ///< The number of virtual entities
+    uint64_t first_entity_id;                  ///< The entity id of the first entity, later entities count up from it
+    const virtual_entity_template * templates; ///< The templates, assigned to the entities in turn
+    uint32_t template_count;                   ///< The number of templates
+    uint32_t advertise_interval_ms;            ///< The interval between ENTITY_AVAILABLE advertisements of an entity, below the 62 s valid time
+    uint32_t latency_min_ms;                   ///< The minimum delay of a response
+    uint32_t latency_max_ms;                   ///< The maximum delay of a response
+    uint32_t loss_percent;                     ///< The percentage of frames that are lost
+    uint32_t reorder_percent;                  ///< The percentage of responses that are delayed past later responses
+    uint32_t seed;                             ///< The seed of the random number generator
+    virtual_clock * clock;                     ///< The virtual clock to run the farm on instead of a thread, or NULL for the real clock
+};
+
+///
+/// The frame counters of a virtual entity farm.
+///
+struct entity_farm_stats
+{
+    uint64_t frames_received;  ///< Frames sent by the controller
+    uint64_t frames_sent;      ///< Frames delivered to the controller
+    uint64_t frames_lost;      ///< Frames dropped to simulate loss
+    uint64_t frames_reordered; ///< Responses delayed to simulate reordering
+};
+
+///
+/// A simulated network of AVDECC entities.
+///
+/// The entities send ADP advertisements, answer READ_DESCRIPTOR commands from their template
+/// and handle ACMP connect and disconnect commands. Pass the farm to
+/// create_net_interface_with_transport() to connect a controller to it.
+///
+/// A farm on a virtual clock has no thread. Each advance of the clock advertises the entities
+/// and delivers the responses that are due, so that a controller on the same clock can run long
+/// scenarios with many entities faster than real time.
+///
+class entity_farm : public net_transport
+{
+public:
+    ///
+    /// Stop the farm and destroy it.
+    ///
+    virtual void STDCALL destroy() = 0;
+
+    ///
+    /// Start the farm thread, which advertises the entities and delivers responses, or start
+    /// listening to the virtual clock.
+    ///
+    /// \return 0 on success, -1 if the farm is already started.
+    ///
+    virtual int STDCALL start() = 0;
+
+    ///
+    /// Stop the farm thread or stop listening to the virtual clock. Frames that are not delivered
+    /// yet are discarded.
+    ///
+    virtual void STDCALL stop() = 0;
+
+    ///
+    /// \return The number of virtual entities.
+    ///
+    virtual uint32_t STDCALL entity_count() = 0;
+
+    ///
+    /// \return The entity id of a virtual entity by index.
+    ///
+    virtual uint64_t STDCALL entity_id_by_index(uint32_t index) = 0;
+
+    ///
+    /// Get the frame counters of the farm.
+    ///
+    virtual void STDCALL get_stats(entity_farm_stats & stats) = 0;
+};
+
+///
+/// Create a virtual entity farm.
+///
+/// \return The farm, or NULL if the configuration is not valid.
+///
+entity_farm * STDCALL create_entity_farm(const entity_farm_config & config);
+}
@@ -0,0 +1,685 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * entity_farm_imp.cpp
+ *
+ * Virtual entity farm implementation
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <algorithm>
+
+#include "jdksavdecc.h"
+#include "enumeration.h"
+#include "entity_farm_imp.h"
+
+namespace avdecc_lib
+{
+namespace
+{
+    const uint64_t controller_mac = UINT64_C(0x020000000001);    ///< Locally administered MAC address of the controller
+    const uint64_t entity_mac_base = UINT64_C(0x020001000000);   ///< Locally administered MAC addresses of the entities count up from it
+    const uint64_t stream_format = UINT64_C(0x00a0020840000800); ///< IEC 61883-6 AM824, 48 kHz, 8 channels
+
+    void set_name(uint8_t * dest, const char * name)
+    {
+        if (name)
+            memcpy(dest, name, strnlen(name, 64));
+    }
+
+    void set_mac(uint8_t * dest, uint64_t mac)
+    {
+        for (int i = 0; i < 6; i++)
+            dest[i] = (uint8_t)(mac >> (8 * (5 - i)));
+    }
+}
+
+entity_farm * STDCALL create_entity_farm(const entity_farm_config & config)
+{
+    if ((config.entity_count == 0) || (config.entity_count > 0xFFFFFF) ||
+        !config.templates || (config.template_count == 0) ||
+        (config.advertise_interval_ms == 0) ||
+        (config.latency_min_ms > config.latency_max_ms) ||
+        (config.loss_percent > 100) || (config.reorder_percent > 100))
+    {
+        return NULL;
+    }
+
+    return (new entity_farm_imp(config));
+}
+
+entity_farm_imp::entity_farm_imp(const entity_farm_config & config) : m_config(config), m_rng(config.seed)
+{
+    m_controller_mac = controller_mac;
+    m_running = false;
+    m_sequence = 0;
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    if (pipe(m_pipe) == 0)
+    {
+        fcntl(m_pipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(m_pipe[1], F_SETFL, O_NONBLOCK);
+    }
+    else
+    {
+        m_pipe[0] = m_pipe[1] = -1;
+    }
+
+    // Spread the first advertisements over the advertise interval
+    farm_clock::time_point start_time = now();
+    m_entities.resize(m_config.entity_count);
+    for (uint32_t i = 0; i < m_config.entity_count; i++)
+    {
+        virtual_entity & entity = m_entities[i];
+        entity.entity_id = m_config.first_entity_id + i;
+        entity.mac = entity_mac_base + i;
+        entity.model = &m_config.templates[i % m_config.template_count];
+        entity.available_index = 0;
+        entity.rx_streams.resize(entity.model->stream_input_count);
+        entity.tx_connection_counts.resize(entity.model->stream_output_count);
+
+        uint64_t offset_us = (uint64_t)m_config.advertise_interval_ms * 1000 * i / m_config.entity_count;
+        m_advertise_queue.push(std::make_pair(start_time + std::chrono::microseconds(offset_us), (size_t)i));
+        m_entity_index[entity.entity_id] = i;
+    }
+}
+
+entity_farm_imp::~entity_farm_imp()
+{
+    stop();
+
+    if (m_pipe[0] >= 0)
+    {
+        close(m_pipe[0]);
+        close(m_pipe[1]);
+    }
+}
+
+void STDCALL entity_farm_imp::destroy()
+{
+    delete this;
+}
+
+int STDCALL entity_farm_imp::start()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_running || (m_pipe[0] < 0))
+        return -1;
+
+    m_running = true;
+    if (m_config.clock)
+    {
+        m_config.clock->set_listener(this);
+        add_clock_deadline(m_advertise_queue.top().first);
+    }
+    else
+    {
+        m_thread = std::thread(&entity_farm_imp::thread_fn, this);
+    }
+    return 0;
+}
+
+void STDCALL entity_farm_imp::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+
+    if (m_config.clock)
+    {
+        m_config.clock->set_listener(NULL);
+    }
+    else
+    {
+        m_wakeup.notify_one();
+        m_thread.join();
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    while (!m_in_flight.empty())
+        m_in_flight.pop();
+    if (!m_ready.empty())
+    {
+        m_ready.clear();
+        clear_ready_signal();
+    }
+}
+
+uint32_t STDCALL entity_farm_imp::entity_count()
+{
+    return m_config.entity_count;
+}
+
+uint64_t STDCALL entity_farm_imp::entity_id_by_index(uint32_t index)
+{
+    if (index >= m_entities.size())
+        return 0;
+
+    return m_entities[index].entity_id;
+}
+
+void STDCALL entity_farm_imp::get_stats(entity_farm_stats & stats)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    stats = m_stats;
+}
+
+uint64_t STDCALL entity_farm_imp::mac_addr()
+{
+    return m_controller_mac;
+}
+
+int STDCALL entity_farm_imp::get_fd()
+{
+    return m_pipe[0];
+}
+
+int STDCALL entity_farm_imp::capture_frame(uint8_t * frame, uint16_t max_len)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_ready.empty())
+        return -1;
+
+    std::vector<uint8_t> & ready = m_ready.front();
+    uint16_t len = (uint16_t)std::min<size_t>(ready.size(), max_len);
+    memcpy(frame, ready.data(), len);
+    m_ready.pop_front();
+    m_stats.frames_sent++;
+
+    // The pipe stays readable while frames are ready
+    if (m_ready.empty())
+        clear_ready_signal();
+
+    return len;
+}
+
+int STDCALL entity_farm_imp::send_frame(const uint8_t * frame, uint16_t frame_len)
+{
+    if (frame_len < ETHER_HDR_SIZE + JDKSAVDECC_COMMON_CONTROL_HEADER_LEN)
+        return -1;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_stats.frames_received++;
+
+    if (jdksavdecc_uint16_get(frame, SRC_MAC_SIZE + DEST_MAC_SIZE) != JDKSAVDECC_AVTP_ETHERTYPE)
+        return frame_len;
+
+    switch (jdksavdecc_common_control_header_get_subtype(frame, ETHER_HDR_SIZE))
+    {
+    case JDKSAVDECC_SUBTYPE_ADP:
+        proc_adp(frame, frame_len);
+        break;
+
+    case JDKSAVDECC_SUBTYPE_AECP:
+        proc_aecp(frame, frame_len);
+        break;
+
+    case JDKSAVDECC_SUBTYPE_ACMP:
+        proc_acmp(frame, frame_len);
+        break;
+    }
+
+    m_wakeup.notify_one();
+    return frame_len;
+}
+
+void STDCALL entity_farm_imp::clock_advanced(uint64_t now_ms)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_running)
+        add_clock_deadline(run_due(farm_clock::time_point(std::chrono::milliseconds(now_ms))));
+}
+
+void entity_farm_imp::thread_fn()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    while (m_running)
+    {
+        farm_clock::time_point wakeup_at = run_due(farm_clock::now());
+        m_wakeup.wait_until(lock, wakeup_at);
+    }
+}
+
+entity_farm_imp::farm_clock::time_point entity_farm_imp::run_due(farm_clock::time_point now)
+{
+    while (m_advertise_queue.top().first <= now)
+    {
+        std::pair<farm_clock::time_point, size_t> next_advertise = m_advertise_queue.top();
+        m_advertise_queue.pop();
+        advertise(m_entities[next_advertise.second]);
+        next_advertise.first += std::chrono::milliseconds(m_config.advertise_interval_ms);
+        m_advertise_queue.push(next_advertise);
+    }
+
+    deliver_due(now);
+
+    farm_clock::time_point next = m_advertise_queue.top().first;
+    if (!m_in_flight.empty() && (m_in_flight.top().deliver_at < next))
+        next = m_in_flight.top().deliver_at;
+
+    return next;
+}
+
+entity_farm_imp::farm_clock::time_point entity_farm_imp::now()
+{
+    if (m_config.clock)
+        return farm_clock::time_point(std::chrono::milliseconds(m_config.clock->now_ms()));
+
+    return farm_clock::now();
+}
+
+void entity_farm_imp::add_clock_deadline(farm_clock::time_point time)
+{
+    if (!m_config.clock)
+        return;
+
+    // Round up, so that the clock does not stop short of the time
+    std::chrono::microseconds since_epoch = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch());
+    m_config.clock->add_deadline((uint64_t)((since_epoch.count() + 999) / 1000));
+}
+
+void entity_farm_imp::schedule(const uint8_t * frame, uint16_t len)
+{
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+    std::uniform_int_distribution<uint32_t> latency(m_config.latency_min_ms, m_config.latency_max_ms);
+
+    if (percent(m_rng) < m_config.loss_percent)
+    {
+        m_stats.frames_lost++;
+        return;
+    }
+
+    // Latency jitter reorders frames too, a reordered frame is held back past every other frame
+    uint32_t delay_ms = latency(m_rng);
+    if (percent(m_rng) < m_config.reorder_percent)
+    {
+        delay_ms += m_config.latency_max_ms + 1;
+        m_stats.frames_reordered++;
+    }
+
+    scheduled_frame scheduled;
+    scheduled.deliver_at = now() + std::chrono::milliseconds(delay_ms);
+    scheduled.sequence = m_sequence++;
+    scheduled.frame.assign(frame, frame + len);
+    m_in_flight.push(scheduled);
+    add_clock_deadline(scheduled.deliver_at);
+}
+
+void entity_farm_imp::deliver_due(farm_clock::time_point now)
+{
+    bool was_empty = m_ready.empty();
+
+    while (!m_in_flight.empty() && (m_in_flight.top().deliver_at <= now))
+    {
+        m_ready.push_back(m_in_flight.top().frame);
+        m_in_flight.pop();
+    }
+
+    if (was_empty && !m_ready.empty())
+        set_ready_signal();
+}
+
+void entity_farm_imp::set_ready_signal()
+{
+    uint8_t signal = 1;
+    if (write(m_pipe[1], &signal, 1) != 1)
+        return;
+}
+
+void entity_farm_imp::clear_ready_signal()
+{
+    uint8_t signal;
+    if (read(m_pipe[0], &signal, 1) != 1)
+        return;
+}
+
+void entity_farm_imp::write_ether_hdr(uint8_t * frame, const uint8_t * dest_mac, uint64_t src_mac)
+{
+    memcpy(frame, dest_mac, DEST_MAC_SIZE);
+    set_mac(&frame[DEST_MAC_SIZE], src_mac);
+    jdksavdecc_uint16_set(JDKSAVDECC_AVTP_ETHERTYPE, frame, SRC_MAC_SIZE + DEST_MAC_SIZE);
+}
+
+entity_farm_imp::virtual_entity * entity_farm_imp::find_entity(struct jdksavdecc_eui64 entity_id)
+{
+    std::unordered_map<uint64_t, size_t>::iterator it = m_entity_index.find(jdksavdecc_eui64_convert_to_uint64(&entity_id));
+    if (it == m_entity_index.end())
+        return NULL;
+
+    return &m_entities[it->second];
+}
+
+void entity_farm_imp::advertise(virtual_entity & entity)
+{
+    uint8_t frame[ADP_FRAME_LEN];
+    struct jdksavdecc_adpdu adpdu;
+    const virtual_entity_template * model = entity.model;
+
+    memset(frame, 0, sizeof(frame));
+    memset(&adpdu, 0, sizeof(adpdu));
+    write_ether_hdr(frame, jdksavdecc_multicast_adp_acmp.value, entity.mac);
+
+    adpdu.header.cd = 1;
+    adpdu.header.subtype = JDKSAVDECC_SUBTYPE_ADP;
+    adpdu.header.message_type = JDKSAVDECC_ADP_MESSAGE_TYPE_ENTITY_AVAILABLE;
+    adpdu.header.valid_time = ADP_VALID_TIME;
+    adpdu.header.control_data_length = JDKSAVDECC_ADPDU_LEN - JDKSAVDECC_COMMON_CONTROL_HEADER_LEN;
+    jdksavdecc_eui64_init_from_uint64(&adpdu.header.entity_id, entity.entity_id);
+    jdksavdecc_eui64_init_from_uint64(&adpdu.entity_model_id, model->entity_model_id);
+    adpdu.entity_capabilities = JDKSAVDECC_ADP_ENTITY_CAPABILITY_AEM_SUPPORTED;
+    adpdu.talker_stream_sources = model->stream_output_count;
+    adpdu.listener_stream_sinks = model->stream_input_count;
+    if (model->stream_output_count)
+        adpdu.talker_capabilities = JDKSAVDECC_ADP_TALKER_CAPABILITY_IMPLEMENTED | JDKSAVDECC_ADP_TALKER_CAPABILITY_AUDIO_SOURCE;
+    if (model->stream_input_count)
+        adpdu.listener_capabilities = JDKSAVDECC_ADP_LISTENER_CAPABILITY_IMPLEMENTED | JDKSAVDECC_ADP_LISTENER_CAPABILITY_AUDIO_SINK;
+    adpdu.available_index = entity.available_index++;
+
+    jdksavdecc_adpdu_write(&adpdu, frame, ETHER_HDR_SIZE, sizeof(frame));
+    schedule(frame, sizeof(frame));
+}
+
+void entity_farm_imp::proc_adp(const uint8_t * frame, uint16_t len)
+{
+    if (jdksavdecc_common_control_header_get_control_data(frame, ETHER_HDR_SIZE) != JDKSAVDECC_ADP_MESSAGE_TYPE_ENTITY_DISCOVER)
+        return;
+
+    struct jdksavdecc_eui64 entity_id = jdksavdecc_common_control_header_get_stream_id(frame, ETHER_HDR_SIZE);
+
+    if (jdksavdecc_eui64_convert_to_uint64(&entity_id) == 0)
+    {
+        for (size_t i = 0; i < m_entities.size(); i++)
+            advertise(m_entities[i]);
+    }
+    else
+    {
+        virtual_entity * entity = find_entity(entity_id);
+        if (entity)
+            advertise(*entity);
+    }
+}
+
+void entity_farm_imp::proc_aecp(const uint8_t * frame, uint16_t len)
+{
+    uint8_t resp[MAX_FRAME_SIZE];
+    uint16_t resp_len = len;
+    uint32_t msg_type = jdksavdecc_common_control_header_get_control_data(frame, ETHER_HDR_SIZE);
+    uint8_t status = AEM_STATUS_NOT_IMPLEMENTED;
+
+    // Responses of other entities and frames that are too short are ignored
+    if ((msg_type & 0x1) || (len < ETHER_HDR_SIZE + JDKSAVDECC_AECPDU_AEM_LEN) || (len > sizeof(resp)))
+        return;
+
+    virtual_entity * entity = find_entity(jdksavdecc_common_control_header_get_stream_id(frame, ETHER_HDR_SIZE));
+    if (!entity)
+        return;
+
+    memset(resp, 0, sizeof(resp));
+    memcpy(resp, frame, len);
+
+    if (msg_type == JDKSAVDECC_AECP_MESSAGE_TYPE_AEM_COMMAND)
+    {
+        uint16_t cmd_type = jdksavdecc_aecpdu_aem_get_command_type(frame, ETHER_HDR_SIZE) & 0x7FFF;
+
+        switch (cmd_type)
+        {
+        case JDKSAVDECC_AEM_COMMAND_READ_DESCRIPTOR:
+            if (len >= ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_READ_DESCRIPTOR_COMMAND_LEN)
+            {
+                const uint16_t desc_pos = ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_READ_DESCRIPTOR_RESPONSE_LEN;
+                uint16_t desc_type = jdksavdecc_aem_command_read_descriptor_get_descriptor_type(frame, ETHER_HDR_SIZE);
+                uint16_t desc_index = jdksavdecc_aem_command_read_descriptor_get_descriptor_index(frame, ETHER_HDR_SIZE);
+
+                memset(&resp[desc_pos], 0, sizeof(resp) - desc_pos);
+                uint16_t desc_len = write_descriptor(*entity, desc_type, desc_index, &resp[desc_pos]);
+                if (desc_len)
+                {
+                    resp_len = desc_pos + desc_len;
+                    status = AEM_STATUS_SUCCESS;
+                }
+                else
+                {
+                    memcpy(resp, frame, len);
+                    status = AEM_STATUS_NO_SUCH_DESCRIPTOR;
+                }
+            }
+            break;
+
+        case JDKSAVDECC_AEM_COMMAND_ENTITY_AVAILABLE:
+        case JDKSAVDECC_AEM_COMMAND_ACQUIRE_ENTITY:
+        case JDKSAVDECC_AEM_COMMAND_REGISTER_UNSOLICITED_NOTIFICATION:
+        case JDKSAVDECC_AEM_COMMAND_DEREGISTER_UNSOLICITED_NOTIFICATION:
+            status = AEM_STATUS_SUCCESS;
+            break;
+        }
+    }
+
+    write_ether_hdr(resp, &frame[DEST_MAC_SIZE], entity->mac);
+    jdksavdecc_common_control_header_set_control_data(msg_type + 1, resp, ETHER_HDR_SIZE);
+    jdksavdecc_common_control_header_set_status(status, resp, ETHER_HDR_SIZE);
+    jdksavdecc_common_control_header_set_control_data_length(resp_len - ETHER_HDR_SIZE - JDKSAVDECC_COMMON_CONTROL_HEADER_LEN,
+                                                             resp, ETHER_HDR_SIZE);
+    schedule(resp, resp_len);
+}
+
+uint16_t entity_farm_imp::write_descriptor(virtual_entity & entity, uint16_t desc_type, uint16_t desc_index, uint8_t * desc)
+{
+    const virtual_entity_template * model = entity.model;
+    struct jdksavdecc_eui64 eui64;
+    struct jdksavdecc_eui48 eui48;
+
+    switch (desc_type)
+    {
+    case JDKSAVDECC_DESCRIPTOR_ENTITY:
+        if (desc_index != 0)
+            return 0;
+
+        jdksavdecc_descriptor_entity_set_descriptor_type(desc_type, desc, 0);
+        jdksavdecc_descriptor_entity_set_descriptor_index(desc_index, desc, 0);
+        jdksavdecc_eui64_init_from_uint64(&eui64, entity.entity_id);
+        jdksavdecc_descriptor_entity_set_entity_id(eui64, desc, 0);
+        jdksavdecc_eui64_init_from_uint64(&eui64, model->entity_model_id);
+        jdksavdecc_descriptor_entity_set_entity_model_id(eui64, desc, 0);
+        jdksavdecc_descriptor_entity_set_entity_capabilities(JDKSAVDECC_ADP_ENTITY_CAPABILITY_AEM_SUPPORTED, desc, 0);
+        jdksavdecc_descriptor_entity_set_talker_stream_sources(model->stream_output_count, desc, 0);
+        jdksavdecc_descriptor_entity_set_listener_stream_sinks(model->stream_input_count, desc, 0);
+        jdksavdecc_descriptor_entity_set_available_index(entity.available_index, desc, 0);
+        set_name(&desc[JDKSAVDECC_DESCRIPTOR_ENTITY_OFFSET_ENTITY_NAME], model->entity_name);
+        jdksavdecc_descriptor_entity_set_configurations_count(1, desc, 0);
+        jdksavdecc_descriptor_entity_set_current_configuration(0, desc, 0);
+        return JDKSAVDECC_DESCRIPTOR_ENTITY_LEN;
+
+    case JDKSAVDECC_DESCRIPTOR_CONFIGURATION:
+    {
+        uint16_t counts_count = 0;
+        uint16_t counts[3][2] = {{JDKSAVDECC_DESCRIPTOR_AVB_INTERFACE, 1},
+                                 {JDKSAVDECC_DESCRIPTOR_STREAM_INPUT, model->stream_input_count},
+                                 {JDKSAVDECC_DESCRIPTOR_STREAM_OUTPUT, model->stream_output_count}};
+
+        if (desc_index != 0)
+            return 0;
+
+        jdksavdecc_descriptor_configuration_set_descriptor_type(desc_type, desc, 0);
+        jdksavdecc_descriptor_configuration_set_descriptor_index(desc_index, desc, 0);
+        jdksavdecc_descriptor_configuration_set_descriptor_counts_offset(JDKSAVDECC_DESCRIPTOR_CONFIGURATION_LEN, desc, 0);
+        for (int i = 0; i < 3; i++)
+        {
+            if (counts[i][1] == 0)
+                continue;
+
+            jdksavdecc_uint16_set(counts[i][0], desc, JDKSAVDECC_DESCRIPTOR_CONFIGURATION_LEN + 4 * counts_count);
+            jdksavdecc_uint16_set(counts[i][1], desc, JDKSAVDECC_DESCRIPTOR_CONFIGURATION_LEN + 4 * counts_count + 2);
+            counts_count++;
+        }
+        jdksavdecc_descriptor_configuration_set_descriptor_counts_count(counts_count, desc, 0);
+        return JDKSAVDECC_DESCRIPTOR_CONFIGURATION_LEN + 4 * counts_count;
+    }
+
+    case JDKSAVDECC_DESCRIPTOR_STREAM_INPUT:
+    case JDKSAVDECC_DESCRIPTOR_STREAM_OUTPUT:
+        if (desc_index >= ((desc_type == JDKSAVDECC_DESCRIPTOR_STREAM_INPUT) ? model->stream_input_count : model->stream_output_count))
+            return 0;
+
+        jdksavdecc_descriptor_stream_set_descriptor_type(desc_type, desc, 0);
+        jdksavdecc_descriptor_stream_set_descriptor_index(desc_index, desc, 0);
+        jdksavdecc_eui64_init_from_uint64(&eui64, stream_format);
+        jdksavdecc_descriptor_stream_set_current_format(eui64, desc, 0);
+        jdksavdecc_descriptor_stream_set_formats_offset(JDKSAVDECC_DESCRIPTOR_STREAM_LEN, desc, 0);
+        jdksavdecc_descriptor_stream_set_number_of_formats(STREAM_FORMAT_COUNT, desc, 0);
+        jdksavdecc_eui64_set(eui64, desc, JDKSAVDECC_DESCRIPTOR_STREAM_LEN);
+        return JDKSAVDECC_DESCRIPTOR_STREAM_LEN + 8 * STREAM_FORMAT_COUNT;
+
+    case JDKSAVDECC_DESCRIPTOR_AVB_INTERFACE:
+        if (desc_index != 0)
+            return 0;
+
+        jdksavdecc_descriptor_avb_interface_set_descriptor_type(desc_type, desc, 0);
+        jdksavdecc_descriptor_avb_interface_set_descriptor_index(desc_index, desc, 0);
+        jdksavdecc_eui48_init_from_uint64(&eui48, entity.mac);
+        jdksavdecc_descriptor_avb_interface_set_mac_address(eui48, desc, 0);
+        jdksavdecc_eui64_init_from_uint64(&eui64, entity.entity_id);
+        jdksavdecc_descriptor_avb_interface_set_clock_identity(eui64, desc, 0);
+        return JDKSAVDECC_DESCRIPTOR_AVB_INTERFACE_LEN;
+    }
+
+    return 0;
+}
+
+void entity_farm_imp::proc_acmp(const uint8_t * frame, uint16_t len)
+{
+    uint8_t resp[ACMP_FRAME_LEN];
+    struct jdksavdecc_acmpdu acmpdu;
+    virtual_entity * responder = NULL;
+    uint8_t status = ACMP_STATUS_SUCCESS;
+
+    memset(&acmpdu, 0, sizeof(acmpdu));
+    if (jdksavdecc_acmpdu_read(&acmpdu, frame, ETHER_HDR_SIZE, len) < 0)
+        return;
+
+    switch (acmpdu.header.message_type)
+    {
+    case CONNECT_RX_COMMAND:
+    case DISCONNECT_RX_COMMAND:
+    case GET_RX_STATE_COMMAND:
+    {
+        responder = find_entity(acmpdu.listener_entity_id);
+        if (!responder)
+            return;
+
+        if (acmpdu.listener_unique_id >= responder->rx_streams.size())
+        {
+            status = ACMP_STATUS_LISTENER_UNKNOWN_ID;
+            break;
+        }
+
+        rx_stream_state & rx_stream = responder->rx_streams[acmpdu.listener_unique_id];
+        uint64_t talker_entity_id = jdksavdecc_eui64_convert_to_uint64(&acmpdu.talker_entity_id);
+
+        if (acmpdu.header.message_type == CONNECT_RX_COMMAND)
+        {
+            virtual_entity * talker = find_entity(acmpdu.talker_entity_id);
+
+            if (!talker)
+                status = ACMP_STATUS_LISTENER_TALKER_TIMEOUT;
+            else if (acmpdu.talker_unique_id >= talker->tx_connection_counts.size())
+                status = ACMP_STATUS_TALKER_UNKNOWN_ID;
+            else if (rx_stream.connected && ((rx_stream.talker_entity_id != talker_entity_id) ||
+                                             (rx_stream.talker_unique_id != acmpdu.talker_unique_id)))
+                status = ACMP_STATUS_LISTENER_EXCLUSIVE;
+            else if (!rx_stream.connected)
+            {
+                rx_stream.connected = true;
+                rx_stream.talker_entity_id = talker_entity_id;
+                rx_stream.talker_unique_id = acmpdu.talker_unique_id;
+                talker->tx_connection_counts[acmpdu.talker_unique_id]++;
+            }
+        }
+        else if (acmpdu.header.message_type == DISCONNECT_RX_COMMAND)
+        {
+            if (!rx_stream.connected)
+            {
+                status = ACMP_STATUS_NOT_CONNECTED;
+            }
+            else
+            {
+                jdksavdecc_eui64_init_from_uint64(&acmpdu.talker_entity_id, rx_stream.talker_entity_id);
+                virtual_entity * talker = find_entity(acmpdu.talker_entity_id);
+                if (talker && talker->tx_connection_counts[rx_stream.talker_unique_id])
+                    talker->tx_connection_counts[rx_stream.talker_unique_id]--;
+                rx_stream.connected = false;
+            }
+        }
+
+        if (rx_stream.connected)
+        {
+            jdksavdecc_eui64_init_from_uint64(&acmpdu.talker_entity_id, rx_stream.talker_entity_id);
+            acmpdu.talker_unique_id = rx_stream.talker_unique_id;
+        }
+        acmpdu.connection_count = rx_stream.connected ? 1 : 0;
+    }
+    break;
+
+    case GET_TX_STATE_COMMAND:
+        responder = find_entity(acmpdu.talker_entity_id);
+        if (!responder)
+            return;
+
+        if (acmpdu.talker_unique_id >= responder->tx_connection_counts.size())
+            status = ACMP_STATUS_TALKER_UNKNOWN_ID;
+        else
+            acmpdu.connection_count = responder->tx_connection_counts[acmpdu.talker_unique_id];
+        break;
+
+    case CONNECT_TX_COMMAND:
+    case DISCONNECT_TX_COMMAND:
+    case GET_TX_CONNECTION_COMMAND:
+        responder = find_entity(acmpdu.talker_entity_id);
+        if (!responder)
+            return;
+
+        status = JDKSAVDECC_ACMP_STATUS_NOT_SUPPORTED;
+        break;
+
+    default:
+        // Responses of other entities are ignored
+        return;
+    }
+
+    memset(resp, 0, sizeof(resp));
+    write_ether_hdr(resp, jdksavdecc_multicast_adp_acmp.value, responder->mac);
+    acmpdu.header.message_type++;
+    acmpdu.header.status = status;
+    jdksavdecc_acmpdu_write(&acmpdu, resp, ETHER_HDR_SIZE, sizeof(resp));
+    schedule(resp, sizeof(resp));
+}
+}
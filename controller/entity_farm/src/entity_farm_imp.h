@@ -0,0 +1,185 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * entity_farm_imp.h
+ *
+ * Virtual entity farm implementation class
+ */
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <queue>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <unordered_map>
+
+#include "jdksavdecc_pdu.h"
+#include "entity_farm.h"
+
+namespace avdecc_lib
+{
+class entity_farm_imp : public entity_farm, public virtual_clock_listener
+{
+private:
+    enum farm_consts
+    {
+        MAX_FRAME_SIZE = 1518,
+        ADP_VALID_TIME = 31, ///< ADP valid time in units of 2 seconds
+        STREAM_FORMAT_COUNT = 1
+    };
+
+    typedef std::chrono::steady_clock farm_clock;
+
+    struct scheduled_frame
+    {
+        farm_clock::time_point deliver_at;
+        uint64_t sequence; ///< Keeps frames with the same delivery time in order
+        std::vector<uint8_t> frame;
+
+        bool operator>(const scheduled_frame & other) const
+        {
+            return (deliver_at > other.deliver_at) ||
+                   ((deliver_at == other.deliver_at) && (sequence > other.sequence));
+        }
+    };
+
+    struct rx_stream_state
+    {
+        bool connected;
+        uint64_t talker_entity_id;
+        uint16_t talker_unique_id;
+    };
+
+    struct virtual_entity
+    {
+        uint64_t entity_id;
+        uint64_t mac;
+        const virtual_entity_template * model;
+        uint32_t available_index;
+        farm_clock::time_point next_advertise;
+        std::vector<rx_stream_state> rx_streams;
+        std::vector<uint16_t> tx_connection_counts;
+    };
+
+    entity_farm_config m_config;
+    uint64_t m_controller_mac;
+    std::vector<virtual_entity> m_entities;
+    std::unordered_map<uint64_t, size_t> m_entity_index;
+
+    std::mutex m_lock;
+    std::condition_variable m_wakeup;
+    std::thread m_thread;
+    bool m_running;
+    int m_pipe[2];
+
+    std::mt19937 m_rng;
+    uint64_t m_sequence;
+    std::priority_queue<std::pair<farm_clock::time_point, size_t>,
+                        std::vector<std::pair<farm_clock::time_point, size_t>>,
+                        std::greater<std::pair<farm_clock::time_point, size_t>>> m_advertise_queue; ///< Next advertise time of each entity
+    std::priority_queue<scheduled_frame, std::vector<scheduled_frame>, std::greater<scheduled_frame>> m_in_flight;
+    std::deque<std::vector<uint8_t>> m_ready;
+    entity_farm_stats m_stats;
+
+    void thread_fn();
+
+    ///
+    /// Send the advertisements and deliver the frames that are due.
+    ///
+    /// \return The time of the next advertisement or delivery.
+    ///
+    farm_clock::time_point run_due(farm_clock::time_point now);
+
+    ///
+    /// \return The current time of the virtual clock, or of the real clock without one.
+    ///
+    farm_clock::time_point now();
+
+    ///
+    /// Add a deadline at the time to the virtual clock, if the farm runs on one.
+    ///
+    void add_clock_deadline(farm_clock::time_point time);
+
+    ///
+    /// Queue a frame for delivery to the controller after the simulated latency, or drop it.
+    ///
+    void schedule(const uint8_t * frame, uint16_t len);
+
+    ///
+    /// Move frames whose delivery time has passed to the ready queue and signal the pipe.
+    ///
+    void deliver_due(farm_clock::time_point now);
+
+    ///
+    /// Make the pipe readable while frames are ready to be captured.
+    ///
+    void set_ready_signal();
+    void clear_ready_signal();
+
+    void advertise(virtual_entity & entity);
+    void proc_adp(const uint8_t * frame, uint16_t len);
+    void proc_aecp(const uint8_t * frame, uint16_t len);
+    void proc_acmp(const uint8_t * frame, uint16_t len);
+
+    ///
+    /// Write the descriptor into the READ_DESCRIPTOR response.
+    ///
+    /// \return The length of the descriptor, or 0 if the entity has no such descriptor.
+    ///
+    uint16_t write_descriptor(virtual_entity & entity, uint16_t desc_type, uint16_t desc_index, uint8_t * desc);
+
+    virtual_entity * find_entity(struct jdksavdecc_eui64 entity_id);
+    void write_ether_hdr(uint8_t * frame, const uint8_t * dest_mac, uint64_t src_mac);
+
+public:
+    ///
+    /// Constructor for entity_farm_imp used for constructing an object with a configuration.
+    ///
+    entity_farm_imp(const entity_farm_config & config);
+
+    ///
+    /// Destructor for entity_farm_imp used for destroying objects
+    ///
+    virtual ~entity_farm_imp();
+
+    void STDCALL destroy();
+    int STDCALL start();
+    void STDCALL stop();
+    uint32_t STDCALL entity_count();
+    uint64_t STDCALL entity_id_by_index(uint32_t index);
+    void STDCALL get_stats(entity_farm_stats & stats);
+
+    uint64_t STDCALL mac_addr();
+    int STDCALL get_fd();
+    int STDCALL capture_frame(uint8_t * frame, uint16_t max_len);
+    int STDCALL send_frame(const uint8_t * frame, uint16_t frame_len);
+
+    void STDCALL clock_advanced(uint64_t now_ms);
+};
+}
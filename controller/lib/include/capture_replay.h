@@ -0,0 +1,82 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * capture_replay.h
+ *
+ * Public capture replay class, which feeds the frames of a recorded pcapng capture to the
+ * controller.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "avdecc-lib_build.h"
+#include "net_interface.h"
+
+namespace avdecc_lib
+{
+///
+/// A frame transport that replays the received frames of a pcapng capture, such as one recorded
+/// with controller::start_frame_capture(). Frames sent by the controller are discarded.
+///
+/// Pass the replay to create_net_interface_with_transport() to connect a controller to it. Replaying
+/// as fast as possible gives a deterministic benchmark of the receive path.
+///
+class capture_replay : public net_transport
+{
+public:
+    ///
+    /// Stop the replay and destroy it.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL destroy() = 0;
+
+    ///
+    /// Start replaying the frames.
+    ///
+    /// \return 0 on success, -1 if the replay is already started.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL start() = 0;
+
+    ///
+    /// \return The number of received frames in the capture.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual size_t STDCALL frame_count() = 0;
+
+    ///
+    /// \return The number of frames captured by the controller so far.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual size_t STDCALL frames_replayed() = 0;
+};
+
+///
+/// Create a replay of a pcapng capture.
+///
+/// \param path The pcapng file to replay.
+/// \param recorded_pace Replay the frames at the pace they were recorded, or as fast as possible.
+///
+/// \return The replay, or NULL if the file cannot be read or replays are not supported on the platform.
+///
+extern "C" AVDECC_CONTROLLER_LIB32_API capture_replay * STDCALL create_capture_replay(const char * path, bool recorded_pace);
+}
@@ -0,0 +1,359 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_coroutine.h
+ *
+ * C++20 coroutine support for AVDECC commands, built on command futures.
+ *
+ * A command is awaited with send_cmd(), which sends it with the notification id of a new
+ * cmd_future and resumes the coroutine with its cmd_result once the future is ready:
+ *
+ *     avdecc_lib::coro::task<int> set_format(avdecc_lib::coro::scheduler & s,
+ *                                            avdecc_lib::stream_input_descriptor * stream_input,
+ *                                            uint64_t stream_format)
+ *     {
+ *         avdecc_lib::coro::cmd_result r = co_await avdecc_lib::coro::send_cmd(
+ *             s, stream_input, &avdecc_lib::stream_input_descriptor::send_set_stream_format_cmd, stream_format);
+ *         co_return r.status();
+ *     }
+ *
+ * The scheduler becomes the command executor of the controller, and resumes coroutines on the
+ * thread calling scheduler::run(), so any number of tasks started with scheduler::spawn() run
+ * concurrently on that one thread.
+ *
+ * The header is only available when the library is configured with USE_CPP20_COROUTINES,
+ * which builds with C++20 and defines AVDECC_LIB_COROUTINES.
+ */
+
+#pragma once
+
+#if defined(AVDECC_LIB_COROUTINES)
+
+#include <stdint.h>
+#include <coroutine>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include "enumeration.h"
+#include "controller.h"
+#include "cmd_future.h"
+
+namespace avdecc_lib
+{
+namespace coro
+{
+template <typename T>
+class task;
+
+namespace detail
+{
+    struct promise_base
+    {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+
+        struct final_awaiter
+        {
+            bool await_ready() noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+            {
+                std::coroutine_handle<> continuation = h.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        final_awaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    template <typename T>
+    struct promise : promise_base
+    {
+        std::optional<T> value;
+
+        task<T> get_return_object();
+        void return_value(T v) { value = std::move(v); }
+
+        T result()
+        {
+            if (exception)
+                std::rethrow_exception(exception);
+            return std::move(*value);
+        }
+    };
+
+    template <>
+    struct promise<void> : promise_base
+    {
+        task<void> get_return_object();
+        void return_void() {}
+
+        void result()
+        {
+            if (exception)
+                std::rethrow_exception(exception);
+        }
+    };
+}
+
+///
+/// A lazily started coroutine, run when it is awaited or spawned on a scheduler.
+///
+template <typename T = void>
+class task
+{
+public:
+    typedef detail::promise<T> promise_type;
+
+    explicit task(std::coroutine_handle<promise_type> h) : m_handle(h) {}
+    task(task && other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    task(const task &) = delete;
+    task & operator=(const task &) = delete;
+
+    ~task()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return !m_handle || m_handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        m_handle.promise().continuation = awaiting;
+        return m_handle;
+    }
+
+    T await_resume() { return m_handle.promise().result(); }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace detail
+{
+    template <typename T>
+    task<T> promise<T>::get_return_object()
+    {
+        return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+    }
+
+    inline task<void> promise<void>::get_return_object()
+    {
+        return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this));
+    }
+
+    struct detached_task
+    {
+        struct promise_type
+        {
+            detached_task get_return_object() { return detached_task(); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+}
+
+///
+/// Runs spawned tasks and resumes the coroutines awaiting commands, all on the thread calling run().
+///
+/// One scheduler is used per controller, as it becomes the command executor of the controller.
+///
+class scheduler : public cmd_executor
+{
+public:
+    explicit scheduler(controller * controller_obj) : m_controller(controller_obj), m_task_count(0)
+    {
+        m_controller->set_cmd_executor(this);
+    }
+
+    ~scheduler()
+    {
+        m_controller->set_cmd_executor(nullptr);
+    }
+
+    controller * get_controller() { return m_controller; }
+
+    ///
+    /// Start the task on the calling thread, which runs it until it first awaits a command.
+    ///
+    void spawn(task<void> t)
+    {
+        m_task_count++;
+        run_detached(this, std::move(t));
+    }
+
+    ///
+    /// Resume coroutines as their commands complete, until all spawned tasks have finished.
+    /// The first exception thrown by a spawned task is rethrown.
+    ///
+    void run()
+    {
+        while (m_task_count > 0)
+        {
+            std::pair<void (*)(void *), void *> entry;
+
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+                m_cv.wait(lock, [this] { return !m_ready.empty(); });
+                entry = m_ready.front();
+                m_ready.pop_front();
+            }
+
+            entry.first(entry.second);
+        }
+
+        if (m_exception)
+            std::rethrow_exception(std::exchange(m_exception, nullptr));
+    }
+
+    void STDCALL execute(void (*fn)(void *), void * arg) override
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_ready.push_back(std::make_pair(fn, arg));
+        }
+        m_cv.notify_one();
+    }
+
+private:
+    controller * m_controller;
+    size_t m_task_count; // Only used on the thread calling spawn() and run()
+    std::exception_ptr m_exception;
+    std::mutex m_lock; // Protects m_ready, which is pushed to on the AVDECC library thread
+    std::condition_variable m_cv;
+    std::deque<std::pair<void (*)(void *), void *>> m_ready;
+
+    static detail::detached_task run_detached(scheduler * s, task<void> t)
+    {
+        try
+        {
+            co_await t;
+        }
+        catch (...)
+        {
+            if (!s->m_exception)
+                s->m_exception = std::current_exception();
+        }
+        s->m_task_count--;
+    }
+};
+
+///
+/// The outcome of an awaited command, which owns its future.
+///
+class cmd_result
+{
+public:
+    cmd_result(cmd_future * future, bool is_sent) : m_future(future), m_is_sent(is_sent) {}
+    cmd_result(cmd_result && other) noexcept
+        : m_future(std::exchange(other.m_future, nullptr)), m_is_sent(other.m_is_sent) {}
+    cmd_result(const cmd_result &) = delete;
+    cmd_result & operator=(const cmd_result &) = delete;
+
+    ~cmd_result()
+    {
+        if (m_future)
+            m_future->destroy();
+    }
+
+    ///
+    /// \return The status of the command, or AVDECC_LIB_STATUS_INVALID if it could not be sent.
+    ///
+    int status() { return m_is_sent ? m_future->status() : AVDECC_LIB_STATUS_INVALID; }
+
+    ///
+    /// \return A view of the response, valid for the lifetime of the result.
+    ///
+    cmd_response response()
+    {
+        cmd_response r = {};
+        r.status = status();
+        if (m_is_sent)
+            m_future->get_response(r);
+        return r;
+    }
+
+private:
+    cmd_future * m_future;
+    bool m_is_sent;
+};
+
+///
+/// Awaits one command, sent by a function given the notification id to send it with.
+///
+class cmd_awaitable
+{
+public:
+    cmd_awaitable(scheduler & s, std::function<int(void *)> send) : m_scheduler(s), m_send(std::move(send)), m_future(nullptr), m_is_sent(false) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        m_handle = h;
+        m_future = m_scheduler.get_controller()->create_cmd_future(&cmd_awaitable::on_ready, this);
+        m_is_sent = (m_send(m_future->notification_id()) == 0);
+        return m_is_sent; // Resume at once if the command could not be sent
+    }
+
+    cmd_result await_resume() { return cmd_result(m_future, m_is_sent); }
+
+private:
+    scheduler & m_scheduler;
+    std::function<int(void *)> m_send;
+    cmd_future * m_future;
+    bool m_is_sent;
+    std::coroutine_handle<> m_handle;
+
+    static void on_ready(void * context, cmd_future *)
+    {
+        static_cast<cmd_awaitable *>(context)->m_handle.resume();
+    }
+};
+
+///
+/// Await a send_*_cmd method of an End Station or descriptor, called with the notification id
+/// of the command followed by args.
+///
+template <typename Obj, typename Class, typename... Params, typename... Args>
+cmd_awaitable send_cmd(scheduler & s, Obj * obj, int (STDCALL Class::*send_fn)(void *, Params...), Args... args)
+{
+    return cmd_awaitable(s, [=](void * notification_id) { return (obj->*send_fn)(notification_id, args...); });
+}
+}
+}
+
+#endif
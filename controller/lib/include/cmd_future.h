@@ -0,0 +1,137 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_future.h
+ *
+ * Public command future interface class
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "avdecc-lib_build.h"
+
+namespace avdecc_lib
+{
+class cmd_future;
+
+///
+/// A view of the response that completed a command future.
+///
+struct cmd_response
+{
+    int32_t status;              ///< The AEM or ACMP status of the response, or an AVDECC library specific status
+    uint8_t subtype;             ///< The AVTPDU subtype of the response, AECP (0xFB) or ACMP (0xFC), or 0 if no response was received
+    uint32_t msg_type;           ///< The AECP or ACMP message type of the response
+    uint16_t cmd_type;           ///< The AEM command type of an AEM response
+    uint16_t desc_type;          ///< The descriptor type of an AEM response to a command on a descriptor
+    uint16_t desc_index;         ///< The descriptor index of an AEM response to a command on a descriptor
+    uint64_t entity_id;          ///< The End Station of an AECP response, or the talker of an ACMP response
+    uint64_t listener_entity_id; ///< The listener of an ACMP response
+    const uint8_t * frame;       ///< The response frame, valid until the future is destroyed, or NULL if no response was received
+    size_t frame_len;            ///< The length of the response frame
+};
+
+///
+/// Called on the command executor when a command future completes.
+///
+typedef void (*cmd_future_callback)(void * context, cmd_future * future);
+
+///
+/// Runs the callbacks of completed command futures on application threads.
+///
+class cmd_executor
+{
+public:
+    virtual ~cmd_executor() {}
+
+    ///
+    /// Run fn(arg) on an application thread. Called on the AVDECC library thread, so must not block.
+    ///
+    virtual void STDCALL execute(void (*fn)(void *), void * arg) = 0;
+};
+
+///
+/// The outcome of one command, sent with the notification id of the future.
+///
+/// The notification id of a future can be passed to any send_*_cmd method. The command then
+/// completes the future instead of sending notifications to the application callback, so any
+/// number of commands can be in flight from a single application thread.
+///
+class cmd_future
+{
+public:
+    ///
+    /// \return The notification id to send the command with.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void * STDCALL notification_id() = 0;
+
+    ///
+    /// \return True if the command has completed, timed out or been cancelled.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual bool STDCALL is_ready() = 0;
+
+    ///
+    /// Block until the future is ready.
+    ///
+    /// \return The status of the command.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL wait() = 0;
+
+    ///
+    /// Block until the future is ready, or for at most timeout_ms.
+    ///
+    /// \return True if the future is ready.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual bool STDCALL wait_for(uint32_t timeout_ms) = 0;
+
+    ///
+    /// \return The status of the command, or AVDECC_LIB_STATUS_INVALID if the future is not ready.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL status() = 0;
+
+    ///
+    /// Copy a view of the response into the structure provided.
+    ///
+    /// \return 0 on success, -1 if the future is not ready.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL get_response(cmd_response & response) = 0;
+
+    ///
+    /// Complete the future with AVDECC_LIB_STATUS_CANCELLED. The command is not recalled,
+    /// and its response or timeout is ignored.
+    ///
+    /// \return 0 on success, -1 if the future is already ready.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL cancel() = 0;
+
+    ///
+    /// Release the future. The future can be destroyed at any time, and a pending callback
+    /// still runs with the future. The callback is not called for a command completing after
+    /// the future is destroyed.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL destroy() = 0;
+};
+}
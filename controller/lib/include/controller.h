@@ -33,6 +33,7 @@
 #include <stddef.h>
 #include "avdecc-lib_build.h"
 #include "net_interface.h"
+#include "cmd_future.h"
 
 class net_interface;
 
@@ -41,6 +42,131 @@ namespace avdecc_lib
 class end_station;
 class configuration_descriptor;
 
+///
+/// A talker stream output to listener stream input connection, as cached in the connection graph.
+///
+struct stream_connection
+{
+    uint64_t talker_entity_id;
+    uint16_t talker_unique_id;
+    uint64_t listener_entity_id;
+    uint16_t listener_unique_id;
+};
+
+///
+/// A command to send as part of a bulk query, and its result.
+///
+struct bulk_query_target
+{
+    uint64_t entity_id;   ///< The Entity ID of the End Station to query
+    uint16_t desc_type;   ///< The descriptor type to query, in the current configuration
+    uint16_t desc_index;  ///< The descriptor index to query
+    uint16_t cmd_type;    ///< The AEM command, or the ACMP command + CMD_LOOKUP
+    int32_t status;       ///< The AEM or ACMP status of the response, or an AVDECC library specific status
+};
+
+///
+/// A CONNECT_RX or DISCONNECT_RX sent to apply a routing matrix, and its result.
+///
+struct routing_change
+{
+    stream_connection connection;
+    bool connect;   ///< True for CONNECT_RX, false for DISCONNECT_RX
+    int32_t status; ///< The ACMP status of the response, or an AVDECC library specific status
+};
+
+///
+/// The settings of a firmware rollout.
+///
+struct firmware_rollout_config
+{
+    const char * image_path;       ///< The firmware image to upload
+    const char * state_file_path;  ///< The file recording the progress of each End Station, used to resume a rollout, or NULL
+    uint16_t memory_object_index;  ///< The MEMORY_OBJECT to upgrade, in the current configuration
+    size_t wave_size;              ///< The number of End Stations upgraded at once, each wave starts once the previous one has finished
+    size_t per_entity_window;      ///< The maximum number of ADDRESS_ACCESS writes inflight to one End Station
+    uint32_t max_bytes_per_sec;    ///< The limit on image bytes sent per second over all End Stations, or 0 for no limit
+    uint32_t max_packets_per_sec;  ///< The limit on writes sent per second over all End Stations, or 0 for no limit
+    bool reboot;                   ///< Send a REBOOT command to each End Station once its image is uploaded
+    bool stop_on_wave_failure;     ///< Skip the remaining waves if an End Station in a wave fails
+};
+
+///
+/// The progress of one End Station in a firmware rollout.
+///
+struct firmware_rollout_entity_status
+{
+    uint64_t entity_id;
+    uint16_t state;            ///< avdecc_lib::firmware_rollout_states
+    uint16_t percent_complete; ///< Over the erase, upload and reboot of the End Station
+    int32_t status;            ///< The status of the command that failed, when state is FIRMWARE_ROLLOUT_FAILED
+};
+
+///
+/// A descriptor whose counters are polled with GET_COUNTERS.
+///
+struct counter_poll_target
+{
+    uint64_t entity_id;  ///< The Entity ID of the End Station to poll
+    uint16_t desc_type;  ///< AEM_DESC_ENTITY, AEM_DESC_AVB_INTERFACE, AEM_DESC_CLOCK_DOMAIN or AEM_DESC_STREAM_INPUT
+    uint16_t desc_index; ///< The descriptor index, in the current configuration
+};
+
+///
+/// The settings of counter polling.
+///
+struct counter_poll_config
+{
+    uint32_t entity_interval_ms;        ///< The polling interval of ENTITY descriptors, or 0 to not poll them
+    uint32_t avb_interface_interval_ms; ///< The polling interval of AVB_INTERFACE descriptors, or 0 to not poll them
+    uint32_t clock_domain_interval_ms;  ///< The polling interval of CLOCK_DOMAIN descriptors, or 0 to not poll them
+    uint32_t stream_input_interval_ms;  ///< The polling interval of STREAM_INPUT descriptors, or 0 to not poll them
+    uint32_t jitter_ms;                 ///< Each poll is moved randomly by up to half this either way
+    uint32_t max_cmds_per_sec;          ///< The limit on GET_COUNTERS commands sent per second, up to 10000, or 0 for 10000
+    size_t history_length;              ///< The number of samples kept for each descriptor
+};
+
+///
+/// The counters of a descriptor in one GET_COUNTERS response.
+///
+struct counter_sample
+{
+    uint32_t timestamp_ms;   ///< When the response was received, in milliseconds since polling was started
+    uint32_t interval_ms;    ///< The time since the previous sample, or 0 for the first sample
+    uint32_t counters_valid; ///< Bit n is set if counters[n] is valid
+    uint32_t counters[32];   ///< The counters block, indexed as the counters of the descriptor type
+    uint32_t deltas[32];     ///< The change of each counter since the previous sample, modulo 2^32
+    float rates[32];         ///< The change of each counter per second since the previous sample
+};
+
+///
+/// How commands are timed out and resent.
+///
+struct cmd_retry_policy
+{
+    bool adaptive_timeouts;   ///< Time commands out from the round trip time measured for each End Station and command type
+    uint32_t min_timeout_ms;  ///< The lower bound of an adaptive timeout
+    uint32_t max_timeout_ms;  ///< The upper bound of an adaptive timeout and of a timeout after backoff
+    uint32_t max_retries;     ///< The number of times a timed out command is resent before it fails, up to 8
+    uint32_t backoff_percent; ///< The timeout of each resend as a percentage of the previous timeout, at least 100
+};
+
+///
+/// The round trip time measured for the commands of one type sent to one End Station.
+///
+struct rtt_estimate
+{
+    uint64_t entity_id;     ///< The Entity ID the commands are sent to
+    uint32_t cmd_class;     ///< One of the cmd_classes values
+    uint16_t cmd_type;      ///< The AEM command type or ACMP message type, or 0 for other commands
+    uint32_t sample_count;  ///< The number of responses measured, which excludes responses to resent commands
+    float srtt_ms;          ///< The smoothed round trip time, valid when sample_count is not 0
+    float rttvar_ms;        ///< The round trip time variation, valid when sample_count is not 0
+    uint32_t timeout_ms;    ///< The timeout of the next command sent
+    uint32_t retry_count;   ///< The number of commands resent after a timeout
+    uint32_t timeout_count; ///< The number of commands that failed after their last resend timed out
+};
+
 class controller
 {
 public:
@@ -142,11 +268,309 @@ public:
     /// Send a CONTROLLER_AVAILABLE command to verify that the AVDECC Controller is still there.
     ///
     AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_controller_avail_cmd(void * notification_id, uint32_t end_station_index) = 0;
+
+    ///
+    /// Copy the cached stream connections into the array provided.
+    ///
+    /// The connection graph is maintained from ACMP traffic: CONNECT_RX and DISCONNECT_RX
+    /// responses (solicited or not), GET_RX_STATE, GET_TX_STATE and GET_TX_CONNECTION responses,
+    /// and the GET_RX_STATE commands sent for each STREAM_INPUT once an End Station is enumerated.
+    /// CONNECTION_ADDED and CONNECTION_REMOVED ACMP notifications are sent as it changes.
+    ///
+    /// \param connections The array to copy to, may be NULL when max_count is 0.
+    /// \param max_count The number of entries in the connections array.
+    /// \return The total number of connections, which may exceed max_count.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual size_t STDCALL get_connections(stream_connection * connections, size_t max_count) = 0;
+
+    ///
+    /// Copy the cached connections of a talker stream output into the array provided.
+    ///
+    /// \return The total number of listeners connected to the talker stream, which may exceed max_count.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual size_t STDCALL get_talker_connections(uint64_t talker_entity_id, uint16_t talker_unique_id,
+                                                                              stream_connection * connections, size_t max_count) = 0;
+
+    ///
+    /// Look up the cached talker stream a listener stream input is connected to.
+    ///
+    /// \return True if the listener stream is connected, in which case connection is filled in.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual bool STDCALL get_listener_connection(uint64_t listener_entity_id, uint16_t listener_unique_id,
+                                                                             stream_connection & connection) = 0;
+
+    ///
+    /// Send a set of state query commands concurrently and report all the results together.
+    ///
+    /// Commands are sent to several End Stations at once, taking the End Stations in turn,
+    /// with at most per_entity_window commands inflight to any one End Station and at most
+    /// global_window inflight in total. The responses update the descriptors as they do for
+    /// the individual send_*_cmd functions, but no application notifications are sent for them.
+    ///
+    /// The supported targets are:
+    ///     GET_RX_STATE_COMMAND + CMD_LOOKUP on a STREAM_INPUT
+    ///     GET_TX_STATE_COMMAND + CMD_LOOKUP on a STREAM_OUTPUT
+    ///     AEM_CMD_GET_STREAM_INFO and AEM_CMD_GET_STREAM_FORMAT on a STREAM_INPUT or STREAM_OUTPUT
+    ///     AEM_CMD_GET_COUNTERS on an ENTITY, AVB_INTERFACE, STREAM_INPUT or CLOCK_DOMAIN
+    ///     AEM_CMD_GET_AVB_INFO on an AVB_INTERFACE
+    ///     AEM_CMD_GET_CLOCK_SOURCE on a CLOCK_DOMAIN
+    ///     AEM_CMD_GET_SAMPLING_RATE on an AUDIO_UNIT
+    ///
+    /// The status of each target is set to the response status, AVDECC_LIB_STATUS_TICK_TIMEOUT
+    /// if no response was received, or AVDECC_LIB_STATUS_INVALID if the End Station or descriptor
+    /// is not found. The targets array must remain valid until the completion callback is called.
+    ///
+    /// \param targets The commands to send. Each element is also the notification id of its command.
+    /// \param target_count The number of elements in targets.
+    /// \param per_entity_window The maximum number of commands inflight to one End Station.
+    /// \param global_window The maximum number of commands inflight in total, up to 512.
+    /// \param completion_callback Called once all the targets have completed, on the library thread
+    ///        or, if none were sent, before this function returns. It must not wait for commands.
+    /// \param user_obj Passed to completion_callback.
+    /// \return 0 on success, -1 if a target is not supported or a window is 0, in which case nothing is sent.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_bulk_query(bulk_query_target * targets, size_t target_count,
+                                                                    size_t per_entity_window, size_t global_window,
+                                                                    void (*completion_callback)(void * user_obj, bulk_query_target * targets,
+                                                                                                size_t target_count),
+                                                                    void * user_obj) = 0;
+
+    ///
+    /// Bring the stream connections on the network to a desired set, such as a recalled scene.
+    ///
+    /// The desired connections are compared with the connection graph (see get_connections()).
+    /// A DISCONNECT_RX is sent for each connected listener stream that is not in the desired set
+    /// or is connected to another talker stream, and a CONNECT_RX for each desired connection that
+    /// is not already made. A listener stream that changes talker is disconnected before it is
+    /// connected, and the CONNECT_RX is not sent if the DISCONNECT_RX fails, in which case its status
+    /// is AVDECC_LIB_STATUS_CANCELLED. Up to window commands are inflight at once, and no application
+    /// notifications are sent for them.
+    ///
+    /// \param connections The complete set of desired connections.
+    /// \param connection_count The number of elements in connections.
+    /// \param window The maximum number of ACMP commands inflight, up to 512.
+    /// \param change_callback Called as the result of each change arrives, usually on the library thread.
+    /// \param completion_callback Called with all the changes once they have completed, on the library
+    ///        thread or, if none were sent, before this function returns. Neither callback may wait for commands.
+    /// \param user_obj Passed to the callbacks.
+    /// \return 0 on success, -1 if a listener stream is given two talker streams or window is 0, in which case nothing is sent.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_routing_matrix(const stream_connection * connections, size_t connection_count, size_t window,
+                                                                        void (*change_callback)(void * user_obj, const routing_change * change),
+                                                                        void (*completion_callback)(void * user_obj, const routing_change * changes,
+                                                                                                    size_t change_count),
+                                                                        void * user_obj) = 0;
+
+    ///
+    /// Upgrade the firmware of a set of End Stations, in waves of End Stations upgraded concurrently.
+    ///
+    /// For each End Station the memory object is erased with START_OPERATION, the image is uploaded
+    /// with pipelined ADDRESS_ACCESS writes and the End Station is optionally rebooted. The image is
+    /// memory mapped once for all End Stations, and the writes to all of them share the byte and packet
+    /// rate limits. FIRMWARE_ROLLOUT_PROGRESS notifications report the overall progress, including the
+    /// progress of erase operations reported in OPERATION_STATUS responses, and a FIRMWARE_ROLLOUT_COMPLETED
+    /// notification is sent at the end. No notifications are sent for the individual commands.
+    ///
+    /// With a state file, End Stations recorded as upgraded with the same image are skipped, and an
+    /// interrupted upload continues from the last offset written without erasing the memory object again.
+    ///
+    /// \param entity_ids The End Stations to upgrade, in the order of the waves.
+    /// \param entity_count The number of elements in entity_ids.
+    /// \param config The rollout settings.
+    /// \param notification_id A void pointer to the unique identifier passed in the rollout notifications.
+    /// \return 0 if the rollout has started, -1 if a rollout is running, the image cannot be mapped, or the settings are invalid.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL start_firmware_rollout(const uint64_t * entity_ids, size_t entity_count,
+                                                                           const firmware_rollout_config & config,
+                                                                           void * notification_id) = 0;
+
+    ///
+    /// Stop starting End Stations in a firmware rollout. End Stations already being upgraded are
+    /// finished, and the others are skipped.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL abort_firmware_rollout() = 0;
+
+    ///
+    /// Copy the progress of each End Station in the current or last firmware rollout into the array provided.
+    ///
+    /// \return The number of End Stations in the rollout, which may exceed max_count.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual size_t STDCALL get_firmware_rollout_status(firmware_rollout_entity_status * entity_status,
+                                                                                   size_t max_count) = 0;
+
+    ///
+    /// Poll the counters of a set of descriptors with GET_COUNTERS, replacing any targets polled before.
+    ///
+    /// Each descriptor is polled at the interval of its descriptor type. The first polls are spread
+    /// randomly over one interval and each later poll is moved by the jitter, so that the commands
+    /// are sent evenly rather than in bursts, and the commands sent per second are capped. A descriptor
+    /// is not polled again while its last command is inflight. The counters in each response are
+    /// compared with the previous sample, and the latest samples of each descriptor are kept in a
+    /// fixed-size ring buffer. No notifications are sent for the commands.
+    ///
+    /// \param targets The descriptors to poll.
+    /// \param target_count The number of elements in targets, or 0 to stop polling.
+    /// \param config The polling settings.
+    /// \return 0 on success, -1 if a target is not a supported descriptor type or history_length is 0.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL start_counter_polling(const counter_poll_target * targets, size_t target_count,
+                                                                          const counter_poll_config & config) = 0;
+
+    ///
+    /// Stop polling counters and discard the samples.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL stop_counter_polling() = 0;
+
+    ///
+    /// Copy the latest samples of a polled descriptor into the array provided, oldest first.
+    ///
+    /// \return The number of samples copied, up to max_count.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual size_t STDCALL get_counter_samples(uint64_t entity_id, uint16_t desc_type, uint16_t desc_index,
+                                                                           counter_sample * samples, size_t max_count) = 0;
+
+    ///
+    /// Set how AECP and ACMP commands are timed out and resent.
+    ///
+    /// With adaptive timeouts, the round trip time of each End Station and command type, such as
+    /// READ_DESCRIPTOR or CONNECT_RX, is estimated from the responses to commands that were not
+    /// resent, as a smoothed round trip time and variation, and a command times out after the
+    /// smoothed round trip time plus four times the variation, within min_timeout_ms and
+    /// max_timeout_ms. Until a response has been measured, and without adaptive timeouts, the
+    /// 1722.1 timeout of the command is used.
+    /// The default policy is adaptive, from 50 to 5000 ms, with 1 resend at the same timeout.
+    ///
+    /// \return 0 on success, -1 if the policy is not valid.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL set_cmd_retry_policy(const cmd_retry_policy & policy) = 0;
+
+    ///
+    /// Copy the round trip time estimates of each End Station and command type into the array provided.
+    ///
+    /// \return The total number of estimates, which may exceed max_count.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual size_t STDCALL get_rtt_estimates(rtt_estimate * estimates, size_t max_count) = 0;
+
+    ///
+    /// Set when an End Station is degraded by the circuit breaker.
+    ///
+    /// An End Station is degraded after timeout_threshold consecutive AECP command timeouts, and
+    /// END_STATION_DEGRADED is sent. AECP commands to a degraded End Station then fail immediately,
+    /// with a COMMAND_TIMEOUT notification or get_last_resp_status() of AVDECC_LIB_STATUS_ENTITY_DEGRADED,
+    /// instead of waiting for their timeouts. The End Station is probed with ENTITY_AVAILABLE every
+    /// probe_interval_ms, and END_STATION_RECOVERED is sent once it responds or restarts.
+    /// The default is 3 timeouts and 1000 ms, and a timeout_threshold of 0 turns the circuit breaker off.
+    ///
+    /// \return 0 on success, -1 if the probe interval is not valid.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL set_circuit_breaker(uint32_t timeout_threshold, uint32_t probe_interval_ms) = 0;
+
+    ///
+    /// Create a future for the outcome of one command, to send with the notification id of the future.
+    ///
+    /// \param callback Called on the command executor when the future is ready, or NULL.
+    /// \param context Passed to the callback.
+    ///
+    /// \return The future, to be released with destroy().
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual cmd_future * STDCALL create_cmd_future(cmd_future_callback callback, void * context) = 0;
+
+    ///
+    /// Set the executor the callbacks of the command futures created by this controller run on,
+    /// or NULL for a library thread started on first use. The executor must outlive the controller.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL set_cmd_executor(cmd_executor * executor) = 0;
+
+    ///
+    /// Record every frame received and sent by the controller to a pcapng file, with nanosecond
+    /// timestamps. The capture can be replayed with create_capture_replay().
+    ///
+    /// Frames are copied into a preallocated ring and written to the file by a background thread,
+    /// so that recording never blocks the network thread. Frames are dropped while the ring is full.
+    ///
+    /// \param path The pcapng file to write.
+    /// \param ring_frames The number of frames the ring holds.
+    ///
+    /// \return 0 on success, -1 if a capture is already running or the file cannot be opened.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL start_frame_capture(const char * path, uint32_t ring_frames) = 0;
+
+    ///
+    /// Stop recording frames, write the frames left in the ring and close the capture file.
+    ///
+    /// \return The number of frames dropped because the ring was full.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual uint64_t STDCALL stop_frame_capture() = 0;
+
+    ///
+    /// Evict End Stations that have been disconnected for longer than a timeout.
+    ///
+    /// An evicted End Station is removed from the End Stations of the controller, so the indexes of
+    /// the End Stations after it change, and END_STATION_EVICTED is sent. Its handle and the handles
+    /// of its descriptors stay valid until the controller is destroyed, but their commands fail and
+    /// their responses are no longer available. An End Station is not evicted while one of its calls
+    /// or the call of one of its descriptors is running, or while an operation such as an audio map
+    /// batch, address access batch or memory object transfer is running on it. Applications that keep an End Station across
+    /// evictions should keep its Entity ID and look it up with get_end_station_by_entity_id().
+    /// An End Station that advertises again after it has been evicted is enumerated as a new End Station.
+    /// End Stations are not evicted while a firmware rollout is running. By default End Stations
+    /// are never evicted.
+    ///
+    /// \param disconnected_timeout_ms The time an End Station is disconnected before it is evicted,
+    ///        at least 1000 ms, or 0 to never evict End Stations.
+    ///
+    /// \return 0 on success, -1 if the timeout is not valid.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL set_end_station_eviction(uint32_t disconnected_timeout_ms) = 0;
+
+    ///
+    /// \return The number of End Stations evicted since the controller was created.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual uint64_t STDCALL evicted_end_station_count() = 0;
+
+    ///
+    /// Automatically register for unsolicited notifications on every End Station.
+    ///
+    /// When enabled, REGISTER_UNSOLICITED_NOTIFICATION is sent to each End Station once it has
+    /// been enumerated, again when it is re-enumerated after a reboot (detected from its ADP
+    /// available index) and when it reconnects. The application is not notified of these
+    /// commands. Unsolicited responses keep the cached descriptor and GET command results up to
+    /// date, so the current state can be read locally without polling.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL set_auto_register_unsolicited(bool enable) = 0;
+
+    ///
+    /// \return The End Station with the Entity ID, or NULL if there is none. Unlike an index, the Entity ID
+    ///         of an End Station does not change when other End Stations are evicted.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual end_station * STDCALL get_end_station_by_entity_id(uint64_t entity_id) = 0;
+
+    ///
+    /// Start recording command lifecycle trace events to a file in the Chrome trace event
+    /// JSON format, viewable in chrome://tracing or the Perfetto UI.
+    ///
+    /// Enqueue, transmit, retry, response, timeout, notification dispatch and command wait
+    /// events are recorded, as well as the enumeration of each End Station. The file is
+    /// written by a background thread and is completed by disable_command_trace().
+    ///
+    /// \param file_path The path of the trace file to create.
+    /// \return 0 on success, -1 if tracing is already enabled or the file cannot be created.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL enable_command_trace(const char * file_path) = 0;
+
+    ///
+    /// Stop recording command lifecycle trace events and close the trace file.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL disable_command_trace() = 0;
 };
 
 ///
 /// Create a public AVDECC Controller object with a network interface object, notification and post_log_msg callback functions used for accessing from outside the library.
 ///
+/// A process can create several controllers, for example one per network interface of redundant
+/// networks. Each controller needs its own network interface and system, and has its own state,
+/// event thread, notifications and log.
+///
 /// \param netif A network interface object created in the application level using the public network interface API provided.
 /// \param notification_user_obj A void pointer used to store any helpful C++ class object.
 /// \param notification_type The type of notification that the callback function is called with. (Refer to notifications enumeration included in the library for a list of notification types supported.)
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 #include "avdecc-lib_build.h"
 
 namespace avdecc_lib
@@ -37,6 +38,18 @@ namespace avdecc_lib
 class entity_descriptor;
 class descriptor_base;
 
+///
+/// One TLV of an ADDRESS_ACCESS batch.
+///
+struct address_access_tlv
+{
+    uint16_t mode;    ///< JDKSAVDECC_AECP_AA_MODE_READ, WRITE or EXECUTE
+    uint16_t length;  ///< The number of bytes to read or write, up to AECP_AA_MAX_TLV_DATA_LEN
+    uint64_t address; ///< The address of the memory to access
+    uint8_t * data;   ///< The bytes to write, or the buffer of length bytes the bytes read are copied into
+    int32_t status;   ///< Set on completion to the status of the response carrying the TLV, or AVDECC_LIB_STATUS_TICK_TIMEOUT
+};
+
 class end_station
 {
 public:
@@ -95,6 +108,15 @@ public:
     ///
     AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_entity_avail_cmd(void * notification_id) = 0;
 
+    ///
+    /// Send an ADDRESS_ACCESS command with a single TLV.
+    ///
+    /// \param notification_id A void pointer to the unique identifier associated with the command.
+    /// \param mode The TLV mode, JDKSAVDECC_AECP_AA_MODE_READ, WRITE or EXECUTE.
+    /// \param length The number of bytes to read or write.
+    /// \param address The address of the memory to access.
+    /// \param memory_data The bytes to write, not used for a read.
+    ///
     AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_aecp_address_access_cmd(void * notification_id,
                                                                                  unsigned mode,
                                                                                  unsigned length,
@@ -151,5 +173,26 @@ public:
     /// \param notification_id A void pointer to the unique identifier associated with the command.
     ///
     AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_milan_vendor_unique_cmd(void * notification_id) = 0;
+
+    ///
+    /// Send a batch of ADDRESS_ACCESS TLVs, packing as many consecutive TLVs as fit into each
+    /// command and keeping up to window commands inflight. Each TLV's status is set from the
+    /// response to the command that carried it. Read data is copied into the TLV's buffer. No
+    /// notifications are sent for the individual commands. When every TLV has completed, the
+    /// completion callback is called on the lib thread with the TLVs and their count. The TLVs
+    /// must remain valid until then.
+    ///
+    /// \param tlvs The TLVs to send, in order.
+    /// \param tlv_count The number of TLVs.
+    /// \param window The maximum number of commands inflight, up to 512.
+    /// \param completion_callback Called once all the TLVs have completed, or NULL.
+    /// \param user_obj Passed to the completion callback.
+    /// \return 0 if the batch has started, -1 if window is 0 or a TLV is longer than AECP_AA_MAX_TLV_DATA_LEN.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_aecp_address_access_batch(address_access_tlv * tlvs,
+                                                                                   size_t tlv_count,
+                                                                                   size_t window,
+                                                                                   void (*completion_callback)(void *, address_access_tlv *, size_t),
+                                                                                   void * user_obj) = 0;
 };
 }
@@ -174,8 +174,12 @@ enum aem_cmds_status
     TOTAL_NUM_OF_AEM_CMDS_STATUS = 13,      ///< The total number of AEM commands status currently supported in the 1722.1 specification
     AVDECC_LIB_STATUS_INVALID = 1023,       ///< AVDECC library specific status, not part of the 1722.1 specification
     ///< The response received has a subtype different from the subtype of the command sent
-    AVDECC_LIB_STATUS_TICK_TIMEOUT = 1024 ///< AVDECC library specific status, not part of the 1722.1 specification
-                                          ///< The response is not received within the timeout period after re-sending a command
+    AVDECC_LIB_STATUS_TICK_TIMEOUT = 1024, ///< AVDECC library specific status, not part of the 1722.1 specification
+                                           ///< The response is not received within the timeout period after re-sending a command
+    AVDECC_LIB_STATUS_ENTITY_DEGRADED = 1025, ///< AVDECC library specific status, not part of the 1722.1 specification
+                                              ///< The command is not sent as the AVDECC Entity has stopped responding to commands
+    AVDECC_LIB_STATUS_CANCELLED = 1026        ///< AVDECC library specific status, not part of the 1722.1 specification
+                                              ///< The application cancelled the command before it completed
 };
 
 enum acmp_cmds_values /// The command codes values for ACMP commands
@@ -229,6 +233,24 @@ enum aem_cmd_waiting
     CMD_WITH_NOTIFICATION = 1,    ///< All user commands are sent with unique notification ids
 };
 
+enum cmd_priorities
+{
+    CMD_PRIORITY_INTERACTIVE = 0, ///< Commands a user is waiting on, sent ahead of all other queued commands
+    CMD_PRIORITY_NORMAL = 1,      ///< Application commands
+    CMD_PRIORITY_BACKGROUND = 2,  ///< Enumeration reads, polling and other internal commands
+    CMD_PRIORITY_COUNT = 3,
+};
+
+enum cmd_classes
+{
+    CMD_CLASS_AEM = 0,             ///< AECP AEM commands
+    CMD_CLASS_ADDRESS_ACCESS = 1,  ///< AECP Address Access commands
+    CMD_CLASS_VENDOR_UNIQUE = 2,   ///< AECP Vendor Unique commands
+    CMD_CLASS_ACMP = 3,            ///< ACMP commands answered by the End Station they are sent to
+    CMD_CLASS_ACMP_CONNECT_RX = 4, ///< ACMP CONNECT_RX and DISCONNECT_RX commands, answered after the Listener has contacted the Talker
+    CMD_CLASS_COUNT = 5,
+};
+
 enum ether_hdr_info
 {
     SRC_MAC_SIZE = 6,
@@ -249,6 +271,13 @@ enum frame_lengths
     AECP_FRAME_LEN = 64  ///< Length of AECP packet is 64 bytes
 };
 
+enum aecp_aa_lengths
+{
+    AECP_MAX_CONTROL_DATA_LEN = 524, ///< 1722.1 max control_data_length of an AECPDU
+    AECP_AA_MAX_TLVS_LEN = 512,      ///< Max TLV headers and memory data in an ADDRESS_ACCESS AECPDU, after the controller ID, sequence ID and TLV count
+    AECP_AA_MAX_TLV_DATA_LEN = 502   ///< Max memory data in an ADDRESS_ACCESS TLV, after the controller ID, sequence ID, TLV count and TLV header
+};
+
 enum aem_max_maps
 {
     AEM_MAX_MAPS = 63 ///< 1722.1 max maps allowed per cmd frame for ADD/REMOVE audio mappings cmd
@@ -274,14 +303,21 @@ enum flags
 
 enum notifications /// Notifications for the AVDECC library implementation, not part of the 1722.1 specification
 {
-    NO_MATCH_FOUND = 0,                ///< A command or response is not implemented
-    END_STATION_CONNECTED = 1,         ///< An AVDECC End Station is discovered and connected
-    END_STATION_DISCONNECTED = 2,      ///< An AVDECC End Station is disconnected
-    COMMAND_TIMEOUT = 3,               ///< A command is sent, but the response is not received within a timeout period
-    RESPONSE_RECEIVED = 4,             ///< A response is received after sending a command
-    END_STATION_READ_COMPLETED = 5,    ///< An AVDECC End Station has finished internal READ_DESCRIPTOR processing for all top level descriptors
-    UNSOLICITED_RESPONSE_RECEIVED = 6, ///< An unsolicited response is received
-    TOTAL_NUM_OF_NOTIFICATIONS = 7
+    NO_MATCH_FOUND = 0,                   ///< A command or response is not implemented
+    END_STATION_CONNECTED = 1,            ///< An AVDECC End Station is discovered and connected
+    END_STATION_DISCONNECTED = 2,         ///< An AVDECC End Station is disconnected
+    COMMAND_TIMEOUT = 3,                  ///< A command is sent, but the response is not received within a timeout period
+    RESPONSE_RECEIVED = 4,                ///< A response is received after sending a command
+    END_STATION_READ_COMPLETED = 5,       ///< An AVDECC End Station has finished internal READ_DESCRIPTOR processing for all top level descriptors
+    UNSOLICITED_RESPONSE_RECEIVED = 6,    ///< An unsolicited response is received
+    MEMORY_OBJECT_TRANSFER_PROGRESS = 7,  ///< A memory object transfer has progressed, cmd_status is the percentage complete
+    MEMORY_OBJECT_TRANSFER_COMPLETED = 8, ///< A memory object transfer has finished, cmd_status is the ADDRESS_ACCESS status of the transfer
+    FIRMWARE_ROLLOUT_PROGRESS = 9,        ///< A firmware rollout has progressed, cmd_status is the percentage complete over all End Stations
+    FIRMWARE_ROLLOUT_COMPLETED = 10,      ///< A firmware rollout has finished, cmd_status is the number of End Stations that failed
+    END_STATION_DEGRADED = 11,            ///< An AVDECC End Station has stopped responding to commands, cmd_status is the number of consecutive timeouts
+    END_STATION_RECOVERED = 12,           ///< A degraded AVDECC End Station has responded to a probe or advertised a restart
+    END_STATION_EVICTED = 13,             ///< A disconnected AVDECC End Station has been removed from the controller
+    TOTAL_NUM_OF_NOTIFICATIONS = 14
 };
 
 enum acmp_notifications
@@ -289,7 +325,21 @@ enum acmp_notifications
     NULL_ACMP_NOTIFICATION = 0,
     BROADCAST_ACMP_RESPONSE_RECEIVED = 1,
     ACMP_RESPONSE_RECEIVED = 2,
-    TOTAL_NUM_OF_ACMP_NOTIFICATIONS = 3
+    CONNECTION_ADDED = 3,   ///< A talker to listener stream connection has been added to the connection graph
+    CONNECTION_REMOVED = 4, ///< A talker to listener stream connection has been removed from the connection graph
+    TOTAL_NUM_OF_ACMP_NOTIFICATIONS = 5
+};
+
+enum firmware_rollout_states
+{
+    FIRMWARE_ROLLOUT_PENDING = 0,   ///< Waiting for its wave to start
+    FIRMWARE_ROLLOUT_ERASING = 1,   ///< The memory object is being erased with START_OPERATION
+    FIRMWARE_ROLLOUT_UPLOADING = 2, ///< The image is being written with ADDRESS_ACCESS commands
+    FIRMWARE_ROLLOUT_REBOOTING = 3, ///< A REBOOT command has been sent
+    FIRMWARE_ROLLOUT_DONE = 4,      ///< The End Station has been upgraded
+    FIRMWARE_ROLLOUT_FAILED = 5,    ///< A command failed, see the status
+    FIRMWARE_ROLLOUT_SKIPPED = 6,   ///< Not upgraded as the rollout was aborted or stopped after a failed wave
+    TOTAL_NUM_OF_FIRMWARE_ROLLOUT_STATES = 7
 };
 
 enum logging_levels
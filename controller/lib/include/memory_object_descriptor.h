@@ -52,5 +52,44 @@ public:
     /// \param operation_tyoe    An integer representation the operation type to perform on the object
     ///
     AVDECC_CONTROLLER_LIB32_API virtual int STDCALL start_operation_cmd(void * notification_id, uint16_t operation_type) = 0;
+
+    ///
+    /// Upload an image file to the memory object, starting at its start address.
+    ///
+    /// The file is memory mapped and written with ADDRESS_ACCESS commands carrying the largest TLV
+    /// that fits in an AECPDU, with up to window writes inflight. A write that times out is sent
+    /// again, and the upload stops at the first write that fails. MEMORY_OBJECT_TRANSFER_PROGRESS
+    /// notifications are sent as each percent is written, then a MEMORY_OBJECT_TRANSFER_COMPLETED
+    /// notification with the status of the upload. No notifications are sent for the individual writes.
+    ///
+    /// The memory object normally needs to be erased with start_operation_cmd() first.
+    ///
+    /// \param notification_id   A void pointer to the unique identifier passed in the progress and completion notifications.
+    /// \param file_path         The path of the image file to upload.
+    /// \param window            The maximum number of writes inflight, up to 512.
+    /// \return 0 if the upload has started, -1 if the file cannot be mapped or window is 0.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL start_upload(void * notification_id, const char * file_path, size_t window) = 0;
+
+    ///
+    /// Download the contents of the memory object into a file, starting at its start address.
+    ///
+    /// The memory object is read with ADDRESS_ACCESS commands for the largest TLV that fits in an
+    /// AECPDU, with up to window reads inflight. Responses may arrive in any order, and the data of
+    /// each is copied from the received frame into a memory mapping of the file at its offset. A read
+    /// that times out is sent again, and the download stops at the first read that fails, logging
+    /// the offset below which every read has completed. The download is then continued by calling
+    /// this function again with that offset and the same file, whose contents are kept.
+    /// MEMORY_OBJECT_TRANSFER_PROGRESS and MEMORY_OBJECT_TRANSFER_COMPLETED notifications are sent
+    /// as for start_upload().
+    ///
+    /// \param notification_id   A void pointer to the unique identifier passed in the progress and completion notifications.
+    /// \param file_path         The path of the file to download into, which is created if needed and sized to the memory object length.
+    /// \param window            The maximum number of reads inflight, up to 512.
+    /// \param offset            The offset into the memory object to start reading from, 0 for a new download.
+    /// \return 0 if the download has started, -1 if the file cannot be mapped or window is 0.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL start_download(void * notification_id, const char * file_path,
+                                                                   size_t window, uint64_t offset) = 0;
 };
 }
@@ -101,8 +101,72 @@ public:
     AVDECC_CONTROLLER_LIB32_API virtual int STDCALL capture_frame(const uint8_t ** frame, uint16_t * frame_len) = 0;
 };
 
+///
+/// Frame transport used in place of the operating system network interface.
+///
+/// A transport lets frames be exchanged in-process, for example with a simulated network of
+/// AVDECC entities, so that the library can be tested without network access or root privileges.
+///
+class net_transport
+{
+public:
+    virtual ~net_transport() {}
+
+    ///
+    /// \return The MAC address the controller sends frames from.
+    ///
+    virtual uint64_t STDCALL mac_addr() = 0;
+
+    ///
+    /// \return A file descriptor that is readable while a frame is ready to be captured.
+    ///
+    virtual int STDCALL get_fd() = 0;
+
+    ///
+    /// Capture the next frame sent to the controller.
+    ///
+    /// \return The length of the frame, or -1 if no frame is ready.
+    ///
+    virtual int STDCALL capture_frame(uint8_t * frame, uint16_t max_len) = 0;
+
+    ///
+    /// Send a frame from the controller.
+    ///
+    /// \return The number of bytes sent, or -1 on error.
+    ///
+    virtual int STDCALL send_frame(const uint8_t * frame, uint16_t frame_len) = 0;
+};
+
 /**
      * Create a public network interface object used for accessing from outside the library.
      */
 extern "C" AVDECC_CONTROLLER_LIB32_API net_interface * STDCALL create_net_interface();
+
+///
+/// Create a public network interface object that sends and captures frames through a transport.
+///
+/// The network interface has a single device, which is selected with select_interface_by_num(1).
+/// The transport must outlive the network interface.
+///
+/// \return The network interface, or NULL if transports are not supported on the platform.
+///
+extern "C" AVDECC_CONTROLLER_LIB32_API net_interface * STDCALL create_net_interface_with_transport(net_transport * transport);
+
+///
+/// Create a public network interface object that captures frames as one shard of a fanout group.
+///
+/// The network interfaces of a fanout group open their own sockets on the same device, and the
+/// operating system delivers every received frame to exactly one of them, chosen by a hash of the
+/// source MAC address. All frames of an AVDECC entity reach the same shard in order, so a controller
+/// and system created for each shard owns a disjoint subset of the end stations together with their
+/// inflight commands, timers and transmit queue, and the shards process frames on separate threads.
+///
+/// Select the same device on every shard before starting any of their systems, because frames are
+/// distributed over the shards that have joined the group so far.
+///
+/// \param group_id An identifier of the fanout group that is not used by other processes.
+///
+/// \return The network interface, or NULL if fanout groups are not supported on the platform.
+///
+extern "C" AVDECC_CONTROLLER_LIB32_API net_interface * STDCALL create_net_interface_in_fanout_group(uint16_t group_id);
 }
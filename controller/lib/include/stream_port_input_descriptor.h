@@ -31,6 +31,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 #include "avdecc-lib_build.h"
 #include "descriptor_base.h"
 #include "stream_port_input_descriptor_response.h"
@@ -111,5 +112,68 @@ public:
     ///	       1 if there are more pending mappings after sending the command.
     ///
     AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_remove_audio_mappings_cmd(void * notification_id) = 0;
+
+    ///
+    /// Send ADD_AUDIO_MAPPINGS commands for any number of mappings, AEM_MAX_MAPS mappings per
+    /// command, with up to window commands inflight. No notifications are sent for the individual
+    /// commands. No further commands are sent once one fails. When they have all completed, the
+    /// completion callback is called on the lib thread with the status of the first command that
+    /// failed, or AEM_STATUS_SUCCESS, and the mappings that were applied.
+    ///
+    /// \param mappings The mappings to add, which are copied.
+    /// \param mapping_count The number of mappings.
+    /// \param window The maximum number of commands inflight, up to 64.
+    /// \param completion_callback Called once all the commands have completed, or NULL.
+    /// \param user_obj Passed to the completion callback.
+    /// \return 0 if the commands have started, -1 if window is 0.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_add_audio_mappings_batch(const struct audio_map_mapping * mappings,
+                                                                                  size_t mapping_count, size_t window,
+                                                                                  void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                                                                                  void * user_obj) = 0;
+
+    ///
+    /// Send REMOVE_AUDIO_MAPPINGS commands for any number of mappings, as for send_add_audio_mappings_batch().
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_remove_audio_mappings_batch(const struct audio_map_mapping * mappings,
+                                                                                     size_t mapping_count, size_t window,
+                                                                                     void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                                                                                     void * user_obj) = 0;
+
+    ///
+    /// Read the complete dynamic audio map of the Stream Port. GET_AUDIO_MAP is sent for map index 0,
+    /// then for the remaining map indexes its response reports, with up to window commands inflight.
+    /// When they have all completed, the completion callback is called on the lib thread with the
+    /// status of the first command that failed, or AEM_STATUS_SUCCESS, and the mappings of all the
+    /// maps in map index order. A Stream Port reporting no maps completes with no mappings.
+    ///
+    /// \param window The maximum number of commands inflight, up to 64.
+    /// \param completion_callback Called once all the commands have completed.
+    /// \param user_obj Passed to the completion callback.
+    /// \return 0 if the commands have started, -1 if window is 0.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_get_audio_map_batch(size_t window,
+                                                                             void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                                                                             void * user_obj) = 0;
+
+    ///
+    /// Bring the dynamic audio map of the Stream Port to the given mappings. The current map is read
+    /// with send_get_audio_map_batch(), the mappings it has that are not wanted are removed and the
+    /// missing ones are added, so only the channels that change are touched. The map is then read
+    /// again to verify the result. The completion callback is called on the lib thread with the
+    /// status of the first command that failed, AVDECC_LIB_STATUS_INVALID if the map read back
+    /// differs, or AEM_STATUS_SUCCESS, and the number of mappings removed and added.
+    ///
+    /// \param mappings The mappings the Stream Port should have, which are copied.
+    /// \param mapping_count The number of mappings.
+    /// \param window The maximum number of commands inflight, up to 64.
+    /// \param completion_callback Called once the map has been reconciled.
+    /// \param user_obj Passed to the completion callback.
+    /// \return 0 if the commands have started, -1 if window is 0.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL send_set_audio_map(const struct audio_map_mapping * mappings,
+                                                                       size_t mapping_count, size_t window,
+                                                                       void (*completion_callback)(void *, int32_t, size_t, size_t),
+                                                                       void * user_obj) = 0;
 };
 }
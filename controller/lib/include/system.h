@@ -36,6 +36,7 @@ namespace avdecc_lib
 {
 class net_interface;
 class controller;
+class virtual_clock;
 
 class system
 {
@@ -54,11 +55,20 @@ public:
     ///
     /// Set a waiting flag for the command to be sent.
     ///
+    /// The next command sent by the calling thread with the notification id blocks the thread until
+    /// the command completes. Any number of threads can wait for commands at the same time, as long
+    /// as the commands have different notification ids. A command with the notification id of a command
+    /// that another thread waits for is sent without waiting.
+    ///
+    /// \return 0 on success, -1 if the calling thread is already waiting for a command.
+    ///
     AVDECC_CONTROLLER_LIB32_API virtual int STDCALL set_wait_for_next_cmd(void *) = 0;
 
     ///
     /// Wait for the response packet with the corrsponding notification id to be received.
     ///
+    /// \return The status of the last command the calling thread waited for.
+    ///
     AVDECC_CONTROLLER_LIB32_API virtual int STDCALL get_last_resp_status() = 0;
 
     ///
@@ -70,6 +80,33 @@ public:
     /// End point of the system process, which terminates the threads.
     ///
     AVDECC_CONTROLLER_LIB32_API virtual int STDCALL process_close() = 0;
+
+    ///
+    /// Set the priority class of the next command to be sent with the notification id.
+    ///
+    /// Commands are queued for sending in one FIFO per priority class, and queued interactive
+    /// commands are sent before any queued normal or background commands. Without a priority set,
+    /// commands waited on with set_wait_for_next_cmd() are interactive and all other application
+    /// commands are normal. The priority applies to the next command only, and is cleared once
+    /// that command is queued.
+    ///
+    /// \param id The notification id of the command.
+    /// \param priority The priority class, one of the cmd_priorities values.
+    ///
+    /// \return 0 on success, -1 if the priority is not valid.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL set_priority_for_next_cmd(void * id, uint32_t priority) = 0;
+
+    ///
+    /// Run the library on a virtual clock instead of the real clock, so that simulations can run
+    /// faster than real time. Must be called before process_start(). The clock must outlive the system.
+    ///
+    /// \param clock A virtual clock created with create_virtual_clock(), or NULL for the real clock.
+    ///
+    /// \return 0 on success, -1 if the system is already started or virtual clocks are not supported
+    ///         on the platform.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int STDCALL set_virtual_clock(virtual_clock * clock) = 0;
 };
 
 //
@@ -79,5 +116,7 @@ public:
 // \param netif A network interface object created in the application level using the public network interface API provided.
 // \param controller_obj An AVDECC Controller object created in the application level using the public Controller API provided.
 //
+// Each controller needs its own system, which runs the event thread of the controller.
+//
 extern "C" AVDECC_CONTROLLER_LIB32_API system * STDCALL create_system(system::system_type type, net_interface * netif, controller * controller_obj);
 }
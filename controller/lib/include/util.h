@@ -91,6 +91,11 @@ namespace utility
     ///
     AVDECC_CONTROLLER_LIB32_API const char * STDCALL acmp_notification_value_to_name(uint16_t acmp_notification_value);
 
+    ///
+    /// Convert firmware rollout state value to its corresponding firmware rollout state name.
+    ///
+    AVDECC_CONTROLLER_LIB32_API const char * STDCALL firmware_rollout_state_value_to_name(uint16_t firmware_rollout_state_value);
+
     ///
     /// Convert post_log_msg value to its corresponding post_log_msg name.
     ///
@@ -0,0 +1,107 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * virtual_clock.h
+ *
+ * Public virtual clock class, which replaces the real time source of the library for
+ * faster-than-real-time simulation.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "avdecc-lib_build.h"
+
+namespace avdecc_lib
+{
+///
+/// Simulated component that runs on the virtual time, such as a simulated network.
+///
+class virtual_clock_listener
+{
+public:
+    virtual ~virtual_clock_listener() {}
+
+    ///
+    /// Called by each advance of the virtual clock, before the timer tick of the library runs.
+    ///
+    /// \param now_ms The new virtual time in milliseconds.
+    ///
+    virtual void STDCALL clock_advanced(uint64_t now_ms) = 0;
+};
+
+///
+/// A virtual time source for the library.
+///
+/// Once the clock is passed to system::set_virtual_clock(), the timers of the library read the
+/// virtual time and the timer tick runs only when the clock is advanced, instead of every 25 ms.
+/// The clock keeps the deadlines of the running timers, so that advance_to_next_deadline() can
+/// skip straight to the next timeout and the time between timeouts costs nothing.
+///
+/// The clock is advanced by one driver thread. An advance waits for the timer tick to finish, so
+/// it must not be called from a notification or log callback.
+///
+class virtual_clock
+{
+public:
+    ///
+    /// Destroy the virtual clock. The system must be destroyed first.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL destroy() = 0;
+
+    ///
+    /// \return The virtual time in milliseconds.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual uint64_t STDCALL now_ms() = 0;
+
+    ///
+    /// Add a deadline for advance_to_next_deadline() to stop at. The timers of the library add
+    /// their deadlines when started, and listeners add the deadlines of their own events.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL add_deadline(uint64_t deadline_ms) = 0;
+
+    ///
+    /// Advance the virtual time to the earliest deadline and run the timer tick. A deadline that
+    /// has already passed runs the timer tick without advancing the time.
+    ///
+    /// \return The milliseconds advanced, or -1 if there is no deadline.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual int64_t STDCALL advance_to_next_deadline() = 0;
+
+    ///
+    /// Advance the virtual time by a fixed step and run the timer tick.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL advance(uint32_t duration_ms) = 0;
+
+    ///
+    /// Set the listener called by each advance, or NULL for none.
+    ///
+    AVDECC_CONTROLLER_LIB32_API virtual void STDCALL set_listener(virtual_clock_listener * listener) = 0;
+};
+
+///
+/// Create a virtual clock, which starts at the current time of the real clock.
+///
+extern "C" AVDECC_CONTROLLER_LIB32_API virtual_clock * STDCALL create_virtual_clock();
+}
@@ -38,12 +38,15 @@
 #include "log_imp.h"
 #include "inflight.h"
 #include "adp.h"
+#include "cmd_trace.h"
+#include "cmd_completion.h"
+#include "rtt_estimator.h"
+#include "frame_recorder.h"
+#include "controller_imp.h"
 #include "acmp_controller_state_machine.h"
 
 namespace avdecc_lib
 {
-acmp_controller_state_machine * acmp_controller_state_machine_ref = new acmp_controller_state_machine();
-
 acmp_controller_state_machine::acmp_controller_state_machine()
 {
     acmp_seq_id = 0;
@@ -114,7 +117,7 @@ int acmp_controller_state_machine::state_resp(void *& notification_id, struct jd
 void acmp_controller_state_machine::state_timeout(uint32_t inflight_cmd_index)
 {
     struct jdksavdecc_frame frame = inflight_cmds.at(inflight_cmd_index).frame();
-    bool is_retried = inflight_cmds.at(inflight_cmd_index).retried();
+    bool is_retried = inflight_cmds.at(inflight_cmd_index).retried(rtt_estimator_ref->max_retries());
 
     if (is_retried)
     {
@@ -130,14 +133,21 @@ void acmp_controller_state_machine::state_timeout(uint32_t inflight_cmd_index)
         struct jdksavdecc_eui64 _listener_entity_id = jdksavdecc_acmpdu_get_listener_entity_id(frame.payload, ETHER_HDR_SIZE);
         listener_entity_id = jdksavdecc_uint64_get(&_listener_entity_id, 0);
         
-        notification_acmp_imp_ref->post_acmp_notification_msg(ACMP_RESPONSE_RECEIVED,
-                                                              (uint16_t)msg_type + CMD_LOOKUP,
-                                                              talker_entity_id,
-                                                              0,
-                                                              listener_entity_id,
-                                                              0,
-                                                              UINT_MAX,
-                                                              inflight_cmds.at(inflight_cmd_index).cmd_notification_id);
+        void * notification_id = inflight_cmds.at(inflight_cmd_index).cmd_notification_id;
+        rtt_estimator_ref->timed_out(inflight_cmds.at(inflight_cmd_index).cmd_target_entity_id, inflight_cmds.at(inflight_cmd_index).cmd_class,
+                                     inflight_cmds.at(inflight_cmd_index).cmd_type);
+        controller_imp_ref->acmp_cmd_timed_out(notification_id);
+        if (!cmd_completion_ref->complete(notification_id, AVDECC_LIB_STATUS_TICK_TIMEOUT, NULL, 0))
+        {
+            notification_acmp_imp_ref->post_acmp_notification_msg(ACMP_RESPONSE_RECEIVED,
+                                                                  (uint16_t)msg_type + CMD_LOOKUP,
+                                                                  talker_entity_id,
+                                                                  0,
+                                                                  listener_entity_id,
+                                                                  0,
+                                                                  UINT_MAX,
+                                                                  notification_id);
+        }
 
         log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR,
                                   "Command Timeout, 0x%llx, %s, %s, %s, %d",
@@ -147,6 +157,13 @@ void acmp_controller_state_machine::state_timeout(uint32_t inflight_cmd_index)
                                   "NULL",
                                   inflight_cmds.at(inflight_cmd_index).cmd_seq_id);
 
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "acmp", "timeout", inflight_cmds.at(inflight_cmd_index).cmd_seq_id);
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_END,
+                                        "acmp",
+                                        utility::acmp_cmd_value_to_name(msg_type),
+                                        inflight_cmds.at(inflight_cmd_index).cmd_seq_id,
+                                        listener_entity_id,
+                                        UINT_MAX);
         inflight_cmds.erase(inflight_cmds.begin() + inflight_cmd_index);
     }
     else
@@ -170,7 +187,12 @@ int acmp_controller_state_machine::tx_cmd(void * notification_id, uint32_t notif
     {
         uint16_t this_seq_id = acmp_seq_id;
         uint32_t msg_type = jdksavdecc_common_control_header_get_control_data(cmd_frame->payload, ETHER_HDR_SIZE);
-        uint32_t timeout_ms = utility::acmp_cmd_to_timeout(msg_type); // ACMP command timeout lookup
+        uint32_t cmd_class = rtt_estimator::acmp_cmd_class(msg_type);
+        uint64_t target_entity_id = acmp_target_entity_id(msg_type, cmd_frame->payload);
+        uint32_t timeout_ms = rtt_estimator_ref->timeout_ms(target_entity_id,
+                                                            cmd_class,
+                                                            (uint16_t)msg_type,
+                                                            utility::acmp_cmd_to_timeout(msg_type)); // ACMP command timeout lookup
         jdksavdecc_acmpdu_set_sequence_id(acmp_seq_id++, cmd_frame->payload, ETHER_HDR_SIZE);
 
         inflight in_flight = inflight(cmd_frame,
@@ -179,8 +201,10 @@ int acmp_controller_state_machine::tx_cmd(void * notification_id, uint32_t notif
                                       notification_flag,
                                       timeout_ms);
 
+        in_flight.set_target(target_entity_id, cmd_class, (uint16_t)msg_type);
         in_flight.start_timer();
         inflight_cmds.push_back(in_flight);
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_BEGIN, "acmp", utility::acmp_cmd_value_to_name(msg_type), this_seq_id, 0, (intptr_t)notification_id);
     }
     else
     {
@@ -190,11 +214,14 @@ int acmp_controller_state_machine::tx_cmd(void * notification_id, uint32_t notif
 
         if (j != inflight_cmds.end()) // found?
         {
+            (*j).set_timeout_ms(rtt_estimator_ref->retry_timeout_ms((*j).cmd_target_entity_id, (*j).cmd_class, (*j).cmd_type, (*j).timeout_ms()));
             (*j).start_timer();
         }
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "acmp", "retry", resend_with_seq_id);
     }
 
     send_frame_returned = net_interface_ref->send_frame(cmd_frame->payload, cmd_frame->length);
+    frame_recorder_ref->record(frame_recorder::TX, cmd_frame->payload, cmd_frame->length);
     if (send_frame_returned < 0)
     {
         log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "netif_send_frame error");
@@ -206,6 +233,25 @@ int acmp_controller_state_machine::tx_cmd(void * notification_id, uint32_t notif
     return 0;
 }
 
+uint64_t acmp_controller_state_machine::acmp_target_entity_id(uint32_t msg_type, const uint8_t * frame)
+{
+    struct jdksavdecc_eui64 id;
+
+    switch (msg_type)
+    {
+    case JDKSAVDECC_ACMP_MESSAGE_TYPE_CONNECT_RX_COMMAND:
+    case JDKSAVDECC_ACMP_MESSAGE_TYPE_DISCONNECT_RX_COMMAND:
+    case JDKSAVDECC_ACMP_MESSAGE_TYPE_GET_RX_STATE_COMMAND:
+        id = jdksavdecc_acmpdu_get_listener_entity_id(frame, ETHER_HDR_SIZE);
+        break;
+    default:
+        id = jdksavdecc_acmpdu_get_talker_entity_id(frame, ETHER_HDR_SIZE);
+        break;
+    }
+
+    return jdksavdecc_uint64_get(&id, 0);
+}
+
 int acmp_controller_state_machine::proc_resp(void *& notification_id, struct jdksavdecc_frame * cmd_frame)
 {
     uint16_t seq_id = jdksavdecc_acmpdu_get_sequence_id(cmd_frame->payload, ETHER_HDR_SIZE);
@@ -216,10 +262,25 @@ int acmp_controller_state_machine::proc_resp(void *& notification_id, struct jdk
 
     if (j != inflight_cmds.end()) // found?
     {
+        uint32_t rtt_ms;
+
+        if ((*j).take_rtt(rtt_ms))
+            rtt_estimator_ref->sample((*j).cmd_target_entity_id, (*j).cmd_class, (*j).cmd_type, rtt_ms);
+
         notification_id = (*j).cmd_notification_id;
         notification_flag = (*j).notification_flag();
         callback(notification_id, notification_flag, cmd_frame->payload);
+        if (cmd_trace_ref->enabled())
+        {
+            uint32_t msg_type = jdksavdecc_common_control_header_get_control_data(cmd_frame->payload, ETHER_HDR_SIZE);
+            uint32_t status = jdksavdecc_common_control_header_get_status(cmd_frame->payload, ETHER_HDR_SIZE);
+            cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_END, "acmp", utility::acmp_cmd_value_to_name(msg_type - 1), seq_id, 0, status);
+        }
         inflight_cmds.erase(j);
+        cmd_completion_ref->complete(notification_id,
+                                     jdksavdecc_common_control_header_get_status(cmd_frame->payload, ETHER_HDR_SIZE),
+                                     cmd_frame->payload,
+                                     ACMP_FRAME_LEN);
         return 1;
     }
     else
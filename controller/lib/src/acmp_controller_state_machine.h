@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include "controller_context.h"
+
 namespace avdecc_lib
 {
 class inflight;
@@ -93,7 +95,10 @@ private:
     /// Call notification or post_log_msg callback function for the command sent or response received.
     ///
     int callback(void * notification_id, uint32_t notification_flag, uint8_t * frame);
-};
 
-extern acmp_controller_state_machine * acmp_controller_state_machine_ref;
+    ///
+    /// \return The Entity ID of the Listener or Talker that answers an ACMP command.
+    ///
+    uint64_t acmp_target_entity_id(uint32_t msg_type, const uint8_t * frame);
+};
 }
@@ -0,0 +1,205 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * address_access_batch.cpp
+ *
+ * ADDRESS_ACCESS batch implementation
+ */
+
+#include <string.h>
+#include <algorithm>
+#include "jdksavdecc_aecp_aa.h"
+#include "enumeration.h"
+#include "end_station_imp.h"
+#include "address_access_batch.h"
+
+namespace avdecc_lib
+{
+address_access_batch::address_access_batch(end_station_imp * end_station_obj,
+                                           address_access_tlv * tlvs, size_t tlv_count, size_t window,
+                                           void (*completion_callback)(void *, address_access_tlv *, size_t),
+                                           void * user_obj)
+    : m_end_station(end_station_obj), m_tlvs(tlvs), m_tlv_count(tlv_count), m_window(window),
+      m_completion_callback(completion_callback), m_user_obj(user_obj),
+      m_next_command(0), m_inflight(0), m_remaining(0)
+{
+    for (size_t i = 0; i < m_tlv_count; i++)
+        m_tlvs[i].status = AVDECC_LIB_STATUS_INVALID;
+
+    pack();
+    m_remaining = m_commands.size() + 1;
+    m_is_pinned = m_end_station->pin();
+}
+
+address_access_batch::~address_access_batch()
+{
+    if (m_is_pinned)
+        m_end_station->unpin();
+}
+
+void address_access_batch::pack()
+{
+    size_t tlvs_length = AECP_AA_MAX_TLVS_LEN;
+
+    for (size_t i = 0; i < m_tlv_count; i++)
+    {
+        // Sized for the response, which carries the data of reads as well as writes
+        size_t tlv_length = JDKSAVDECC_AECPDU_AA_TLV_LEN + m_tlvs[i].length;
+
+        if (tlvs_length + tlv_length > AECP_AA_MAX_TLVS_LEN)
+        {
+            command cmd;
+            cmd.first_tlv = i;
+            cmd.tlv_count = 0;
+            m_commands.push_back(cmd);
+            tlvs_length = 0;
+        }
+
+        m_commands.back().tlv_count++;
+        tlvs_length += tlv_length;
+    }
+}
+
+void address_access_batch::start()
+{
+    if (send_pending())
+        return;
+
+    if (release(m_commands.size()))
+        finish();
+}
+
+void address_access_batch::cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len)
+{
+    command * cmd = static_cast<command *>(notification_id);
+
+    parse_response(*cmd, status, frame, frame_len);
+
+    if (release(cmd - &m_commands[0]))
+    {
+        finish();
+        return;
+    }
+
+    send_pending();
+}
+
+void address_access_batch::select_commands(std::vector<size_t> & to_send)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    to_send.clear();
+    while ((m_inflight < m_window) && (m_next_command < m_commands.size()))
+    {
+        size_t index = m_next_command++;
+
+        m_inflight++;
+        cmd_completion_ref->register_id(&m_commands[index], this);
+        to_send.push_back(index);
+    }
+}
+
+bool address_access_batch::send_pending()
+{
+    std::vector<size_t> to_send;
+
+    for (;;)
+    {
+        select_commands(to_send);
+        if (to_send.empty())
+            return false;
+
+        for (size_t i = 0; i < to_send.size(); i++)
+        {
+            command & cmd = m_commands[to_send[i]];
+
+            if (m_end_station->send_aecp_address_access_tlvs(&cmd, &m_tlvs[cmd.first_tlv], cmd.tlv_count) == 0)
+                continue;
+
+            // Not sent, so its TLVs keep the invalid status and its place in the window is reused
+            cmd_completion_ref->unregister_id(&cmd);
+            if (release(to_send[i]))
+            {
+                finish();
+                return true;
+            }
+        }
+    }
+}
+
+void address_access_batch::parse_response(const command & cmd, int status, const uint8_t * frame, size_t frame_len)
+{
+    size_t tlv_offset = ETHER_HDR_SIZE + JDKSAVDECC_AECPDU_AA_LEN;
+    size_t rcvd_tlv_count = 0;
+
+    if ((status == JDKSAVDECC_AECP_AA_STATUS_SUCCESS) && frame && (frame_len >= tlv_offset))
+        rcvd_tlv_count = std::min<size_t>(jdksavdecc_aecp_aa_get_tlv_count(frame, ETHER_HDR_SIZE), cmd.tlv_count);
+
+    for (size_t i = 0; i < cmd.tlv_count; i++)
+    {
+        address_access_tlv & tlv = m_tlvs[cmd.first_tlv + i];
+
+        if (status != JDKSAVDECC_AECP_AA_STATUS_SUCCESS)
+        {
+            tlv.status = status;
+            continue;
+        }
+
+        // A response that ends early leaves the remaining TLVs with the invalid status
+        if ((i >= rcvd_tlv_count) || (frame_len < tlv_offset + JDKSAVDECC_AECPDU_AA_TLV_LEN))
+            break;
+
+        uint16_t mode_length = jdksavdecc_aecp_aa_tlv_get_mode_length(frame, tlv_offset);
+        size_t length = mode_length & 0xFFF;
+        size_t data_offset = tlv_offset + JDKSAVDECC_AECPDU_AA_TLV_LEN;
+
+        if (frame_len < data_offset + length)
+            break;
+
+        if ((tlv.mode == JDKSAVDECC_AECP_AA_MODE_READ) && tlv.data)
+            memcpy(tlv.data, frame + data_offset, std::min<size_t>(length, tlv.length));
+
+        tlv.status = JDKSAVDECC_AECP_AA_STATUS_SUCCESS;
+        tlv_offset = data_offset + length;
+    }
+}
+
+bool address_access_batch::release(size_t index)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (index < m_commands.size())
+        m_inflight--;
+
+    return --m_remaining == 0;
+}
+
+void address_access_batch::finish()
+{
+    if (m_completion_callback)
+        m_completion_callback(m_user_obj, m_tlvs, m_tlv_count);
+
+    delete this;
+}
+}
@@ -0,0 +1,116 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * address_access_batch.h
+ *
+ * ADDRESS_ACCESS batch class, which packs a list of TLVs into as few commands as fit and sends
+ * them to an End Station within a window of inflight commands.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <vector>
+#include "end_station.h"
+#include "cmd_completion.h"
+
+namespace avdecc_lib
+{
+class end_station_imp;
+
+class address_access_batch : public cmd_completion_handler
+{
+public:
+    enum
+    {
+        MAX_WINDOW = 512 // Keeps the commands queued to the lib thread well within the tx pipe
+    };
+
+    address_access_batch(end_station_imp * end_station_obj,
+                         address_access_tlv * tlvs, size_t tlv_count, size_t window,
+                         void (*completion_callback)(void *, address_access_tlv *, size_t),
+                         void * user_obj);
+    ~address_access_batch();
+
+    ///
+    /// Send the first window of commands. The object deletes itself after calling the
+    /// completion callback, which may happen before this function returns.
+    ///
+    void start();
+
+    void cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len);
+
+private:
+    struct command
+    {
+        size_t first_tlv;
+        size_t tlv_count;
+    };
+
+    end_station_imp * m_end_station;
+    bool m_is_pinned; // The End Station is not evicted while the operation runs
+    address_access_tlv * m_tlvs;
+    size_t m_tlv_count;
+    size_t m_window;
+    void (*m_completion_callback)(void *, address_access_tlv *, size_t);
+    void * m_user_obj;
+    std::vector<command> m_commands; // Each is the notification id of its command
+
+    std::mutex m_lock;
+    size_t m_next_command;
+    size_t m_inflight;
+    size_t m_remaining; // Commands not yet completed, plus one while start() is running
+
+    ///
+    /// Split the TLVs into commands, each taking consecutive TLVs while their headers and data fit
+    /// in the command and in its response.
+    ///
+    void pack();
+
+    void select_commands(std::vector<size_t> & to_send);
+
+    ///
+    /// Send the commands the window allows.
+    ///
+    /// \return True if the last command completed and the object was deleted.
+    ///
+    bool send_pending();
+
+    ///
+    /// Set the status of the TLVs of a command from its response, copying the data read.
+    ///
+    void parse_response(const command & cmd, int status, const uint8_t * frame, size_t frame_len);
+
+    ///
+    /// Account for a completed command, or for the end of start() if index is the number of commands.
+    ///
+    /// \return True if all the commands have completed.
+    ///
+    bool release(size_t index);
+
+    void finish();
+};
+}
@@ -36,12 +36,11 @@
 #include "log_imp.h"
 #include "util.h"
 #include "adp.h"
+#include "frame_recorder.h"
 #include "adp_discovery_state_machine.h"
 
 namespace avdecc_lib
 {
-adp_discovery_state_machine * adp_discovery_state_machine_ref = new adp_discovery_state_machine(); // To have one ADP Discovery State Machine for all end stations
-
 adp_discovery_state_machine::adp_discovery_state_machine()
 {
     first_tick = true;
@@ -104,6 +103,7 @@ int adp_discovery_state_machine::tx_discover(struct jdksavdecc_frame * cmd_frame
 {
     int send_frame_returned;
     send_frame_returned = net_interface_ref->send_frame(cmd_frame->payload, cmd_frame->length); // Send the frame with message information
+    frame_recorder_ref->record(frame_recorder::TX, cmd_frame->payload, cmd_frame->length);
 
     if (send_frame_returned < 0)
     {
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "timer.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
@@ -116,6 +117,4 @@ private:
     ///
     int state_timeout(uint32_t entity_index);
 };
-
-extern adp_discovery_state_machine * adp_discovery_state_machine_ref;
 }
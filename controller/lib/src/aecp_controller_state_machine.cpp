@@ -37,11 +37,21 @@
 #include "log_imp.h"
 #include "inflight.h"
 #include "operation.h"
+#include "cmd_trace.h"
+#include "cmd_completion.h"
+#include "rtt_estimator.h"
+#include "frame_recorder.h"
+#include "controller_imp.h"
 #include "aecp_controller_state_machine.h"
 
 namespace avdecc_lib
 {
-aecp_controller_state_machine * aecp_controller_state_machine_ref = new aecp_controller_state_machine(); // To have one Controller State Machine for all end stations
+// The length of an AECP frame, from its control_data_length
+static size_t aecp_frame_len(const uint8_t * frame)
+{
+    return ETHER_HDR_SIZE + JDKSAVDECC_COMMON_CONTROL_HEADER_LEN +
+           jdksavdecc_common_control_header_get_control_data_length(frame, ETHER_HDR_SIZE);
+}
 
 aecp_controller_state_machine::aecp_controller_state_machine()
 {
@@ -96,22 +106,30 @@ void aecp_controller_state_machine::common_hdr_init(int message_type, struct jdk
     }
 }
 
-int aecp_controller_state_machine::tx_cmd(void * notification_id, uint32_t notification_flag, struct jdksavdecc_frame * cmd_frame, bool resend)
+int aecp_controller_state_machine::tx_cmd(void * notification_id, uint32_t notification_flag, struct jdksavdecc_frame * cmd_frame, bool resend, uint32_t priority)
 {
     int send_frame_returned;
 
     if (!resend)
     {
         uint16_t current_seq_id = aecp_seq_id;
+        jdksavdecc_eui64 id = jdksavdecc_common_control_header_get_stream_id(cmd_frame->payload, ETHER_HDR_SIZE);
+        uint64_t target_entity_id = jdksavdecc_uint64_get(&id, 0);
+        uint32_t msg_type = jdksavdecc_common_control_header_get_control_data(cmd_frame->payload, ETHER_HDR_SIZE);
+        uint32_t cmd_class = rtt_estimator::aecp_cmd_class(msg_type);
+        uint16_t cmd_type = rtt_estimator::aecp_cmd_type(msg_type, cmd_frame->payload);
 
         jdksavdecc_aecpdu_common_set_sequence_id(aecp_seq_id++, cmd_frame->payload, ETHER_HDR_SIZE);
         inflight in_flight = inflight(cmd_frame,
                                       current_seq_id,
                                       notification_id,
                                       notification_flag,
-                                      AVDECC_MSG_TIMEOUT_MS);
+                                      rtt_estimator_ref->timeout_ms(target_entity_id, cmd_class, cmd_type, AVDECC_MSG_TIMEOUT_MS));
+        in_flight.set_priority(priority);
+        in_flight.set_target(target_entity_id, cmd_class, cmd_type);
         in_flight.start_timer();
         inflight_cmds.push_back(in_flight);
+        trace_cmd(cmd_trace::TRACE_ASYNC_BEGIN, current_seq_id, cmd_frame->payload, (intptr_t)notification_id);
     }
     else
     {
@@ -121,11 +139,14 @@ int aecp_controller_state_machine::tx_cmd(void * notification_id, uint32_t notif
 
         if (j != inflight_cmds.end()) // found?
         {
+            j->set_timeout_ms(rtt_estimator_ref->retry_timeout_ms(j->cmd_target_entity_id, j->cmd_class, j->cmd_type, j->timeout_ms()));
             j->start_timer();
         }
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "aecp", "retry", resend_with_seq_id);
     }
 
     send_frame_returned = net_interface_ref->send_frame(cmd_frame->payload, cmd_frame->length);
+    frame_recorder_ref->record(frame_recorder::TX, cmd_frame->payload, cmd_frame->length);
     if (send_frame_returned < 0)
     {
         log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "netif_send_frame error");
@@ -158,18 +179,29 @@ int aecp_controller_state_machine::proc_resp(void *& notification_id, struct jdk
 
     if (j != inflight_cmds.end()) // found?
     {
+        uint32_t rtt_ms;
+
+        if (j->take_rtt(rtt_ms))
+            rtt_estimator_ref->sample(j->cmd_target_entity_id, j->cmd_class, j->cmd_type, rtt_ms);
+
         notification_id = j->cmd_notification_id;
         notification_flag = j->notification_flag();
         callback(notification_id, notification_flag, cmd_frame->payload);
 
-        // Restart the timer if response is indicating the operation is still in progress so that it won't be timed out
+        // Restart the timer if response is indicating the operation is still in progress so that it won't be timed out.
+        // The entity sends IN_PROGRESS responses within the 1722.1 timeout, which may exceed an adaptive timeout.
         if (status == AEM_STATUS_IN_PROGRESS)
         {
+            cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "aecp", "in_progress", seq_id);
+            j->set_timeout_ms(std::max(j->timeout_ms(), (uint32_t)AVDECC_MSG_TIMEOUT_MS));
             j->restart_timer();
         }
         else
         {
+            if (cmd_trace_ref->enabled())
+                trace_cmd(cmd_trace::TRACE_ASYNC_END, seq_id, j->frame().payload, status);
             inflight_cmds.erase(j);
+            cmd_completion_ref->complete(notification_id, status, cmd_frame->payload, aecp_frame_len(cmd_frame->payload));
         }
 
         return 1;
@@ -178,9 +210,9 @@ int aecp_controller_state_machine::proc_resp(void *& notification_id, struct jdk
     return -1;
 }
 
-int aecp_controller_state_machine::state_send_cmd(void * notification_id, uint32_t notification_flag, struct jdksavdecc_frame * cmd_frame)
+int aecp_controller_state_machine::state_send_cmd(void * notification_id, uint32_t notification_flag, struct jdksavdecc_frame * cmd_frame, uint32_t priority)
 {
-    return tx_cmd(notification_id, notification_flag, cmd_frame, false);
+    return tx_cmd(notification_id, notification_flag, cmd_frame, false, priority);
 }
 
 int aecp_controller_state_machine::state_rcvd_unsolicited(struct jdksavdecc_frame * cmd_frame)
@@ -196,7 +228,7 @@ int aecp_controller_state_machine::state_rcvd_resp(void *& notification_id, stru
 void aecp_controller_state_machine::state_timeout(uint32_t inflight_cmd_index)
 {
     struct jdksavdecc_frame frame = inflight_cmds.at(inflight_cmd_index).frame();
-    bool is_retried = inflight_cmds.at(inflight_cmd_index).retried();
+    bool is_retried = inflight_cmds.at(inflight_cmd_index).retried(rtt_estimator_ref->max_retries());
     uint32_t notification_flag = inflight_cmds.at(inflight_cmd_index).notification_flag();
 
     if (is_retried)
@@ -208,14 +240,21 @@ void aecp_controller_state_machine::state_timeout(uint32_t inflight_cmd_index)
         uint16_t desc_type = jdksavdecc_aem_command_read_descriptor_get_descriptor_type(frame.payload, ETHER_HDR_SIZE);
         uint16_t desc_index = jdksavdecc_aem_command_read_descriptor_get_descriptor_index(frame.payload, ETHER_HDR_SIZE);
 
-        notification_imp_ref->post_notification_msg(COMMAND_TIMEOUT,
-                                                    jdksavdecc_uint64_get(&id, 0),
-                                                    msg_type,
-                                                    cmd_type,
-                                                    desc_type,
-                                                    desc_index,
-                                                    UINT_MAX,
-                                                    inflight_cmds.at(inflight_cmd_index).cmd_notification_id);
+        void * notification_id = inflight_cmds.at(inflight_cmd_index).cmd_notification_id;
+        rtt_estimator_ref->timed_out(inflight_cmds.at(inflight_cmd_index).cmd_target_entity_id, inflight_cmds.at(inflight_cmd_index).cmd_class,
+                                     inflight_cmds.at(inflight_cmd_index).cmd_type);
+        controller_imp_ref->aecp_cmd_timed_out(inflight_cmds.at(inflight_cmd_index).cmd_target_entity_id, notification_id);
+        if (!cmd_completion_ref->complete(notification_id, AVDECC_LIB_STATUS_TICK_TIMEOUT, NULL, 0))
+        {
+            notification_imp_ref->post_notification_msg(COMMAND_TIMEOUT,
+                                                        jdksavdecc_uint64_get(&id, 0),
+                                                        msg_type,
+                                                        cmd_type,
+                                                        desc_type,
+                                                        desc_index,
+                                                        UINT_MAX,
+                                                        notification_id);
+        }
 
         log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR,
                                   "Command Timeout, 0x%llx, %s, %s, %d, %d",
@@ -225,6 +264,8 @@ void aecp_controller_state_machine::state_timeout(uint32_t inflight_cmd_index)
                                   desc_index,
                                   inflight_cmds.at(inflight_cmd_index).cmd_seq_id);
 
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "aecp", "timeout", inflight_cmds.at(inflight_cmd_index).cmd_seq_id);
+        trace_cmd(cmd_trace::TRACE_ASYNC_END, inflight_cmds.at(inflight_cmd_index).cmd_seq_id, frame.payload, UINT_MAX);
         inflight_cmds.erase(inflight_cmds.begin() + inflight_cmd_index);
     }
     else
@@ -236,7 +277,8 @@ void aecp_controller_state_machine::state_timeout(uint32_t inflight_cmd_index)
         tx_cmd(inflight_cmds.at(inflight_cmd_index).cmd_notification_id,
                notification_flag,
                &frame,
-               true);
+               true,
+               inflight_cmds.at(inflight_cmd_index).cmd_priority);
     }
 }
 
@@ -284,7 +326,7 @@ int aecp_controller_state_machine::start_operation(void *& notification_id, uint
                                operation_id,
                                operation_type,
                                notification_id,
-                               CMD_WITH_NOTIFICATION);
+                               cmd_completion_ref->is_registered(notification_id) ? CMD_WITHOUT_NOTIFICATION : CMD_WITH_NOTIFICATION);
     active_operations.push_back(oper);
 
     log_imp_ref->post_log_msg(LOGGING_LEVEL_DEBUG, "Added new operation with type %x and id %d", operation_type, operation_id);
@@ -308,6 +350,13 @@ int aecp_controller_state_machine::update_operation_for_rcvd_resp(void *& notifi
         {
             log_imp_ref->post_log_msg(LOGGING_LEVEL_DEBUG, "Removed operation with id %d, percent_complete: %d", operation_id, percent_complete);
             active_operations.erase(j);
+            cmd_completion_ref->complete(notification_id,
+                                         jdksavdecc_common_control_header_get_status(cmd_frame->payload, ETHER_HDR_SIZE),
+                                         cmd_frame->payload, aecp_frame_len(cmd_frame->payload));
+        }
+        else
+        {
+            cmd_completion_ref->progress(notification_id, cmd_frame->payload, aecp_frame_len(cmd_frame->payload));
         }
         return 1;
     }
@@ -548,6 +597,25 @@ int aecp_controller_state_machine::callback(void * notification_id, uint32_t not
     return 0;
 }
 
+void aecp_controller_state_machine::trace_cmd(char ph, uint16_t seq_id, const uint8_t * frame, int64_t value)
+{
+    if (!cmd_trace_ref->enabled())
+        return;
+
+    uint32_t msg_type = jdksavdecc_common_control_header_get_control_data(frame, ETHER_HDR_SIZE);
+    jdksavdecc_eui64 id = jdksavdecc_common_control_header_get_stream_id(frame, ETHER_HDR_SIZE);
+    const char * name;
+
+    if (msg_type == JDKSAVDECC_AECP_MESSAGE_TYPE_AEM_COMMAND)
+        name = utility::aem_cmd_value_to_name(jdksavdecc_aecpdu_aem_get_command_type(frame, ETHER_HDR_SIZE) & 0x7FFF);
+    else if (msg_type == JDKSAVDECC_AECP_MESSAGE_TYPE_ADDRESS_ACCESS_COMMAND)
+        name = "ADDRESS_ACCESS";
+    else
+        name = "VENDOR_UNIQUE";
+
+    cmd_trace_ref->post_trace_event(ph, "aecp", name, seq_id, jdksavdecc_uint64_get(&id, 0), value);
+}
+
 bool aecp_controller_state_machine::is_inflight_cmd_with_notification_id(void * notification_id)
 {
     std::vector<inflight>::iterator j =
@@ -560,4 +628,12 @@ bool aecp_controller_state_machine::is_inflight_cmd_with_notification_id(void *
 
     return false;
 }
+
+bool aecp_controller_state_machine::is_inflight_cmd_with_priority(uint64_t target_entity_id, uint32_t priority)
+{
+    std::vector<inflight>::iterator j =
+        std::find_if(inflight_cmds.begin(), inflight_cmds.end(), PriorityComp(target_entity_id, priority));
+
+    return j != inflight_cmds.end();
+}
 }
@@ -32,6 +32,7 @@
 #include <vector>
 #include "inflight.h"
 #include "operation.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
@@ -61,7 +62,9 @@ public:
     ///
     /// Process the Send Command state of the AEM Controller State Machine.
     ///
-    int state_send_cmd(void * notification_id, uint32_t notification_flag, struct jdksavdecc_frame * cmd_frame);
+    /// \param priority The cmd_priorities class the command was queued with.
+    ///
+    int state_send_cmd(void * notification_id, uint32_t notification_flag, struct jdksavdecc_frame * cmd_frame, uint32_t priority);
 
     ///
     /// Process the Received Unsolicited state of the AEM Controller State Machine.
@@ -93,11 +96,16 @@ public:
     ///
     bool is_inflight_cmd_with_notification_id(void * notification_id);
 
+    ///
+    /// Check if a command with the priority class is inflight to the target entity.
+    ///
+    bool is_inflight_cmd_with_priority(uint64_t target_entity_id, uint32_t priority);
+
 private:
     ///
     /// Transmit an AEM Command.
     ///
-    int tx_cmd(void * notification_id, uint32_t notification_flag, struct jdksavdecc_frame * cmd_frame, bool resend);
+    int tx_cmd(void * notification_id, uint32_t notification_flag, struct jdksavdecc_frame * cmd_frame, bool resend, uint32_t priority);
 
     ///
     /// Handle the receipt and processing of a received unsolicited response for a command sent.
@@ -119,7 +127,10 @@ private:
     /// Call notification or post_log_msg callback function for the command sent or response received.
     ///
     int callback(void * notification_id, uint32_t notification_flag, uint8_t * frame);
-};
 
-extern aecp_controller_state_machine * aecp_controller_state_machine_ref;
+    ///
+    /// Post a trace event for the inflight command with the sequence id, named after the command in the frame.
+    ///
+    void trace_cmd(char ph, uint16_t seq_id, const uint8_t * frame, int64_t value);
+};
 }
@@ -0,0 +1,355 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * audio_map_batch.cpp
+ *
+ * Audio map batch implementation
+ */
+
+#include <string.h>
+#include <algorithm>
+#include "jdksavdecc_aem_command.h"
+#include "enumeration.h"
+#include "log_imp.h"
+#include "adp.h"
+#include "system_tx_queue.h"
+#include "aecp_controller_state_machine.h"
+#include "end_station_imp.h"
+#include "audio_map_batch.h"
+
+namespace avdecc_lib
+{
+audio_map_batch::audio_map_batch(end_station_imp * end_station_obj, uint16_t desc_type, uint16_t desc_index, uint16_t cmd_type,
+                                 size_t window,
+                                 void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                                 void * user_obj)
+    : m_end_station(end_station_obj), m_desc_type(desc_type), m_desc_index(desc_index), m_cmd_type(cmd_type),
+      m_window(window), m_completion_callback(completion_callback), m_user_obj(user_obj),
+      m_next_command(0), m_inflight(0), m_remaining(0), m_status(AEM_STATUS_SUCCESS)
+{
+    // The number of maps is only known from the response for map index 0
+    if (m_cmd_type == JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP)
+    {
+        m_commands.resize(1);
+        m_commands[0].index = 0;
+        m_commands[0].applied = false;
+    }
+    m_remaining = m_commands.size() + 1;
+    m_is_pinned = m_end_station->pin();
+}
+
+audio_map_batch::~audio_map_batch()
+{
+    if (m_is_pinned)
+        m_end_station->unpin();
+}
+
+void audio_map_batch::set_mappings(const struct audio_map_mapping * mappings, size_t mapping_count)
+{
+    m_mappings.assign(mappings, mappings + mapping_count);
+
+    m_commands.resize((mapping_count + AEM_MAX_MAPS - 1) / AEM_MAX_MAPS);
+    for (size_t i = 0; i < m_commands.size(); i++)
+    {
+        m_commands[i].index = i;
+        m_commands[i].applied = false;
+    }
+    m_remaining = m_commands.size() + 1;
+}
+
+void audio_map_batch::start()
+{
+    if (send_pending())
+        return;
+
+    if (release(START_INDEX, AEM_STATUS_SUCCESS, 0))
+        finish();
+}
+
+void audio_map_batch::cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len)
+{
+    command & cmd = *static_cast<command *>(notification_id);
+    uint16_t number_of_maps = 0;
+
+    if ((status == AEM_STATUS_SUCCESS) && (m_cmd_type == JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP))
+    {
+        int maps = parse_audio_map(cmd, frame, frame_len);
+        if (maps < 0)
+            status = AVDECC_LIB_STATUS_INVALID;
+        else
+            number_of_maps = (uint16_t)maps;
+    }
+
+    if (release(cmd.index, status, number_of_maps))
+    {
+        finish();
+        return;
+    }
+
+    send_pending();
+}
+
+void audio_map_batch::select_commands(std::vector<size_t> & to_send)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    to_send.clear();
+    while ((m_inflight < m_window) && (m_next_command < m_commands.size()))
+    {
+        size_t index = m_next_command++;
+
+        m_inflight++;
+        cmd_completion_ref->register_id(&m_commands[index], this);
+        to_send.push_back(index);
+    }
+}
+
+bool audio_map_batch::send_pending()
+{
+    std::vector<size_t> to_send;
+
+    for (;;)
+    {
+        select_commands(to_send);
+        if (to_send.empty())
+            return false;
+
+        for (size_t i = 0; i < to_send.size(); i++)
+        {
+            command * cmd;
+            {
+                // The deque grows when map index 0 completes, which keeps the commands in place but races with indexing
+                std::lock_guard<std::mutex> guard(m_lock);
+                cmd = &m_commands[to_send[i]];
+            }
+
+            if (send_command(*cmd) == 0)
+                continue;
+
+            // Drop this command and the rest of the selection, the failure stops the batch
+            bool done = false;
+            for (size_t j = i; j < to_send.size(); j++)
+            {
+                std::lock_guard<std::mutex> guard(m_lock);
+                cmd_completion_ref->unregister_id(&m_commands[to_send[j]]);
+            }
+            for (size_t j = i; j < to_send.size(); j++)
+                done = release(to_send[j], AVDECC_LIB_STATUS_INVALID, 0);
+            if (done)
+            {
+                finish();
+                return true;
+            }
+            break;
+        }
+    }
+}
+
+int audio_map_batch::send_command(command & cmd)
+{
+    end_station_pin pin(m_end_station);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(m_end_station->context());
+
+    struct jdksavdecc_frame cmd_frame;
+    struct jdksavdecc_aem_command_get_audio_map aem_cmd_get_audio_map;
+
+    if (m_cmd_type != JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP)
+    {
+        size_t first = cmd.index * AEM_MAX_MAPS;
+        return send_mappings_cmd(m_end_station, m_desc_type, m_desc_index, m_cmd_type, &m_mappings[first],
+                                 std::min<size_t>(AEM_MAX_MAPS, m_mappings.size() - first), &cmd);
+    }
+
+    memset(&aem_cmd_get_audio_map, 0, sizeof(aem_cmd_get_audio_map));
+    aem_cmd_get_audio_map.aem_header.aecpdu_header.controller_entity_id = m_end_station->get_adp()->get_controller_entity_id();
+    aem_cmd_get_audio_map.aem_header.command_type = JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP;
+    aem_cmd_get_audio_map.descriptor_type = m_desc_type;
+    aem_cmd_get_audio_map.descriptor_index = m_desc_index;
+    aem_cmd_get_audio_map.map_index = (uint16_t)cmd.index;
+
+    aecp_controller_state_machine_ref->ether_frame_init(m_end_station->mac(), &cmd_frame,
+                                                        ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP_COMMAND_LEN);
+    if (jdksavdecc_aem_command_get_audio_map_write(&aem_cmd_get_audio_map, cmd_frame.payload, ETHER_HDR_SIZE,
+                                                   sizeof(cmd_frame.payload)) < 0)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "aem_cmd_get_audio_map_write error\n");
+        return -1;
+    }
+
+    aecp_controller_state_machine_ref->common_hdr_init(JDKSAVDECC_AECP_MESSAGE_TYPE_AEM_COMMAND,
+                                                       &cmd_frame,
+                                                       m_end_station->entity_id(),
+                                                       JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP_COMMAND_LEN -
+                                                           JDKSAVDECC_COMMON_CONTROL_HEADER_LEN);
+    system_queue_tx(&cmd, CMD_WITH_NOTIFICATION, cmd_frame.payload, cmd_frame.length);
+
+    return 0;
+}
+
+int audio_map_batch::send_mappings_cmd(end_station_imp * end_station_obj, uint16_t desc_type, uint16_t desc_index, uint16_t cmd_type,
+                                       const struct audio_map_mapping * mappings, size_t mapping_count, void * notification_id)
+{
+    end_station_pin pin(end_station_obj);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(end_station_obj->context());
+
+    struct jdksavdecc_frame cmd_frame;
+    struct jdksavdecc_aem_command_add_audio_mappings aem_cmd_audio_mappings;
+    ssize_t aem_cmd_audio_mappings_returned;
+
+    // ADD_AUDIO_MAPPINGS and REMOVE_AUDIO_MAPPINGS commands have the same layout
+    mapping_count = std::min<size_t>(mapping_count, AEM_MAX_MAPS);
+    memset(&aem_cmd_audio_mappings, 0, sizeof(aem_cmd_audio_mappings));
+    aem_cmd_audio_mappings.aem_header.aecpdu_header.controller_entity_id = end_station_obj->get_adp()->get_controller_entity_id();
+    aem_cmd_audio_mappings.aem_header.command_type = cmd_type;
+    aem_cmd_audio_mappings.descriptor_type = desc_type;
+    aem_cmd_audio_mappings.descriptor_index = desc_index;
+    aem_cmd_audio_mappings.number_of_mappings = (uint16_t)mapping_count;
+
+    aecp_controller_state_machine_ref->ether_frame_init(end_station_obj->mac(), &cmd_frame,
+                                                        ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS_COMMAND_LEN +
+                                                            (uint16_t)mapping_count * JDKSAVDECC_AUDIO_MAPPING_LEN);
+    aem_cmd_audio_mappings_returned = jdksavdecc_aem_command_add_audio_mappings_write(&aem_cmd_audio_mappings,
+                                                                                      cmd_frame.payload,
+                                                                                      ETHER_HDR_SIZE,
+                                                                                      sizeof(cmd_frame.payload));
+    if (aem_cmd_audio_mappings_returned < 0)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "aem_cmd_audio_mappings_write error\n");
+        return -1;
+    }
+
+    for (size_t i = 0; i < mapping_count; i++)
+    {
+        ssize_t offset = ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS_COMMAND_OFFSET_MAPPINGS + JDKSAVDECC_AUDIO_MAPPING_LEN * i;
+
+        jdksavdecc_uint16_set(mappings[i].stream_index, cmd_frame.payload, offset + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_STREAM_INDEX);
+        jdksavdecc_uint16_set(mappings[i].stream_channel, cmd_frame.payload, offset + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_STREAM_CHANNEL);
+        jdksavdecc_uint16_set(mappings[i].cluster_offset, cmd_frame.payload, offset + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_CLUSTER_OFFSET);
+        jdksavdecc_uint16_set(mappings[i].cluster_channel, cmd_frame.payload, offset + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_CLUSTER_CHANNEL);
+    }
+
+    aecp_controller_state_machine_ref->common_hdr_init(JDKSAVDECC_AECP_MESSAGE_TYPE_AEM_COMMAND,
+                                                       &cmd_frame,
+                                                       end_station_obj->entity_id(),
+                                                       JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS_COMMAND_LEN + mapping_count * JDKSAVDECC_AUDIO_MAPPING_LEN -
+                                                           JDKSAVDECC_COMMON_CONTROL_HEADER_LEN);
+    system_queue_tx(notification_id, CMD_WITH_NOTIFICATION, cmd_frame.payload, cmd_frame.length);
+
+    return 0;
+}
+
+int audio_map_batch::parse_audio_map(command & cmd, const uint8_t * frame, size_t frame_len)
+{
+    if (!frame || frame_len < ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP_RESPONSE_OFFSET_MAPPINGS)
+        return -1;
+
+    uint16_t number_of_maps = jdksavdecc_aem_command_get_audio_map_response_get_number_of_maps(frame, ETHER_HDR_SIZE);
+    uint16_t number_of_mappings = jdksavdecc_aem_command_get_audio_map_response_get_number_of_mappings(frame, ETHER_HDR_SIZE);
+    size_t offset = ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP_RESPONSE_OFFSET_MAPPINGS;
+
+    if (frame_len < offset + number_of_mappings * JDKSAVDECC_AUDIO_MAPPING_LEN)
+        return -1;
+
+    cmd.rcvd.resize(number_of_mappings);
+    for (size_t i = 0; i < number_of_mappings; i++, offset += JDKSAVDECC_AUDIO_MAPPING_LEN)
+    {
+        cmd.rcvd[i].stream_index = jdksavdecc_uint16_get(frame, offset + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_STREAM_INDEX);
+        cmd.rcvd[i].stream_channel = jdksavdecc_uint16_get(frame, offset + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_STREAM_CHANNEL);
+        cmd.rcvd[i].cluster_offset = jdksavdecc_uint16_get(frame, offset + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_CLUSTER_OFFSET);
+        cmd.rcvd[i].cluster_channel = jdksavdecc_uint16_get(frame, offset + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_CLUSTER_CHANNEL);
+    }
+
+    return number_of_maps;
+}
+
+bool audio_map_batch::release(size_t index, int status, uint16_t number_of_maps)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (index != START_INDEX)
+    {
+        m_inflight--;
+        if (status == AEM_STATUS_SUCCESS)
+        {
+            m_commands[index].applied = true;
+        }
+        else if (m_status == AEM_STATUS_SUCCESS)
+        {
+            // Stop at the first failure, the commands not yet sent are dropped
+            m_status = status;
+            m_remaining -= m_commands.size() - m_next_command;
+            m_next_command = m_commands.size();
+        }
+
+        // The response for map index 0 gives the number of maps, which may be 0, the rest are read in parallel
+        if ((index == 0) && (m_cmd_type == JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP) && (m_commands.size() == 1))
+        {
+            for (size_t i = 1; i < number_of_maps; i++)
+            {
+                m_commands.push_back(command());
+                m_commands.back().index = i;
+                m_commands.back().applied = false;
+                m_remaining++;
+            }
+        }
+    }
+
+    return --m_remaining == 0;
+}
+
+void audio_map_batch::finish()
+{
+    if (m_cmd_type == JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP)
+    {
+        for (size_t i = 0; i < m_commands.size(); i++)
+            m_mappings.insert(m_mappings.end(), m_commands[i].rcvd.begin(), m_commands[i].rcvd.end());
+    }
+    else if (m_status != AEM_STATUS_SUCCESS)
+    {
+        // Report only the chunks that were applied before the failure
+        std::vector<struct audio_map_mapping> applied;
+        for (size_t i = 0; i < m_commands.size(); i++)
+        {
+            if (!m_commands[i].applied)
+                continue;
+
+            size_t first = i * AEM_MAX_MAPS;
+            size_t last = std::min<size_t>(first + AEM_MAX_MAPS, m_mappings.size());
+            applied.insert(applied.end(), m_mappings.begin() + first, m_mappings.begin() + last);
+        }
+        m_mappings.swap(applied);
+    }
+
+    if (m_completion_callback)
+        m_completion_callback(m_user_obj, m_status, m_mappings.empty() ? NULL : &m_mappings[0], m_mappings.size());
+
+    delete this;
+}
+}
@@ -0,0 +1,136 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * audio_map_batch.h
+ *
+ * Audio map batch class, which adds or removes any number of audio mappings on a Stream Port in
+ * commands of up to AEM_MAX_MAPS mappings, or reads every page of its GET_AUDIO_MAP, keeping a
+ * window of commands inflight.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include "audio_map_descriptor_response.h"
+#include "cmd_completion.h"
+
+namespace avdecc_lib
+{
+class end_station_imp;
+
+class audio_map_batch : public cmd_completion_handler
+{
+public:
+    enum
+    {
+        MAX_WINDOW = 64
+    };
+
+    ///
+    /// \param cmd_type JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS, REMOVE_AUDIO_MAPPINGS or GET_AUDIO_MAP.
+    ///
+    audio_map_batch(end_station_imp * end_station_obj, uint16_t desc_type, uint16_t desc_index, uint16_t cmd_type,
+                    size_t window,
+                    void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                    void * user_obj);
+    ~audio_map_batch();
+
+    ///
+    /// Set the mappings to add or remove.
+    ///
+    void set_mappings(const struct audio_map_mapping * mappings, size_t mapping_count);
+
+    ///
+    /// Send the first window of commands. The object deletes itself after calling the
+    /// completion callback, which may happen before this function returns.
+    ///
+    void start();
+
+    void cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len);
+
+    ///
+    /// Send an ADD_AUDIO_MAPPINGS or REMOVE_AUDIO_MAPPINGS command carrying up to AEM_MAX_MAPS mappings.
+    ///
+    static int send_mappings_cmd(end_station_imp * end_station_obj, uint16_t desc_type, uint16_t desc_index, uint16_t cmd_type,
+                                 const struct audio_map_mapping * mappings, size_t mapping_count, void * notification_id);
+
+private:
+    static const size_t START_INDEX = (size_t)-1;
+
+    struct command
+    {
+        size_t index;                                // The chunk of mappings, or the GET_AUDIO_MAP map index
+        bool applied;                                // The chunk of mappings was added or removed
+        std::vector<struct audio_map_mapping> rcvd; // The mappings in the GET_AUDIO_MAP response
+    };
+
+    end_station_imp * m_end_station;
+    bool m_is_pinned; // The End Station is not evicted while the operation runs
+    uint16_t m_desc_type;
+    uint16_t m_desc_index;
+    uint16_t m_cmd_type;
+    size_t m_window;
+    void (*m_completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t);
+    void * m_user_obj;
+    std::vector<struct audio_map_mapping> m_mappings;
+
+    std::mutex m_lock;
+    std::deque<command> m_commands; // Each is the notification id of its command, grown once the number of maps is known
+    size_t m_next_command;
+    size_t m_inflight;
+    size_t m_remaining; // Commands not yet completed, plus one while start() is running
+    int32_t m_status;   // The first failure, after which no more commands are sent
+
+    void select_commands(std::vector<size_t> & to_send);
+
+    ///
+    /// Send the commands the window allows.
+    ///
+    /// \return True if the last command completed and the object was deleted.
+    ///
+    bool send_pending();
+
+    int send_command(command & cmd);
+
+    ///
+    /// Copy the mappings of a GET_AUDIO_MAP response.
+    ///
+    /// \return The number of maps the Stream Port has, or -1 if the response is malformed.
+    ///
+    int parse_audio_map(command & cmd, const uint8_t * frame, size_t frame_len);
+
+    ///
+    /// Account for a completed command, or for the end of start() if index is START_INDEX.
+    ///
+    /// \return True if all the commands have completed.
+    ///
+    bool release(size_t index, int status, uint16_t number_of_maps);
+
+    void finish();
+};
+}
@@ -43,6 +43,10 @@ audio_map_descriptor_imp::~audio_map_descriptor_imp() {}
 
 audio_map_descriptor_response * STDCALL audio_map_descriptor_imp::get_audio_map_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new audio_map_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                         resp_ref->get_desc_size(), resp_ref->get_desc_pos());
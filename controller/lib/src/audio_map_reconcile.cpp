@@ -0,0 +1,201 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * audio_map_reconcile.cpp
+ *
+ * Audio map reconcile implementation
+ */
+
+#include <algorithm>
+#include <iterator>
+#include "jdksavdecc_aem_command.h"
+#include "enumeration.h"
+#include "log_imp.h"
+#include "end_station_imp.h"
+#include "audio_map_batch.h"
+#include "audio_map_reconcile.h"
+
+namespace avdecc_lib
+{
+static bool mapping_equal(const struct audio_map_mapping & a, const struct audio_map_mapping & b)
+{
+    return !audio_map_reconcile::mapping_less(a, b) && !audio_map_reconcile::mapping_less(b, a);
+}
+
+audio_map_reconcile::audio_map_reconcile(end_station_imp * end_station_obj, uint16_t desc_type, uint16_t desc_index, size_t window,
+                                         void (*completion_callback)(void *, int32_t, size_t, size_t),
+                                         void * user_obj)
+    : m_end_station(end_station_obj), m_desc_type(desc_type), m_desc_index(desc_index), m_window(window),
+      m_completion_callback(completion_callback), m_user_obj(user_obj), m_stage(STAGE_READ),
+      m_removed(0), m_added(0)
+{
+    m_is_pinned = m_end_station->pin();
+}
+
+audio_map_reconcile::~audio_map_reconcile()
+{
+    if (m_is_pinned)
+        m_end_station->unpin();
+}
+
+bool audio_map_reconcile::mapping_less(const struct audio_map_mapping & a, const struct audio_map_mapping & b)
+{
+    if (a.stream_index != b.stream_index)
+        return a.stream_index < b.stream_index;
+    if (a.stream_channel != b.stream_channel)
+        return a.stream_channel < b.stream_channel;
+    if (a.cluster_offset != b.cluster_offset)
+        return a.cluster_offset < b.cluster_offset;
+    return a.cluster_channel < b.cluster_channel;
+}
+
+void audio_map_reconcile::set_mappings(const struct audio_map_mapping * mappings, size_t mapping_count)
+{
+    m_desired.assign(mappings, mappings + mapping_count);
+    std::sort(m_desired.begin(), m_desired.end(), mapping_less);
+    m_desired.erase(std::unique(m_desired.begin(), m_desired.end(), mapping_equal), m_desired.end());
+}
+
+void audio_map_reconcile::start()
+{
+    run_stage(STAGE_READ);
+}
+
+void audio_map_reconcile::batch_completed(void * user_obj, int32_t status, const struct audio_map_mapping * mappings, size_t mapping_count)
+{
+    static_cast<audio_map_reconcile *>(user_obj)->stage_completed(status, mappings, mapping_count);
+}
+
+void audio_map_reconcile::stage_completed(int32_t status, const struct audio_map_mapping * mappings, size_t mapping_count)
+{
+    // A failed batch reports the mappings it applied before stopping
+    if (m_stage == STAGE_REMOVE)
+        m_removed = mapping_count;
+    else if (m_stage == STAGE_ADD)
+        m_added = mapping_count;
+
+    if (status != AEM_STATUS_SUCCESS)
+    {
+        finish(status);
+        return;
+    }
+
+    switch (m_stage)
+    {
+    case STAGE_READ:
+        diff(m_desired, mappings, mapping_count, m_to_remove, m_to_add);
+        if (m_to_remove.empty() && m_to_add.empty())
+            finish(AEM_STATUS_SUCCESS);
+        else if (!m_to_remove.empty())
+            run_stage(STAGE_REMOVE);
+        else
+            run_stage(STAGE_ADD);
+        break;
+
+    case STAGE_REMOVE:
+        if (!m_to_add.empty())
+            run_stage(STAGE_ADD);
+        else
+            run_stage(STAGE_VERIFY);
+        break;
+
+    case STAGE_ADD:
+        run_stage(STAGE_VERIFY);
+        break;
+
+    case STAGE_VERIFY:
+    {
+        // Another controller may have changed the map while the commands were inflight
+        std::vector<struct audio_map_mapping> extra;
+        std::vector<struct audio_map_mapping> missing;
+        diff(m_desired, mappings, mapping_count, extra, missing);
+
+        if (!extra.empty() || !missing.empty())
+        {
+            log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "audio map of 0x%llx descriptor %u index %u does not match after reconcile",
+                                      (unsigned long long)m_end_station->entity_id(), m_desc_type, m_desc_index);
+            finish(AVDECC_LIB_STATUS_INVALID);
+            return;
+        }
+
+        finish(AEM_STATUS_SUCCESS);
+        break;
+    }
+    }
+}
+
+void audio_map_reconcile::diff(const std::vector<struct audio_map_mapping> & desired,
+                               const struct audio_map_mapping * mappings, size_t mapping_count,
+                               std::vector<struct audio_map_mapping> & to_remove,
+                               std::vector<struct audio_map_mapping> & to_add)
+{
+    std::vector<struct audio_map_mapping> current(mappings, mappings + mapping_count);
+    std::sort(current.begin(), current.end(), mapping_less);
+    current.erase(std::unique(current.begin(), current.end(), mapping_equal), current.end());
+
+    to_remove.clear();
+    to_add.clear();
+    std::set_difference(current.begin(), current.end(), desired.begin(), desired.end(),
+                        std::back_inserter(to_remove), mapping_less);
+    std::set_difference(desired.begin(), desired.end(), current.begin(), current.end(),
+                        std::back_inserter(to_add), mapping_less);
+}
+
+void audio_map_reconcile::run_stage(enum stage next_stage)
+{
+    audio_map_batch * batch;
+
+    m_stage = next_stage;
+    switch (m_stage)
+    {
+    case STAGE_REMOVE:
+        // Removing first frees any cluster channels the new mappings use
+        batch = new audio_map_batch(m_end_station, m_desc_type, m_desc_index, JDKSAVDECC_AEM_COMMAND_REMOVE_AUDIO_MAPPINGS,
+                                    m_window, batch_completed, this);
+        batch->set_mappings(&m_to_remove[0], m_to_remove.size());
+        break;
+
+    case STAGE_ADD:
+        batch = new audio_map_batch(m_end_station, m_desc_type, m_desc_index, JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS,
+                                    m_window, batch_completed, this);
+        batch->set_mappings(&m_to_add[0], m_to_add.size());
+        break;
+
+    default:
+        batch = new audio_map_batch(m_end_station, m_desc_type, m_desc_index, JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP,
+                                    m_window, batch_completed, this);
+        break;
+    }
+
+    batch->start();
+}
+
+void audio_map_reconcile::finish(int32_t status)
+{
+    if (m_completion_callback)
+        m_completion_callback(m_user_obj, status, m_removed, m_added);
+
+    delete this;
+}
+}
@@ -0,0 +1,115 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * audio_map_reconcile.h
+ *
+ * Audio map reconcile class, which brings the dynamic audio map of a Stream Port to a desired
+ * state by reading the current map and removing and adding only the mappings that differ.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "audio_map_descriptor_response.h"
+
+namespace avdecc_lib
+{
+class end_station_imp;
+
+class audio_map_reconcile
+{
+public:
+    audio_map_reconcile(end_station_imp * end_station_obj, uint16_t desc_type, uint16_t desc_index, size_t window,
+                        void (*completion_callback)(void *, int32_t, size_t, size_t),
+                        void * user_obj);
+    ~audio_map_reconcile();
+
+    ///
+    /// Set the mappings the Stream Port should have. Duplicates are ignored.
+    ///
+    void set_mappings(const struct audio_map_mapping * mappings, size_t mapping_count);
+
+    ///
+    /// Read the current map. The object deletes itself after calling the completion callback,
+    /// which may happen before this function returns.
+    ///
+    void start();
+
+    ///
+    /// Order mappings by stream index, stream channel, cluster offset and cluster channel.
+    ///
+    static bool mapping_less(const struct audio_map_mapping & a, const struct audio_map_mapping & b);
+
+    ///
+    /// Compute the mappings to remove and to add to bring a map to the desired mappings.
+    ///
+    /// \param desired The desired mappings, sorted by mapping_less() and unique.
+    /// \param mappings The current mappings, in any order and possibly with duplicates.
+    /// \param mapping_count The number of current mappings.
+    /// \param to_remove Set to the current mappings that are not desired, sorted.
+    /// \param to_add Set to the desired mappings that are not current, sorted.
+    ///
+    static void diff(const std::vector<struct audio_map_mapping> & desired,
+                     const struct audio_map_mapping * mappings, size_t mapping_count,
+                     std::vector<struct audio_map_mapping> & to_remove,
+                     std::vector<struct audio_map_mapping> & to_add);
+
+private:
+    enum stage
+    {
+        STAGE_READ,
+        STAGE_REMOVE,
+        STAGE_ADD,
+        STAGE_VERIFY
+    };
+
+    end_station_imp * m_end_station;
+    bool m_is_pinned; // The End Station is not evicted while the operation runs
+    uint16_t m_desc_type;
+    uint16_t m_desc_index;
+    size_t m_window;
+    void (*m_completion_callback)(void *, int32_t, size_t, size_t);
+    void * m_user_obj;
+
+    enum stage m_stage;
+    std::vector<struct audio_map_mapping> m_desired; // Sorted and unique
+    std::vector<struct audio_map_mapping> m_to_remove;
+    std::vector<struct audio_map_mapping> m_to_add;
+    size_t m_removed; // The mappings the remove stage applied
+    size_t m_added;   // The mappings the add stage applied
+
+    static void batch_completed(void * user_obj, int32_t status, const struct audio_map_mapping * mappings, size_t mapping_count);
+
+    void stage_completed(int32_t status, const struct audio_map_mapping * mappings, size_t mapping_count);
+
+    ///
+    /// Start the audio map batch for a stage.
+    ///
+    void run_stage(enum stage next_stage);
+
+    void finish(int32_t status);
+};
+}
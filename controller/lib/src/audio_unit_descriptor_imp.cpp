@@ -47,6 +47,10 @@ audio_unit_descriptor_imp::~audio_unit_descriptor_imp() {}
 
 audio_unit_descriptor_response * STDCALL audio_unit_descriptor_imp::get_audio_unit_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new audio_unit_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                          resp_ref->get_desc_size(), resp_ref->get_desc_pos());
@@ -54,6 +58,10 @@ audio_unit_descriptor_response * STDCALL audio_unit_descriptor_imp::get_audio_un
 
 audio_unit_get_sampling_rate_response * STDCALL audio_unit_descriptor_imp::get_audio_unit_get_sampling_rate_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_SAMPLING_RATE);
     if (!resp_frame)
@@ -65,6 +73,12 @@ audio_unit_get_sampling_rate_response * STDCALL audio_unit_descriptor_imp::get_a
 
 int STDCALL audio_unit_descriptor_imp::send_set_sampling_rate_cmd(void * notification_id, uint32_t new_sampling_rate)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_set_sampling_rate aem_cmd_set_sampling_rate;
     ssize_t aem_cmd_set_sampling_rate_returned;
@@ -134,6 +148,8 @@ int audio_unit_descriptor_imp::proc_set_sampling_rate_resp(void *& notification_
 
     if (status == AEM_STATUS_SUCCESS)
     {
+        store_cmd_resp_frame(AEM_CMD_GET_SAMPLING_RATE, frame, ETHER_HDR_SIZE, frame_len); // Same layout as the GET_SAMPLING_RATE response
+
         uint8_t * buffer = (uint8_t *)malloc(resp_ref->get_desc_size() * sizeof(uint8_t)); //fetch current desc frame
         memcpy(buffer, resp_ref->get_desc_buffer(), resp_ref->get_desc_size());
         jdksavdecc_descriptor_audio_unit_set_current_sampling_rate(aem_cmd_set_sampling_rate_resp.sampling_rate, buffer, resp_ref->get_desc_pos()); //set clk source
@@ -149,6 +165,12 @@ int audio_unit_descriptor_imp::proc_set_sampling_rate_resp(void *& notification_
 
 int STDCALL audio_unit_descriptor_imp::send_get_sampling_rate_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_sampling_rate aem_cmd_get_sampling_rate;
     ssize_t aem_cmd_get_sampling_rate_returned;
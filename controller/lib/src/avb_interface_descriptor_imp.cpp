@@ -47,6 +47,10 @@ avb_interface_descriptor_imp::~avb_interface_descriptor_imp() {}
 
 avb_interface_descriptor_response * STDCALL avb_interface_descriptor_imp::get_avb_interface_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new avb_interface_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                             resp_ref->get_desc_size(), resp_ref->get_desc_pos());
@@ -54,6 +58,10 @@ avb_interface_descriptor_response * STDCALL avb_interface_descriptor_imp::get_av
 
 avb_counters_response * STDCALL avb_interface_descriptor_imp::get_avb_interface_counters_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_COUNTERS);
     if (!resp_frame)
@@ -65,6 +73,10 @@ avb_counters_response * STDCALL avb_interface_descriptor_imp::get_avb_interface_
 
 avb_interface_get_avb_info_response * STDCALL avb_interface_descriptor_imp::get_avb_interface_get_avb_info_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_AVB_INFO);
     if (!resp_frame)
@@ -76,6 +88,12 @@ avb_interface_get_avb_info_response * STDCALL avb_interface_descriptor_imp::get_
 
 int STDCALL avb_interface_descriptor_imp::send_get_counters_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_counters aem_cmd_get_counters;
     memset(&aem_cmd_get_counters, 0, sizeof(aem_cmd_get_counters));
@@ -149,6 +167,12 @@ int avb_interface_descriptor_imp::proc_get_counters_resp(void *& notification_id
 
 int STDCALL avb_interface_descriptor_imp::send_get_avb_info_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_avb_info aem_cmd_get_avb_info;
     memset(&aem_cmd_get_avb_info, 0, sizeof(aem_cmd_get_avb_info));
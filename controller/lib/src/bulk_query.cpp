@@ -0,0 +1,317 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * bulk_query.cpp
+ *
+ * Bulk state query implementation
+ */
+
+#include <stddef.h>
+#include "enumeration.h"
+#include "end_station.h"
+#include "entity_descriptor.h"
+#include "configuration_descriptor.h"
+#include "audio_unit_descriptor.h"
+#include "stream_input_descriptor.h"
+#include "stream_output_descriptor.h"
+#include "avb_interface_descriptor.h"
+#include "clock_domain_descriptor.h"
+#include "end_station_imp.h"
+#include "controller_imp.h"
+#include "bulk_query.h"
+
+namespace avdecc_lib
+{
+bulk_query::bulk_query(controller_imp * controller_obj,
+                       bulk_query_target * targets, size_t target_count,
+                       size_t per_entity_window, size_t global_window,
+                       void (*completion_callback)(void *, bulk_query_target *, size_t),
+                       void * user_obj)
+    : m_controller(controller_obj), m_targets(targets), m_target_count(target_count),
+      m_per_entity_window(per_entity_window), m_global_window(global_window),
+      m_completion_callback(completion_callback), m_user_obj(user_obj),
+      m_inflight(0), m_remaining(target_count + 1)
+{
+    for (size_t i = 0; i < m_target_count; i++)
+    {
+        m_targets[i].status = AVDECC_LIB_STATUS_INVALID;
+
+        entity_queue_map::iterator it = m_entities.find(m_targets[i].entity_id);
+        if (it == m_entities.end())
+        {
+            it = m_entities.insert(entity_queue_map::value_type(m_targets[i].entity_id, entity_queue())).first;
+            it->second.inflight = 0;
+            m_ready.push_back(m_targets[i].entity_id);
+        }
+        it->second.pending.push_back(i);
+    }
+}
+
+bulk_query::~bulk_query() {}
+
+bool bulk_query::is_supported(const bulk_query_target & target)
+{
+    switch (target.cmd_type)
+    {
+    case GET_RX_STATE_COMMAND + CMD_LOOKUP:
+        return target.desc_type == AEM_DESC_STREAM_INPUT;
+
+    case GET_TX_STATE_COMMAND + CMD_LOOKUP:
+        return target.desc_type == AEM_DESC_STREAM_OUTPUT;
+
+    case AEM_CMD_GET_STREAM_INFO:
+    case AEM_CMD_GET_STREAM_FORMAT:
+        return target.desc_type == AEM_DESC_STREAM_INPUT || target.desc_type == AEM_DESC_STREAM_OUTPUT;
+
+    case AEM_CMD_GET_COUNTERS:
+        return target.desc_type == AEM_DESC_ENTITY || target.desc_type == AEM_DESC_AVB_INTERFACE ||
+               target.desc_type == AEM_DESC_STREAM_INPUT || target.desc_type == AEM_DESC_CLOCK_DOMAIN;
+
+    case AEM_CMD_GET_AVB_INFO:
+        return target.desc_type == AEM_DESC_AVB_INTERFACE;
+
+    case AEM_CMD_GET_CLOCK_SOURCE:
+        return target.desc_type == AEM_DESC_CLOCK_DOMAIN;
+
+    case AEM_CMD_GET_SAMPLING_RATE:
+        return target.desc_type == AEM_DESC_AUDIO_UNIT;
+
+    default:
+        return false;
+    }
+}
+
+void bulk_query::start()
+{
+    if (send_pending())
+        return;
+
+    if (release(m_target_count))
+        finish();
+}
+
+void bulk_query::cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len)
+{
+    (void)frame;
+    (void)frame_len;
+
+    bulk_query_target * target = static_cast<bulk_query_target *>(notification_id);
+    target->status = status;
+
+    if (release(target - m_targets))
+    {
+        finish();
+        return;
+    }
+
+    send_pending();
+}
+
+void bulk_query::select_targets(std::vector<size_t> & to_send)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    to_send.clear();
+    while ((m_inflight < m_global_window) && !m_ready.empty())
+    {
+        uint64_t entity_id = m_ready.front();
+        m_ready.pop_front();
+
+        entity_queue & queue = m_entities[entity_id];
+        size_t index = queue.pending.front();
+        queue.pending.pop_front();
+        queue.inflight++;
+        m_inflight++;
+
+        // Registered before sending so that the command is routed here when the lib thread sends it
+        cmd_completion_ref->register_id(&m_targets[index], this);
+        to_send.push_back(index);
+
+        if (!queue.pending.empty() && (queue.inflight < m_per_entity_window))
+            m_ready.push_back(entity_id);
+    }
+}
+
+bool bulk_query::send_pending()
+{
+    std::vector<size_t> to_send;
+
+    for (;;)
+    {
+        select_targets(to_send);
+        if (to_send.empty())
+            return false;
+
+        for (size_t i = 0; i < to_send.size(); i++)
+        {
+            bulk_query_target & target = m_targets[to_send[i]];
+
+            if (send_target(m_controller, target) == 0)
+                continue;
+
+            // Not sent, so it completes straight away and its place in the windows is reused
+            cmd_completion_ref->unregister_id(&target);
+            target.status = AVDECC_LIB_STATUS_INVALID;
+            if (release(to_send[i]))
+            {
+                finish();
+                return true;
+            }
+        }
+    }
+}
+
+int bulk_query::send_target(controller_imp * controller_obj, bulk_query_target & target)
+{
+    end_station_imp * end_station = is_supported(target) ? controller_obj->find_end_station_by_entity_id(target.entity_id) : NULL;
+    if (!end_station)
+        return -1;
+
+    end_station_pin pin(end_station);
+    if (!pin.is_pinned())
+        return -1;
+
+    configuration_descriptor * configuration = end_station->get_current_config();
+    if (!configuration)
+        return -1;
+
+    switch (target.desc_type)
+    {
+    case AEM_DESC_ENTITY:
+    {
+        entity_descriptor * entity = end_station->get_entity_desc_by_index(end_station->get_current_entity_index());
+        if (entity)
+            return entity->send_get_counters_cmd(&target);
+    }
+    break;
+
+    case AEM_DESC_AUDIO_UNIT:
+    {
+        audio_unit_descriptor * audio_unit = configuration->get_audio_unit_desc_by_index(target.desc_index);
+        if (audio_unit)
+            return audio_unit->send_get_sampling_rate_cmd(&target);
+    }
+    break;
+
+    case AEM_DESC_STREAM_INPUT:
+    {
+        stream_input_descriptor * stream_input = configuration->get_stream_input_desc_by_index(target.desc_index);
+        if (!stream_input)
+            break;
+
+        switch (target.cmd_type)
+        {
+        case GET_RX_STATE_COMMAND + CMD_LOOKUP:
+            return stream_input->send_get_rx_state_cmd(&target);
+        case AEM_CMD_GET_STREAM_INFO:
+            return stream_input->send_get_stream_info_cmd(&target);
+        case AEM_CMD_GET_STREAM_FORMAT:
+            return stream_input->send_get_stream_format_cmd(&target);
+        case AEM_CMD_GET_COUNTERS:
+            return stream_input->send_get_counters_cmd(&target);
+        }
+    }
+    break;
+
+    case AEM_DESC_STREAM_OUTPUT:
+    {
+        stream_output_descriptor * stream_output = configuration->get_stream_output_desc_by_index(target.desc_index);
+        if (!stream_output)
+            break;
+
+        switch (target.cmd_type)
+        {
+        case GET_TX_STATE_COMMAND + CMD_LOOKUP:
+            return stream_output->send_get_tx_state_cmd(&target);
+        case AEM_CMD_GET_STREAM_INFO:
+            return stream_output->send_get_stream_info_cmd(&target);
+        case AEM_CMD_GET_STREAM_FORMAT:
+            return stream_output->send_get_stream_format_cmd(&target);
+        }
+    }
+    break;
+
+    case AEM_DESC_AVB_INTERFACE:
+    {
+        avb_interface_descriptor * avb_interface = configuration->get_avb_interface_desc_by_index(target.desc_index);
+        if (!avb_interface)
+            break;
+
+        switch (target.cmd_type)
+        {
+        case AEM_CMD_GET_AVB_INFO:
+            return avb_interface->send_get_avb_info_cmd(&target);
+        case AEM_CMD_GET_COUNTERS:
+            return avb_interface->send_get_counters_cmd(&target);
+        }
+    }
+    break;
+
+    case AEM_DESC_CLOCK_DOMAIN:
+    {
+        clock_domain_descriptor * clock_domain = configuration->get_clock_domain_desc_by_index(target.desc_index);
+        if (!clock_domain)
+            break;
+
+        switch (target.cmd_type)
+        {
+        case AEM_CMD_GET_CLOCK_SOURCE:
+            return clock_domain->send_get_clock_source_cmd(&target);
+        case AEM_CMD_GET_COUNTERS:
+            return clock_domain->send_get_counters_cmd(&target);
+        }
+    }
+    break;
+    }
+
+    return -1;
+}
+
+bool bulk_query::release(size_t index)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (index < m_target_count)
+    {
+        uint64_t entity_id = m_targets[index].entity_id;
+        entity_queue & queue = m_entities[entity_id];
+        bool is_ready = !queue.pending.empty() && (queue.inflight < m_per_entity_window);
+
+        queue.inflight--;
+        m_inflight--;
+        if (!is_ready && !queue.pending.empty())
+            m_ready.push_back(entity_id);
+    }
+
+    return --m_remaining == 0;
+}
+
+void bulk_query::finish()
+{
+    if (m_completion_callback)
+        m_completion_callback(m_user_obj, m_targets, m_target_count);
+
+    delete this;
+}
+}
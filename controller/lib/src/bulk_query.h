@@ -0,0 +1,125 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * bulk_query.h
+ *
+ * Bulk state query class, which fans a set of GET commands out across End Stations
+ * within a per End Station and a global window of inflight commands.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include "controller.h"
+#include "cmd_completion.h"
+
+namespace avdecc_lib
+{
+class controller_imp;
+
+class bulk_query : public cmd_completion_handler
+{
+public:
+    enum
+    {
+        MAX_GLOBAL_WINDOW = 512 // Keeps the commands queued to the lib thread well within the tx pipe
+    };
+
+    bulk_query(controller_imp * controller_obj,
+               bulk_query_target * targets, size_t target_count,
+               size_t per_entity_window, size_t global_window,
+               void (*completion_callback)(void *, bulk_query_target *, size_t),
+               void * user_obj);
+    ~bulk_query();
+
+    ///
+    /// Send the first window of commands. The object deletes itself after calling the
+    /// completion callback, which may happen before this function returns.
+    ///
+    void start();
+
+    void cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len);
+
+    ///
+    /// \return True if the command type and descriptor type of the target are supported.
+    ///
+    static bool is_supported(const bulk_query_target & target);
+
+    ///
+    /// Send the command for a target to the descriptor it names.
+    ///
+    /// \return 0 on success, -1 if the End Station or descriptor is not found.
+    ///
+    static int send_target(controller_imp * controller_obj, bulk_query_target & target);
+
+private:
+    struct entity_queue
+    {
+        std::deque<size_t> pending; // Indices of the targets not yet sent
+        size_t inflight;
+    };
+
+    typedef std::unordered_map<uint64_t, entity_queue> entity_queue_map;
+
+    controller_imp * m_controller;
+    bulk_query_target * m_targets;
+    size_t m_target_count;
+    size_t m_per_entity_window;
+    size_t m_global_window;
+    void (*m_completion_callback)(void *, bulk_query_target *, size_t);
+    void * m_user_obj;
+
+    std::mutex m_lock;
+    entity_queue_map m_entities;
+    std::deque<uint64_t> m_ready; // End Stations with pending targets and room in their window, in round robin order
+    size_t m_inflight;
+    size_t m_remaining; // Targets not yet completed, plus one while start() is running
+
+    ///
+    /// Take targets from the ready End Stations, in turn, while the global window allows.
+    ///
+    void select_targets(std::vector<size_t> & to_send);
+
+    ///
+    /// Send commands for the pending targets.
+    ///
+    /// \return True if the last target completed and the object was deleted.
+    ///
+    bool send_pending();
+
+    ///
+    /// Account for a completed target, or for the end of start() if index is m_target_count.
+    ///
+    /// \return True if all the targets have completed.
+    ///
+    bool release(size_t index);
+
+    void finish();
+};
+}
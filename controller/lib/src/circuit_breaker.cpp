@@ -0,0 +1,235 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * circuit_breaker.cpp
+ *
+ * Circuit breaker implementation
+ */
+
+#include "enumeration.h"
+#include "log_imp.h"
+#include "notification_imp.h"
+#include "end_station_imp.h"
+#include "controller_imp.h"
+#include "circuit_breaker.h"
+
+namespace avdecc_lib
+{
+circuit_breaker::circuit_breaker(controller_imp * controller_obj)
+    : m_controller(controller_obj), m_timeout_threshold(DEFAULT_TIMEOUT_THRESHOLD), m_probe_interval_ms(DEFAULT_PROBE_INTERVAL_MS)
+{
+}
+
+circuit_breaker::~circuit_breaker()
+{
+    for (entity_map::iterator i = m_entities.begin(); i != m_entities.end(); ++i)
+    {
+        if (i->second.is_probing)
+            cmd_completion_ref->unregister_id(&i->second);
+    }
+}
+
+void circuit_breaker::configure(uint32_t timeout_threshold, uint32_t probe_interval_ms)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_timeout_threshold = timeout_threshold;
+    m_probe_interval_ms = probe_interval_ms;
+}
+
+bool circuit_breaker::allow_cmd(uint64_t entity_id, void * notification_id)
+{
+    entity_map::iterator i = m_entities.find(entity_id);
+
+    if (i == m_entities.end() || !i->second.is_degraded)
+        return true;
+
+    return notification_id == &i->second; // Only the probe reaches a degraded End Station
+}
+
+void circuit_breaker::cmd_responded(uint64_t entity_id)
+{
+    entity_map::iterator i = m_entities.find(entity_id);
+
+    if (i == m_entities.end())
+        return;
+
+    if (i->second.is_degraded)
+    {
+        recover(i);
+    }
+    else
+    {
+        i->second.consecutive_timeouts = 0;
+        if (!i->second.is_probing)
+            m_entities.erase(i);
+    }
+}
+
+void circuit_breaker::cmd_timed_out(uint64_t entity_id)
+{
+    uint32_t timeout_threshold;
+    uint32_t probe_interval_ms;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        timeout_threshold = m_timeout_threshold;
+        probe_interval_ms = m_probe_interval_ms;
+    }
+
+    if (timeout_threshold == 0)
+        return;
+
+    entity_map::iterator i = m_entities.find(entity_id);
+    if (i == m_entities.end())
+    {
+        struct entity_state state;
+        state.entity_id = entity_id;
+        state.consecutive_timeouts = 0;
+        state.is_degraded = false;
+        state.is_probing = false;
+        i = m_entities.insert(entity_map::value_type(entity_id, state)).first;
+    }
+
+    struct entity_state & state = i->second;
+    state.consecutive_timeouts++;
+
+    if (!state.is_degraded && state.consecutive_timeouts >= timeout_threshold)
+    {
+        state.is_degraded = true;
+        state.probe_timer.start(probe_interval_ms);
+
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_WARNING,
+                                  "End Station 0x%llx degraded after %d consecutive command timeouts",
+                                  (unsigned long long)entity_id,
+                                  state.consecutive_timeouts);
+        notification_imp_ref->post_notification_msg(END_STATION_DEGRADED, entity_id, 0, 0, 0, 0, state.consecutive_timeouts, 0);
+    }
+}
+
+void circuit_breaker::entity_restarted(uint64_t entity_id)
+{
+    cmd_responded(entity_id);
+}
+
+void circuit_breaker::tick()
+{
+    uint32_t timeout_threshold;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        timeout_threshold = m_timeout_threshold;
+    }
+
+    entity_map::iterator i = m_entities.begin();
+    while (i != m_entities.end())
+    {
+        if (!i->second.is_degraded)
+        {
+            ++i;
+        }
+        else if (timeout_threshold == 0)
+        {
+            i = recover(i); // The circuit breaker was turned off
+        }
+        else
+        {
+            if (!i->second.is_probing && i->second.probe_timer.timeout())
+                send_probe(i->second);
+            ++i;
+        }
+    }
+}
+
+void circuit_breaker::cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len)
+{
+    struct entity_state * state = (struct entity_state *)notification_id;
+    uint32_t probe_interval_ms;
+
+    (void)status;
+    (void)frame_len;
+    cmd_completion_ref->unregister_id(notification_id);
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        probe_interval_ms = m_probe_interval_ms;
+    }
+
+    entity_map::iterator i = m_entities.find(state->entity_id);
+    i->second.is_probing = false;
+
+    if (i->second.is_degraded)
+    {
+        if (frame)
+            recover(i); // Any response to the probe shows the End Station is back
+        else
+            i->second.probe_timer.start(probe_interval_ms);
+    }
+    else if (i->second.consecutive_timeouts == 0)
+    {
+        m_entities.erase(i);
+    }
+}
+
+circuit_breaker::entity_map::iterator circuit_breaker::recover(entity_map::iterator i)
+{
+    uint64_t entity_id = i->second.entity_id;
+
+    i->second.is_degraded = false;
+    i->second.consecutive_timeouts = 0;
+    i->second.probe_timer.stop();
+
+    log_imp_ref->post_log_msg(LOGGING_LEVEL_NOTICE, "End Station 0x%llx recovered", (unsigned long long)entity_id);
+    notification_imp_ref->post_notification_msg(END_STATION_RECOVERED, entity_id, 0, 0, 0, 0, 0, 0);
+
+    if (i->second.is_probing)
+        return ++i; // Erased when the probe completes
+
+    m_entities.erase(i++);
+    return i;
+}
+
+void circuit_breaker::send_probe(struct entity_state & state)
+{
+    end_station_imp * end_station = m_controller->find_end_station_by_entity_id(state.entity_id);
+
+    if (!end_station)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        state.probe_timer.start(m_probe_interval_ms); // Probe again once the End Station is advertised
+        return;
+    }
+
+    cmd_completion_ref->register_id(&state, this);
+    state.is_probing = true;
+    if (end_station->send_entity_avail_cmd(&state) != 0)
+    {
+        // The End Station has been evicted, so probe again in case it is advertised again
+        cmd_completion_ref->unregister_id(&state);
+        std::lock_guard<std::mutex> guard(m_lock);
+        state.is_probing = false;
+        state.probe_timer.start(m_probe_interval_ms);
+    }
+}
+}
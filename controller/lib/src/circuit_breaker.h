@@ -0,0 +1,117 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * circuit_breaker.h
+ *
+ * Circuit breaker class, which counts the consecutive AECP command timeouts of each End Station
+ * and marks it degraded once they reach a threshold. Commands to a degraded End Station fail
+ * immediately with AVDECC_LIB_STATUS_ENTITY_DEGRADED instead of waiting for their timeouts.
+ *
+ * A degraded End Station is probed with ENTITY_AVAILABLE at an interval, and recovers when a
+ * probe or any other command is answered, or when its ADP advertisements show it has restarted.
+ * END_STATION_DEGRADED and END_STATION_RECOVERED notifications are sent as the state changes.
+ *
+ * All the methods but configure() are called on the lib thread.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <mutex>
+#include "cmd_completion.h"
+#include "timer.h"
+
+namespace avdecc_lib
+{
+class controller_imp;
+
+class circuit_breaker : public cmd_completion_handler
+{
+public:
+    enum
+    {
+        DEFAULT_TIMEOUT_THRESHOLD = 3,
+        DEFAULT_PROBE_INTERVAL_MS = 1000
+    };
+
+    circuit_breaker(controller_imp * controller_obj);
+    ~circuit_breaker();
+
+    ///
+    /// Set the number of consecutive timeouts that degrade an End Station, or 0 to never degrade
+    /// them, and the interval of the probes of a degraded End Station.
+    ///
+    void configure(uint32_t timeout_threshold, uint32_t probe_interval_ms);
+
+    ///
+    /// \return False if a command to the End Station should fail immediately.
+    ///
+    bool allow_cmd(uint64_t entity_id, void * notification_id);
+
+    ///
+    /// Record a response from the End Station, which recovers it if it is degraded.
+    ///
+    void cmd_responded(uint64_t entity_id);
+
+    ///
+    /// Record a command to the End Station that failed after its last resend timed out.
+    ///
+    void cmd_timed_out(uint64_t entity_id);
+
+    ///
+    /// Recover the End Station, as its ADP advertisements show it has restarted or reconnected.
+    ///
+    void entity_restarted(uint64_t entity_id);
+
+    ///
+    /// Called on the lib thread each timer tick to probe degraded End Stations.
+    ///
+    void tick();
+
+    void cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len);
+
+private:
+    struct entity_state
+    {
+        uint64_t entity_id;
+        uint32_t consecutive_timeouts;
+        bool is_degraded;
+        bool is_probing; // The probe command, sent with the address of this state as its notification id, is inflight
+        timer probe_timer;
+    };
+
+    typedef std::map<uint64_t, entity_state> entity_map; // Entries are only kept while an End Station times out
+
+    controller_imp * m_controller;
+    std::mutex m_lock; // Held by configure() and by the lib thread while reading the settings
+    uint32_t m_timeout_threshold;
+    uint32_t m_probe_interval_ms;
+    entity_map m_entities;
+
+    entity_map::iterator recover(entity_map::iterator i); // Returns the next entry
+    void send_probe(struct entity_state & state);
+};
+}
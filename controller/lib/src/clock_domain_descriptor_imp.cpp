@@ -47,6 +47,10 @@ clock_domain_descriptor_imp::~clock_domain_descriptor_imp() {}
 
 clock_domain_descriptor_response * STDCALL clock_domain_descriptor_imp::get_clock_domain_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new clock_domain_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                            resp_ref->get_desc_size(), resp_ref->get_desc_pos());
@@ -54,6 +58,10 @@ clock_domain_descriptor_response * STDCALL clock_domain_descriptor_imp::get_cloc
 
 clock_domain_counters_response * STDCALL clock_domain_descriptor_imp::get_clock_domain_counters_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_COUNTERS);
     if (!resp_frame)
@@ -65,6 +73,10 @@ clock_domain_counters_response * STDCALL clock_domain_descriptor_imp::get_clock_
 
 clock_domain_get_clock_source_response * STDCALL clock_domain_descriptor_imp::get_clock_domain_get_clock_source_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_CLOCK_SOURCE);
     if (!resp_frame)
@@ -76,6 +88,12 @@ clock_domain_get_clock_source_response * STDCALL clock_domain_descriptor_imp::ge
 
 int STDCALL clock_domain_descriptor_imp::send_set_clock_source_cmd(void * notification_id, uint16_t new_clk_src_index)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_set_clock_source aem_cmd_set_clk_src;
     ssize_t aem_cmd_set_clk_src_returned;
@@ -145,6 +163,8 @@ int clock_domain_descriptor_imp::proc_set_clock_source_resp(void *& notification
 
     if (status == AEM_STATUS_SUCCESS)
     {
+        store_cmd_resp_frame(AEM_CMD_GET_CLOCK_SOURCE, frame, ETHER_HDR_SIZE, frame_len); // Same layout as the GET_CLOCK_SOURCE response
+
         uint8_t * buffer = (uint8_t *)malloc(resp_ref->get_desc_size() * sizeof(uint8_t)); //fetch current desc frame
         memcpy(buffer, resp_ref->get_desc_buffer(), resp_ref->get_desc_size());
         jdksavdecc_descriptor_clock_domain_set_clock_source_index(aem_cmd_set_clk_src_resp.clock_source_index,
@@ -161,6 +181,12 @@ int clock_domain_descriptor_imp::proc_set_clock_source_resp(void *& notification
 
 int STDCALL clock_domain_descriptor_imp::send_get_clock_source_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_clock_source aem_cmd_get_clk_src;
     ssize_t aem_cmd_get_clk_src_returned;
@@ -236,6 +262,12 @@ int clock_domain_descriptor_imp::proc_get_clock_source_resp(void *& notification
 
 int STDCALL clock_domain_descriptor_imp::send_get_counters_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_counters aem_cmd_get_clock_domain_counters;
     memset(&aem_cmd_get_clock_domain_counters, 0, sizeof(aem_cmd_get_clock_domain_counters));
@@ -0,0 +1,124 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_completion.cpp
+ *
+ * Command completion routing implementation
+ */
+
+#include "cmd_completion.h"
+
+namespace avdecc_lib
+{
+cmd_completion * cmd_completion_ref = new cmd_completion();
+
+cmd_completion::cmd_completion() {}
+
+cmd_completion::~cmd_completion() {}
+
+void cmd_completion::register_id(void * notification_id, cmd_completion_handler * handler)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_handlers[notification_id] = handler;
+}
+
+bool cmd_completion::unregister_id(void * notification_id)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_handlers.erase(notification_id) != 0;
+}
+
+bool cmd_completion::is_registered(void * notification_id)
+{
+    if (!notification_id)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_handlers.find(notification_id) != m_handlers.end();
+}
+
+void cmd_completion::sent(void * notification_id)
+{
+    cmd_completion_handler * handler;
+
+    if (!notification_id)
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        std::unordered_map<void *, cmd_completion_handler *>::iterator it = m_handlers.find(notification_id);
+
+        if (it == m_handlers.end())
+            return;
+
+        handler = it->second;
+    }
+
+    handler->cmd_sent(notification_id);
+}
+
+bool cmd_completion::complete(void * notification_id, int status, const uint8_t * frame, size_t frame_len)
+{
+    cmd_completion_handler * handler;
+
+    if (!notification_id)
+        return false;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        std::unordered_map<void *, cmd_completion_handler *>::iterator it = m_handlers.find(notification_id);
+
+        if (it == m_handlers.end())
+            return false;
+
+        handler = it->second;
+        m_handlers.erase(it);
+    }
+
+    // Called without the lock held so that the handler can register further commands
+    handler->cmd_completed(notification_id, status, frame, frame_len);
+
+    return true;
+}
+
+void cmd_completion::progress(void * notification_id, const uint8_t * frame, size_t frame_len)
+{
+    cmd_completion_handler * handler;
+
+    if (!notification_id)
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        std::unordered_map<void *, cmd_completion_handler *>::iterator it = m_handlers.find(notification_id);
+
+        if (it == m_handlers.end())
+            return;
+
+        handler = it->second;
+    }
+
+    handler->cmd_progress(notification_id, frame, frame_len);
+}
+}
@@ -0,0 +1,128 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_completion.h
+ *
+ * Completion routing for commands issued by the library itself on behalf of a
+ * multi-command operation, such as a bulk query.
+ *
+ * An operation registers the notification id of each command it sends together with a
+ * cmd_completion_handler. Commands with a registered notification id are sent without
+ * application notifications, and when the response is received or the command times out
+ * the AEM and ACMP Controller State Machines call the handler on the lib thread instead.
+ * The same applies to the OPERATION_STATUS responses of an operation started by a registered
+ * START_OPERATION command, while the notification id stays registered.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <unordered_map>
+
+namespace avdecc_lib
+{
+class cmd_completion_handler
+{
+public:
+    virtual ~cmd_completion_handler() {}
+
+    ///
+    /// Called on the lib thread when a command sent with a notification id registered to this
+    /// handler completes.
+    ///
+    /// \param notification_id The notification id the command was sent with.
+    /// \param status The AEM or ACMP status of the response, or AVDECC_LIB_STATUS_TICK_TIMEOUT.
+    /// \param frame The response frame, or NULL on timeout.
+    /// \param frame_len The length of the response frame.
+    ///
+    virtual void cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len) = 0;
+
+    ///
+    /// Called on the sending thread when a command with a notification id registered to this
+    /// handler is queued, before it is sent.
+    ///
+    virtual void cmd_sent(void * notification_id)
+    {
+        (void)notification_id;
+    }
+
+    ///
+    /// Called on the lib thread when an OPERATION_STATUS response reports the progress of an
+    /// operation started with a notification id registered to this handler.
+    ///
+    virtual void cmd_progress(void * notification_id, const uint8_t * frame, size_t frame_len)
+    {
+        (void)notification_id;
+        (void)frame;
+        (void)frame_len;
+    }
+};
+
+class cmd_completion
+{
+public:
+    cmd_completion();
+    ~cmd_completion();
+
+    ///
+    /// Route the completion of commands sent with the notification id to the handler.
+    ///
+    void register_id(void * notification_id, cmd_completion_handler * handler);
+
+    ///
+    /// \return True if the notification id was routed to a handler, which will then not be called.
+    ///
+    bool unregister_id(void * notification_id);
+
+    ///
+    /// \return True if the notification id is routed to a handler.
+    ///
+    bool is_registered(void * notification_id);
+
+    ///
+    /// Tell the handler registered for the notification id, if any, that a command is queued with it.
+    ///
+    void sent(void * notification_id);
+
+    ///
+    /// Call the handler registered for the notification id, if any.
+    ///
+    /// \return True if a handler was called, in which case the application is not notified.
+    ///
+    bool complete(void * notification_id, int status, const uint8_t * frame, size_t frame_len);
+
+    ///
+    /// Report the progress of an operation to the handler registered for the notification id, if any.
+    ///
+    void progress(void * notification_id, const uint8_t * frame, size_t frame_len);
+
+private:
+    std::mutex m_lock;
+    std::unordered_map<void *, cmd_completion_handler *> m_handlers;
+};
+
+extern cmd_completion * cmd_completion_ref;
+}
@@ -0,0 +1,112 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_dispatcher.cpp
+ *
+ * Command future callback dispatcher implementation
+ */
+
+#include "cmd_dispatcher.h"
+
+namespace avdecc_lib
+{
+cmd_dispatcher::cmd_dispatcher()
+    : m_is_running(false), m_executor(NULL)
+{
+}
+
+cmd_dispatcher::~cmd_dispatcher()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (!m_is_running)
+            return;
+
+        m_is_running = false;
+    }
+
+    m_cv.notify_one();
+    m_thread.join();
+}
+
+void cmd_dispatcher::set_executor(cmd_executor * executor)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_executor = executor;
+}
+
+void cmd_dispatcher::dispatch(void (*fn)(void *), void * arg)
+{
+    cmd_executor * executor;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        executor = m_executor ? m_executor : this;
+    }
+
+    executor->execute(fn, arg);
+}
+
+void STDCALL cmd_dispatcher::execute(void (*fn)(void *), void * arg)
+{
+    dispatch_entry entry;
+    entry.fn = fn;
+    entry.arg = arg;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_pending.push_back(entry);
+
+        if (!m_is_running)
+        {
+            m_is_running = true;
+            m_thread = std::thread(&cmd_dispatcher::dispatcher_thread, this);
+        }
+    }
+
+    m_cv.notify_one();
+}
+
+void cmd_dispatcher::dispatcher_thread()
+{
+    while (true)
+    {
+        dispatch_entry entry;
+
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            while (m_is_running && m_pending.empty())
+                m_cv.wait(lock);
+
+            if (m_pending.empty())
+                return; // Stopped with nothing left to run
+
+            entry = m_pending.front();
+            m_pending.pop_front();
+        }
+
+        entry.fn(entry.arg);
+    }
+}
+}
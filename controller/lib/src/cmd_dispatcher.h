@@ -0,0 +1,79 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_dispatcher.h
+ *
+ * Dispatches the callbacks of completed command futures to the command executor set by the
+ * application, or to a dispatcher thread started on first use, so that they never run on the
+ * lib thread. Each controller has its own dispatcher, reached through cmd_dispatcher_ref.
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "cmd_future.h"
+
+namespace avdecc_lib
+{
+class cmd_dispatcher : public cmd_executor
+{
+public:
+    cmd_dispatcher();
+    ~cmd_dispatcher();
+
+    ///
+    /// Set the executor to dispatch to, or NULL for the dispatcher thread.
+    ///
+    void set_executor(cmd_executor * executor);
+
+    ///
+    /// Run fn(arg) on the executor set.
+    ///
+    void dispatch(void (*fn)(void *), void * arg);
+
+    ///
+    /// Run fn(arg) on the dispatcher thread.
+    ///
+    void STDCALL execute(void (*fn)(void *), void * arg);
+
+private:
+    struct dispatch_entry
+    {
+        void (*fn)(void *);
+        void * arg;
+    };
+
+    std::mutex m_lock; // Protects all the members but m_thread
+    std::condition_variable m_cv;
+    std::deque<dispatch_entry> m_pending;
+    std::thread m_thread;
+    bool m_is_running;
+    cmd_executor * m_executor;
+
+    void dispatcher_thread();
+};
+}
@@ -0,0 +1,229 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_future_imp.cpp
+ *
+ * Command future implementation
+ */
+
+#include <string.h>
+#include <chrono>
+#include "jdksavdecc_aem_command.h"
+#include "jdksavdecc_acmp.h"
+#include "enumeration.h"
+#include "cmd_dispatcher.h"
+#include "cmd_future_imp.h"
+
+namespace avdecc_lib
+{
+cmd_future_imp::cmd_future_imp(cmd_future_callback callback, void * context)
+    : m_ref_cnt(2), m_is_sent(false), m_is_ready(false), m_status(AVDECC_LIB_STATUS_INVALID), m_callback(callback), m_context(context),
+      m_controller_context(current_context())
+{
+    cmd_completion_ref->register_id(this, this); // Released by cmd_completed() or destroy()
+}
+
+cmd_future_imp::~cmd_future_imp() {}
+
+void * STDCALL cmd_future_imp::notification_id()
+{
+    return this;
+}
+
+bool STDCALL cmd_future_imp::is_ready()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_is_ready;
+}
+
+int STDCALL cmd_future_imp::wait()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    while (!m_is_ready)
+        m_ready_cv.wait(lock);
+
+    return m_status;
+}
+
+bool STDCALL cmd_future_imp::wait_for(uint32_t timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    while (!m_is_ready)
+    {
+        if (m_ready_cv.wait_until(lock, deadline) == std::cv_status::timeout)
+            break;
+    }
+
+    return m_is_ready;
+}
+
+int STDCALL cmd_future_imp::status()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_is_ready ? m_status : AVDECC_LIB_STATUS_INVALID;
+}
+
+int STDCALL cmd_future_imp::get_response(cmd_response & response)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (!m_is_ready)
+        return -1;
+
+    memset(&response, 0, sizeof(response));
+    response.status = m_status;
+    if (m_frame.empty())
+        return 0;
+
+    const uint8_t * frame = &m_frame[0];
+    response.subtype = jdksavdecc_common_control_header_get_subtype(frame, ETHER_HDR_SIZE);
+    response.msg_type = jdksavdecc_common_control_header_get_control_data(frame, ETHER_HDR_SIZE);
+    response.frame = frame;
+    response.frame_len = m_frame.size();
+
+    if (response.subtype == JDKSAVDECC_SUBTYPE_AECP)
+    {
+        struct jdksavdecc_eui64 id = jdksavdecc_common_control_header_get_stream_id(frame, ETHER_HDR_SIZE);
+        response.entity_id = jdksavdecc_uint64_get(&id, 0);
+
+        if (response.msg_type == JDKSAVDECC_AECP_MESSAGE_TYPE_AEM_RESPONSE)
+        {
+            response.cmd_type = jdksavdecc_aecpdu_aem_get_command_type(frame, ETHER_HDR_SIZE) & 0x7FFF;
+            response.desc_type = jdksavdecc_aem_command_read_descriptor_get_descriptor_type(frame, ETHER_HDR_SIZE);
+            response.desc_index = jdksavdecc_aem_command_read_descriptor_get_descriptor_index(frame, ETHER_HDR_SIZE);
+        }
+    }
+    else if (response.subtype == JDKSAVDECC_SUBTYPE_ACMP)
+    {
+        struct jdksavdecc_eui64 talker_id = jdksavdecc_acmpdu_get_talker_entity_id(frame, ETHER_HDR_SIZE);
+        struct jdksavdecc_eui64 listener_id = jdksavdecc_acmpdu_get_listener_entity_id(frame, ETHER_HDR_SIZE);
+        response.entity_id = jdksavdecc_uint64_get(&talker_id, 0);
+        response.listener_entity_id = jdksavdecc_uint64_get(&listener_id, 0);
+    }
+
+    return 0;
+}
+
+int STDCALL cmd_future_imp::cancel()
+{
+    bool is_callback_dispatched;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (m_is_ready)
+            return -1;
+
+        // The registration is kept so that the response or timeout of the command is dropped quietly
+        is_callback_dispatched = resolve(AVDECC_LIB_STATUS_CANCELLED, NULL, 0);
+    }
+
+    if (is_callback_dispatched)
+        m_controller_context->dispatcher_obj->dispatch(&cmd_future_imp::run_callback, this);
+
+    return 0;
+}
+
+void STDCALL cmd_future_imp::destroy()
+{
+    bool is_sent;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        is_sent = m_is_sent;
+        if (!m_is_ready)
+            m_callback = NULL; // The application no longer expects the future to complete
+    }
+
+    // The registration of a command in flight is kept, like on cancel(), and released by cmd_completed()
+    if (!is_sent && cmd_completion_ref->unregister_id(this))
+        release();
+
+    release();
+}
+
+void cmd_future_imp::cmd_sent(void * notification_id)
+{
+    (void)notification_id;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_is_sent = true;
+}
+
+void cmd_future_imp::cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len)
+{
+    bool is_callback_dispatched = false;
+
+    (void)notification_id;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (!m_is_ready)
+            is_callback_dispatched = resolve(status, frame, frame_len);
+    }
+
+    if (is_callback_dispatched)
+        m_controller_context->dispatcher_obj->dispatch(&cmd_future_imp::run_callback, this);
+
+    release();
+}
+
+bool cmd_future_imp::resolve(int status, const uint8_t * frame, size_t frame_len)
+{
+    m_is_ready = true;
+    m_status = status;
+    if (frame)
+        m_frame.assign(frame, frame + frame_len);
+    m_ready_cv.notify_all();
+
+    if (!m_callback)
+        return false;
+
+    m_ref_cnt++; // Released once the callback has run
+    return true;
+}
+
+void cmd_future_imp::release()
+{
+    bool is_unreferenced;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        is_unreferenced = (--m_ref_cnt == 0);
+    }
+
+    if (is_unreferenced)
+        delete this;
+}
+
+void cmd_future_imp::run_callback(void * arg)
+{
+    cmd_future_imp * future = (cmd_future_imp *)arg;
+
+    future->m_callback(future->m_context, future);
+    future->release();
+}
+}
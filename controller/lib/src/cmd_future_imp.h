@@ -0,0 +1,91 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_future_imp.h
+ *
+ * Command future implementation class
+ *
+ * A future is registered with cmd_completion under its own address as notification id, and
+ * is completed on the lib thread by the response or timeout of the command sent with it.
+ * It is reference counted by the application, the registration and a pending callback, so
+ * the application can destroy it at any time. A future destroyed while its command is in flight
+ * stays registered until the response or timeout arrives, so that neither reaches the
+ * application nor a later future allocated at the same address.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "cmd_future.h"
+#include "cmd_completion.h"
+#include "controller_context.h"
+
+namespace avdecc_lib
+{
+class cmd_future_imp : public virtual cmd_future, public cmd_completion_handler
+{
+public:
+    cmd_future_imp(cmd_future_callback callback, void * context);
+
+    void * STDCALL notification_id();
+    bool STDCALL is_ready();
+    int STDCALL wait();
+    bool STDCALL wait_for(uint32_t timeout_ms);
+    int STDCALL status();
+    int STDCALL get_response(cmd_response & response);
+    int STDCALL cancel();
+    void STDCALL destroy();
+
+    void cmd_sent(void * notification_id);
+    void cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len);
+
+private:
+    std::mutex m_lock; // Protects all the members, and the callback until the future is ready
+    std::condition_variable m_ready_cv;
+    uint32_t m_ref_cnt;
+    bool m_is_sent; // A command was queued with the notification id
+    bool m_is_ready;
+    int m_status;
+    std::vector<uint8_t> m_frame;
+    cmd_future_callback m_callback;
+    void * m_context;
+    controller_context * m_controller_context; // The callback is dispatched by the controller that created the future
+
+    ~cmd_future_imp();
+
+    ///
+    /// Make the future ready, with m_lock held.
+    ///
+    /// \return True if the callback is to be dispatched.
+    ///
+    bool resolve(int status, const uint8_t * frame, size_t frame_len);
+
+    void release();
+    static void run_callback(void * arg);
+};
+}
@@ -0,0 +1,222 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_trace.cpp
+ *
+ * Command lifecycle tracing implementation
+ */
+
+#include <inttypes.h>
+#include "cmd_trace.h"
+
+namespace avdecc_lib
+{
+cmd_trace::cmd_trace()
+    : m_enabled(false), m_missed_event_cnt(0), m_poster_cnt(0), m_ring(NULL), m_head(0), m_tail(0), m_running(false), m_file(NULL), m_first_event(true)
+{
+}
+
+cmd_trace::~cmd_trace()
+{
+    stop();
+    wait_for_posters();
+    delete[] m_ring;
+}
+
+int cmd_trace::start(const char * file_path)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_running || !file_path)
+        return -1;
+
+    m_file = fopen(file_path, "w");
+    if (!m_file)
+        return -1;
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", m_file);
+    m_first_event = true;
+    m_missed_event_cnt.store(0);
+    if (!m_ring)
+    {
+        m_ring = new ring_slot[TRACE_BUF_COUNT];
+        for (uint64_t i = 0; i < TRACE_BUF_COUNT; i++)
+            m_ring[i].seq.store(i, std::memory_order_relaxed);
+    }
+    m_epoch = std::chrono::steady_clock::now();
+    m_running = true;
+    m_writer = std::thread(&cmd_trace::writer_thread, this);
+    m_enabled.store(true, std::memory_order_release);
+
+    return 0;
+}
+
+void cmd_trace::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (!m_running)
+            return;
+
+        m_enabled.store(false);
+
+        // The writer thread drains the ring once more after this, so no slot may be written later
+        wait_for_posters();
+        m_running = false;
+    }
+
+    m_cv.notify_one();
+    m_writer.join();
+
+    fputs("\n]}\n", m_file);
+    fclose(m_file);
+    m_file = NULL;
+}
+
+void cmd_trace::wait_for_posters()
+{
+    while (m_poster_cnt.load() != 0)
+        std::this_thread::yield();
+}
+
+uint32_t cmd_trace::current_tid()
+{
+    static std::atomic<uint32_t> next_tid(1);
+    static thread_local uint32_t tid = 0;
+
+    if (tid == 0)
+        tid = next_tid.fetch_add(1);
+
+    return tid;
+}
+
+void cmd_trace::record(char ph, const char * cat, const char * name, uint64_t id, uint64_t entity_id, int64_t value)
+{
+    // Counted before tracing is checked again, so that stop() either sees the poster or the
+    // poster sees tracing disabled
+    m_poster_cnt.fetch_add(1);
+    if (m_enabled.load())
+        claim_and_write(ph, cat, name, id, entity_id, value);
+    m_poster_cnt.fetch_sub(1);
+}
+
+void cmd_trace::claim_and_write(char ph, const char * cat, const char * name, uint64_t id, uint64_t entity_id, int64_t value)
+{
+    uint64_t pos = m_head.load(std::memory_order_relaxed);
+    ring_slot * slot;
+
+    // Claim a free slot, as a bounded multi-producer queue.
+    for (;;)
+    {
+        slot = &m_ring[pos & (TRACE_BUF_COUNT - 1)];
+        int64_t dif = (int64_t)(slot->seq.load(std::memory_order_acquire) - pos);
+
+        if (dif == 0)
+        {
+            if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (dif < 0)
+        {
+            // The writer thread has not freed the slot yet
+            m_missed_event_cnt++;
+            return;
+        }
+        else
+        {
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    trace_event & e = slot->event;
+    e.ph = ph;
+    e.cat = cat;
+    e.name = name;
+    e.id = id;
+    e.entity_id = entity_id;
+    e.value = value;
+    e.ts_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+    e.tid = current_tid();
+
+    slot->seq.store(pos + 1, std::memory_order_release);
+}
+
+void cmd_trace::writer_thread()
+{
+    bool running = true;
+
+    while (running)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_cv.wait_for(lock, std::chrono::milliseconds(TRACE_FLUSH_INTERVAL_MS));
+            running = m_running;
+        }
+
+        write_pending_events();
+    }
+
+    fflush(m_file);
+}
+
+void cmd_trace::write_pending_events()
+{
+    for (;;)
+    {
+        ring_slot & slot = m_ring[m_tail & (TRACE_BUF_COUNT - 1)];
+
+        // Stop at the first slot that is claimed but not yet written, or not claimed
+        if (slot.seq.load(std::memory_order_acquire) != m_tail + 1)
+            break;
+
+        write_event(slot.event);
+        slot.seq.store(m_tail + TRACE_BUF_COUNT, std::memory_order_release);
+        m_tail++;
+    }
+}
+
+void cmd_trace::write_event(const trace_event & e)
+{
+    fprintf(m_file,
+            "%s{\"ph\":\"%c\",\"cat\":\"%s\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%" PRIu64,
+            m_first_event ? "" : ",\n",
+            e.ph,
+            e.cat,
+            e.name,
+            e.tid,
+            e.ts_us);
+
+    if (e.ph == TRACE_INSTANT)
+        fputs(",\"s\":\"t\"", m_file);
+    else
+        fprintf(m_file, ",\"id\":\"0x%" PRIx64 "\"", e.id);
+
+    fprintf(m_file,
+            ",\"args\":{\"entity_id\":\"0x%016" PRIx64 "\",\"value\":%" PRId64 "}}",
+            e.entity_id,
+            e.value);
+
+    m_first_event = false;
+}
+}
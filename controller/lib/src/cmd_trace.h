@@ -0,0 +1,174 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * cmd_trace.h
+ *
+ * Command lifecycle tracing in the Chrome trace event format.
+ *
+ * When enabled, AVDECC LIB modules post lightweight trace events at each stage of a
+ * command's lifecycle (enqueue, transmit, retry, response, timeout, notification
+ * dispatch and wake-up of a waiting application thread) and for the enumeration of
+ * each End Station. Events are copied into a lock-free ring by the posting thread and written
+ * out as JSON by a background writer thread, so that posting never waits for a lock or file I/O.
+ *
+ * The resulting file can be loaded into chrome://tracing or https://ui.perfetto.dev.
+ * Commands are traced as async events so that a single command can be followed across
+ * the app, lib and notification threads:
+ *
+ *   category "tx_queue"     - id is the tx queue sequence, time spent in the tx pipe
+ *   category "aecp"/"acmp"  - id is the sequence id, time from transmit to response or timeout
+ *   category "wait"         - id is the notification id, time an app thread blocked on a command
+ *   category "notification" - id is the notification slot, time from post to callback return
+ *   category "enumeration"  - id is the End Station entity id, time to read all descriptors
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+
+#include "controller_context.h"
+
+namespace avdecc_lib
+{
+class cmd_trace
+{
+public:
+    enum trace_phase
+    {
+        TRACE_ASYNC_BEGIN = 'b',
+        TRACE_ASYNC_INSTANT = 'n',
+        TRACE_ASYNC_END = 'e',
+        TRACE_INSTANT = 'i'
+    };
+
+    cmd_trace();
+    ~cmd_trace();
+
+    ///
+    /// Open the trace file and start the writer thread.
+    ///
+    /// \return 0 on success, -1 if tracing is already enabled or the file cannot be opened.
+    ///
+    int start(const char * file_path);
+
+    ///
+    /// Flush all pending events, terminate the JSON document and close the trace file.
+    ///
+    void stop();
+
+    ///
+    /// \return True if trace events are currently being recorded.
+    ///
+    bool enabled() const
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    ///
+    /// Record a trace event. The name and category must point to static strings.
+    ///
+    /// \param ph The trace_phase of the event.
+    /// \param cat The category, which together with id groups async events.
+    /// \param name The name of the event.
+    /// \param id The async event id.
+    /// \param entity_id The entity id the event relates to, written as an argument.
+    /// \param value An event specific value (status, descriptor index, ...), written as an argument.
+    ///
+    void post_trace_event(char ph, const char * cat, const char * name, uint64_t id, uint64_t entity_id = 0, int64_t value = 0)
+    {
+        if (m_enabled.load(std::memory_order_acquire))
+            record(ph, cat, name, id, entity_id, value);
+    }
+
+    ///
+    /// \return The number of events dropped because the writer thread could not keep up.
+    ///
+    uint32_t missed_trace_event_count() const
+    {
+        return m_missed_event_cnt.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct trace_event
+    {
+        char ph;
+        const char * cat;
+        const char * name;
+        uint64_t id;
+        uint64_t entity_id;
+        int64_t value;
+        uint64_t ts_us;
+        uint32_t tid;
+    };
+
+    ///
+    /// A slot of the ring. The sequence is the ring position the slot can be written at, and one
+    /// more than that once the event is written, until the writer thread frees the slot.
+    ///
+    struct ring_slot
+    {
+        std::atomic<uint64_t> seq;
+        trace_event event;
+    };
+
+    enum
+    {
+        TRACE_BUF_COUNT = 16384, // A power of two
+        TRACE_FLUSH_INTERVAL_MS = 100
+    };
+
+    std::atomic<bool> m_enabled;
+    std::atomic<uint32_t> m_missed_event_cnt;
+    std::atomic<uint32_t> m_poster_cnt; // The posting threads claiming or writing a slot
+    std::mutex m_lock; // Protects m_running, never held by the posting threads
+    std::condition_variable m_cv;
+    ring_slot * m_ring; // Allocated when tracing is first started
+    std::atomic<uint64_t> m_head; // The next ring position to write
+    uint64_t m_tail;              // The next ring position to read, only used by the writer thread
+    std::thread m_writer;
+    bool m_running;
+    FILE * m_file;
+    bool m_first_event;
+    std::chrono::steady_clock::time_point m_epoch;
+
+    void record(char ph, const char * cat, const char * name, uint64_t id, uint64_t entity_id, int64_t value);
+    void claim_and_write(char ph, const char * cat, const char * name, uint64_t id, uint64_t entity_id, int64_t value);
+
+    ///
+    /// Wait for the posting threads that saw tracing enabled to finish writing their slot.
+    ///
+    void wait_for_posters();
+    void writer_thread();
+    void write_pending_events();
+    void write_event(const trace_event & e);
+    static uint32_t current_tid();
+};
+
+}
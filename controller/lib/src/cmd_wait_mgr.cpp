@@ -1,7 +1,7 @@
 /*
  * Licensed under the MIT License (MIT)
  *
- * Copyright (c) 2014 AudioScience Inc.
+ * Copyright (c) 2013 AudioScience Inc.
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy of
  * this software and associated documentation files (the "Software"), to deal in
@@ -24,7 +24,7 @@
 /**
  * cmd_wait_mgr.cpp
  *
- * Notification base class implementation, which is called by AVDECC LIB modules to generate notification messages.
+ * Command wait manager implementation, which blocks app threads until the commands they wait for complete.
  */
 
 #include "cmd_wait_mgr.h"
@@ -32,77 +32,100 @@
 namespace avdecc_lib
 {
 
-cmd_wait_mgr::cmd_wait_mgr()
-{
-    state = wait_idle;
-}
+cmd_wait_mgr::cmd_wait_mgr() {}
 
 cmd_wait_mgr::~cmd_wait_mgr() {}
 
-int cmd_wait_mgr::set_primed_state(void * id)
+cmd_wait_mgr::wait_token & cmd_wait_mgr::token_for_this_thread()
 {
-    if (state != wait_idle)
-        return -1;
-    else
-    {
-        notify_id = id;
-        state = wait_primed;
-        return 0;
-    }
+    // A thread waits for one command at a time, whichever system it sends it to
+    static thread_local wait_token token;
+
+    return token;
 }
-int cmd_wait_mgr::set_active_state(void)
+
+int cmd_wait_mgr::set_primed_state(void * id)
 {
-    if (state != wait_primed)
+    wait_token & token = token_for_this_thread();
+    std::lock_guard<std::mutex> guard(token.lock);
+
+    if (token.state == wait_active || token.state == wait_complete)
         return -1;
-    else
-    {
-        state = wait_active;
-        return 0;
-    }
+
+    token.notify_id = id;
+    token.state = wait_primed;
+    return 0;
 }
-int cmd_wait_mgr::set_idle_state(void)
+
+bool cmd_wait_mgr::set_active_state(void * id)
 {
-    if (state != wait_active)
-        return -1;
-    else
+    wait_token & token = token_for_this_thread();
+    std::lock_guard<std::mutex> token_guard(token.lock);
+
+    if (token.state != wait_primed || token.notify_id != id)
+        return false;
+
     {
-        state = wait_idle;
-        return 0;
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        if (!m_active_tokens.insert(std::make_pair(id, &token)).second)
+        {
+            token.state = wait_idle; // Another thread waits for the notification id
+            return false;
+        }
     }
-}
 
-bool cmd_wait_mgr::match_id(void * id)
-{
-    return id == notify_id;
+    token.state = wait_active;
+    return true;
 }
 
-void * cmd_wait_mgr::get_notify_id(void)
+int cmd_wait_mgr::wait_for_completion(void)
 {
-    return notify_id;
+    wait_token & token = token_for_this_thread();
+    std::unique_lock<std::mutex> lock(token.lock);
+
+    while (token.state == wait_active)
+        token.complete_cv.wait(lock);
+
+    token.state = wait_idle;
+    return token.completion_status;
 }
 
-bool cmd_wait_mgr::active_state(void)
+int cmd_wait_mgr::get_completion_status(void)
 {
-    return state == wait_active;
+    wait_token & token = token_for_this_thread();
+    std::lock_guard<std::mutex> guard(token.lock);
+
+    return token.completion_status;
 }
 
-bool cmd_wait_mgr::primed_state(void)
+bool cmd_wait_mgr::active_state(void * id)
 {
-    return state == wait_primed;
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    return m_active_tokens.find(id) != m_active_tokens.end();
 }
 
-int cmd_wait_mgr::set_completion_status(int status)
+bool cmd_wait_mgr::set_completion_status(void * id, int status)
 {
-    if (state != wait_active)
-        return -1;
-    else
+    wait_token * token;
+
     {
-        completion_status = status;
-        return 0;
+        std::lock_guard<std::mutex> guard(m_lock);
+        std::unordered_map<void *, wait_token *>::iterator i = m_active_tokens.find(id);
+
+        if (i == m_active_tokens.end())
+            return false;
+
+        token = i->second;
+        m_active_tokens.erase(i);
     }
-}
-int cmd_wait_mgr::get_completion_status(void)
-{
-    return completion_status;
+
+    // The waiting thread, and so its token, stays until the token is complete
+    std::lock_guard<std::mutex> guard(token->lock);
+    token->completion_status = status;
+    token->state = wait_complete;
+    token->complete_cv.notify_one();
+    return true;
 }
 }
@@ -1,7 +1,7 @@
 /*
  * Licensed under the MIT License (MIT)
  *
- * Copyright (c) 2014 AudioScience Inc.
+ * Copyright (c) 2013 AudioScience Inc.
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy of
  * this software and associated documentation files (the "Software"), to deal in
@@ -27,24 +27,30 @@
  * A helper class for managing commands that are sent from an application that
  * wait for the commands to complete.
  *
- * There are 2 threads that operate on this class. The avdecc-lib "lib" thread
+ * There are 2 kinds of threads that operate on this class. The avdecc-lib "lib" thread
  * that is responsible for all 1722.1 operations happening in a single context and
- * the "app" thread that is responsible for issuing commands to the 1722.1 lib
+ * any number of "app" threads that are responsible for issuing commands to the 1722.1 lib
  * thread and potentially waiting for the completion of those commands.
- * This class clarifies the "contract" between the two threads.
+ * This class clarifies the "contract" between the threads.
  *
- * An internal state is maintained that is written to by the app thread and read
- * by the lib thread.
+ * Each app thread primes a wait with set_wait_for_next_cmd() and then sends the command,
+ * which blocks the thread on its own wait token until the lib thread completes the token
+ * that is active for the notification id of the command. Any number of app threads can wait
+ * at the same time, as long as the commands they wait for have different notification ids.
+ *
+ * The wait token is thread local, with its own lock, so it goes away with its thread and
+ * waiting threads only share the lock of the table of active tokens.
  *
- * The only communication from the lib thread to the main thread occurs when
- * a semaphore is posted to release the waiting operation in the app thread.
  * Either a successful command completion or a timeout can cause the lib
- * thread to post to the waiting semaphore in the app thread.
+ * thread to release the waiting app thread.
  */
 
 #pragma once
 
 #include <stdint.h>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
 #include "avdecc-lib_build.h"
 
 namespace avdecc_lib
@@ -55,16 +61,45 @@ public:
     cmd_wait_mgr();
     virtual ~cmd_wait_mgr();
 
+    ///
+    /// Called on an app thread to wait for the next command it sends with the notification id.
+    ///
+    /// \return 0 on success, -1 if the calling thread is already waiting.
+    ///
     int set_primed_state(void * id);
-    int set_active_state(void);
-    int set_idle_state(void);
 
-    bool match_id(void * id);
-    bool active_state(void);
-    bool primed_state(void);
-    int set_completion_status(int status);
+    ///
+    /// Called on an app thread before the command is queued, so that the lib thread can complete
+    /// the wait as soon as it takes the command.
+    ///
+    /// \return True if the calling thread primed a wait for the notification id and now waits for it,
+    ///         false if it did not, or if another thread already waits for the same notification id.
+    ///
+    bool set_active_state(void * id);
+
+    ///
+    /// Called on an app thread to block until the wait made active by set_active_state() completes.
+    ///
+    /// \return The completion status of the command.
+    ///
+    int wait_for_completion(void);
+
+    ///
+    /// Called on an app thread for the completion status of the last command it waited for.
+    ///
     int get_completion_status(void);
-    void * get_notify_id(void);
+
+    ///
+    /// Called on the lib thread to check whether an app thread waits for the notification id.
+    ///
+    bool active_state(void * id);
+
+    ///
+    /// Called on the lib thread to release the app thread waiting for the notification id.
+    ///
+    /// \return True if an app thread was waiting for the notification id.
+    ///
+    bool set_completion_status(void * id, int status);
 
 private:
     ///
@@ -72,13 +107,26 @@ private:
     ///
     enum wait_states
     {
-        wait_idle,   /// idle state
-        wait_primed, /// primed means a call to set_wait_for_next_cmd() has been made
-        wait_active  /// active means a command matching the "primed" notify ID has been sent
+        wait_idle,    /// idle state
+        wait_primed,  /// primed means a call to set_wait_for_next_cmd() has been made
+        wait_active,  /// active means a command matching the "primed" notify ID has been sent
+        wait_complete /// complete means the lib thread has set the completion status
+    };
+
+    struct wait_token
+    {
+        std::mutex lock; // Held while changing the state and completion status
+        void * notify_id;
+        int completion_status;
+        enum wait_states state;
+        std::condition_variable complete_cv;
+
+        wait_token() : notify_id(NULL), completion_status(0), state(wait_idle) {}
     };
 
-    void * notify_id;
-    int completion_status;
-    enum wait_states state;
+    std::mutex m_lock;                                        // Held while changing the active tokens
+    std::unordered_map<void *, wait_token *> m_active_tokens; // The active wait tokens by notification id
+
+    static wait_token & token_for_this_thread();
 };
 }
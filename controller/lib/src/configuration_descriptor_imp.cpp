@@ -67,6 +67,18 @@ configuration_descriptor_imp::~configuration_descriptor_imp()
     m_all_desc.clear();
 }
 
+void configuration_descriptor_imp::release_frames()
+{
+    descriptor_base_imp::release_frames();
+
+    std::map<uint16_t, DITEM>::iterator it;
+    for (it = m_all_desc.begin(); it != m_all_desc.end(); ++it)
+    {
+        for (size_t i = 0; i < it->second.size(); i++)
+            it->second[i]->release_frames();
+    }
+}
+
 size_t configuration_descriptor_imp::desc_count(uint16_t desc_type)
 {
     if (m_all_desc.find(desc_type) == m_all_desc.end())
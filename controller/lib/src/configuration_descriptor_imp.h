@@ -70,6 +70,8 @@ public:
     configuration_descriptor_imp(end_station_imp * end_station_obj, const uint8_t * frame, ssize_t pos, size_t frame_len);
     virtual ~configuration_descriptor_imp();
 
+    void release_frames();
+
     uint16_t STDCALL descriptor_type() const;
     uint16_t STDCALL descriptor_index() const;
     uint8_t * STDCALL object_name();
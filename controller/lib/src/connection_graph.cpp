@@ -0,0 +1,242 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * connection_graph.cpp
+ *
+ * Connection graph implementation
+ */
+
+#include <inttypes.h>
+#include "jdksavdecc_acmp.h"
+#include "enumeration.h"
+#include "notification_acmp_imp.h"
+#include "log_imp.h"
+#include "connection_graph.h"
+
+namespace avdecc_lib
+{
+connection_graph::connection_graph() {}
+
+connection_graph::~connection_graph() {}
+
+void connection_graph::update_from_acmp_resp(const uint8_t * frame, size_t frame_len)
+{
+    if (frame_len < ACMP_FRAME_LEN)
+        return;
+
+    uint16_t msg_type = (uint16_t)jdksavdecc_common_control_header_get_control_data(frame, ETHER_HDR_SIZE);
+    uint32_t status = jdksavdecc_common_control_header_get_status(frame, ETHER_HDR_SIZE);
+
+    if (status != ACMP_STATUS_SUCCESS)
+        return;
+
+    struct jdksavdecc_eui64 talker_entity_id = jdksavdecc_acmpdu_get_talker_entity_id(frame, ETHER_HDR_SIZE);
+    struct jdksavdecc_eui64 listener_entity_id = jdksavdecc_acmpdu_get_listener_entity_id(frame, ETHER_HDR_SIZE);
+    stream_key talker(jdksavdecc_uint64_get(&talker_entity_id, 0), jdksavdecc_acmpdu_get_talker_unique_id(frame, ETHER_HDR_SIZE));
+    stream_key listener(jdksavdecc_uint64_get(&listener_entity_id, 0), jdksavdecc_acmpdu_get_listener_unique_id(frame, ETHER_HDR_SIZE));
+    uint16_t connection_count = jdksavdecc_acmpdu_get_connection_count(frame, ETHER_HDR_SIZE);
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    switch (msg_type)
+    {
+    case JDKSAVDECC_ACMP_MESSAGE_TYPE_CONNECT_RX_RESPONSE:
+        connect(talker, listener, msg_type);
+        break;
+
+    case JDKSAVDECC_ACMP_MESSAGE_TYPE_DISCONNECT_RX_RESPONSE:
+        disconnect(listener, msg_type);
+        break;
+
+    case JDKSAVDECC_ACMP_MESSAGE_TYPE_GET_RX_STATE_RESPONSE:
+        if (connection_count && talker.entity_id)
+            connect(talker, listener, msg_type);
+        else
+            disconnect(listener, msg_type);
+        break;
+
+    case JDKSAVDECC_ACMP_MESSAGE_TYPE_GET_TX_STATE_RESPONSE:
+        // Only the count is reported; a talker with no connections has no listeners.
+        if (!connection_count)
+            disconnect_talker(talker, msg_type);
+        break;
+
+    case JDKSAVDECC_ACMP_MESSAGE_TYPE_GET_TX_CONNECTION_RESPONSE:
+        if (listener.entity_id)
+            connect(talker, listener, msg_type);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void connection_graph::remove_listener_entity(uint64_t listener_entity_id)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    std::vector<stream_key> listeners;
+
+    for (listener_map::iterator it = m_listener_to_talker.begin(); it != m_listener_to_talker.end(); ++it)
+    {
+        if (it->first.entity_id == listener_entity_id)
+            listeners.push_back(it->first);
+    }
+
+    for (size_t i = 0; i < listeners.size(); i++)
+        disconnect(listeners[i], 0);
+}
+
+void connection_graph::remove_talker_entity(uint64_t talker_entity_id)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    std::vector<stream_key> talkers;
+
+    for (talker_map::iterator it = m_talker_to_listeners.begin(); it != m_talker_to_listeners.end(); ++it)
+    {
+        if (it->first.entity_id == talker_entity_id)
+            talkers.push_back(it->first);
+    }
+
+    for (size_t i = 0; i < talkers.size(); i++)
+        disconnect_talker(talkers[i], 0);
+}
+
+void connection_graph::connect(const stream_key & talker, const stream_key & listener, uint16_t msg_type)
+{
+    listener_map::iterator it = m_listener_to_talker.find(listener);
+
+    if (it != m_listener_to_talker.end())
+    {
+        if (it->second == talker)
+            return;
+
+        disconnect(listener, msg_type); // A listener stream has at most one talker
+    }
+
+    m_listener_to_talker.insert(std::make_pair(listener, talker));
+    m_talker_to_listeners[talker].insert(listener);
+    post_change(CONNECTION_ADDED, msg_type, talker, listener);
+}
+
+void connection_graph::disconnect(const stream_key & listener, uint16_t msg_type)
+{
+    listener_map::iterator it = m_listener_to_talker.find(listener);
+
+    if (it == m_listener_to_talker.end())
+        return;
+
+    stream_key talker = it->second;
+    m_listener_to_talker.erase(it);
+
+    talker_map::iterator t = m_talker_to_listeners.find(talker);
+    if (t != m_talker_to_listeners.end())
+    {
+        t->second.erase(listener);
+        if (t->second.empty())
+            m_talker_to_listeners.erase(t);
+    }
+
+    post_change(CONNECTION_REMOVED, msg_type, talker, listener);
+}
+
+void connection_graph::disconnect_talker(const stream_key & talker, uint16_t msg_type)
+{
+    talker_map::iterator t = m_talker_to_listeners.find(talker);
+
+    if (t == m_talker_to_listeners.end())
+        return;
+
+    std::vector<stream_key> listeners(t->second.begin(), t->second.end());
+    for (size_t i = 0; i < listeners.size(); i++)
+        disconnect(listeners[i], msg_type);
+}
+
+void connection_graph::post_change(int32_t notification_type, uint16_t msg_type, const stream_key & talker, const stream_key & listener)
+{
+    log_imp_ref->post_log_msg(LOGGING_LEVEL_DEBUG, "%s, 0x%" PRIx64 "[%d] -> 0x%" PRIx64 "[%d]",
+                              notification_type == CONNECTION_ADDED ? "CONNECTION_ADDED" : "CONNECTION_REMOVED",
+                              talker.entity_id, talker.unique_id, listener.entity_id, listener.unique_id);
+
+    notification_acmp_imp_ref->post_acmp_notification_msg(notification_type,
+                                                          msg_type ? msg_type + CMD_LOOKUP : 0,
+                                                          talker.entity_id,
+                                                          talker.unique_id,
+                                                          listener.entity_id,
+                                                          listener.unique_id,
+                                                          ACMP_STATUS_SUCCESS,
+                                                          NULL);
+}
+
+size_t connection_graph::get_connections(stream_connection * connections, size_t max_count)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    size_t i = 0;
+
+    for (listener_map::iterator it = m_listener_to_talker.begin(); it != m_listener_to_talker.end() && i < max_count; ++it, i++)
+    {
+        connections[i].talker_entity_id = it->second.entity_id;
+        connections[i].talker_unique_id = it->second.unique_id;
+        connections[i].listener_entity_id = it->first.entity_id;
+        connections[i].listener_unique_id = it->first.unique_id;
+    }
+
+    return m_listener_to_talker.size();
+}
+
+size_t connection_graph::get_talker_connections(uint64_t talker_entity_id, uint16_t talker_unique_id, stream_connection * connections, size_t max_count)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    talker_map::iterator t = m_talker_to_listeners.find(stream_key(talker_entity_id, talker_unique_id));
+
+    if (t == m_talker_to_listeners.end())
+        return 0;
+
+    size_t i = 0;
+    for (stream_key_set::iterator it = t->second.begin(); it != t->second.end() && i < max_count; ++it, i++)
+    {
+        connections[i].talker_entity_id = talker_entity_id;
+        connections[i].talker_unique_id = talker_unique_id;
+        connections[i].listener_entity_id = it->entity_id;
+        connections[i].listener_unique_id = it->unique_id;
+    }
+
+    return t->second.size();
+}
+
+bool connection_graph::get_listener_connection(uint64_t listener_entity_id, uint16_t listener_unique_id, stream_connection & connection)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    listener_map::iterator it = m_listener_to_talker.find(stream_key(listener_entity_id, listener_unique_id));
+
+    if (it == m_listener_to_talker.end())
+        return false;
+
+    connection.talker_entity_id = it->second.entity_id;
+    connection.talker_unique_id = it->second.unique_id;
+    connection.listener_entity_id = listener_entity_id;
+    connection.listener_unique_id = listener_unique_id;
+
+    return true;
+}
+}
@@ -0,0 +1,107 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * connection_graph.h
+ *
+ * A cache of the talker stream output to listener stream input connections on the
+ * network, maintained from the ACMP responses received by the controller.
+ *
+ * Connections are indexed by listener and by talker, so that the talker of a listener
+ * stream and the listeners of a talker stream are found without searching all End
+ * Stations. The lib thread updates the graph and application threads query it.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "controller.h"
+
+namespace avdecc_lib
+{
+class connection_graph
+{
+public:
+    connection_graph();
+    ~connection_graph();
+
+    ///
+    /// Update the graph from a received ACMP response frame.
+    ///
+    void update_from_acmp_resp(const uint8_t * frame, size_t frame_len);
+
+    ///
+    /// Remove the connections of all stream inputs of a listener that has departed.
+    ///
+    void remove_listener_entity(uint64_t listener_entity_id);
+
+    ///
+    /// Remove the connections of all stream outputs of a talker that has been evicted.
+    ///
+    void remove_talker_entity(uint64_t talker_entity_id);
+
+    size_t get_connections(stream_connection * connections, size_t max_count);
+    size_t get_talker_connections(uint64_t talker_entity_id, uint16_t talker_unique_id, stream_connection * connections, size_t max_count);
+    bool get_listener_connection(uint64_t listener_entity_id, uint16_t listener_unique_id, stream_connection & connection);
+
+private:
+    struct stream_key
+    {
+        uint64_t entity_id;
+        uint16_t unique_id;
+
+        stream_key(uint64_t id, uint16_t uid) : entity_id(id), unique_id(uid) {}
+
+        bool operator==(const stream_key & other) const
+        {
+            return entity_id == other.entity_id && unique_id == other.unique_id;
+        }
+    };
+
+    struct stream_key_hash
+    {
+        size_t operator()(const stream_key & k) const
+        {
+            return std::hash<uint64_t>()(k.entity_id ^ ((uint64_t)k.unique_id << 48));
+        }
+    };
+
+    typedef std::unordered_set<stream_key, stream_key_hash> stream_key_set;
+    typedef std::unordered_map<stream_key, stream_key, stream_key_hash> listener_map;
+    typedef std::unordered_map<stream_key, stream_key_set, stream_key_hash> talker_map;
+
+    std::mutex m_lock;
+    listener_map m_listener_to_talker;  // Each listener stream input has at most one talker
+    talker_map m_talker_to_listeners;   // Each talker stream output has any number of listeners
+
+    void connect(const stream_key & talker, const stream_key & listener, uint16_t msg_type);
+    void disconnect(const stream_key & listener, uint16_t msg_type);
+    void disconnect_talker(const stream_key & talker, uint16_t msg_type);
+    void post_change(int32_t notification_type, uint16_t msg_type, const stream_key & talker, const stream_key & listener);
+};
+}
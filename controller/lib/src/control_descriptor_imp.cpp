@@ -1,58 +1,66 @@
-/*
- * Licensed under the MIT License (MIT)
- *
- * Copyright (c) 2014 Renkus-Heinz Inc.
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy of
- * this software and associated documentation files (the "Software"), to deal in
- * the Software without restriction, including without limitation the rights to
- * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
- * the Software, and to permit persons to whom the Software is furnished to do so,
- * subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in all
- * copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
- * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
- * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
- * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
- * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
- */
-
-/**
- * control_descriptor_imp.cpp
- *
- * CONTROL descriptor implementation
- */
-
-#include <mutex>
-
-#include "avdecc_error.h"
-#include "enumeration.h"
-#include "log_imp.h"
-#include "end_station_imp.h"
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2014 Renkus-Heinz Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * control_descriptor_imp.cpp
+ *
+ * CONTROL descriptor implementation
+ */
+
+#include <mutex>
+
+#include "avdecc_error.h"
+#include "enumeration.h"
+#include "log_imp.h"
+#include "end_station_imp.h"
 #include "control_descriptor_imp.h"
 #include "aecp_controller_state_machine.h"
 #include "adp.h"
-#include "system_tx_queue.h"
-
-namespace avdecc_lib
-{
-control_descriptor_imp::control_descriptor_imp(end_station_imp * end_station_obj, const uint8_t * frame, ssize_t pos, size_t frame_len) : descriptor_base_imp(end_station_obj, frame, frame_len, pos) {}
-
-control_descriptor_imp::~control_descriptor_imp() {}
-
-control_descriptor_response * STDCALL control_descriptor_imp::get_control_response()
-{
-    std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
-    return resp = new control_descriptor_response_imp(resp_ref->get_desc_buffer(),
-                                                      resp_ref->get_desc_size(), resp_ref->get_desc_pos());
+#include "system_tx_queue.h"
+
+namespace avdecc_lib
+{
+control_descriptor_imp::control_descriptor_imp(end_station_imp * end_station_obj, const uint8_t * frame, ssize_t pos, size_t frame_len) : descriptor_base_imp(end_station_obj, frame, frame_len, pos) {}
+
+control_descriptor_imp::~control_descriptor_imp() {}
+
+control_descriptor_response * STDCALL control_descriptor_imp::get_control_response()
+{
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
+    std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
+    return resp = new control_descriptor_response_imp(resp_ref->get_desc_buffer(),
+                                                      resp_ref->get_desc_size(), resp_ref->get_desc_pos());
 }
 
 control_descriptor_get_jdks_ipv4_control_response * STDCALL control_descriptor_imp::get_control_get_jdks_ipv4_control_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_CONTROL);
     if (!resp_frame)
@@ -64,6 +72,12 @@ control_descriptor_get_jdks_ipv4_control_response * STDCALL control_descriptor_i
 
 int STDCALL control_descriptor_imp::send_get_jdks_ipv4_control_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_control aem_cmd_get_control;
     memset(&aem_cmd_get_control, 0, sizeof(aem_cmd_get_control));
@@ -134,5 +148,5 @@ int control_descriptor_imp::proc_get_control_resp(void *& notification_id, const
     aecp_controller_state_machine_ref->update_inflight_for_rcvd_resp(notification_id, msg_type, u_field, &cmd_frame);
 
     return 0;
-}
-}
+}
+}
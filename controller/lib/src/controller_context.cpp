@@ -0,0 +1,158 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * controller_context.cpp
+ *
+ * Controller context implementation
+ */
+
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+#include "log_imp.h"
+#include "notification_imp.h"
+#include "notification_acmp_imp.h"
+#include "rtt_estimator.h"
+#include "frame_recorder.h"
+#include "cmd_trace.h"
+#include "cmd_dispatcher.h"
+#include "controller_context.h"
+
+namespace avdecc_lib
+{
+static thread_local controller_context * bound_context = NULL;
+
+static std::mutex contexts_lock;
+static std::vector<controller_context *> contexts; // The default context is first
+
+controller_context::controller_context()
+{
+    // The notification threads run in the context that creates them
+    context_scope scope(this);
+
+    log_obj = new log_imp();
+    notification_obj = new notification_imp();
+    notification_acmp_obj = new notification_acmp_imp();
+    rtt_obj = new rtt_estimator();
+    recorder_obj = new frame_recorder();
+    trace_obj = new cmd_trace();
+    dispatcher_obj = new cmd_dispatcher();
+    clock_obj = NULL;
+    netif_obj = NULL;
+    controller_obj = NULL;
+    aecp_obj = NULL;
+    acmp_obj = NULL;
+    adp_discovery_obj = NULL;
+    system_obj = NULL;
+    ref_count = 0;
+}
+
+controller_context::~controller_context()
+{
+    // The notification threads post trace events, and the log is the last to go
+    delete dispatcher_obj;
+    delete notification_acmp_obj;
+    delete notification_obj;
+    delete trace_obj;
+    delete recorder_obj;
+    delete rtt_obj;
+    delete log_obj;
+}
+
+controller_context * controller_context::default_context()
+{
+    // Created on first use, so that it exists before any static initializer of the library uses it
+    static controller_context * context = new controller_context();
+    return context;
+}
+
+controller_context * controller_context::acquire()
+{
+    controller_context * context = default_context();
+    std::lock_guard<std::mutex> guard(contexts_lock);
+
+    if (contexts.empty())
+        contexts.push_back(context);
+
+    if (context->ref_count)
+    {
+        context = new controller_context();
+        contexts.push_back(context);
+    }
+
+    context->ref_count = 1;
+    return context;
+}
+
+void controller_context::retain(controller_context * context)
+{
+    std::lock_guard<std::mutex> guard(contexts_lock);
+    context->ref_count++;
+}
+
+void controller_context::release(controller_context * context)
+{
+    {
+        std::lock_guard<std::mutex> guard(contexts_lock);
+        if (--context->ref_count)
+            return;
+
+        context->netif_obj = NULL;
+        context->controller_obj = NULL;
+        context->system_obj = NULL;
+        context->clock_obj = NULL;
+
+        if (context != contexts.front())
+            contexts.erase(std::find(contexts.begin(), contexts.end(), context));
+    }
+
+    if (context == default_context())
+    {
+        context->trace_obj->stop();
+        context->dispatcher_obj->set_executor(NULL); // The executor of the controller may be gone
+    }
+    else
+        delete context;
+}
+
+controller_context * current_context()
+{
+    if (bound_context)
+        return bound_context;
+
+    return controller_context::default_context();
+}
+
+context_scope::context_scope(controller_context * context)
+{
+    m_previous = bound_context;
+    bound_context = context;
+}
+
+context_scope::~context_scope()
+{
+    bound_context = m_previous;
+}
+}
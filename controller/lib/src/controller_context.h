@@ -0,0 +1,141 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * controller_context.h
+ *
+ * The state of one controller: its network interface, state machines, system, log and
+ * notification dispatch. One process can run several controllers, each bound to its own network
+ * interface with its own event thread.
+ *
+ * The library code reaches the state of a controller through the *_ref names defined below,
+ * which resolve to the context bound to the calling thread. The event thread of a system is bound
+ * to the context of its controller. Public methods called by application threads bind the context
+ * of their controller with a context_scope. Threads without a bound context use the context of
+ * the first controller, so that a process with a single controller works as before.
+ *
+ * A context is referenced by its controller and by the system created for the controller, and is
+ * torn down once both are destroyed.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+namespace avdecc_lib
+{
+class log_imp;
+class notification_imp;
+class notification_acmp_imp;
+class net_interface_imp;
+class controller_imp;
+class aecp_controller_state_machine;
+class acmp_controller_state_machine;
+class adp_discovery_state_machine;
+class system_layer2_multithreaded_callback;
+class rtt_estimator;
+class frame_recorder;
+class cmd_trace;
+class virtual_clock_imp;
+class cmd_dispatcher;
+
+class controller_context
+{
+public:
+    log_imp * log_obj;
+    notification_imp * notification_obj;
+    notification_acmp_imp * notification_acmp_obj;
+    rtt_estimator * rtt_obj;
+    frame_recorder * recorder_obj;
+    cmd_trace * trace_obj;
+    cmd_dispatcher * dispatcher_obj;
+    virtual_clock_imp * clock_obj; // NULL while the controller runs on the real clock
+    net_interface_imp * netif_obj;
+    controller_imp * controller_obj;
+    aecp_controller_state_machine * aecp_obj;
+    acmp_controller_state_machine * acmp_obj;
+    adp_discovery_state_machine * adp_discovery_obj;
+    system_layer2_multithreaded_callback * system_obj;
+
+    ///
+    /// \return The context of the first controller, used by threads without a bound context.
+    ///
+    static controller_context * default_context();
+
+    ///
+    /// Take a context for a new controller, holding one reference to it. The default context is
+    /// taken when no other controller uses it, otherwise a new context is created.
+    ///
+    static controller_context * acquire();
+
+    ///
+    /// Add a reference to the context of a controller.
+    ///
+    static void retain(controller_context * context);
+
+    ///
+    /// Drop a reference to a context. Once the last reference is dropped the command trace is
+    /// stopped and the command executor is reset, and a context other than the default context is
+    /// deleted, which joins its log, notification and dispatcher threads. The default context is kept for the threads without a bound context.
+    ///
+    static void release(controller_context * context);
+
+private:
+    unsigned int ref_count;
+
+    controller_context();
+    ~controller_context();
+};
+
+///
+/// \return The context bound to the calling thread, or the default context.
+///
+controller_context * current_context();
+
+///
+/// Bind a context to the calling thread for the lifetime of the scope.
+///
+class context_scope
+{
+public:
+    context_scope(controller_context * context);
+    ~context_scope();
+
+private:
+    controller_context * m_previous;
+};
+
+#define log_imp_ref (avdecc_lib::current_context()->log_obj)
+#define notification_imp_ref (avdecc_lib::current_context()->notification_obj)
+#define notification_acmp_imp_ref (avdecc_lib::current_context()->notification_acmp_obj)
+#define rtt_estimator_ref (avdecc_lib::current_context()->rtt_obj)
+#define frame_recorder_ref (avdecc_lib::current_context()->recorder_obj)
+#define cmd_trace_ref (avdecc_lib::current_context()->trace_obj)
+#define cmd_dispatcher_ref (avdecc_lib::current_context()->dispatcher_obj)
+#define virtual_clock_ref (avdecc_lib::current_context()->clock_obj)
+#define net_interface_ref (avdecc_lib::current_context()->netif_obj)
+#define controller_imp_ref (avdecc_lib::current_context()->controller_obj)
+#define aecp_controller_state_machine_ref (avdecc_lib::current_context()->aecp_obj)
+#define acmp_controller_state_machine_ref (avdecc_lib::current_context()->acmp_obj)
+#define adp_discovery_state_machine_ref (avdecc_lib::current_context()->adp_discovery_obj)
+}
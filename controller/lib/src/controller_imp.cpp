@@ -31,6 +31,8 @@
 #include <cstdint>
 #include <inttypes.h>
 #include <mutex>
+#include <atomic>
+#include <stdexcept>
 
 #include "version.h"
 #include "net_interface_imp.h"
@@ -45,56 +47,50 @@
 #include "adp_discovery_state_machine.h"
 #include "acmp_controller_state_machine.h"
 #include "aecp_controller_state_machine.h"
+#include "cmd_trace.h"
+#include "connection_graph.h"
+#include "cmd_completion.h"
+#include "bulk_query.h"
+#include "routing_matrix.h"
+#include "firmware_rollout.h"
+#include "counter_poller.h"
+#include "rtt_estimator.h"
+#include "circuit_breaker.h"
+#include "cmd_dispatcher.h"
+#include "frame_recorder.h"
+#include "cmd_future_imp.h"
+#include "epoch_reclaimer.h"
+#include "segmented_array.h"
 #include "controller_imp.h"
 
 namespace avdecc_lib
 {
-net_interface_imp * net_interface_ref;
-controller_imp * controller_imp_ref;
-
 /*
 * The end_stations class is added here so that in the rare case that an endpoint is added by the background discovery
-* thread, causing the vector of end_stations to be re-allocated, a foreground process can still obtain a handle
-* to an end-station and send commands. Note that end_stations are never deleted by this library, even if they go
-* off-line, so end_station classes and their pointers will remain valid.
+* thread, a foreground process can still obtain a handle to an end-station and send commands. Note that end_station
+* classes are not deleted while the controller exists, even if they go off-line or are evicted, so their pointers remain valid.
+*
+* End stations are stored in a segmented_array, which readers index and iterate without locks.
+*
+* When end stations are evicted, the remaining end stations are moved to a new generation, which replaces the current one.
+* An evicted end station becomes a tombstone, which keeps its descriptors and is freed with the controller. The calls of
+* the end station and of its descriptors fail once it is evicted, and its ADP and descriptor frames are freed once no
+* thread can still read them.
 */
-class end_stations
-{
-private:
-    size_t m_count;
-    std::mutex locker;
-    std::vector<end_station_imp *> end_station_vec; // Store a list of End Station objects
-public:
-    end_stations()
-    {
-        m_count = 0;
-    };
-    ~end_stations()
-    {
-        for (uint32_t i = 0; i < end_station_vec.size(); i++)
-            delete end_station_vec.at(i);
-    };
-    /* use local m_count to avoid mutex operations */
-    const size_t size(void)
-    {
-        return m_count;
-    };
-    end_station_imp * at(size_t i)
-    {
-        end_station_imp * ep;
-        std::lock_guard<std::mutex> guard(locker);
-        ep = end_station_vec.at(i);
-        return ep;
-    };
-    void push_back(end_station_imp * ep)
-    {
-        locker.lock();
-        end_station_vec.push_back(ep);
-        m_count++;
-        locker.unlock();
-    };
+class end_stations : public segmented_array<end_station_imp>
+{
 };
 
+static void free_end_stations(void * obj)
+{
+    delete (end_stations *)obj;
+}
+
+static void free_end_station_contents(void * obj)
+{
+    ((end_station_imp *)obj)->release_contents();
+}
+
 controller * STDCALL create_controller(net_interface * netif,
                                        void (*notification_callback)(void *, int32_t, uint64_t, uint32_t,
                                                                      uint16_t, uint16_t, uint16_t,
@@ -105,11 +101,14 @@ controller * STDCALL create_controller(net_interface * netif,
                                        void (*log_callback)(void *, int32_t, const char *, int32_t),
                                        int32_t initial_log_level)
 {
+    controller_context * context = controller_context::acquire();
+    context_scope scope(context);
+
     log_imp_ref->set_log_level(initial_log_level);
 
     net_interface_ref = dynamic_cast<net_interface_imp *>(netif);
 
-    controller_imp_ref = new controller_imp(notification_callback, acmp_notification_callback, log_callback);
+    controller_imp_ref = new controller_imp(context, notification_callback, acmp_notification_callback, log_callback);
 
     //Start up state machines if previously deleted on a restart
     if (!aecp_controller_state_machine_ref)
@@ -129,39 +128,75 @@ controller * STDCALL create_controller(net_interface * netif,
     return controller_imp_ref;
 }
 
-controller_imp::controller_imp(void (*notification_callback)(void *, int32_t, uint64_t, uint32_t, uint16_t,
+controller_imp::controller_imp(controller_context * context,
+                               void (*notification_callback)(void *, int32_t, uint64_t, uint32_t, uint16_t,
                                                              uint16_t, uint16_t, uint32_t, void *),
                                void (*acmp_notification_callback)(void *, int32_t, uint16_t,
                                                                   uint64_t, uint16_t, uint64_t,
                                                                   uint16_t, uint32_t, void *),
                                void (*log_callback)(void *, int32_t, const char *, int32_t))
 {
+    m_context = context;
     notification_imp_ref->set_notification_callback(notification_callback, NULL);
     notification_acmp_imp_ref->set_acmp_notification_callback(acmp_notification_callback, NULL);
-    end_station_array = new end_stations();
+    m_end_stations = new end_stations();
+    m_reclaimer = new epoch_reclaimer();
+    m_eviction_timeout_ms = 0;
+    m_evicted_count = 0;
+    m_connection_graph = new connection_graph();
+    m_firmware_rollout = NULL;
+    m_counter_poller = new counter_poller(this);
+    m_circuit_breaker = new circuit_breaker(this);
     log_imp_ref->set_log_callback(log_callback, NULL);
 
     m_entity_capabilities_flags = 0x00000000;
     m_talker_capabilities_flags = 0x00000000;
     m_listener_capabilities_flags = 0x00000000;
     m_max_num_read_desc_cmd_inflight = -1;
+    m_auto_register_unsolicited = false;
 }
 
 controller_imp::~controller_imp()
 {
-    delete end_station_array;
-    end_station_array = NULL;
+    delete m_firmware_rollout;
+    m_firmware_rollout = NULL;
+    delete m_counter_poller;
+    m_counter_poller = NULL;
+    delete m_circuit_breaker;
+    m_circuit_breaker = NULL;
+    delete m_end_stations.load();
+    m_end_stations = NULL;
+    delete m_reclaimer;
+    m_reclaimer = NULL;
+    for (size_t i = 0; i < m_evicted_end_stations.size(); i++)
+        delete m_evicted_end_stations[i];
+    m_evicted_end_stations.clear();
+    delete m_connection_graph;
+    m_connection_graph = NULL;
     delete adp_discovery_state_machine_ref;
     adp_discovery_state_machine_ref = NULL;
     delete acmp_controller_state_machine_ref;
     acmp_controller_state_machine_ref = NULL;
     delete aecp_controller_state_machine_ref;
     aecp_controller_state_machine_ref = NULL;
+    cmd_trace_ref->stop();
 }
 
 void STDCALL controller_imp::destroy()
 {
-    delete this;
+    controller_context * context = m_context;
+
+    {
+        context_scope scope(context);
+        delete this;
+    }
+
+    controller_context::release(context);
+}
+
+controller_context * controller_imp::context()
+{
+    return m_context;
 }
 
 const char * STDCALL controller_imp::get_version() const
@@ -171,16 +206,22 @@ const char * STDCALL controller_imp::get_version() const
 
 size_t STDCALL controller_imp::get_end_station_count()
 {
-    return end_station_array->size();
+    epoch_guard guard(*m_reclaimer);
+
+    return m_end_stations.load(std::memory_order_acquire)->size();
 }
     
 uint64_t STDCALL controller_imp::get_entity_id()
 {
+    context_scope scope(m_context);
+
     return net_interface_ref->get_dev_eui();
 }
     
 void STDCALL controller_imp::set_entity_id(uint64_t entity_id)
 {
+    context_scope scope(m_context);
+
     net_interface_ref->set_dev_eui(entity_id);
 }
     
@@ -189,13 +230,50 @@ void STDCALL controller_imp::set_max_num_read_desc_cmd_inflight(int max_num_read
     m_max_num_read_desc_cmd_inflight = max_num_read_desc_cmd_inflight;
 }
 
+void STDCALL controller_imp::set_auto_register_unsolicited(bool enable)
+{
+    context_scope scope(m_context);
+    epoch_guard guard(*m_reclaimer);
+    end_stations * end_station_array = m_end_stations.load(std::memory_order_acquire);
+
+    m_auto_register_unsolicited = enable;
+
+    for (uint32_t i = 0; i < end_station_array->size(); i++)
+    {
+        end_station_array->at(i)->set_auto_register_unsolicited(enable);
+    }
+}
+
 end_station * STDCALL controller_imp::get_end_station_by_index(size_t end_station_index)
 {
-    return end_station_array->at(end_station_index);
+    epoch_guard guard(*m_reclaimer);
+
+    return m_end_stations.load(std::memory_order_acquire)->at(end_station_index);
+}
+
+end_station * STDCALL controller_imp::get_end_station_by_entity_id(uint64_t entity_id)
+{
+    return find_end_station_by_entity_id(entity_id);
+}
+
+end_station_imp * controller_imp::find_end_station_by_entity_id(uint64_t entity_id)
+{
+    epoch_guard guard(*m_reclaimer);
+    end_stations * end_station_array = m_end_stations.load(std::memory_order_acquire);
+
+    for (uint32_t i = 0; i < end_station_array->size(); i++)
+    {
+        if (end_station_array->at(i)->entity_id() == entity_id)
+            return end_station_array->at(i);
+    }
+
+    return NULL;
 }
 
 bool STDCALL controller_imp::is_end_station_found_by_entity_id(uint64_t entity_entity_id, uint32_t & end_station_index)
 {
+    epoch_guard guard(*m_reclaimer);
+    end_stations * end_station_array = m_end_stations.load(std::memory_order_acquire);
     uint64_t end_station_entity_id;
 
     for (uint32_t i = 0; i < end_station_array->size(); i++)
@@ -214,6 +292,8 @@ bool STDCALL controller_imp::is_end_station_found_by_entity_id(uint64_t entity_e
 
 bool STDCALL controller_imp::is_end_station_found_by_mac_addr(uint64_t mac_addr, uint32_t & end_station_index)
 {
+    epoch_guard guard(*m_reclaimer);
+    end_stations * end_station_array = m_end_stations.load(std::memory_order_acquire);
     uint64_t end_station_mac_addr;
 
     for (uint32_t i = 0; i < end_station_array->size(); i++)
@@ -232,25 +312,20 @@ bool STDCALL controller_imp::is_end_station_found_by_mac_addr(uint64_t mac_addr,
 
 configuration_descriptor * STDCALL controller_imp::get_current_config_desc(size_t end_station_index, bool report_error)
 {
-    uint16_t entity_index = 0;
-    uint16_t config_index = 0;
-    bool is_valid = false;
+    context_scope scope(m_context);
+    epoch_guard guard(*m_reclaimer);
+    end_stations * end_station_array = m_end_stations.load(std::memory_order_acquire);
+    configuration_descriptor * configuration = NULL;
 
     if (end_station_index < end_station_array->size())
     {
-        avdecc_lib::end_station * end_station = end_station_array->at(end_station_index);
-        entity_index = end_station->get_current_entity_index();
-        config_index = end_station->get_current_config_index();
-
-        is_valid = (entity_index < end_station->entity_desc_count()) &&
-                   (config_index < end_station->get_entity_desc_by_index(entity_index)->config_desc_count());
+        end_station_pin pin(end_station_array->at(end_station_index));
+        if (pin.is_pinned())
+            configuration = end_station_array->at(end_station_index)->get_current_config();
     }
 
-    if (is_valid)
+    if (configuration)
     {
-        configuration_descriptor * configuration;
-        configuration = end_station_array->at(end_station_index)->get_entity_desc_by_index(entity_index)->get_config_desc_by_index(config_index);
-
         return configuration;
     }
     else if (report_error)
@@ -263,28 +338,20 @@ configuration_descriptor * STDCALL controller_imp::get_current_config_desc(size_
 
 configuration_descriptor * controller_imp::get_config_desc_by_entity_id(uint64_t entity_entity_id, uint16_t entity_index, uint16_t config_index)
 {
-    for (uint32_t i = 0; i < end_station_array->size(); i++)
-    {
-        entity_descriptor_response * entity_resp_ref = end_station_array->at(i)->get_entity_desc_by_index(entity_index)->get_entity_response();
-        uint64_t end_station_entity_id = end_station_array->at(i)->entity_id();
-        if (end_station_entity_id == entity_entity_id)
-        {
-            bool is_valid = ((entity_index < end_station_array->at(i)->entity_desc_count()) &&
-                             (config_index < entity_resp_ref->configurations_count()));
-            if (is_valid)
-            {
-                configuration_descriptor * configuration;
-                configuration = end_station_array->at(i)->get_entity_desc_by_index(entity_index)->get_config_desc_by_index(config_index);
+    context_scope scope(m_context);
+    end_station_imp * end_station = find_end_station_by_entity_id(entity_entity_id);
+    if (!end_station)
+        return NULL;
 
-                return configuration;
-            }
-            else
-            {
-                log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "get_config_desc_by_entity_id error");
-            }
-        }
-        delete entity_resp_ref;
+    end_station_pin pin(end_station);
+    if (pin.is_pinned() && (entity_index < end_station->entity_desc_count()))
+    {
+        entity_descriptor * entity = end_station->get_entity_desc_by_index(entity_index);
+        if (config_index < entity->config_desc_count())
+            return entity->get_config_desc_by_index(config_index);
     }
+
+    log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "get_config_desc_by_entity_id error");
     return NULL;
 }
 
@@ -303,6 +370,8 @@ bool controller_imp::is_active_operation_with_notification_id(void * notificatio
 
 void STDCALL controller_imp::set_logging_level(int32_t new_log_level)
 {
+    context_scope scope(m_context);
+
     log_imp_ref->set_log_level(new_log_level);
 }
 
@@ -317,18 +386,310 @@ void STDCALL controller_imp::apply_end_station_capabilities_filters(uint32_t ent
 
 uint32_t STDCALL controller_imp::missed_notification_count()
 {
+    context_scope scope(m_context);
+
     return notification_imp_ref->missed_notification_event_count();
 }
 
 uint32_t STDCALL controller_imp::missed_log_count()
 {
+    context_scope scope(m_context);
+
     return log_imp_ref->missed_log_event_count();
 }
 
+int STDCALL controller_imp::set_end_station_eviction(uint32_t disconnected_timeout_ms)
+{
+    if (disconnected_timeout_ms && (disconnected_timeout_ms < MIN_EVICTION_TIMEOUT_MS))
+    {
+        context_scope scope(m_context);
+
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "set_end_station_eviction error: timeout below %d ms", MIN_EVICTION_TIMEOUT_MS);
+        return -1;
+    }
+
+    m_eviction_timeout_ms = disconnected_timeout_ms;
+
+    return 0;
+}
+
+uint64_t STDCALL controller_imp::evicted_end_station_count()
+{
+    return m_evicted_count.load();
+}
+
+int STDCALL controller_imp::enable_command_trace(const char * file_path)
+{
+    context_scope scope(m_context);
+
+    if (cmd_trace_ref->start(file_path) != 0)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Unable to start command trace to %s", file_path ? file_path : "NULL");
+        return -1;
+    }
+
+    return 0;
+}
+
+size_t STDCALL controller_imp::get_connections(stream_connection * connections, size_t max_count)
+{
+    return m_connection_graph->get_connections(connections, max_count);
+}
+
+size_t STDCALL controller_imp::get_talker_connections(uint64_t talker_entity_id, uint16_t talker_unique_id,
+                                                      stream_connection * connections, size_t max_count)
+{
+    return m_connection_graph->get_talker_connections(talker_entity_id, talker_unique_id, connections, max_count);
+}
+
+bool STDCALL controller_imp::get_listener_connection(uint64_t listener_entity_id, uint16_t listener_unique_id,
+                                                     stream_connection & connection)
+{
+    return m_connection_graph->get_listener_connection(listener_entity_id, listener_unique_id, connection);
+}
+
+int STDCALL controller_imp::send_bulk_query(bulk_query_target * targets, size_t target_count,
+                                            size_t per_entity_window, size_t global_window,
+                                            void (*completion_callback)(void *, bulk_query_target *, size_t),
+                                            void * user_obj)
+{
+    context_scope scope(m_context);
+
+    if ((target_count && !targets) || (per_entity_window == 0) || (global_window == 0))
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "send_bulk_query error: invalid window or targets");
+        return -1;
+    }
+
+    for (size_t i = 0; i < target_count; i++)
+    {
+        if (!bulk_query::is_supported(targets[i]))
+        {
+            log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "send_bulk_query error: target %d is not a supported query", (int)i);
+            return -1;
+        }
+    }
+
+    if (global_window > bulk_query::MAX_GLOBAL_WINDOW)
+        global_window = bulk_query::MAX_GLOBAL_WINDOW;
+
+    bulk_query * query = new bulk_query(this, targets, target_count, per_entity_window, global_window,
+                                        completion_callback, user_obj);
+    query->start();
+
+    return 0;
+}
+
+int STDCALL controller_imp::send_routing_matrix(const stream_connection * connections, size_t connection_count, size_t window,
+                                                void (*change_callback)(void *, const routing_change *),
+                                                void (*completion_callback)(void *, const routing_change *, size_t),
+                                                void * user_obj)
+{
+    context_scope scope(m_context);
+
+    if ((connection_count && !connections) || (window == 0))
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "send_routing_matrix error: invalid window or connections");
+        return -1;
+    }
+
+    if (window > routing_matrix::MAX_WINDOW)
+        window = routing_matrix::MAX_WINDOW;
+
+    routing_matrix * matrix = new routing_matrix(this, window, change_callback, completion_callback, user_obj);
+    if (matrix->plan(connections, connection_count) != 0)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "send_routing_matrix error: listener stream with more than one talker stream");
+        delete matrix;
+        return -1;
+    }
+    matrix->start();
+
+    return 0;
+}
+
+int STDCALL controller_imp::start_firmware_rollout(const uint64_t * entity_ids, size_t entity_count,
+                                                   const firmware_rollout_config & config, void * notification_id)
+{
+    context_scope scope(m_context);
+
+    if ((entity_count && !entity_ids) || !config.image_path)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "start_firmware_rollout error: invalid image or End Stations");
+        return -1;
+    }
+
+    // Opened before taking the lock, as hashing the image would hold up the lib thread
+    firmware_rollout * rollout = new firmware_rollout(this, config, notification_id);
+    if (rollout->open(entity_ids, entity_count) != 0)
+    {
+        delete rollout;
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> guard(m_firmware_rollout_lock);
+
+    if (m_firmware_rollout && !m_firmware_rollout->is_finished())
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "start_firmware_rollout error: a firmware rollout is running");
+        delete rollout;
+        return -1;
+    }
+
+    delete m_firmware_rollout;
+    m_firmware_rollout = rollout;
+
+    return 0;
+}
+
+void STDCALL controller_imp::abort_firmware_rollout()
+{
+    context_scope scope(m_context);
+
+    std::lock_guard<std::mutex> guard(m_firmware_rollout_lock);
+
+    if (m_firmware_rollout)
+        m_firmware_rollout->abort();
+}
+
+size_t STDCALL controller_imp::get_firmware_rollout_status(firmware_rollout_entity_status * entity_status, size_t max_count)
+{
+    context_scope scope(m_context);
+
+    std::lock_guard<std::mutex> guard(m_firmware_rollout_lock);
+
+    if (!m_firmware_rollout)
+        return 0;
+
+    return m_firmware_rollout->get_status(entity_status, max_count);
+}
+
+int STDCALL controller_imp::start_counter_polling(const counter_poll_target * targets, size_t target_count, const counter_poll_config & config)
+{
+    context_scope scope(m_context);
+
+    if ((target_count && !targets) || (config.history_length == 0))
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "start_counter_polling error: invalid targets or history length");
+        return -1;
+    }
+
+    for (size_t i = 0; i < target_count; i++)
+    {
+        if (!counter_poller::is_supported(targets[i].desc_type))
+        {
+            log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "start_counter_polling error: target %d has no counters", (int)i);
+            return -1;
+        }
+    }
+
+    m_counter_poller->configure(targets, target_count, config);
+
+    return 0;
+}
+
+void STDCALL controller_imp::stop_counter_polling()
+{
+    context_scope scope(m_context);
+
+    counter_poll_config config = counter_poll_config();
+
+    m_counter_poller->configure(NULL, 0, config);
+}
+
+size_t STDCALL controller_imp::get_counter_samples(uint64_t entity_id, uint16_t desc_type, uint16_t desc_index,
+                                                   counter_sample * samples, size_t max_count)
+{
+    context_scope scope(m_context);
+
+    return m_counter_poller->get_samples(entity_id, desc_type, desc_index, samples, max_count);
+}
+
+int STDCALL controller_imp::set_cmd_retry_policy(const cmd_retry_policy & policy)
+{
+    context_scope scope(m_context);
+
+    return rtt_estimator_ref->set_policy(policy);
+}
+
+size_t STDCALL controller_imp::get_rtt_estimates(rtt_estimate * estimates, size_t max_count)
+{
+    context_scope scope(m_context);
+
+    return rtt_estimator_ref->get_estimates(estimates, max_count);
+}
+
+int STDCALL controller_imp::set_circuit_breaker(uint32_t timeout_threshold, uint32_t probe_interval_ms)
+{
+    if (probe_interval_ms == 0)
+        return -1;
+
+    m_circuit_breaker->configure(timeout_threshold, probe_interval_ms);
+    return 0;
+}
+
+cmd_future * STDCALL controller_imp::create_cmd_future(cmd_future_callback callback, void * context)
+{
+    context_scope scope(m_context);
+
+    return new cmd_future_imp(callback, context);
+}
+
+void STDCALL controller_imp::set_cmd_executor(cmd_executor * executor)
+{
+    context_scope scope(m_context);
+
+    cmd_dispatcher_ref->set_executor(executor);
+}
+
+int STDCALL controller_imp::start_frame_capture(const char * path, uint32_t ring_frames)
+{
+    context_scope scope(m_context);
+
+    return frame_recorder_ref->start(path, ring_frames, net_interface_ref->mac_addr());
+}
+
+uint64_t STDCALL controller_imp::stop_frame_capture()
+{
+    context_scope scope(m_context);
+
+    return frame_recorder_ref->stop();
+}
+
+void controller_imp::aecp_cmd_timed_out(uint64_t entity_id, void * notification_id)
+{
+    m_circuit_breaker->cmd_timed_out(entity_id);
+    m_timed_out_notification_ids.push_back(notification_id);
+}
+
+void controller_imp::acmp_cmd_timed_out(void * notification_id)
+{
+    m_timed_out_notification_ids.push_back(notification_id);
+}
+
+const std::vector<void *> & controller_imp::timed_out_notification_ids()
+{
+    return m_timed_out_notification_ids;
+}
+
+void STDCALL controller_imp::disable_command_trace()
+{
+    context_scope scope(m_context);
+
+    cmd_trace_ref->stop();
+    if (cmd_trace_ref->missed_trace_event_count())
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_WARNING, "Command trace dropped %d events", cmd_trace_ref->missed_trace_event_count());
+    }
+}
+
 void controller_imp::time_tick_event()
 {
+    end_stations * end_station_array = m_end_stations.load(std::memory_order_acquire);
     uint64_t end_station_entity_id;
     uint32_t disconnected_end_station_index;
+
+    m_timed_out_notification_ids.clear();
     if (aecp_controller_state_machine_ref)
         aecp_controller_state_machine_ref->tick();
     if (acmp_controller_state_machine_ref)
@@ -340,6 +701,8 @@ void controller_imp::time_tick_event()
             is_end_station_found_by_entity_id(end_station_entity_id, disconnected_end_station_index))
         {
             end_station_array->at(disconnected_end_station_index)->set_disconnected();
+            m_connection_graph->remove_listener_entity(end_station_entity_id);
+            rtt_estimator_ref->remove_entity(end_station_entity_id);
         }
     }
 
@@ -349,10 +712,82 @@ void controller_imp::time_tick_event()
         end_station_array->at(i)->background_read_update_timeouts();
         end_station_array->at(i)->background_read_submit_pending();
     }
+
+    {
+        std::lock_guard<std::mutex> guard(m_firmware_rollout_lock);
+        if (m_firmware_rollout)
+            m_firmware_rollout->tick();
+    }
+
+    m_counter_poller->tick();
+    m_circuit_breaker->tick();
+    evict_end_stations();
+}
+
+void controller_imp::evict_end_stations()
+{
+    end_stations * end_station_array = m_end_stations.load(std::memory_order_acquire);
+    uint32_t eviction_timeout_ms = m_eviction_timeout_ms.load();
+    std::vector<end_station_imp *> evicted;
+
+    m_reclaimer->reclaim();
+
+    if (!eviction_timeout_ms)
+        return;
+
+    {
+        // The End Stations of a running firmware rollout are kept until it finishes
+        std::lock_guard<std::mutex> guard(m_firmware_rollout_lock);
+        if (m_firmware_rollout && !m_firmware_rollout->is_finished())
+            return;
+    }
+
+    for (uint32_t i = 0; i < end_station_array->size(); i++)
+    {
+        end_station_imp * end_station = end_station_array->at(i);
+
+        // A pinned End Station is used by a call or an operation, and is evicted on a later tick
+        if ((end_station->get_connection_status() == 'D') && (end_station->disconnected_ms() > eviction_timeout_ms) &&
+            end_station->try_evict())
+            evicted.push_back(end_station);
+    }
+
+    if (evicted.empty())
+        return;
+
+    end_stations * remaining = new end_stations();
+    size_t next_evicted = 0;
+
+    for (uint32_t i = 0; i < end_station_array->size(); i++)
+    {
+        if ((next_evicted < evicted.size()) && (end_station_array->at(i) == evicted[next_evicted]))
+            next_evicted++;
+        else
+            remaining->push_back(end_station_array->at(i));
+    }
+
+    end_station_array->disown();
+    m_end_stations.store(remaining, std::memory_order_release);
+    m_reclaimer->retire(free_end_stations, end_station_array, 0);
+
+    for (size_t i = 0; i < evicted.size(); i++)
+    {
+        uint64_t entity_id = evicted[i]->entity_id();
+
+        m_connection_graph->remove_talker_entity(entity_id);
+        m_connection_graph->remove_listener_entity(entity_id);
+        rtt_estimator_ref->remove_entity(entity_id);
+        m_reclaimer->retire(free_end_station_contents, evicted[i], 0);
+        m_evicted_end_stations.push_back(evicted[i]);
+        notification_imp_ref->post_notification_msg(END_STATION_EVICTED, entity_id, 0, 0, 0, 0, 0, 0);
+    }
+
+    m_evicted_count += evicted.size();
 }
 
 int controller_imp::find_in_end_station(struct jdksavdecc_eui64 & other_entity_id, bool isUnsolicited, const uint8_t * frame)
 {
+    end_stations * end_station_array = m_end_stations.load(std::memory_order_acquire);
     struct jdksavdecc_eui64 other_controller_id = jdksavdecc_acmpdu_get_controller_entity_id(frame, ETHER_HDR_SIZE);
 
     for (uint32_t i = 0; i < end_station_array->size(); i++)
@@ -398,9 +833,11 @@ void controller_imp::rx_packet_event(void *& notification_id,
                                      uint16_t & operation_id,
                                      bool & is_operation_id_valid)
 {
+    end_stations * end_station_array = m_end_stations.load(std::memory_order_acquire);
     uint64_t dest_mac_addr;
     utility::convert_eui48_to_uint64(frame, dest_mac_addr);
     is_operation_id_valid = false;
+    frame_recorder_ref->record(frame_recorder::RX, frame, frame_len);
 
     if ((dest_mac_addr == net_interface_ref->mac_addr()) || (dest_mac_addr & UINT64_C(0x010000000000))) // Process if the packet dest is our MAC address or a multicast address
     {
@@ -465,6 +902,8 @@ void controller_imp::rx_packet_event(void *& notification_id,
                     end_station_array->at(end_station_array->size() - 1)->set_connected();
                     if (m_max_num_read_desc_cmd_inflight != -1)
                         end_station_array->at(end_station_array->size() - 1)->set_max_num_read_desc_cmd_inflight(m_max_num_read_desc_cmd_inflight);
+                    if (m_auto_register_unsolicited)
+                        end_station_array->at(end_station_array->size() - 1)->set_auto_register_unsolicited(true);
                 }
                 else
                 {
@@ -473,6 +912,7 @@ void controller_imp::rx_packet_event(void *& notification_id,
                     {
                         log_imp_ref->post_log_msg(LOGGING_LEVEL_DEBUG, "Re-enumerating end station with entity_id %ull", end_station->entity_id());
                         end_station->end_station_reenumerate();
+                        m_circuit_breaker->entity_restarted(end_station->entity_id());
                     }
 
                     end_station->get_adp()->proc_adpdu(frame, frame_len);
@@ -480,6 +920,8 @@ void controller_imp::rx_packet_event(void *& notification_id,
                     if (end_station->get_connection_status() == 'D')
                     {
                         end_station->set_connected();
+                        end_station->auto_register_unsolicited();
+                        m_circuit_breaker->entity_restarted(end_station->entity_id());
                         if (adp_discovery_state_machine_ref)
                             adp_discovery_state_machine_ref->state_avail(frame, frame_len);
                     }
@@ -521,6 +963,8 @@ void controller_imp::rx_packet_event(void *& notification_id,
                     found_end_station_index = find_in_end_station(entity_entity_id, isUnsolicited, frame);
                     if (found_end_station_index >= 0)
                     {
+                        m_circuit_breaker->cmd_responded(jdksavdecc_uint64_get(&entity_entity_id, 0));
+
                         switch (msg_type)
                         {
 
@@ -571,6 +1015,9 @@ void controller_imp::rx_packet_event(void *& notification_id,
             struct jdksavdecc_eui64 entity_entity_id;
             uint32_t msg_type = jdksavdecc_common_control_header_get_control_data(frame, ETHER_HDR_SIZE);
 
+            // Keep the connection graph up to date from all ACMP responses, including those for other controllers
+            m_connection_graph->update_from_acmp_resp(frame, frame_len);
+
             if ((msg_type == JDKSAVDECC_ACMP_MESSAGE_TYPE_GET_TX_STATE_RESPONSE) ||
                 (msg_type == JDKSAVDECC_ACMP_MESSAGE_TYPE_GET_TX_CONNECTION_RESPONSE) ||
                 (msg_type == JDKSAVDECC_ACMP_MESSAGE_TYPE_DISCONNECT_TX_RESPONSE))
@@ -617,7 +1064,7 @@ void controller_imp::rx_packet_event(void *& notification_id,
     }
 }
 
-void controller_imp::tx_packet_event(void * notification_id, uint32_t notification_flag, uint8_t * frame, size_t frame_len)
+int controller_imp::tx_packet_event(void * notification_id, uint32_t notification_flag, uint8_t * frame, size_t frame_len, uint32_t priority)
 {
     uint8_t subtype = jdksavdecc_common_control_header_get_subtype(frame, ETHER_HDR_SIZE);
     struct jdksavdecc_frame packet_frame;
@@ -626,11 +1073,36 @@ void controller_imp::tx_packet_event(void * notification_id, uint32_t notificati
     assert(frame_len <= sizeof(packet_frame.payload));
     memcpy(packet_frame.payload, frame, frame_len);
 
+    // Commands issued by a library operation report completion to the operation, not the application
+    if (cmd_completion_ref->is_registered(notification_id))
+        notification_flag = CMD_WITHOUT_NOTIFICATION;
+
     if (subtype == JDKSAVDECC_SUBTYPE_AECP)
     {
+        struct jdksavdecc_eui64 id = jdksavdecc_common_control_header_get_stream_id(frame, ETHER_HDR_SIZE);
+        uint64_t entity_id = jdksavdecc_uint64_get(&id, 0);
+
+        if (!m_circuit_breaker->allow_cmd(entity_id, notification_id))
+        {
+            uint32_t msg_type = jdksavdecc_common_control_header_get_control_data(frame, ETHER_HDR_SIZE);
+            uint16_t cmd_type = jdksavdecc_aecpdu_aem_get_command_type(frame, ETHER_HDR_SIZE) & 0x7FFF;
+            uint16_t desc_type = jdksavdecc_aem_command_read_descriptor_get_descriptor_type(frame, ETHER_HDR_SIZE);
+            uint16_t desc_index = jdksavdecc_aem_command_read_descriptor_get_descriptor_index(frame, ETHER_HDR_SIZE);
+
+            log_imp_ref->post_log_msg(LOGGING_LEVEL_DEBUG, "Command to degraded End Station 0x%llx failed, %s",
+                                      (unsigned long long)entity_id, utility::aem_cmd_value_to_name(cmd_type));
+            if (!cmd_completion_ref->complete(notification_id, AVDECC_LIB_STATUS_ENTITY_DEGRADED, NULL, 0) &&
+                notification_flag == CMD_WITH_NOTIFICATION)
+            {
+                notification_imp_ref->post_notification_msg(COMMAND_TIMEOUT, entity_id, msg_type, cmd_type, desc_type, desc_index,
+                                                            AVDECC_LIB_STATUS_ENTITY_DEGRADED, notification_id);
+            }
+            return AVDECC_LIB_STATUS_ENTITY_DEGRADED;
+        }
+
         if (aecp_controller_state_machine_ref)
         {
-            aecp_controller_state_machine_ref->state_send_cmd(notification_id, notification_flag, &packet_frame);
+            aecp_controller_state_machine_ref->state_send_cmd(notification_id, notification_flag, &packet_frame, priority);
             memcpy(frame, packet_frame.payload, frame_len); // Get the updated frame with sequence id
         }
     }
@@ -646,10 +1118,16 @@ void controller_imp::tx_packet_event(void * notification_id, uint32_t notificati
     {
         log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Invalid Subtype: %x", subtype);
     }
+
+    return 0;
 }
 
 int STDCALL controller_imp::send_controller_avail_cmd(void * notification_id, uint32_t end_station_index)
 {
+    context_scope scope(m_context);
+    epoch_guard guard(*m_reclaimer);
+    end_stations * end_station_array = m_end_stations.load(std::memory_order_acquire);
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_controller_available aem_cmd_controller_avail;
     ssize_t aem_cmd_controller_avail_returned;
@@ -687,6 +1165,8 @@ int STDCALL controller_imp::send_controller_avail_cmd(void * notification_id, ui
 
 int STDCALL controller_imp::send_controller_avail_response(const uint8_t * frame, size_t frame_len)
 {
+    context_scope scope(m_context);
+
     struct jdksavdecc_eui48 dest_address;
     struct jdksavdecc_eui48 src_address;
     struct jdksavdecc_eui48 temp_address;
@@ -720,6 +1200,7 @@ int STDCALL controller_imp::send_controller_avail_response(const uint8_t * frame
 
     //send packet
     send_frame_returned = net_interface_ref->send_frame(tx_frame, frame_len);
+    frame_recorder_ref->record(frame_recorder::TX, tx_frame, frame_len);
 
     if (send_frame_returned < 0)
     {
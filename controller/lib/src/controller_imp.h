@@ -29,31 +29,64 @@
 
 #pragma once
 
+#include <mutex>
+#include <vector>
+#include <atomic>
 #include "controller.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
 class end_stations;
+class connection_graph;
+class firmware_rollout;
+class counter_poller;
+class circuit_breaker;
+class epoch_reclaimer;
+class end_station_imp;
 
 class controller_imp : public virtual controller
 {
 private:
-    end_stations * end_station_array;
+    enum econsts
+    {
+        MIN_EVICTION_TIMEOUT_MS = 1000
+    };
+
+    controller_context * m_context; // The state of this controller, bound by its public methods
+    std::atomic<end_stations *> m_end_stations; // Replaced by a new generation when End Stations are evicted
+    epoch_reclaimer * m_reclaimer; // Frees replaced generations and evicted End Station contents once no thread reads them
+    std::vector<end_station_imp *> m_evicted_end_stations; // Tombstones kept so that application handles stay valid
+    std::atomic<uint32_t> m_eviction_timeout_ms; // 0 if End Stations are never evicted
+    std::atomic<uint64_t> m_evicted_count;
     uint32_t m_entity_capabilities_flags;
     uint32_t m_talker_capabilities_flags;
     uint32_t m_listener_capabilities_flags;
     int m_max_num_read_desc_cmd_inflight;
+    bool m_auto_register_unsolicited;
+    connection_graph * m_connection_graph; // Talker to listener stream connections seen in ACMP responses
+    std::mutex m_firmware_rollout_lock;
+    firmware_rollout * m_firmware_rollout; // The running or last firmware rollout, ticked on the lib thread
+    counter_poller * m_counter_poller;
+    std::vector<void *> m_timed_out_notification_ids; // Commands that timed out during the last time tick
+    circuit_breaker * m_circuit_breaker; // Fast-fails commands to End Stations that stopped responding
 
     ///
     /// Find an end station that matches the entity and controller IDs
     ///
     int find_in_end_station(struct jdksavdecc_eui64 & entity_entity_id, bool isUnsolicited, const uint8_t * frame);
 
+    ///
+    /// Remove the End Stations disconnected for longer than the eviction timeout, on the lib thread.
+    ///
+    void evict_end_stations();
+
 public:
     ///
-    /// A constructor for controller_imp used for constructing an object with notification, and post_log_msg callback functions.
+    /// A constructor for controller_imp used for constructing an object with a context, notification, and post_log_msg callback functions.
     ///
-    controller_imp(void (*notification_callback)(void *, int32_t, uint64_t, uint32_t, uint16_t, uint16_t, uint16_t, uint32_t, void *),
+    controller_imp(controller_context * context,
+                   void (*notification_callback)(void *, int32_t, uint64_t, uint32_t, uint16_t, uint16_t, uint16_t, uint32_t, void *),
                    void (*acmp_notification_callback)(void *, int32_t, uint16_t, uint64_t, uint16_t, uint64_t,
                                                       uint16_t, uint32_t, void *),
                    void (*log_callback)(void *, int32_t, const char *, int32_t));
@@ -65,6 +98,11 @@ public:
     ///
     void STDCALL destroy();
 
+    ///
+    /// \return The state of this controller.
+    ///
+    controller_context * context();
+
     const char * STDCALL get_version() const;
 
     ///
@@ -75,8 +113,16 @@ public:
     uint64_t STDCALL get_entity_id();
     void STDCALL set_entity_id(uint64_t entity_id);
     void STDCALL set_max_num_read_desc_cmd_inflight(int max_num_read_desc_cmd_inflight);
+    void STDCALL set_auto_register_unsolicited(bool enable);
     size_t STDCALL get_end_station_count();
     end_station * STDCALL get_end_station_by_index(size_t end_station_index);
+    end_station * STDCALL get_end_station_by_entity_id(uint64_t entity_id);
+
+    ///
+    /// \return The End Station with the Entity ID, or NULL if there is none. The End Station is valid
+    ///         for the lifetime of the controller, but must be pinned to use its ADP and descriptors.
+    ///
+    end_station_imp * find_end_station_by_entity_id(uint64_t entity_id);
 
     ///
     /// Check if the corresponding End Station with the Entity ID exists.
@@ -108,6 +154,60 @@ public:
     uint32_t STDCALL missed_notification_count();
     uint32_t STDCALL missed_log_count();
 
+    int STDCALL set_end_station_eviction(uint32_t disconnected_timeout_ms);
+
+    uint64_t STDCALL evicted_end_station_count();
+
+    int STDCALL enable_command_trace(const char * file_path);
+    void STDCALL disable_command_trace();
+
+    size_t STDCALL get_connections(stream_connection * connections, size_t max_count);
+    size_t STDCALL get_talker_connections(uint64_t talker_entity_id, uint16_t talker_unique_id,
+                                          stream_connection * connections, size_t max_count);
+    bool STDCALL get_listener_connection(uint64_t listener_entity_id, uint16_t listener_unique_id,
+                                         stream_connection & connection);
+
+    int STDCALL send_bulk_query(bulk_query_target * targets, size_t target_count,
+                                size_t per_entity_window, size_t global_window,
+                                void (*completion_callback)(void *, bulk_query_target *, size_t),
+                                void * user_obj);
+    int STDCALL send_routing_matrix(const stream_connection * connections, size_t connection_count, size_t window,
+                                    void (*change_callback)(void *, const routing_change *),
+                                    void (*completion_callback)(void *, const routing_change *, size_t),
+                                    void * user_obj);
+
+    int STDCALL start_firmware_rollout(const uint64_t * entity_ids, size_t entity_count,
+                                       const firmware_rollout_config & config, void * notification_id);
+    void STDCALL abort_firmware_rollout();
+    size_t STDCALL get_firmware_rollout_status(firmware_rollout_entity_status * entity_status, size_t max_count);
+
+    int STDCALL start_counter_polling(const counter_poll_target * targets, size_t target_count, const counter_poll_config & config);
+    void STDCALL stop_counter_polling();
+    size_t STDCALL get_counter_samples(uint64_t entity_id, uint16_t desc_type, uint16_t desc_index,
+                                       counter_sample * samples, size_t max_count);
+    int STDCALL set_cmd_retry_policy(const cmd_retry_policy & policy);
+    size_t STDCALL get_rtt_estimates(rtt_estimate * estimates, size_t max_count);
+    int STDCALL set_circuit_breaker(uint32_t timeout_threshold, uint32_t probe_interval_ms);
+    cmd_future * STDCALL create_cmd_future(cmd_future_callback callback, void * context);
+    void STDCALL set_cmd_executor(cmd_executor * executor);
+    int STDCALL start_frame_capture(const char * path, uint32_t ring_frames);
+    uint64_t STDCALL stop_frame_capture();
+
+    ///
+    /// Record an AECP command to the End Station that failed after its last resend timed out.
+    ///
+    void aecp_cmd_timed_out(uint64_t entity_id, void * notification_id);
+
+    ///
+    /// Record an ACMP command that failed after its last resend timed out.
+    ///
+    void acmp_cmd_timed_out(void * notification_id);
+
+    ///
+    /// \return The notification ids of the commands that timed out during the last time_tick_event().
+    ///
+    const std::vector<void *> & timed_out_notification_ids();
+
     ///
     /// Check for End Station connection, command packet, and response packet timeouts.
     ///
@@ -121,7 +221,9 @@ public:
     ///
     /// Send queued packet to the AEM Controller State Machine.
     ///
-    void tx_packet_event(void * notification_id, uint32_t notification_flag, uint8_t * frame, size_t frame_len);
+    /// \return 0 if the command was sent, or AVDECC_LIB_STATUS_ENTITY_DEGRADED if it failed immediately.
+    ///
+    int tx_packet_event(void * notification_id, uint32_t notification_flag, uint8_t * frame, size_t frame_len, uint32_t priority);
 
     int STDCALL send_controller_avail_cmd(void * notification_id, uint32_t end_station_index);
 
@@ -132,6 +234,4 @@ public:
     ///
     int proc_controller_avail_resp(void *& notification_id, const uint8_t * frame, size_t frame_len, int & status);
 };
-
-extern controller_imp * controller_imp_ref;
 }
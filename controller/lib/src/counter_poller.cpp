@@ -0,0 +1,322 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * counter_poller.cpp
+ *
+ * Counter poller implementation
+ */
+
+#include <string.h>
+#include <algorithm>
+#include "jdksavdecc_aem_command.h"
+#include "enumeration.h"
+#include "log_imp.h"
+#include "controller_imp.h"
+#include "bulk_query.h"
+#include "system_tx_queue.h"
+#include "counter_poller.h"
+
+namespace avdecc_lib
+{
+counter_poller::counter_poller(controller_imp * controller_obj)
+    : m_controller(controller_obj), m_is_configured(false), m_limiter(NULL), m_inflight(0), m_now_ms(0)
+{
+    m_random.seed(m_clock.clk_convert_to_ms(m_clock.clk_monotonic()));
+    m_last_tick_ms = m_clock.clk_convert_to_ms(m_clock.clk_monotonic());
+    memset(&m_config, 0, sizeof(m_config));
+    memset(&m_new_config, 0, sizeof(m_new_config));
+}
+
+counter_poller::~counter_poller()
+{
+    for (size_t i = 0; i < m_targets.size(); i++)
+    {
+        if (m_targets[i].is_inflight)
+            cmd_completion_ref->unregister_id(&m_targets[i].query);
+    }
+    delete m_limiter;
+}
+
+bool counter_poller::is_supported(uint16_t desc_type)
+{
+    return desc_type == AEM_DESC_ENTITY || desc_type == AEM_DESC_AVB_INTERFACE ||
+           desc_type == AEM_DESC_CLOCK_DOMAIN || desc_type == AEM_DESC_STREAM_INPUT;
+}
+
+uint32_t counter_poller::counter_delta(uint32_t counter, uint32_t previous_counter)
+{
+    return counter - previous_counter;
+}
+
+float counter_poller::counter_rate(uint32_t delta, uint32_t interval_ms)
+{
+    return interval_ms ? delta * 1000.0f / interval_ms : 0.0f;
+}
+
+void counter_poller::configure(const counter_poll_target * targets, size_t target_count, const counter_poll_config & config)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_new_targets.assign(targets, targets + target_count);
+    m_new_config = config;
+    m_is_configured = true;
+}
+
+void counter_poller::tick()
+{
+    std::vector<size_t> to_send;
+    uint32_t now_ms = m_clock.clk_convert_to_ms(m_clock.clk_monotonic());
+
+    m_now_ms += now_ms - m_last_tick_ms;
+    m_last_tick_ms = now_ms;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (m_is_configured)
+            apply_config();
+    }
+
+    if (m_due.empty())
+        return;
+
+    m_limiter->refill();
+    select_targets(to_send);
+
+    for (size_t i = 0; i < to_send.size(); i++)
+    {
+        target & t = m_targets[to_send[i]];
+
+        // Polls are queued behind application commands
+        system_set_priority_for_next_cmd(&t.query, CMD_PRIORITY_BACKGROUND);
+        if (bulk_query::send_target(m_controller, t.query) == 0)
+            continue;
+
+        // The End Station or descriptor is gone, so try again at the next interval
+        system_clear_priority_for_next_cmd(&t.query);
+        cmd_completion_ref->unregister_id(&t.query);
+        std::lock_guard<std::mutex> guard(m_lock);
+        t.query.status = AVDECC_LIB_STATUS_INVALID;
+        t.is_inflight = false;
+        m_inflight--;
+    }
+}
+
+void counter_poller::apply_config()
+{
+    for (size_t i = 0; i < m_targets.size(); i++)
+    {
+        if (m_targets[i].is_inflight)
+            cmd_completion_ref->unregister_id(&m_targets[i].query);
+    }
+
+    m_config = m_new_config;
+    if ((m_config.max_cmds_per_sec == 0) || (m_config.max_cmds_per_sec > MAX_CMDS_PER_SEC))
+        m_config.max_cmds_per_sec = MAX_CMDS_PER_SEC;
+    delete m_limiter;
+    m_limiter = new rate_limiter(0, m_config.max_cmds_per_sec);
+
+    m_targets.clear();
+    m_target_indexes.clear();
+    m_due = due_queue();
+    m_inflight = 0;
+    m_now_ms = 0;
+
+    for (size_t i = 0; i < m_new_targets.size(); i++)
+    {
+        const counter_poll_target & new_target = m_new_targets[i];
+        target t;
+
+        if (!m_target_indexes.insert(target_map::value_type(key_of(new_target.entity_id, new_target.desc_type, new_target.desc_index),
+                                                            m_targets.size()))
+                 .second)
+            continue;
+
+        t.query.entity_id = new_target.entity_id;
+        t.query.desc_type = new_target.desc_type;
+        t.query.desc_index = new_target.desc_index;
+        t.query.cmd_type = AEM_CMD_GET_COUNTERS;
+        t.query.status = AVDECC_LIB_STATUS_INVALID;
+        t.interval_ms = interval_of(new_target.desc_type);
+        t.is_inflight = false;
+        t.sample_count = 0;
+        t.next_sample = 0;
+
+        // The first polls are spread over one interval
+        if (t.interval_ms)
+            m_due.push(due_poll(m_random() % t.interval_ms, m_targets.size()));
+        m_targets.push_back(t);
+    }
+
+    m_samples.clear();
+    m_samples.resize(m_targets.size() * m_config.history_length);
+    m_new_targets.clear();
+    m_is_configured = false;
+}
+
+uint32_t counter_poller::interval_of(uint16_t desc_type)
+{
+    switch (desc_type)
+    {
+    case AEM_DESC_ENTITY:
+        return m_config.entity_interval_ms;
+    case AEM_DESC_AVB_INTERFACE:
+        return m_config.avb_interface_interval_ms;
+    case AEM_DESC_CLOCK_DOMAIN:
+        return m_config.clock_domain_interval_ms;
+    case AEM_DESC_STREAM_INPUT:
+        return m_config.stream_input_interval_ms;
+    default:
+        return 0;
+    }
+}
+
+int64_t counter_poller::jitter()
+{
+    if (m_config.jitter_ms == 0)
+        return 0;
+
+    return (int64_t)(m_random() % (m_config.jitter_ms + 1)) - m_config.jitter_ms / 2;
+}
+
+void counter_poller::select_targets(std::vector<size_t> & to_send)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    to_send.clear();
+    while (!m_due.empty() && (m_due.top().first <= m_now_ms) && (m_inflight < MAX_INFLIGHT))
+    {
+        due_poll poll = m_due.top();
+        target & t = m_targets[poll.second];
+
+        // A poll that is throttled stays due until the next tick
+        if (!t.is_inflight && !m_limiter->try_acquire(0))
+            break;
+
+        // Scheduled from the due time so that the interval holds on average, unless the polls fell behind
+        uint64_t next_ms = poll.first + t.interval_ms;
+        if (next_ms <= m_now_ms)
+            next_ms = m_now_ms + t.interval_ms;
+        next_ms = std::max<int64_t>((int64_t)next_ms + jitter(), (int64_t)m_now_ms + 1);
+
+        m_due.pop();
+        m_due.push(due_poll(next_ms, poll.second));
+
+        // The last poll has not completed, so this one is skipped rather than queued behind it
+        if (t.is_inflight)
+            continue;
+
+        t.is_inflight = true;
+        m_inflight++;
+        cmd_completion_ref->register_id(&t.query, this);
+        to_send.push_back(poll.second);
+    }
+}
+
+void counter_poller::cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len)
+{
+    // The query is the first member of its target
+    target * t = reinterpret_cast<target *>(static_cast<bulk_query_target *>(notification_id));
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_targets.empty() || (t < &m_targets[0]) || (t >= &m_targets[0] + m_targets.size()) || !t->is_inflight)
+        return;
+
+    t->is_inflight = false;
+    t->query.status = status;
+    m_inflight--;
+
+    if ((status != AEM_STATUS_SUCCESS) || !frame ||
+        (frame_len < ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_GET_COUNTERS_RESPONSE_OFFSET_COUNTERS_BLOCK + 4 * COUNTERS_COUNT))
+        return;
+
+    // A response to a command sent for the previous targets
+    jdksavdecc_eui64 entity_id = jdksavdecc_common_control_header_get_stream_id(frame, ETHER_HDR_SIZE);
+    if ((jdksavdecc_uint64_get(&entity_id, 0) != t->query.entity_id) ||
+        (jdksavdecc_aem_command_get_counters_response_get_descriptor_type(frame, ETHER_HDR_SIZE) != t->query.desc_type) ||
+        (jdksavdecc_aem_command_get_counters_response_get_descriptor_index(frame, ETHER_HDR_SIZE) != t->query.desc_index))
+        return;
+
+    add_sample(*t, frame);
+}
+
+void counter_poller::add_sample(target & t, const uint8_t * frame)
+{
+    size_t history_length = m_config.history_length;
+    sample * ring = &m_samples[(&t - &m_targets[0]) * history_length];
+    const sample * previous = t.sample_count ? &ring[(t.next_sample + history_length - 1) % history_length] : NULL;
+    sample s;
+
+    s.timestamp_ms = (uint32_t)(m_now_ms + (uint32_t)(m_clock.clk_convert_to_ms(m_clock.clk_monotonic()) - m_last_tick_ms));
+    s.interval_ms = previous ? s.timestamp_ms - previous->timestamp_ms : 0;
+    s.counters_valid = jdksavdecc_uint32_get(frame, ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_GET_COUNTERS_RESPONSE_OFFSET_COUNTERS_VALID);
+    for (size_t i = 0; i < COUNTERS_COUNT; i++)
+    {
+        s.counters[i] = jdksavdecc_uint32_get(frame, ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_GET_COUNTERS_RESPONSE_OFFSET_COUNTERS_BLOCK + 4 * i);
+        s.deltas[i] = previous ? counter_delta(s.counters[i], previous->counters[i]) : 0;
+    }
+
+    ring[t.next_sample] = s;
+    t.next_sample = (t.next_sample + 1) % history_length;
+    if (t.sample_count < history_length)
+        t.sample_count++;
+}
+
+size_t counter_poller::get_samples(uint64_t entity_id, uint16_t desc_type, uint16_t desc_index, counter_sample * samples, size_t max_count)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    target_map::iterator it = m_target_indexes.find(key_of(entity_id, desc_type, desc_index));
+    if (it == m_target_indexes.end())
+        return 0;
+
+    const target & t = m_targets[it->second];
+    size_t history_length = m_config.history_length;
+    const sample * ring = &m_samples[it->second * history_length];
+    size_t count = std::min(t.sample_count, max_count);
+    size_t pos = (t.next_sample + history_length - count) % history_length;
+
+    for (size_t i = 0; i < count; i++, pos = (pos + 1) % history_length)
+    {
+        const sample & s = ring[pos];
+
+        samples[i].timestamp_ms = s.timestamp_ms;
+        samples[i].interval_ms = s.interval_ms;
+        samples[i].counters_valid = s.counters_valid;
+        for (size_t j = 0; j < COUNTERS_COUNT; j++)
+        {
+            samples[i].counters[j] = s.counters[j];
+            samples[i].deltas[j] = s.deltas[j];
+            samples[i].rates[j] = counter_rate(s.deltas[j], s.interval_ms);
+        }
+    }
+
+    return count;
+}
+
+counter_poller::target_map::key_type counter_poller::key_of(uint64_t entity_id, uint16_t desc_type, uint16_t desc_index)
+{
+    return target_map::key_type(entity_id, ((uint32_t)desc_type << 16) | desc_index);
+}
+}
@@ -0,0 +1,156 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * counter_poller.h
+ *
+ * Counter poller class, which sends GET_COUNTERS to a set of descriptors at the interval of
+ * their descriptor type and keeps a ring buffer of samples for each of them.
+ *
+ * Polls are scheduled, sent and completed on the lib thread, by tick() and by command
+ * completions. New targets are handed over by configure() and applied on the next tick, so
+ * that the targets are only changed on the lib thread.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <map>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+#include "controller.h"
+#include "cmd_completion.h"
+#include "rate_limiter.h"
+#include "timer.h"
+
+namespace avdecc_lib
+{
+class controller_imp;
+
+class counter_poller : public cmd_completion_handler
+{
+public:
+    enum
+    {
+        MAX_CMDS_PER_SEC = 10000, // Bounds the commands queued to the lib thread by the lib thread in one tick
+        MAX_INFLIGHT = 512,
+        COUNTERS_COUNT = 32
+    };
+
+    counter_poller(controller_imp * controller_obj);
+    ~counter_poller();
+
+    ///
+    /// \return True if the descriptor type has GET_COUNTERS.
+    ///
+    static bool is_supported(uint16_t desc_type);
+
+    ///
+    /// \return The change of a counter between two samples, modulo 2^32 so that a counter that
+    ///         wrapped around gives the count since the previous sample.
+    ///
+    static uint32_t counter_delta(uint32_t counter, uint32_t previous_counter);
+
+    ///
+    /// \return The change of a counter per second, or 0 for the first sample.
+    ///
+    static float counter_rate(uint32_t delta, uint32_t interval_ms);
+
+    ///
+    /// Replace the targets on the next tick. No targets stops polling.
+    ///
+    void configure(const counter_poll_target * targets, size_t target_count, const counter_poll_config & config);
+
+    ///
+    /// Called on the lib thread each timer tick to apply new targets and send the polls that are due.
+    ///
+    void tick();
+
+    size_t get_samples(uint64_t entity_id, uint16_t desc_type, uint16_t desc_index, counter_sample * samples, size_t max_count);
+
+    void cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len);
+
+private:
+    struct sample
+    {
+        uint32_t timestamp_ms;
+        uint32_t interval_ms;
+        uint32_t counters_valid;
+        uint32_t counters[COUNTERS_COUNT];
+        uint32_t deltas[COUNTERS_COUNT];
+    };
+
+    struct target
+    {
+        bulk_query_target query; // The notification id of its commands
+        uint32_t interval_ms;
+        bool is_inflight;
+        size_t sample_count;
+        size_t next_sample; // The ring buffer position of the next sample
+    };
+
+    typedef std::pair<uint64_t, size_t> due_poll; // The time a poll is due and the index of its target
+    typedef std::priority_queue<due_poll, std::vector<due_poll>, std::greater<due_poll>> due_queue;
+    typedef std::map<std::pair<uint64_t, uint32_t>, size_t> target_map;
+
+    controller_imp * m_controller;
+    timer m_clock;
+    std::minstd_rand m_random;
+
+    std::mutex m_lock; // Held by the lib thread while changing targets and samples, and by get_samples()
+    bool m_is_configured; // New targets are waiting to be applied
+    std::vector<counter_poll_target> m_new_targets;
+    counter_poll_config m_new_config;
+
+    counter_poll_config m_config;
+    rate_limiter * m_limiter;
+    std::vector<target> m_targets;
+    std::vector<sample> m_samples; // history_length samples for each target, in target order
+    target_map m_target_indexes;
+    due_queue m_due;
+    size_t m_inflight;
+    uint32_t m_last_tick_ms;
+    uint64_t m_now_ms; // Since polling was started
+
+    void apply_config();
+    uint32_t interval_of(uint16_t desc_type);
+
+    ///
+    /// \return A random offset of up to half the jitter either way.
+    ///
+    int64_t jitter();
+
+    ///
+    /// Take the due polls that the window and rate limit allow, and schedule their next polls.
+    ///
+    void select_targets(std::vector<size_t> & to_send);
+
+    void add_sample(target & t, const uint8_t * frame);
+
+    static target_map::key_type key_of(uint64_t entity_id, uint16_t desc_type, uint16_t desc_index);
+};
+}
@@ -60,8 +60,18 @@ descriptor_base_imp::~descriptor_base_imp()
     delete resp_ref;
 }
 
+void descriptor_base_imp::release_frames()
+{
+    delete resp_ref;
+    resp_ref = NULL;
+}
+
 descriptor_response_base * STDCALL descriptor_base_imp::get_descriptor_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp_base = new descriptor_response_base_imp(resp_ref->get_desc_buffer(), resp_ref->get_desc_size(),
                                                         resp_ref->get_desc_pos());
@@ -69,6 +79,10 @@ descriptor_response_base * STDCALL descriptor_base_imp::get_descriptor_response(
 
 descriptor_base_get_name_response * STDCALL descriptor_base_imp::get_name_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_NAME);
     if (!resp_frame)
@@ -177,6 +191,8 @@ int descriptor_base_imp::proc_acquire_entity_resp(void *& notification_id, const
 
 int descriptor_base_imp::default_send_acquire_entity_cmd(descriptor_base_imp * desc_base_imp_ref, void * notification_id, uint32_t acquire_entity_flag)
 {
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_acquire_entity aem_cmd_acquire_entity;
     ssize_t aem_cmd_acquire_entity_returned;
@@ -278,6 +294,8 @@ int descriptor_base_imp::proc_lock_entity_resp(void *& notification_id, const ui
 
 int descriptor_base_imp::default_send_lock_entity_cmd(descriptor_base_imp * descriptor_base_imp_ref, void * notification_id, uint32_t lock_entity_flag)
 {
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_lock_entity aem_cmd_lock_entity;
     ssize_t aem_cmd_lock_entity_returned;
@@ -378,6 +396,8 @@ int descriptor_base_imp::proc_reboot_resp(void *& notification_id, const uint8_t
 
 int descriptor_base_imp::default_send_reboot_cmd(descriptor_base_imp * descriptor_base_imp_ref, void * notification_id)
 {
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_reboot aem_cmd_reboot;
     memset(&aem_cmd_reboot, 0, sizeof(aem_cmd_reboot));
@@ -450,6 +470,10 @@ int descriptor_base_imp::default_proc_reboot_resp(struct jdksavdecc_aem_command_
 
 int STDCALL descriptor_base_imp::send_set_name_cmd(void * notification_id, uint16_t name_index, uint16_t config_index, const struct avdecc_lib_name_string64 * name)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
     return default_send_set_name_cmd(this, notification_id, name_index, config_index, name);
 }
 
@@ -461,6 +485,8 @@ int descriptor_base_imp::proc_set_name_resp(void *& notification_id, const uint8
 
 int descriptor_base_imp::default_send_set_name_cmd(descriptor_base_imp * desc_base_imp_ref, void * notification_id, uint16_t name_index, uint16_t config_index, const struct avdecc_lib_name_string64 * name)
 {
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_set_name aem_cmd_set_name;
     ssize_t aem_cmd_set_name_returned;
@@ -536,6 +562,8 @@ int descriptor_base_imp::default_proc_set_name_resp(struct jdksavdecc_aem_comman
         uint8_t * buffer;
         desc_type = jdksavdecc_aem_command_set_name_response_get_descriptor_type(frame, ETHER_HDR_SIZE);
 
+        store_cmd_resp_frame(AEM_CMD_GET_NAME, frame, ETHER_HDR_SIZE, frame_len); // Same layout as the GET_NAME response
+
         if (desc_type == AEM_DESC_ENTITY)
         {
             buffer = (uint8_t *)malloc(resp_ref->get_desc_size() * sizeof(uint8_t)); //fetch current desc frame
@@ -573,6 +601,8 @@ int descriptor_base_imp::default_proc_set_name_resp(struct jdksavdecc_aem_comman
 
 int descriptor_base_imp::default_send_get_name_cmd(descriptor_base_imp * desc_base_imp_ref, void * notification_id, uint16_t name_index, uint16_t config_index)
 {
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_name aem_cmd_get_name;
     ssize_t aem_cmd_get_name_returned;
@@ -650,6 +680,10 @@ int descriptor_base_imp::default_proc_get_name_resp(struct jdksavdecc_aem_comman
 
 int STDCALL descriptor_base_imp::send_get_name_cmd(void * notification_id, uint16_t name_index, uint16_t config_index)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
     return default_send_get_name_cmd(this, notification_id, name_index, config_index);
 }
 
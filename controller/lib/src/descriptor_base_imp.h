@@ -112,6 +112,13 @@ public:
     ///
     virtual void STDCALL replace_desc_frame(const uint8_t * frame, ssize_t pos, size_t size);
 
+    ///
+    /// Free the frames of the descriptor once its End Station has been evicted. The descriptor is
+    /// kept for the handles the application holds, and its calls fail as the End Station can no
+    /// longer be pinned.
+    ///
+    virtual void release_frames();
+
     ///
     /// Get the flags after sending a ACQUIRE_ENTITY command and receiving a response back for the command.
     ///
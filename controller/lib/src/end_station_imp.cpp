@@ -29,6 +29,7 @@
 
 #include <vector>
 #include <cstring>
+#include <algorithm>
 #include "avdecc_error.h"
 #include "enumeration.h"
 #include "notification_imp.h"
@@ -38,8 +39,10 @@
 #include "acmp_controller_state_machine.h"
 #include "aecp_controller_state_machine.h"
 #include "system_tx_queue.h"
+#include "cmd_trace.h"
 #include "jdksavdecc.h"
 #include "jdksavdecc_aecp_milan_vendor_unique.h"
+#include "address_access_batch.h"
 #include "end_station_imp.h"
 
 namespace avdecc_lib
@@ -47,6 +50,7 @@ namespace avdecc_lib
 end_station_imp::end_station_imp(const uint8_t * frame, size_t frame_len)
 {
     end_station_connection_status = ' ';
+    m_context = current_context(); // End Stations are created on the event thread of their controller
     adp_ref = new adp(frame, frame_len);
     struct jdksavdecc_eui64 entity_id;
     entity_id = adp_ref->get_entity_entity_id();
@@ -54,12 +58,15 @@ end_station_imp::end_station_imp(const uint8_t * frame, size_t frame_len)
     milan_protocol_version = 0;
     utility::convert_eui48_to_uint64(adp_ref->get_src_addr().value, end_station_mac);
     m_max_num_read_desc_cmd_inflight = -1;
+    m_auto_register_unsolicited = false;
+    m_is_evicted = false;
+    m_pin_count = 0;
     end_station_init();
 }
 
 end_station_imp::~end_station_imp()
 {
-    delete adp_ref;
+    release_contents();
 
     for (uint32_t entity_vec_index = 0; entity_vec_index < entity_desc_vec.size(); entity_vec_index++)
     {
@@ -67,12 +74,31 @@ end_station_imp::~end_station_imp()
     }
 }
 
+void end_station_imp::release_contents()
+{
+    delete adp_ref;
+    adp_ref = NULL;
+
+    for (uint32_t entity_vec_index = 0; entity_vec_index < entity_desc_vec.size(); entity_vec_index++)
+    {
+        entity_desc_vec.at(entity_vec_index)->release_frames();
+    }
+
+    for (std::list<background_read_request *>::iterator it = m_background_read_pending.begin(); it != m_background_read_pending.end(); ++it)
+        delete *it;
+    m_background_read_pending.clear();
+    for (std::list<background_read_request *>::iterator it = m_background_read_inflight.begin(); it != m_background_read_inflight.end(); ++it)
+        delete *it;
+    m_background_read_inflight.clear();
+}
+
 int end_station_imp::end_station_init()
 {
     current_entity_desc = 0;
     current_config_desc = 0;
     m_is_enumerated = false;
 
+    cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_BEGIN, "enumeration", "enumerate", end_station_entity_id, end_station_entity_id);
     read_desc_init(JDKSAVDECC_DESCRIPTOR_ENTITY, 0);
 
     return 0;
@@ -95,6 +121,11 @@ const char STDCALL end_station_imp::get_connection_status() const
     return end_station_connection_status;
 }
 
+controller_context * end_station_imp::context()
+{
+    return m_context;
+}
+
 void end_station_imp::set_connected()
 {
     end_station_connection_status = 'C';
@@ -103,6 +134,66 @@ void end_station_imp::set_connected()
 void end_station_imp::set_disconnected()
 {
     end_station_connection_status = 'D';
+    m_disconnected_timer.start(0);
+}
+
+uint32_t end_station_imp::disconnected_ms()
+{
+    return m_disconnected_timer.elapsed_ms();
+}
+
+bool end_station_imp::pin()
+{
+    std::lock_guard<std::mutex> guard(m_evict_lock);
+
+    if (m_is_evicted)
+        return false;
+
+    m_pin_count++;
+    return true;
+}
+
+void end_station_imp::unpin()
+{
+    std::lock_guard<std::mutex> guard(m_evict_lock);
+    m_pin_count--;
+}
+
+bool end_station_imp::try_evict()
+{
+    std::lock_guard<std::mutex> guard(m_evict_lock);
+
+    if (m_pin_count)
+        return false;
+
+    m_is_evicted = true;
+    return true;
+}
+
+bool end_station_imp::is_evicted()
+{
+    std::lock_guard<std::mutex> guard(m_evict_lock);
+    return m_is_evicted;
+}
+
+void end_station_imp::log_evicted(const char * call)
+{
+    context_scope scope(m_context);
+
+    log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "%s error: End Station 0x%llx has been evicted",
+                              call, (unsigned long long)end_station_entity_id);
+}
+
+configuration_descriptor * end_station_imp::get_current_config()
+{
+    if (current_entity_desc >= entity_desc_vec.size())
+        return NULL;
+
+    entity_descriptor * entity = entity_desc_vec.at(current_entity_desc);
+    if (current_config_desc >= entity->config_desc_count())
+        return NULL;
+
+    return entity->get_config_desc_by_index(current_config_desc);
 }
     
 void STDCALL end_station_imp::set_max_num_read_desc_cmd_inflight(int max_num_read_desc_cmd_inflight)
@@ -110,6 +201,19 @@ void STDCALL end_station_imp::set_max_num_read_desc_cmd_inflight(int max_num_rea
     m_max_num_read_desc_cmd_inflight = max_num_read_desc_cmd_inflight;
 }
 
+void end_station_imp::set_auto_register_unsolicited(bool enable)
+{
+    m_auto_register_unsolicited = enable;
+    auto_register_unsolicited();
+}
+
+void end_station_imp::auto_register_unsolicited()
+{
+    // The responses are not reported to the application.
+    if (m_auto_register_unsolicited && m_is_enumerated)
+        send_register_unsolicited(NULL, CMD_WITHOUT_NOTIFICATION);
+}
+
 uint64_t STDCALL end_station_imp::entity_id()
 {
     return end_station_entity_id;
@@ -122,6 +226,10 @@ uint64_t STDCALL end_station_imp::mac()
     
 uint64_t STDCALL end_station_imp::get_gptp_grandmaster_id()
 {
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+        return 0;
+
     return adp_ref->get_gptp_grandmaster_id();
 }
 
@@ -132,6 +240,10 @@ adp * end_station_imp::get_adp()
 
 size_t STDCALL end_station_imp::entity_desc_count()
 {
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+        return 0;
+
     return entity_desc_vec.size();
 }
 
@@ -142,6 +254,13 @@ uint32_t STDCALL end_station_imp::get_milan_protocol_version()
 
 entity_descriptor * STDCALL end_station_imp::get_entity_desc_by_index(size_t entity_desc_index)
 {
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+    {
+        log_evicted("get_entity_desc_by_index");
+        return NULL;
+    }
+
     bool is_valid = (entity_desc_index < entity_desc_vec.size());
 
     if (is_valid)
@@ -163,11 +282,20 @@ int end_station_imp::read_desc_init(uint16_t desc_type, uint16_t desc_index, uin
 
 int STDCALL end_station_imp::send_read_desc_cmd(void * notification_id, uint16_t desc_type, uint16_t desc_index)
 {
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+    {
+        log_evicted("send_read_desc_cmd");
+        return -1;
+    }
+
     return send_read_desc_cmd_with_flag(notification_id, CMD_WITH_NOTIFICATION, desc_type, desc_index, current_config_desc);
 }
 
 int end_station_imp::send_read_desc_cmd_with_flag(void * notification_id, uint32_t notification_flag, uint16_t desc_type, uint16_t desc_index, uint16_t config_desc_index)
 {
+    context_scope scope(m_context);
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_read_descriptor aem_command_read_desc;
     memset(&aem_command_read_desc, 0, sizeof(aem_command_read_desc));
@@ -258,6 +386,12 @@ int end_station_imp::proc_read_desc_resp(void *& notification_id, const uint8_t
         return 0;
     }
 
+    if (!m_is_enumerated)
+    {
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "enumeration", utility::aem_desc_value_to_name(desc_type),
+                                        end_station_entity_id, end_station_entity_id, desc_index);
+    }
+
     bool store_descriptor = false;
     if (status == avdecc_lib::AEM_STATUS_SUCCESS)
     {
@@ -410,7 +544,15 @@ int end_station_imp::proc_read_desc_resp(void *& notification_id, const uint8_t
     {
         if (m_background_read_inflight.empty() && m_background_read_pending.empty())
         {
-            m_is_enumerated = true;
+            if (!m_is_enumerated)
+            {
+                cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_END, "enumeration", "enumerate", end_station_entity_id, end_station_entity_id);
+                query_stream_input_connections();
+                m_is_enumerated = true;
+
+                // Also after a reboot, detected from the available index, which re-enumerates the End Station
+                auto_register_unsolicited();
+            }
             notification_imp_ref->post_notification_msg(END_STATION_READ_COMPLETED, end_station_entity_id, 0, 0, 0, 0, 0, NULL);
         }
     }
@@ -418,6 +560,21 @@ int end_station_imp::proc_read_desc_resp(void *& notification_id, const uint8_t
     return 0;
 }
 
+void end_station_imp::query_stream_input_connections()
+{
+    configuration_descriptor * c = entity_desc_vec.at(current_entity_desc)->get_config_desc_by_index(current_config_desc);
+    if (!c)
+        return;
+
+    // The responses are seen by the controller connection graph; the application is not notified.
+    for (size_t i = 0; i < c->stream_input_desc_count(); i++)
+    {
+        stream_input_descriptor_imp * si = dynamic_cast<stream_input_descriptor_imp *>(c->get_stream_input_desc_by_index(i));
+        if (si)
+            si->send_get_rx_state(NULL, CMD_WITHOUT_NOTIFICATION);
+    }
+}
+
 void end_station_imp::background_read_update_timeouts(void)
 {
     std::list<background_read_request *>::iterator ii;
@@ -431,6 +588,7 @@ void end_station_imp::background_read_update_timeouts(void)
         if (b->m_timer.timeout())
         {
             log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Background read timeout reading descriptor %s index %d\n", utility::aem_desc_value_to_name(b->m_type), b->m_index);
+            cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "enumeration", "read_timeout", end_station_entity_id, end_station_entity_id, b->m_type);
             ii = m_background_read_inflight.erase(ii);
             delete b;
         }
@@ -468,6 +626,11 @@ void end_station_imp::background_read_update_inflight(uint16_t desc_type, void *
 
 void end_station_imp::background_read_submit_pending(void)
 {
+    // Background reads yield to interactive commands to the End Station, and are resumed by the
+    // next tick once the interactive commands have completed.
+    if (aecp_controller_state_machine_ref->is_inflight_cmd_with_priority(end_station_entity_id, CMD_PRIORITY_INTERACTIVE))
+        return;
+
     // if there are no pending inflight, but the background read list is not
     // empty submit the next set of read operations
     if (m_background_read_inflight.empty() && !m_background_read_pending.empty())
@@ -755,6 +918,15 @@ void end_station_imp::queue_background_read_request(uint16_t desc_type, uint16_t
 
 int STDCALL end_station_imp::send_entity_avail_cmd(void * notification_id)
 {
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+    {
+        log_evicted("send_entity_avail_cmd");
+        return -1;
+    }
+
+    context_scope scope(m_context);
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_entity_available aem_cmd_entity_avail;
     memset(&aem_cmd_entity_avail, 0, sizeof(aem_cmd_entity_avail));
@@ -1713,18 +1885,90 @@ int STDCALL end_station_imp::send_aecp_address_access_cmd(void * notification_id
                                                           uint64_t address,
                                                           uint8_t memory_data[])
 {
+    address_access_tlv tlv;
+
+    tlv.mode = (uint16_t)mode;
+    tlv.length = (uint16_t)length;
+    tlv.address = address;
+    tlv.data = memory_data;
+    tlv.status = AVDECC_LIB_STATUS_INVALID;
+
+    return send_aecp_address_access_tlvs(notification_id, &tlv, 1);
+}
+
+int STDCALL end_station_imp::send_aecp_address_access_batch(address_access_tlv * tlvs,
+                                                           size_t tlv_count,
+                                                           size_t window,
+                                                           void (*completion_callback)(void *, address_access_tlv *, size_t),
+                                                           void * user_obj)
+{
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+    {
+        log_evicted("send_aecp_address_access_batch");
+        return -1;
+    }
+
+    context_scope scope(m_context);
+
+    if ((tlv_count && !tlvs) || (window == 0))
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "send_aecp_address_access_batch error: invalid window or TLVs");
+        return -1;
+    }
+
+    for (size_t i = 0; i < tlv_count; i++)
+    {
+        if (tlvs[i].length > AECP_AA_MAX_TLV_DATA_LEN)
+        {
+            log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "send_aecp_address_access_batch error: TLV %d is longer than %d bytes",
+                                      (int)i, AECP_AA_MAX_TLV_DATA_LEN);
+            return -1;
+        }
+    }
+
+    address_access_batch * batch = new address_access_batch(this, tlvs, tlv_count,
+                                                            std::min<size_t>(window, address_access_batch::MAX_WINDOW),
+                                                            completion_callback, user_obj);
+    batch->start();
+
+    return 0;
+}
+
+int end_station_imp::send_aecp_address_access_tlvs(void * notification_id, const address_access_tlv * tlvs, size_t tlv_count)
+{
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+    {
+        log_evicted("send_aecp_address_access");
+        return -1;
+    }
+
+    context_scope scope(m_context);
+
     struct jdksavdecc_aecp_aa aecp_cmd_aa_header;
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aecp_aa_tlv aa_tlv;
+    size_t tlvs_length = 0;
     memset(&aecp_cmd_aa_header, 0, sizeof(aecp_cmd_aa_header));
 
+    // A read TLV carries only the length to read, the data comes back in the response
+    for (size_t i = 0; i < tlv_count; i++)
+        tlvs_length += JDKSAVDECC_AECPDU_AA_TLV_LEN + ((tlvs[i].mode == JDKSAVDECC_AECP_AA_MODE_READ) ? 0 : tlvs[i].length);
+
+    if (tlvs_length > AECP_AA_MAX_TLVS_LEN)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "ADDRESS_ACCESS TLVs of %d bytes do not fit in one command", (int)tlvs_length);
+        return -1;
+    }
+
     aecp_cmd_aa_header.controller_entity_id = adp_ref->get_controller_entity_id();
     aecp_cmd_aa_header.sequence_id = 0;
-    aecp_cmd_aa_header.tlv_count = 1;
+    aecp_cmd_aa_header.tlv_count = (uint16_t)tlv_count;
 
     aecp_controller_state_machine_ref->ether_frame_init(end_station_mac, &cmd_frame, ETHER_HDR_SIZE +
-                                                                                         JDKSAVDECC_AECPDU_AA_LEN + JDKSAVDECC_AECPDU_AA_TLV_LEN +
-                                                                                         (uint16_t)length);
+                                                                                         JDKSAVDECC_AECPDU_AA_LEN +
+                                                                                         (uint16_t)tlvs_length);
 
     ssize_t write_return_val = jdksavdecc_aecp_aa_write(&aecp_cmd_aa_header,
                                                         cmd_frame.payload,
@@ -1737,27 +1981,35 @@ int STDCALL end_station_imp::send_aecp_address_access_cmd(void * notification_id
         return -1;
     }
 
-    aa_tlv.mode_length = (uint16_t)(mode << 12) | (length & 0xFFF);
-    aa_tlv.address_upper = address >> 32;
-    aa_tlv.address_lower = address & 0xFFFFFFFF;
+    size_t tlv_offset = ETHER_HDR_SIZE + JDKSAVDECC_AECPDU_AA_LEN;
+    for (size_t i = 0; i < tlv_count; i++)
+    {
+        unsigned data_length = (tlvs[i].mode == JDKSAVDECC_AECP_AA_MODE_READ) ? 0 : tlvs[i].length;
 
-    write_return_val = jdksavdecc_aecp_aa_tlv_write(&aa_tlv,
-                                                    cmd_frame.payload,
-                                                    ETHER_HDR_SIZE + JDKSAVDECC_AECPDU_AA_LEN,
-                                                    sizeof(cmd_frame.payload));
+        aa_tlv.mode_length = (uint16_t)(tlvs[i].mode << 12) | (tlvs[i].length & 0xFFF);
+        aa_tlv.address_upper = tlvs[i].address >> 32;
+        aa_tlv.address_lower = tlvs[i].address & 0xFFFFFFFF;
 
-    if (write_return_val < 0)
-    {
-        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "jdksavdecc_aecp_aa_tlv_write error");
-        return -1;
-    }
+        write_return_val = jdksavdecc_aecp_aa_tlv_write(&aa_tlv,
+                                                        cmd_frame.payload,
+                                                        tlv_offset,
+                                                        sizeof(cmd_frame.payload));
+
+        if (write_return_val < 0)
+        {
+            log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "jdksavdecc_aecp_aa_tlv_write error");
+            return -1;
+        }
 
-    memcpy(&cmd_frame.payload[ETHER_HDR_SIZE + JDKSAVDECC_AECPDU_AA_LEN + JDKSAVDECC_AECPDU_AA_TLV_LEN], memory_data, length);
+        if (data_length)
+            memcpy(&cmd_frame.payload[tlv_offset + JDKSAVDECC_AECPDU_AA_TLV_LEN], tlvs[i].data, data_length);
+        tlv_offset += JDKSAVDECC_AECPDU_AA_TLV_LEN + data_length;
+    }
 
     aecp_controller_state_machine_ref->common_hdr_init(JDKSAVDECC_AECP_MESSAGE_TYPE_ADDRESS_ACCESS_COMMAND,
                                                        &cmd_frame,
                                                        end_station_entity_id,
-                                                       JDKSAVDECC_AECPDU_AA_LEN + JDKSAVDECC_AECPDU_AA_TLV_LEN + length -
+                                                       JDKSAVDECC_AECPDU_AA_LEN + tlvs_length -
                                                            JDKSAVDECC_COMMON_CONTROL_HEADER_LEN);
 
     system_queue_tx(notification_id, CMD_WITH_NOTIFICATION, cmd_frame.payload, cmd_frame.length);
@@ -1767,6 +2019,20 @@ int STDCALL end_station_imp::send_aecp_address_access_cmd(void * notification_id
 
 int STDCALL end_station_imp::send_register_unsolicited_cmd(void * notification_id)
 {
+    return send_register_unsolicited(notification_id, CMD_WITH_NOTIFICATION);
+}
+
+int end_station_imp::send_register_unsolicited(void * notification_id, uint32_t notification_flag)
+{
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+    {
+        log_evicted("send_register_unsolicited_cmd");
+        return -1;
+    }
+
+    context_scope scope(m_context);
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_register_unsolicited_notification aem_cmd_reg_unsolicited;
     ssize_t aem_cmd_reg_unsolicited_returned;
@@ -1797,7 +2063,7 @@ int STDCALL end_station_imp::send_register_unsolicited_cmd(void * notification_i
                                                        end_station_entity_id,
                                                        JDKSAVDECC_AEM_COMMAND_REGISTER_UNSOLICITED_NOTIFICATION_COMMAND_LEN -
                                                            JDKSAVDECC_COMMON_CONTROL_HEADER_LEN);
-    system_queue_tx(notification_id, CMD_WITH_NOTIFICATION, cmd_frame.payload, cmd_frame.length);
+    system_queue_tx(notification_id, notification_flag, cmd_frame.payload, cmd_frame.length);
 
     return 0;
 }
@@ -1836,6 +2102,15 @@ int end_station_imp::proc_register_unsolicited_resp(void *& notification_id, con
 
 int STDCALL end_station_imp::send_deregister_unsolicited_cmd(void * notification_id)
 {
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+    {
+        log_evicted("send_deregister_unsolicited_cmd");
+        return -1;
+    }
+
+    context_scope scope(m_context);
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_deregister_unsolicited_notification aem_cmd_dereg_unsolicited;
     ssize_t aem_cmd_dereg_unsolicited_returned;
@@ -1905,6 +2180,15 @@ int end_station_imp::proc_deregister_unsolicited_resp(void *& notification_id, c
 
 int STDCALL end_station_imp::send_milan_vendor_unique_cmd(void * notification_id)
 {
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+    {
+        log_evicted("send_milan_vendor_unique_cmd");
+        return -1;
+    }
+
+    context_scope scope(m_context);
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aecp_milan_vendor_unique cmd;
     ssize_t bytes = 0;
@@ -1972,6 +2256,15 @@ int end_station_imp::proc_milan_vendor_unique_resp(void *& notification_id, cons
 
 int STDCALL end_station_imp::send_identify(void * notification_id, bool turn_on)
 {
+    end_station_pin pin(this);
+    if (!pin.is_pinned())
+    {
+        log_evicted("send_identify");
+        return -1;
+    }
+
+    context_scope scope(m_context);
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_set_control aem_command_set_control;
     memset(&aem_command_set_control, 0, sizeof(aem_command_set_control));
@@ -2050,13 +2343,7 @@ int end_station_imp::proc_rcvd_aecp_aa_resp(void *& notification_id, const uint8
     status = jdksavdecc_common_control_header_get_status(frame, ETHER_HDR_SIZE);
 
     //uint16_t sequence_id = jdksavdecc_aecp_aa_get_sequence_id(frame, ETHER_HDR_SIZE);
-    uint16_t tlv_count = jdksavdecc_aecp_aa_get_tlv_count(frame, ETHER_HDR_SIZE);
-
-    if (tlv_count != 1)
-    {
-        // Do not currently support TLV counts > 1
-        notification_imp_ref->post_notification_msg(NO_MATCH_FOUND, 0, 0, 0, 0, 0, 0, 0);
-    }
+    // Responses with several TLVs are parsed by the address_access_batch that sent them
 
     const int tlv_data_offset = ETHER_HDR_SIZE + JDKSAVDECC_AECPDU_AA_LEN;
 
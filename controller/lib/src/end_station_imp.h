@@ -34,6 +34,7 @@
 #include "entity_descriptor_imp.h"
 #include "end_station.h"
 #include "timer.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
@@ -63,8 +64,14 @@ private:
     std::list<background_read_request *> m_background_read_pending;  // Store a list of background reads
     std::list<background_read_request *> m_background_read_inflight; // Store a list of background reads that are inflight
     int m_max_num_read_desc_cmd_inflight;                            // (Optional) The maximum number of read descriptor inflight cmds allowed
+    bool m_auto_register_unsolicited;                                // Register for unsolicited notifications once enumerated
 
+    timer m_disconnected_timer;                                      // Started when the End Station is disconnected
+    std::mutex m_evict_lock;                                         // Protects m_is_evicted and m_pin_count
+    bool m_is_evicted;                                               // Set once evicted, after which the commands of the End Station fail
+    uint32_t m_pin_count;                                            // The calls and operations that keep the End Station from being evicted
     adp * adp_ref;                                        // ADP associated with the End Station
+    controller_context * m_context;                       // The state of the controller that found the End Station
     std::vector<entity_descriptor_imp *> entity_desc_vec; // Store a list of ENTITY descriptor objects
 
     void queue_background_read_request(uint16_t desc_type, uint16_t desc_base_index, uint16_t count, uint16_t config_desc_index);               ///< Generate "count" read requests
@@ -72,6 +79,8 @@ private:
     void background_read_update_inflight(uint16_t desc_type, void * frame, ssize_t read_desc_offset);               ///< Remove rx'd frame from background read inflight list
 
     bool desc_index_from_frame(uint16_t desc_type, void * frame, ssize_t read_desc_offset, uint16_t & desc_index);
+    void query_stream_input_connections(); ///< Send GET_RX_STATE for each STREAM_INPUT to populate the connection graph
+    void log_evicted(const char * call);    ///< Log a call made on an evicted End Station
 
 public:
     end_station_imp(const uint8_t * frame, size_t frame_len);
@@ -80,7 +89,23 @@ public:
     std::mutex locker;
     const char STDCALL get_connection_status() const;
 
+    ///
+    /// \return The state of the controller that found the End Station.
+    ///
+    controller_context * context();
+
     void STDCALL set_max_num_read_desc_cmd_inflight(int max_num_read_desc_cmd_inflight);
+
+    ///
+    /// Register for unsolicited notifications, without notifying the application, each time
+    /// the End Station has been enumerated and when it reconnects.
+    ///
+    void set_auto_register_unsolicited(bool enable);
+
+    ///
+    /// Send REGISTER_UNSOLICITED_NOTIFICATION if automatic registration is enabled and the End Station is enumerated.
+    ///
+    void auto_register_unsolicited();
     
     ///
     /// Change the End Station connection status to connected.
@@ -92,6 +117,41 @@ public:
     ///
     void set_disconnected();
 
+    ///
+    /// \return The milliseconds since the End Station was disconnected.
+    ///
+    uint32_t disconnected_ms();
+
+    ///
+    /// Keep the End Station from being evicted while a call or an operation uses its ADP and descriptors.
+    ///
+    /// \return False if the End Station has been evicted, in which case it is not pinned.
+    ///
+    bool pin();
+    void unpin();
+
+    ///
+    /// Mark the End Station evicted unless it is pinned. An evicted End Station is kept as a tombstone
+    /// for the life of the controller, so that the handles the application holds stay valid, and its
+    /// calls fail. Its ADP and descriptor frames are freed with release_contents().
+    ///
+    /// \return True if the End Station has been evicted.
+    ///
+    bool try_evict();
+    bool is_evicted();
+
+    ///
+    /// Free the ADP and the descriptor frames of an evicted End Station, once nothing can read them.
+    /// The descriptors are kept, as the application may still hold them.
+    ///
+    void release_contents();
+
+    ///
+    /// \return The CONFIGURATION descriptor of the current ENTITY and CONFIGURATION, or NULL if it has not
+    ///         been read. The End Station must be pinned.
+    ///
+    configuration_descriptor * get_current_config();
+
     ///
     /// Re-enumerate the endpoint by re-reading the descriptors
     ///
@@ -116,6 +176,16 @@ public:
                                              unsigned length,
                                              uint64_t address,
                                              uint8_t memory_data[]);
+    int STDCALL send_aecp_address_access_batch(address_access_tlv * tlvs,
+                                               size_t tlv_count,
+                                               size_t window,
+                                               void (*completion_callback)(void *, address_access_tlv *, size_t),
+                                               void * user_obj);
+
+    ///
+    /// Send an ADDRESS_ACCESS command carrying the TLVs, which must fit in one AECPDU.
+    ///
+    int send_aecp_address_access_tlvs(void * notification_id, const address_access_tlv * tlvs, size_t tlv_count);
     int STDCALL send_identify(void * notification_id, bool turn_on);
     int proc_set_control_resp(void *& notification_id, const uint8_t * frame, size_t frame_len, int & status);
 
@@ -135,6 +205,11 @@ public:
     uint16_t STDCALL get_current_config_index() const;
 
     int STDCALL send_register_unsolicited_cmd(void * notification_id);
+
+    ///
+    /// Send a REGISTER_UNSOLICITED_NOTIFICATION command, optionally without notifying the application of the response.
+    ///
+    int send_register_unsolicited(void * notification_id, uint32_t notification_flag);
     int proc_register_unsolicited_resp(void *& notification_id, const uint8_t * frame, size_t frame_len, int & status);
 
     int STDCALL send_deregister_unsolicited_cmd(void * notification_id);
@@ -161,4 +236,31 @@ private:
     ///
     int send_read_desc_cmd_with_flag(void * notification_id, uint32_t notification_flag, uint16_t desc_type, uint16_t desc_index, uint16_t config_desc_index);
 };
+
+///
+/// Pin an End Station for the lifetime of the pin, unless it has been evicted.
+///
+class end_station_pin
+{
+public:
+    end_station_pin(end_station_imp * end_station) : m_end_station(end_station)
+    {
+        m_is_pinned = m_end_station->pin();
+    }
+
+    ~end_station_pin()
+    {
+        if (m_is_pinned)
+            m_end_station->unpin();
+    }
+
+    bool is_pinned() const
+    {
+        return m_is_pinned;
+    }
+
+private:
+    end_station_imp * m_end_station;
+    bool m_is_pinned;
+};
 }
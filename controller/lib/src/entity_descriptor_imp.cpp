@@ -48,13 +48,29 @@ entity_descriptor_imp::~entity_descriptor_imp()
         delete it->second;
 }
 
+void entity_descriptor_imp::release_frames()
+{
+    descriptor_base_imp::release_frames();
+
+    for (auto it = config_desc_map.begin(); it != config_desc_map.end(); it++)
+        it->second->release_frames();
+}
+
 uint16_t STDCALL entity_descriptor_imp::current_configuration()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return 0;
+
     return jdksavdecc_descriptor_entity_get_current_configuration(resp_ref->get_desc_buffer(), resp_ref->get_desc_pos());
 }
 
 entity_descriptor_response * STDCALL entity_descriptor_imp::get_entity_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new entity_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                      resp_ref->get_desc_size(), resp_ref->get_desc_pos());
@@ -62,6 +78,10 @@ entity_descriptor_response * STDCALL entity_descriptor_imp::get_entity_response(
     
 entity_descriptor_get_config_response * STDCALL entity_descriptor_imp::get_entity_get_config_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_CONFIGURATION);
     if (!resp_frame)
@@ -73,6 +93,10 @@ entity_descriptor_get_config_response * STDCALL entity_descriptor_imp::get_entit
     
 entity_counters_response * STDCALL entity_descriptor_imp::get_entity_counters_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); // mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_COUNTERS);
     if (!resp_frame)
@@ -132,6 +156,10 @@ uint64_t STDCALL entity_descriptor_imp::lock_entity_locked_entity_id()
 
 int STDCALL entity_descriptor_imp::send_acquire_entity_cmd(void * notification_id, uint32_t acquire_entity_flag)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
     return default_send_acquire_entity_cmd(this, notification_id, acquire_entity_flag);
 }
 
@@ -142,11 +170,19 @@ int entity_descriptor_imp::proc_acquire_entity_resp(void *& notification_id, con
 
 int STDCALL entity_descriptor_imp::send_lock_entity_cmd(void * notification_id, uint32_t lock_entity_flag)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
     return default_send_lock_entity_cmd(this, notification_id, lock_entity_flag);
 }
 
 int STDCALL entity_descriptor_imp::send_reboot_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
     return default_send_reboot_cmd(this, notification_id);
 }
 
@@ -162,6 +198,12 @@ int entity_descriptor_imp::proc_reboot_resp(void *& notification_id, const uint8
 
 int STDCALL entity_descriptor_imp::send_set_config_cmd(void * notification_id, uint16_t new_configuration_index)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_set_configuration aem_cmd_set_configuration;
     ssize_t aem_cmd_set_configuration_returned;
@@ -244,6 +286,12 @@ int entity_descriptor_imp::proc_set_config_resp(void *& notification_id, const u
 
 int STDCALL entity_descriptor_imp::send_get_config_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_configuration aem_cmd_get_configuration;
     ssize_t aem_cmd_get_configuration_returned;
@@ -314,6 +362,12 @@ int entity_descriptor_imp::proc_get_config_resp(void *& notification_id, const u
     
 int STDCALL entity_descriptor_imp::send_get_counters_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_counters aem_cmd_get_entity_counters;
     memset(&aem_cmd_get_entity_counters, 0, sizeof(aem_cmd_get_entity_counters));
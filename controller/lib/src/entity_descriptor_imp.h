@@ -50,6 +50,8 @@ public:
     entity_descriptor_imp(end_station_imp * end_station_obj, const uint8_t * frame, ssize_t pos, size_t frame_len);
     virtual ~entity_descriptor_imp();
 
+    void release_frames();
+
     entity_descriptor_response_imp * resp;
     entity_counters_response_imp * counters_resp;
     entity_descriptor_get_config_response_imp * get_config_resp;
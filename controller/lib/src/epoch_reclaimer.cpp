@@ -0,0 +1,103 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * epoch_reclaimer.cpp
+ *
+ * Epoch based deferred freeing implementation
+ */
+
+#include "epoch_reclaimer.h"
+
+namespace avdecc_lib
+{
+epoch_reclaimer::epoch_reclaimer()
+{
+    m_epoch = 0;
+    m_readers[0] = 0;
+    m_readers[1] = 0;
+}
+
+epoch_reclaimer::~epoch_reclaimer()
+{
+    for (size_t i = 0; i < m_retired.size(); i++)
+        m_retired[i].fn(m_retired[i].obj);
+}
+
+uint32_t epoch_reclaimer::enter()
+{
+    for (;;)
+    {
+        uint32_t epoch = m_epoch.load();
+
+        m_readers[epoch & 1]++;
+
+        // The epoch may have advanced before the reader was counted, in which case the
+        // reclaiming thread may not have seen the reader.
+        if (m_epoch.load() == epoch)
+            return epoch;
+
+        m_readers[epoch & 1]--;
+    }
+}
+
+void epoch_reclaimer::leave(uint32_t epoch)
+{
+    m_readers[epoch & 1]--;
+}
+
+void epoch_reclaimer::retire(free_fn fn, void * obj, uint32_t hold_ms)
+{
+    retired_obj r;
+
+    r.fn = fn;
+    r.obj = obj;
+    r.epoch = m_epoch.load();
+    r.hold_timer.start(hold_ms);
+    m_retired.push_back(r);
+}
+
+void epoch_reclaimer::reclaim()
+{
+    uint32_t epoch = m_epoch.load();
+
+    if (m_retired.empty())
+        return;
+
+    // Readers of epoch - 1 share a counter with readers of epoch + 1, so the epoch
+    // only advances once they have left.
+    if (m_readers[(epoch + 1) & 1].load() == 0)
+        m_epoch.store(++epoch);
+
+    // Readers of the epoch an object was retired in have left once the epoch is two ahead.
+    size_t kept = 0;
+    for (size_t i = 0; i < m_retired.size(); i++)
+    {
+        if ((epoch - m_retired[i].epoch >= 2) && m_retired[i].hold_timer.timeout())
+            m_retired[i].fn(m_retired[i].obj);
+        else
+            m_retired[kept++] = m_retired[i];
+    }
+    m_retired.resize(kept);
+}
+}
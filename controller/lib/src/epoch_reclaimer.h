@@ -0,0 +1,109 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * epoch_reclaimer.h
+ *
+ * Epoch based deferred freeing of objects that lock-free readers may still hold.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+#include "timer.h"
+
+namespace avdecc_lib
+{
+///
+/// Objects are retired by a single reclaiming thread once they are no longer reachable, and freed
+/// after every reader that entered before they were retired has left, and a hold time has passed.
+///
+class epoch_reclaimer
+{
+public:
+    typedef void (*free_fn)(void * obj);
+
+    epoch_reclaimer();
+
+    ///
+    /// Free every object retired, which requires that no readers are left.
+    ///
+    ~epoch_reclaimer();
+
+    ///
+    /// Enter a read section, in which retired objects are not freed.
+    ///
+    /// \return The epoch to pass to leave().
+    ///
+    uint32_t enter();
+
+    void leave(uint32_t epoch);
+
+    ///
+    /// Free an object that is no longer reachable once no reader can hold it, and at least hold_ms later.
+    ///
+    void retire(free_fn fn, void * obj, uint32_t hold_ms);
+
+    ///
+    /// Advance the epoch if the readers of the previous epoch have left, and free the objects that
+    /// can no longer be held. Called periodically by the reclaiming thread.
+    ///
+    void reclaim();
+
+private:
+    struct retired_obj
+    {
+        free_fn fn;
+        void * obj;
+        uint32_t epoch; // The epoch the object was retired in
+        timer hold_timer;
+    };
+
+    std::atomic<uint32_t> m_epoch;
+    std::atomic<uint32_t> m_readers[2]; // The readers that entered in even and odd epochs
+    std::vector<retired_obj> m_retired; // Only used by the reclaiming thread
+};
+
+///
+/// Read section of an epoch_reclaimer for the lifetime of the guard.
+///
+class epoch_guard
+{
+public:
+    epoch_guard(epoch_reclaimer & reclaimer) : m_reclaimer(reclaimer)
+    {
+        m_epoch = m_reclaimer.enter();
+    }
+
+    ~epoch_guard()
+    {
+        m_reclaimer.leave(m_epoch);
+    }
+
+private:
+    epoch_reclaimer & m_reclaimer;
+    uint32_t m_epoch;
+};
+}
@@ -43,6 +43,10 @@ external_port_output_descriptor_imp::~external_port_output_descriptor_imp() {}
 
 external_port_output_descriptor_response * STDCALL external_port_output_descriptor_imp::get_external_port_output_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new external_port_output_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                                    resp_ref->get_desc_size(), resp_ref->get_desc_pos());
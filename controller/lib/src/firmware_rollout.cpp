@@ -0,0 +1,591 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * firmware_rollout.cpp
+ *
+ * Firmware rollout implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <algorithm>
+#include "jdksavdecc_aem_command.h"
+#include "enumeration.h"
+#include "util.h"
+#include "notification_imp.h"
+#include "log_imp.h"
+#include "end_station.h"
+#include "entity_descriptor.h"
+#include "configuration_descriptor.h"
+#include "memory_object_descriptor.h"
+#include "memory_object_descriptor_response.h"
+#include "end_station_imp.h"
+#include "controller_imp.h"
+#include "firmware_rollout.h"
+
+namespace avdecc_lib
+{
+static const char state_file_header[] = "avdecc-lib firmware rollout";
+
+firmware_rollout::firmware_rollout(controller_imp * controller_obj, const firmware_rollout_config & config, void * notification_id)
+    : m_controller(controller_obj), m_config(config), m_notification_id(notification_id), m_image_hash(0), m_limiter(NULL),
+      m_next_entity(0), m_is_aborting(false), m_is_finished(false), m_is_state_changed(false), m_percent_complete(0)
+{
+    uint32_t max_packets_per_sec = config.max_packets_per_sec;
+
+    if (config.image_path)
+        m_image_path = config.image_path;
+    if (config.state_file_path)
+        m_state_file_path = config.state_file_path;
+    m_config.image_path = m_image_path.c_str();
+    m_config.state_file_path = m_state_file_path.c_str();
+
+    if (m_config.per_entity_window == 0)
+        m_config.per_entity_window = 1;
+    m_config.per_entity_window = std::min<size_t>(m_config.per_entity_window, memory_object_transfer::MAX_WINDOW);
+
+    // The writes are sent from the lib thread, so they are capped to keep its transmit queue from filling
+    if (max_packets_per_sec == 0 || max_packets_per_sec > MAX_PACKETS_PER_SEC)
+        max_packets_per_sec = MAX_PACKETS_PER_SEC;
+    m_limiter = new rate_limiter(config.max_bytes_per_sec, max_packets_per_sec);
+}
+
+firmware_rollout::~firmware_rollout()
+{
+    for (size_t i = 0; i < m_entities.size(); i++)
+    {
+        cmd_completion_ref->unregister_id(&m_entities[i]);
+        delete m_entities[i].upload;
+    }
+    delete m_limiter;
+}
+
+int firmware_rollout::open(const uint64_t * entity_ids, size_t entity_count)
+{
+    if (m_image.open(m_config.image_path) != 0 || m_image.size() == 0)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Unable to map firmware image %s", m_config.image_path);
+        return -1;
+    }
+
+    // FNV-1a, to tell whether the state file was written for this image
+    const uint8_t * data = m_image.data();
+    m_image_hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < m_image.size(); i++)
+    {
+        m_image_hash ^= data[i];
+        m_image_hash *= 0x100000001b3ULL;
+    }
+
+    m_entities.resize(entity_count);
+    for (size_t i = 0; i < entity_count; i++)
+    {
+        entity & e = m_entities[i];
+        e.entity_id = entity_ids[i];
+        e.state = FIRMWARE_ROLLOUT_PENDING;
+        e.resume_state = FIRMWARE_ROLLOUT_PENDING;
+        e.resume_offset = 0;
+        e.percent_complete = 0;
+        e.status = AEM_STATUS_SUCCESS;
+        e.is_operation_running = false;
+        e.end_station = NULL;
+        e.start_address = 0;
+        e.upload = NULL;
+    }
+
+    load_state_file();
+
+    for (size_t i = 0; i < m_entities.size(); i++)
+    {
+        if (m_entities[i].resume_state == FIRMWARE_ROLLOUT_DONE)
+        {
+            m_entities[i].state = FIRMWARE_ROLLOUT_DONE;
+            m_entities[i].percent_complete = 100;
+        }
+    }
+
+    m_save_timer.start(STATE_FILE_SAVE_INTERVAL_MS);
+    return 0;
+}
+
+void firmware_rollout::tick()
+{
+    bool is_idle = true;
+    bool is_wave_failed = false;
+
+    if (m_is_finished)
+        return;
+
+    m_limiter->refill();
+
+    for (size_t i = 0; i < m_wave.size(); i++)
+    {
+        entity & e = m_entities[m_wave[i]];
+
+        if (e.upload)
+            e.upload->resume();
+
+        if (e.state == FIRMWARE_ROLLOUT_ERASING && e.erase_timer.timeout())
+        {
+            log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Firmware rollout erase timed out on 0x%" PRIx64, e.entity_id);
+            cmd_completion_ref->unregister_id(&e);
+            fail(m_wave[i], AVDECC_LIB_STATUS_TICK_TIMEOUT);
+        }
+
+        if (e.state == FIRMWARE_ROLLOUT_FAILED)
+            is_wave_failed = true;
+        else if (e.state != FIRMWARE_ROLLOUT_DONE && e.state != FIRMWARE_ROLLOUT_SKIPPED)
+            is_idle = false;
+    }
+
+    if (is_idle)
+    {
+        bool is_aborting;
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            is_aborting = m_is_aborting;
+        }
+
+        if (is_aborting || (is_wave_failed && m_config.stop_on_wave_failure))
+            skip_pending();
+        else
+            start_wave();
+    }
+
+    uint32_t percent_complete = 0;
+    size_t failed_count = 0;
+    bool is_finished = m_next_entity == m_entities.size();
+    for (size_t i = 0; i < m_entities.size(); i++)
+    {
+        switch (m_entities[i].state)
+        {
+        case FIRMWARE_ROLLOUT_FAILED:
+            failed_count++;
+        // fall through
+        case FIRMWARE_ROLLOUT_DONE:
+        case FIRMWARE_ROLLOUT_SKIPPED:
+            percent_complete += 100;
+            break;
+        default:
+            percent_complete += m_entities[i].percent_complete;
+            is_finished = false;
+            break;
+        }
+    }
+    percent_complete = m_entities.empty() ? 100 : (uint32_t)(percent_complete / m_entities.size());
+
+    if (percent_complete != m_percent_complete)
+    {
+        m_percent_complete = percent_complete;
+        notification_imp_ref->post_notification_msg(FIRMWARE_ROLLOUT_PROGRESS, 0, 0, 0, AEM_DESC_MEMORY_OBJECT,
+                                                    m_config.memory_object_index, percent_complete, m_notification_id);
+    }
+
+    if (m_is_state_changed && (is_finished || m_save_timer.timeout()))
+    {
+        save_state_file();
+        m_is_state_changed = false;
+        m_save_timer.start(STATE_FILE_SAVE_INTERVAL_MS);
+    }
+
+    if (is_finished)
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_is_finished = true;
+        }
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_NOTICE, "Firmware rollout finished, %d of %d End Stations failed",
+                                  (int)failed_count, (int)m_entities.size());
+        notification_imp_ref->post_notification_msg(FIRMWARE_ROLLOUT_COMPLETED, 0, 0, 0, AEM_DESC_MEMORY_OBJECT,
+                                                    m_config.memory_object_index, (uint32_t)failed_count, m_notification_id);
+    }
+}
+
+void firmware_rollout::abort()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_is_aborting = true;
+}
+
+bool firmware_rollout::is_finished()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_is_finished;
+}
+
+size_t firmware_rollout::get_status(firmware_rollout_entity_status * entity_status, size_t max_count)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    for (size_t i = 0; i < m_entities.size() && i < max_count; i++)
+    {
+        entity_status[i].entity_id = m_entities[i].entity_id;
+        entity_status[i].state = m_entities[i].state;
+        entity_status[i].percent_complete = m_entities[i].percent_complete;
+        entity_status[i].status = m_entities[i].status;
+    }
+
+    return m_entities.size();
+}
+
+void firmware_rollout::start_wave()
+{
+    size_t wave_size = m_config.wave_size ? m_config.wave_size : m_entities.size();
+
+    m_wave.clear();
+    while (m_next_entity < m_entities.size() && m_wave.size() < wave_size)
+    {
+        size_t index = m_next_entity++;
+
+        // End Stations upgraded in an earlier run are not part of any wave
+        if (m_entities[index].state != FIRMWARE_ROLLOUT_PENDING)
+            continue;
+
+        m_wave.push_back(index);
+    }
+
+    for (size_t i = 0; i < m_wave.size(); i++)
+        start_entity(m_wave[i]);
+}
+
+void firmware_rollout::start_entity(size_t index)
+{
+    entity & e = m_entities[index];
+    end_station_imp * end_station_obj = m_controller->find_end_station_by_entity_id(e.entity_id);
+
+    memory_object_descriptor * memory_object = NULL;
+    if (end_station_obj)
+    {
+        end_station_pin pin(end_station_obj);
+        configuration_descriptor * configuration = pin.is_pinned() ? end_station_obj->get_current_config() : NULL;
+
+        if (end_station_obj->get_connection_status() == 'C' && configuration)
+        {
+            e.end_station = end_station_obj;
+            memory_object = configuration->get_memory_object_desc_by_index(m_config.memory_object_index);
+        }
+    }
+
+    if (!memory_object)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Firmware rollout unable to find memory object %d on 0x%" PRIx64,
+                                  m_config.memory_object_index, e.entity_id);
+        fail(index, AVDECC_LIB_STATUS_INVALID);
+        return;
+    }
+
+    memory_object_descriptor_response * memory_object_resp = memory_object->get_memory_object_response();
+    e.start_address = memory_object_resp->start_address();
+    delete memory_object_resp;
+
+    switch (e.resume_state)
+    {
+    case FIRMWARE_ROLLOUT_UPLOADING:
+        start_upload(index, e.resume_offset);
+        break;
+
+    case FIRMWARE_ROLLOUT_REBOOTING:
+        start_reboot(index);
+        break;
+
+    default:
+        set_state(index, FIRMWARE_ROLLOUT_ERASING, 0, AEM_STATUS_SUCCESS);
+        e.is_operation_running = false;
+        e.erase_timer.start(ERASE_TIMEOUT_MS);
+        cmd_completion_ref->register_id(&e, this);
+        if (memory_object->start_operation_cmd(&e, JDKSAVDECC_MEMORY_OBJECT_OPERATION_ERASE) != 0)
+        {
+            cmd_completion_ref->unregister_id(&e);
+            fail(index, AVDECC_LIB_STATUS_INVALID);
+        }
+        break;
+    }
+}
+
+void firmware_rollout::start_upload(size_t index, uint64_t offset)
+{
+    entity & e = m_entities[index];
+
+    e.erase_timer.stop();
+    e.resume_state = FIRMWARE_ROLLOUT_UPLOADING;
+    e.resume_offset = offset;
+    set_state(index, FIRMWARE_ROLLOUT_UPLOADING, (uint16_t)(10 + offset * 85 / m_image.size()), AEM_STATUS_SUCCESS);
+
+    e.upload = new memory_object_upload(e.end_station, m_config.memory_object_index, e.start_address,
+                                        m_config.per_entity_window, &e, this);
+    e.upload->set_image(m_image.data(), m_image.size());
+    e.upload->set_rate_limiter(m_limiter);
+    e.upload->start(offset);
+}
+
+void firmware_rollout::start_reboot(size_t index)
+{
+    entity & e = m_entities[index];
+    entity_descriptor * entity_desc = NULL;
+
+    e.resume_state = FIRMWARE_ROLLOUT_REBOOTING;
+    set_state(index, FIRMWARE_ROLLOUT_REBOOTING, 95, AEM_STATUS_SUCCESS);
+
+    if (e.end_station)
+        entity_desc = e.end_station->get_entity_desc_by_index(e.end_station->get_current_entity_index());
+
+    cmd_completion_ref->register_id(&e, this);
+    if (!entity_desc || entity_desc->send_reboot_cmd(&e) != 0)
+    {
+        cmd_completion_ref->unregister_id(&e);
+        fail(index, AVDECC_LIB_STATUS_INVALID);
+    }
+}
+
+void firmware_rollout::set_state(size_t index, uint16_t state, uint16_t percent_complete, int32_t status)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    entity & e = m_entities[index];
+
+    e.state = state;
+    e.percent_complete = percent_complete;
+    e.status = status;
+    m_is_state_changed = true;
+}
+
+void firmware_rollout::fail(size_t index, int32_t status)
+{
+    log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Firmware rollout failed on 0x%" PRIx64 " while %s, status %s",
+                              m_entities[index].entity_id,
+                              utility::firmware_rollout_state_value_to_name(m_entities[index].state),
+                              utility::aem_cmd_status_value_to_name(status));
+    set_state(index, FIRMWARE_ROLLOUT_FAILED, m_entities[index].percent_complete, status);
+}
+
+void firmware_rollout::skip_pending()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    for (; m_next_entity < m_entities.size(); m_next_entity++)
+    {
+        if (m_entities[m_next_entity].state == FIRMWARE_ROLLOUT_PENDING)
+        {
+            m_entities[m_next_entity].state = FIRMWARE_ROLLOUT_SKIPPED;
+            m_is_state_changed = true;
+        }
+    }
+}
+
+size_t firmware_rollout::find_entity(memory_object_transfer * transfer)
+{
+    for (size_t i = 0; i < m_entities.size(); i++)
+    {
+        if (m_entities[i].upload == transfer)
+            return i;
+    }
+
+    return m_entities.size();
+}
+
+void firmware_rollout::cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len)
+{
+    size_t index = (entity *)notification_id - &m_entities[0];
+    entity & e = m_entities[index];
+    (void)frame_len;
+
+    switch (e.state)
+    {
+    case FIRMWARE_ROLLOUT_ERASING:
+        if (status != AEM_STATUS_SUCCESS)
+        {
+            fail(index, status);
+        }
+        else if (!e.is_operation_running)
+        {
+            // The START_OPERATION response. The erase either finished already or reports its
+            // progress in OPERATION_STATUS responses, routed here through the operation tracking.
+            if (jdksavdecc_aem_command_start_operation_response_get_operation_id(frame, ETHER_HDR_SIZE) == 0)
+            {
+                start_upload(index, 0);
+            }
+            else
+            {
+                e.is_operation_running = true;
+                cmd_completion_ref->register_id(&e, this);
+            }
+        }
+        else if (jdksavdecc_aem_command_operation_status_response_get_percent_complete(frame, ETHER_HDR_SIZE) == 1000)
+        {
+            start_upload(index, 0);
+        }
+        else
+        {
+            fail(index, AEM_STATUS_ENTITY_MISBEHAVING);
+        }
+        break;
+
+    case FIRMWARE_ROLLOUT_REBOOTING:
+        // The End Station may reboot before it responds
+        if (status == AEM_STATUS_SUCCESS || status == AVDECC_LIB_STATUS_TICK_TIMEOUT)
+        {
+            e.resume_state = FIRMWARE_ROLLOUT_DONE;
+            set_state(index, FIRMWARE_ROLLOUT_DONE, 100, AEM_STATUS_SUCCESS);
+        }
+        else
+        {
+            fail(index, status);
+        }
+        break;
+    }
+}
+
+void firmware_rollout::cmd_progress(void * notification_id, const uint8_t * frame, size_t frame_len)
+{
+    size_t index = (entity *)notification_id - &m_entities[0];
+    uint16_t percent_complete = jdksavdecc_aem_command_operation_status_response_get_percent_complete(frame, ETHER_HDR_SIZE);
+    (void)frame_len;
+
+    if (m_entities[index].state == FIRMWARE_ROLLOUT_ERASING)
+        set_state(index, FIRMWARE_ROLLOUT_ERASING, (uint16_t)(std::min<uint16_t>(percent_complete, 1000) / 100), AEM_STATUS_SUCCESS);
+}
+
+void firmware_rollout::transfer_progress(memory_object_transfer * transfer, uint32_t percent_complete)
+{
+    size_t index = find_entity(transfer);
+    if (index == m_entities.size())
+        return;
+
+    m_entities[index].resume_offset = transfer->contiguous_offset();
+    set_state(index, FIRMWARE_ROLLOUT_UPLOADING, (uint16_t)(10 + percent_complete * 85 / 100), AEM_STATUS_SUCCESS);
+}
+
+void firmware_rollout::transfer_completed(memory_object_transfer * transfer, int status)
+{
+    size_t index = find_entity(transfer);
+    if (index == m_entities.size())
+        return;
+
+    entity & e = m_entities[index];
+    e.resume_offset = transfer->contiguous_offset();
+    e.upload = NULL;
+    delete transfer;
+
+    if (status != AEM_STATUS_SUCCESS)
+    {
+        fail(index, status);
+    }
+    else if (m_config.reboot)
+    {
+        start_reboot(index);
+    }
+    else
+    {
+        e.resume_state = FIRMWARE_ROLLOUT_DONE;
+        set_state(index, FIRMWARE_ROLLOUT_DONE, 100, AEM_STATUS_SUCCESS);
+    }
+}
+
+void firmware_rollout::load_state_file()
+{
+    char line[128];
+    unsigned long long image_size;
+    unsigned long long image_hash;
+
+    if (m_state_file_path.empty())
+        return;
+
+    FILE * file = fopen(m_state_file_path.c_str(), "r");
+    if (!file)
+        return;
+
+    if (!fgets(line, sizeof(line), file) || strncmp(line, state_file_header, strlen(state_file_header)) != 0 ||
+        !fgets(line, sizeof(line), file) || sscanf(line, "image %llu %llx", &image_size, &image_hash) != 2)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_WARNING, "Ignoring firmware rollout state file %s, unknown format",
+                                  m_state_file_path.c_str());
+        fclose(file);
+        return;
+    }
+
+    if (image_size != m_image.size() || image_hash != m_image_hash)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_WARNING, "Ignoring firmware rollout state file %s, written for another image",
+                                  m_state_file_path.c_str());
+        fclose(file);
+        return;
+    }
+
+    while (fgets(line, sizeof(line), file))
+    {
+        unsigned long long entity_id;
+        unsigned long long offset;
+        char state_name[32];
+
+        if (sscanf(line, "%llx %31s %llu", &entity_id, state_name, &offset) != 3)
+            continue;
+
+        for (size_t i = 0; i < m_entities.size(); i++)
+        {
+            if (m_entities[i].entity_id != entity_id)
+                continue;
+
+            for (uint16_t state = 0; state < TOTAL_NUM_OF_FIRMWARE_ROLLOUT_STATES; state++)
+            {
+                if (strcmp(state_name, utility::firmware_rollout_state_value_to_name(state)) == 0)
+                    m_entities[i].resume_state = state;
+            }
+            m_entities[i].resume_offset = std::min<uint64_t>(offset, m_image.size());
+        }
+    }
+
+    fclose(file);
+}
+
+void firmware_rollout::save_state_file()
+{
+    if (m_state_file_path.empty())
+        return;
+
+    std::string tmp_path = m_state_file_path + ".tmp";
+    FILE * file = fopen(tmp_path.c_str(), "w");
+    if (!file)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Unable to write firmware rollout state file %s", tmp_path.c_str());
+        return;
+    }
+
+    fprintf(file, "%s\nimage %llu %016llx\n", state_file_header,
+            (unsigned long long)m_image.size(), (unsigned long long)m_image_hash);
+    for (size_t i = 0; i < m_entities.size(); i++)
+    {
+        // The phase to continue from, which stays at the last one reached by an End Station that failed
+        fprintf(file, "%016llx %s %llu\n", (unsigned long long)m_entities[i].entity_id,
+                utility::firmware_rollout_state_value_to_name(m_entities[i].resume_state),
+                (unsigned long long)m_entities[i].resume_offset);
+    }
+    fclose(file);
+
+#if defined _WIN32 || defined _WIN64
+    remove(m_state_file_path.c_str());
+#endif
+    if (rename(tmp_path.c_str(), m_state_file_path.c_str()) != 0)
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Unable to replace firmware rollout state file %s", m_state_file_path.c_str());
+}
+}
@@ -0,0 +1,143 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * firmware_rollout.h
+ *
+ * Firmware rollout class, which upgrades a set of End Stations in waves: erasing the memory
+ * object of each with START_OPERATION, uploading the image and rebooting.
+ *
+ * All the commands, uploads and waves are driven from the lib thread, by command completions
+ * and by tick(). The image is mapped once and shared by the uploads, whose writes share one
+ * rate limiter.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <vector>
+#include <string>
+#include "controller.h"
+#include "cmd_completion.h"
+#include "mapped_file.h"
+#include "rate_limiter.h"
+#include "memory_object_upload.h"
+#include "timer.h"
+
+namespace avdecc_lib
+{
+class controller_imp;
+class end_station_imp;
+
+class firmware_rollout : public cmd_completion_handler, public memory_object_transfer_listener
+{
+public:
+    enum
+    {
+        ERASE_TIMEOUT_MS = 180000,       // For the erase operation to report completion
+        STATE_FILE_SAVE_INTERVAL_MS = 1000,
+        MAX_PACKETS_PER_SEC = 10000      // Bounds the writes queued to the lib thread by the lib thread in one tick
+    };
+
+    firmware_rollout(controller_imp * controller_obj, const firmware_rollout_config & config, void * notification_id);
+    ~firmware_rollout();
+
+    ///
+    /// Map the image and apply the state file, if any.
+    ///
+    /// \return 0 on success, -1 if the image cannot be mapped.
+    ///
+    int open(const uint64_t * entity_ids, size_t entity_count);
+
+    ///
+    /// Called on the lib thread each timer tick to refill the rate limiter, resume throttled uploads,
+    /// start waves, time out erase operations, save the state file and report progress.
+    ///
+    void tick();
+
+    void abort();
+
+    ///
+    /// \return True once every End Station has been upgraded, has failed or has been skipped.
+    ///
+    bool is_finished();
+
+    size_t get_status(firmware_rollout_entity_status * entity_status, size_t max_count);
+
+    void cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len);
+    void cmd_progress(void * notification_id, const uint8_t * frame, size_t frame_len);
+
+    void transfer_progress(memory_object_transfer * transfer, uint32_t percent_complete);
+    void transfer_completed(memory_object_transfer * transfer, int status);
+
+private:
+    struct entity
+    {
+        uint64_t entity_id;
+        uint16_t state;
+        uint16_t resume_state; // The state recorded in the state file, to continue from
+        uint64_t resume_offset;
+        uint16_t percent_complete;
+        int32_t status;
+        bool is_operation_running; // The erase START_OPERATION has been accepted
+        end_station_imp * end_station;
+        uint64_t start_address;
+        memory_object_upload * upload;
+        timer erase_timer;
+    };
+
+    controller_imp * m_controller;
+    firmware_rollout_config m_config;
+    std::string m_image_path;
+    std::string m_state_file_path;
+    void * m_notification_id;
+    mapped_file m_image;
+    uint64_t m_image_hash;
+    rate_limiter * m_limiter;
+    std::vector<entity> m_entities; // Not resized once opened, as each element is the notification id of its commands
+
+    std::mutex m_lock; // Held by the lib thread while changing entity states, and by get_status()
+    std::vector<size_t> m_wave;
+    size_t m_next_entity;
+    bool m_is_aborting;
+    bool m_is_finished;
+    bool m_is_state_changed;
+    uint32_t m_percent_complete;
+    timer m_save_timer;
+
+    void start_wave();
+    void start_entity(size_t index);
+    void start_erase(size_t index);
+    void start_upload(size_t index, uint64_t offset);
+    void start_reboot(size_t index);
+    void set_state(size_t index, uint16_t state, uint16_t percent_complete, int32_t status);
+    void fail(size_t index, int32_t status);
+    void skip_pending();
+    size_t find_entity(memory_object_transfer * transfer);
+
+    void load_state_file();
+    void save_state_file();
+};
+}
@@ -0,0 +1,243 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * frame_recorder.cpp
+ *
+ * Frame recorder implementation
+ */
+
+#include <string.h>
+#include <chrono>
+#include "pcapng.h"
+#include "frame_recorder.h"
+
+namespace avdecc_lib
+{
+namespace
+{
+    enum writer_consts
+    {
+        WRITER_POLL_MS = 5 ///< The writer thread checks the ring this often, so that recording never signals it
+    };
+
+    void put_u16(uint8_t *& pos, uint16_t value)
+    {
+        memcpy(pos, &value, sizeof(value));
+        pos += sizeof(value);
+    }
+
+    void put_u32(uint8_t *& pos, uint32_t value)
+    {
+        memcpy(pos, &value, sizeof(value));
+        pos += sizeof(value);
+    }
+
+    void put_option(uint8_t *& pos, uint16_t code, const void * value, uint16_t len)
+    {
+        put_u16(pos, code);
+        put_u16(pos, len);
+        memset(pos, 0, pcapng::padded_len(len));
+        memcpy(pos, value, len);
+        pos += pcapng::padded_len(len);
+    }
+}
+
+frame_recorder::frame_recorder()
+    : m_is_recording(false), m_head(0), m_tail(0), m_dropped(0), m_stop_writer(false), m_file(NULL)
+{
+}
+
+frame_recorder::~frame_recorder()
+{
+    stop();
+}
+
+int frame_recorder::start(const char * path, uint32_t ring_frames, uint64_t mac)
+{
+    std::lock_guard<std::mutex> guard(m_record_lock);
+
+    if (m_is_recording.load() || (ring_frames == 0))
+        return -1;
+
+    m_file = fopen(path, "wb");
+    if (!m_file)
+        return -1;
+
+    write_headers(mac);
+
+    m_ring.resize(ring_frames);
+    m_head.store(0);
+    m_tail.store(0);
+    m_dropped.store(0);
+    m_stop_writer = false;
+    m_writer_thread = std::thread(&frame_recorder::writer_thread, this);
+    m_is_recording.store(true, std::memory_order_release);
+
+    return 0;
+}
+
+uint64_t frame_recorder::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_record_lock);
+        if (!m_is_recording.load())
+            return 0;
+
+        // No frames are recorded after the lock is released
+        m_is_recording.store(false);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_writer_lock);
+        m_stop_writer = true;
+    }
+    m_writer_cv.notify_one();
+    m_writer_thread.join();
+
+    fclose(m_file);
+    m_file = NULL;
+    std::vector<ring_slot>().swap(m_ring);
+
+    return m_dropped.load();
+}
+
+void frame_recorder::record(uint32_t direction, const uint8_t * frame, size_t frame_len)
+{
+    if (!m_is_recording.load(std::memory_order_acquire))
+        return;
+
+    std::lock_guard<std::mutex> guard(m_record_lock);
+    if (!m_is_recording.load())
+        return;
+
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= m_ring.size())
+    {
+        m_dropped++;
+        return;
+    }
+
+    ring_slot & slot = m_ring[head % m_ring.size()];
+    slot.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    slot.direction = direction;
+    slot.len = (uint16_t)((frame_len < (size_t)MAX_FRAME_LEN) ? frame_len : (size_t)MAX_FRAME_LEN);
+    memcpy(slot.data, frame, slot.len);
+
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+void frame_recorder::writer_thread()
+{
+    bool is_stopping = false;
+
+    while (!is_stopping)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_writer_lock);
+            m_writer_cv.wait_for(lock, std::chrono::milliseconds(WRITER_POLL_MS));
+            is_stopping = m_stop_writer;
+        }
+
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        if (tail == head)
+            continue;
+
+        for (; tail != head; tail++)
+        {
+            write_frame(m_ring[tail % m_ring.size()]);
+            m_tail.store(tail + 1, std::memory_order_release);
+        }
+
+        fflush(m_file);
+    }
+}
+
+void frame_recorder::write_headers(uint64_t mac)
+{
+    uint8_t block[64];
+    uint8_t * pos = block;
+    uint8_t tsresol = 9; // nanoseconds
+    uint8_t mac_addr[6];
+    int64_t section_len = -1;
+
+    for (int i = 0; i < 6; i++)
+        mac_addr[i] = (uint8_t)(mac >> (8 * (5 - i)));
+
+    // Section Header Block
+    uint32_t shb_len = pcapng::BLOCK_HDR_LEN + 16 + pcapng::BLOCK_TRAILER_LEN;
+    put_u32(pos, pcapng::SECTION_HEADER_BLOCK);
+    put_u32(pos, shb_len);
+    put_u32(pos, pcapng::BYTE_ORDER_MAGIC);
+    put_u16(pos, pcapng::VERSION_MAJOR);
+    put_u16(pos, pcapng::VERSION_MINOR);
+    memcpy(pos, &section_len, sizeof(section_len));
+    pos += sizeof(section_len);
+    put_u32(pos, shb_len);
+    fwrite(block, 1, pos - block, m_file);
+
+    // Interface Description Block, with nanosecond timestamps and the controller MAC address
+    pos = block;
+    uint32_t idb_len = pcapng::BLOCK_HDR_LEN + 8 + 8 + 12 + 4 + pcapng::BLOCK_TRAILER_LEN;
+    put_u32(pos, pcapng::INTERFACE_DESCRIPTION_BLOCK);
+    put_u32(pos, idb_len);
+    put_u16(pos, pcapng::LINKTYPE_ETHERNET);
+    put_u16(pos, 0);
+    put_u32(pos, MAX_FRAME_LEN);
+    put_option(pos, pcapng::IF_TSRESOL, &tsresol, sizeof(tsresol));
+    put_option(pos, pcapng::IF_MACADDR, mac_addr, sizeof(mac_addr));
+    put_u32(pos, pcapng::OPT_ENDOFOPT);
+    put_u32(pos, idb_len);
+    fwrite(block, 1, pos - block, m_file);
+}
+
+void frame_recorder::write_frame(const ring_slot & slot)
+{
+    uint8_t hdr[28];
+    uint8_t trailer[16];
+    uint8_t padding[3] = {0, 0, 0};
+    uint8_t * pos = hdr;
+    uint32_t flags = (slot.direction == RX) ? pcapng::DIRECTION_INBOUND : pcapng::DIRECTION_OUTBOUND;
+    uint32_t block_len = sizeof(hdr) + pcapng::padded_len(slot.len) + sizeof(trailer);
+
+    // Enhanced Packet Block
+    put_u32(pos, pcapng::ENHANCED_PACKET_BLOCK);
+    put_u32(pos, block_len);
+    put_u32(pos, 0); // interface id
+    put_u32(pos, (uint32_t)(slot.timestamp_ns >> 32));
+    put_u32(pos, (uint32_t)slot.timestamp_ns);
+    put_u32(pos, slot.len);
+    put_u32(pos, slot.len);
+
+    pos = trailer;
+    put_option(pos, pcapng::EPB_FLAGS, &flags, sizeof(flags));
+    put_u32(pos, pcapng::OPT_ENDOFOPT);
+    put_u32(pos, block_len);
+
+    fwrite(hdr, 1, sizeof(hdr), m_file);
+    fwrite(slot.data, 1, slot.len, m_file);
+    fwrite(padding, 1, pcapng::padded_len(slot.len) - slot.len, m_file);
+    fwrite(trailer, 1, sizeof(trailer), m_file);
+}
+}
@@ -0,0 +1,111 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * frame_recorder.h
+ *
+ * Records every frame received and sent by the controller to a pcapng file. The network thread
+ * copies frames into a preallocated ring, and a writer thread writes them to the file, so that
+ * recording never blocks the network thread on file I/O.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include "controller_context.h"
+
+namespace avdecc_lib
+{
+class frame_recorder
+{
+public:
+    enum directions
+    {
+        RX,
+        TX
+    };
+
+    frame_recorder();
+    ~frame_recorder();
+
+    ///
+    /// Open the capture file and start the writer thread.
+    ///
+    /// \param path The pcapng file to write.
+    /// \param ring_frames The number of frames the ring holds.
+    /// \param mac The MAC address of the controller, recorded for replay.
+    ///
+    /// \return 0 on success, -1 if recording is already started or the file cannot be opened.
+    ///
+    int start(const char * path, uint32_t ring_frames, uint64_t mac);
+
+    ///
+    /// Write the frames left in the ring, stop the writer thread and close the file.
+    ///
+    /// \return The number of frames dropped because the ring was full.
+    ///
+    uint64_t stop();
+
+    ///
+    /// Copy a frame into the ring if recording is started. Never waits for the writer thread.
+    ///
+    void record(uint32_t direction, const uint8_t * frame, size_t frame_len);
+
+private:
+    enum recorder_consts
+    {
+        MAX_FRAME_LEN = 1522
+    };
+
+    struct ring_slot
+    {
+        uint64_t timestamp_ns;
+        uint32_t direction;
+        uint16_t len;
+        uint8_t data[MAX_FRAME_LEN];
+    };
+
+    std::atomic<bool> m_is_recording;
+    std::mutex m_record_lock; ///< Serializes the threads that record frames, never held by the writer thread
+    std::vector<ring_slot> m_ring;
+    std::atomic<uint64_t> m_head; ///< Count of frames copied into the ring
+    std::atomic<uint64_t> m_tail; ///< Count of frames written to the file
+    std::atomic<uint64_t> m_dropped;
+
+    std::mutex m_writer_lock;
+    std::condition_variable m_writer_cv;
+    std::thread m_writer_thread;
+    bool m_stop_writer;
+    FILE * m_file;
+
+    void writer_thread();
+    void write_headers(uint64_t mac);
+    void write_frame(const ring_slot & slot);
+};
+}
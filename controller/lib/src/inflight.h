@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include "enumeration.h"
 #include "timer.h"
 
 namespace avdecc_lib
@@ -41,21 +42,28 @@ private:
     timer cmd_timer;
     uint32_t cmd_timeout_ms;
     uint32_t start_timer_cnt;
+    bool rtt_taken;
 
 public:
-    /* following 2 are public for compare prediate classes */
+    /* following 4 are public for compare prediate classes */
     uint16_t cmd_seq_id;
     void * cmd_notification_id;
+    uint32_t cmd_priority;
+    uint64_t cmd_target_entity_id;
+    uint32_t cmd_class;
+    uint16_t cmd_type;
 
     inflight(struct jdksavdecc_frame * frame,
              uint16_t seq_id,
              void * notification_id,
              uint32_t notification_flag,
              uint32_t timeout_ms)
-        : cmd_notification_flag(notification_flag), cmd_timeout_ms(timeout_ms), cmd_seq_id(seq_id), cmd_notification_id(notification_id)
+        : cmd_notification_flag(notification_flag), cmd_timeout_ms(timeout_ms), cmd_seq_id(seq_id), cmd_notification_id(notification_id),
+          cmd_priority(CMD_PRIORITY_NORMAL), cmd_target_entity_id(0), cmd_class(CMD_CLASS_AEM), cmd_type(0)
     {
         cmd_frame = *frame;
         start_timer_cnt = 0;
+        rtt_taken = false;
     }
 
     ~inflight() {}
@@ -72,6 +80,41 @@ public:
         cmd_timer.start(cmd_timeout_ms);
     }
 
+    inline void set_priority(uint32_t priority)
+    {
+        cmd_priority = priority;
+    }
+
+    inline void set_target(uint64_t target_entity_id, uint32_t target_cmd_class, uint16_t target_cmd_type)
+    {
+        cmd_target_entity_id = target_entity_id;
+        cmd_class = target_cmd_class;
+        cmd_type = target_cmd_type;
+    }
+
+    inline uint32_t timeout_ms()
+    {
+        return cmd_timeout_ms;
+    }
+
+    inline void set_timeout_ms(uint32_t timeout_ms)
+    {
+        cmd_timeout_ms = timeout_ms;
+    }
+
+    ///
+    /// Take the round trip time of the first response to the command. Following Karn's algorithm,
+    /// there is none once the command has been resent, as the response may be to either send.
+    ///
+    inline bool take_rtt(uint32_t & rtt_ms)
+    {
+        bool is_valid = !rtt_taken && (start_timer_cnt == 1);
+
+        rtt_taken = true;
+        rtt_ms = cmd_timer.elapsed_ms();
+        return is_valid;
+    }
+
     inline struct jdksavdecc_frame frame()
     {
         return cmd_frame;
@@ -87,9 +130,9 @@ public:
         return cmd_timer.timeout();
     }
 
-    inline bool retried()
+    inline bool retried(uint32_t max_retries)
     {
-        return start_timer_cnt >= 2; // The command can be resent once
+        return start_timer_cnt > max_retries; // The command has been resent max_retries times
     }
 };
 
@@ -126,4 +169,22 @@ public:
         return m.cmd_notification_id == v;
     }
 };
+
+///
+/// Class for use in STL find_if() call to find a command of a priority class to a target entity.
+///
+class PriorityComp
+{
+private:
+    uint64_t id;
+    uint32_t v;
+
+public:
+    PriorityComp(uint64_t target_entity_id, uint32_t priority) : id(target_entity_id), v(priority) {}
+
+    inline bool operator()(const inflight & m) const
+    {
+        return m.cmd_target_entity_id == id && m.cmd_priority == v;
+    }
+};
 }
@@ -43,6 +43,10 @@ jack_input_descriptor_imp::~jack_input_descriptor_imp() {}
 
 jack_input_descriptor_response * STDCALL jack_input_descriptor_imp::get_jack_input_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new jack_input_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                          resp_ref->get_desc_size(), resp_ref->get_desc_pos());
@@ -0,0 +1,371 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * capture_replay_imp.cpp
+ *
+ * Capture replay implementation
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <chrono>
+#include "enumeration.h"
+#include "log_imp.h"
+#include "pcapng.h"
+#include "capture_replay_imp.h"
+
+namespace avdecc_lib
+{
+namespace
+{
+    uint16_t get_u16(const uint8_t * pos)
+    {
+        uint16_t value;
+        memcpy(&value, pos, sizeof(value));
+        return value;
+    }
+
+    uint32_t get_u32(const uint8_t * pos)
+    {
+        uint32_t value;
+        memcpy(&value, pos, sizeof(value));
+        return value;
+    }
+
+    uint64_t get_mac(const uint8_t * pos)
+    {
+        uint64_t mac = 0;
+        for (int i = 0; i < 6; i++)
+            mac = (mac << 8) | pos[i];
+        return mac;
+    }
+}
+
+capture_replay * STDCALL create_capture_replay(const char * path, bool recorded_pace)
+{
+    capture_replay_imp * replay = new capture_replay_imp(recorded_pace);
+
+    if (replay->load(path) < 0)
+    {
+        delete replay;
+        return NULL;
+    }
+
+    return replay;
+}
+
+capture_replay_imp::capture_replay_imp(bool recorded_pace)
+    : m_recorded_pace(recorded_pace), m_mac(0), m_is_started(false), m_stop(false), m_released(0), m_next(0)
+{
+    if (pipe(m_pipe) == 0)
+    {
+        fcntl(m_pipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(m_pipe[1], F_SETFL, O_NONBLOCK);
+    }
+    else
+    {
+        m_pipe[0] = m_pipe[1] = -1;
+    }
+}
+
+capture_replay_imp::~capture_replay_imp()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stop = true;
+    }
+    m_stop_cv.notify_one();
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    if (m_pipe[0] >= 0)
+    {
+        close(m_pipe[0]);
+        close(m_pipe[1]);
+    }
+}
+
+int capture_replay_imp::load(const char * path)
+{
+    std::vector<uint8_t> file;
+    std::vector<capture_interface> interfaces;
+    uint8_t buf[4096];
+    size_t len;
+
+    FILE * fp = fopen(path, "rb");
+    if (!fp || (m_pipe[0] < 0))
+    {
+        if (fp)
+            fclose(fp);
+        return -1;
+    }
+
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+        file.insert(file.end(), buf, buf + len);
+    fclose(fp);
+
+    size_t pos = 0;
+    while (pos + pcapng::BLOCK_HDR_LEN + pcapng::BLOCK_TRAILER_LEN <= file.size())
+    {
+        uint32_t type = get_u32(&file[pos]);
+        uint32_t block_len = get_u32(&file[pos + 4]);
+
+        if ((block_len < pcapng::BLOCK_HDR_LEN + pcapng::BLOCK_TRAILER_LEN) || (block_len % 4) ||
+            (pos + block_len > file.size()))
+        {
+            break; // truncated capture, replay the frames read so far
+        }
+
+        if (!proc_block(type, &file[pos + pcapng::BLOCK_HDR_LEN],
+                        block_len - pcapng::BLOCK_HDR_LEN - pcapng::BLOCK_TRAILER_LEN, interfaces))
+        {
+            return -1;
+        }
+
+        pos += block_len;
+    }
+
+    return m_frames.empty() ? -1 : 0;
+}
+
+bool capture_replay_imp::proc_block(uint32_t type, const uint8_t * body, uint32_t body_len,
+                                    std::vector<capture_interface> & interfaces)
+{
+    switch (type)
+    {
+    case pcapng::SECTION_HEADER_BLOCK:
+        // Captures written with the other byte order are not supported
+        if ((body_len < 16) || (get_u32(body) != pcapng::BYTE_ORDER_MAGIC))
+            return false;
+        interfaces.clear();
+        break;
+
+    case pcapng::INTERFACE_DESCRIPTION_BLOCK:
+    {
+        capture_interface iface;
+        iface.tsresol = 6; // microseconds unless the if_tsresol option is present
+        iface.mac = 0;
+
+        if ((body_len < 8) || (get_u16(body) != pcapng::LINKTYPE_ETHERNET))
+            return false;
+
+        for (uint32_t opt = 8; opt + 4 <= body_len;)
+        {
+            uint16_t code = get_u16(&body[opt]);
+            uint16_t len = get_u16(&body[opt + 2]);
+
+            if ((code == pcapng::OPT_ENDOFOPT) || (opt + 4 + len > body_len))
+                break;
+            if ((code == pcapng::IF_TSRESOL) && (len == 1))
+                iface.tsresol = body[opt + 4];
+            if ((code == pcapng::IF_MACADDR) && (len == 6))
+                iface.mac = get_mac(&body[opt + 4]);
+
+            opt += 4 + pcapng::padded_len(len);
+        }
+        // The MAC address of the recording controller, if the capture has one
+        if (!m_mac)
+            m_mac = iface.mac;
+        interfaces.push_back(iface);
+    }
+    break;
+
+    case pcapng::ENHANCED_PACKET_BLOCK:
+    {
+        if (body_len < 20)
+            return false;
+
+        uint32_t interface_id = get_u32(body);
+        uint64_t timestamp = ((uint64_t)get_u32(&body[4]) << 32) | get_u32(&body[8]);
+        uint32_t captured_len = get_u32(&body[12]);
+        uint32_t direction = pcapng::DIRECTION_UNKNOWN;
+
+        if ((interface_id >= interfaces.size()) || (20 + captured_len > body_len))
+            return false;
+
+        for (uint32_t opt = 20 + pcapng::padded_len(captured_len); opt + 4 <= body_len;)
+        {
+            uint16_t code = get_u16(&body[opt]);
+            uint16_t len = get_u16(&body[opt + 2]);
+
+            if ((code == pcapng::OPT_ENDOFOPT) || (opt + 4 + len > body_len))
+                break;
+            if ((code == pcapng::EPB_FLAGS) && (len == 4))
+                direction = get_u32(&body[opt + 4]) & pcapng::DIRECTION_MASK;
+
+            opt += 4 + pcapng::padded_len(len);
+        }
+
+        if (direction == pcapng::DIRECTION_OUTBOUND)
+        {
+            // Frames sent by the recording controller are from its MAC address
+            if (!m_mac && (captured_len >= 12))
+                m_mac = get_mac(&body[20 + 6]);
+        }
+        else
+        {
+            replay_frame frame;
+            frame.timestamp_ns = timestamp_to_ns(timestamp, interfaces[interface_id].tsresol);
+            frame.data.assign(&body[20], &body[20] + captured_len);
+            m_frames.push_back(frame);
+        }
+    }
+    break;
+
+    case pcapng::SIMPLE_PACKET_BLOCK:
+    {
+        if ((body_len < 4) || interfaces.empty())
+            return false;
+
+        // Simple packets have no timestamp, so they are replayed with the frame before them
+        uint32_t captured_len = get_u32(body);
+        if (captured_len > body_len - 4)
+            captured_len = body_len - 4;
+
+        replay_frame frame;
+        frame.timestamp_ns = m_frames.empty() ? 0 : m_frames.back().timestamp_ns;
+        frame.data.assign(&body[4], &body[4] + captured_len);
+        m_frames.push_back(frame);
+    }
+    break;
+    }
+
+    return true;
+}
+
+uint64_t capture_replay_imp::timestamp_to_ns(uint64_t timestamp, uint8_t tsresol)
+{
+    uint8_t exponent = tsresol & 0x7F;
+
+    if (tsresol & 0x80)
+        return (uint64_t)((long double)timestamp * 1000000000.0L / (long double)((uint64_t)1 << exponent));
+
+    for (; exponent < 9; exponent++)
+        timestamp *= 10;
+    for (; exponent > 9; exponent--)
+        timestamp /= 10;
+
+    return timestamp;
+}
+
+void STDCALL capture_replay_imp::destroy()
+{
+    delete this;
+}
+
+int STDCALL capture_replay_imp::start()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_is_started)
+        return -1;
+
+    m_is_started = true;
+    if (m_recorded_pace)
+        m_thread = std::thread(&capture_replay_imp::pace_thread, this);
+    else
+        release(m_frames.size());
+
+    return 0;
+}
+
+size_t STDCALL capture_replay_imp::frame_count()
+{
+    return m_frames.size();
+}
+
+size_t STDCALL capture_replay_imp::frames_replayed()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_next;
+}
+
+uint64_t STDCALL capture_replay_imp::mac_addr()
+{
+    return m_mac;
+}
+
+int STDCALL capture_replay_imp::get_fd()
+{
+    return m_pipe[0];
+}
+
+int STDCALL capture_replay_imp::capture_frame(uint8_t * frame, uint16_t max_len)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_next >= m_released)
+        return -1;
+
+    const std::vector<uint8_t> & data = m_frames[m_next++].data;
+    uint16_t len = (data.size() < max_len) ? (uint16_t)data.size() : max_len;
+    memcpy(frame, data.data(), len);
+
+    // The pipe stays readable while frames are due
+    uint8_t signal;
+    if ((m_next == m_released) && (read(m_pipe[0], &signal, 1) != 1))
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "capture replay signal read error");
+
+    return len;
+}
+
+int STDCALL capture_replay_imp::send_frame(const uint8_t * frame, uint16_t frame_len)
+{
+    // The recorded End Stations already responded, so frames sent by the controller are discarded
+    return frame_len;
+}
+
+void capture_replay_imp::pace_thread()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t first_timestamp_ns = m_frames[0].timestamp_ns;
+
+    for (size_t i = 0; i < m_frames.size(); i++)
+    {
+        uint64_t offset_ns = (m_frames[i].timestamp_ns > first_timestamp_ns) ? m_frames[i].timestamp_ns - first_timestamp_ns : 0;
+        std::chrono::steady_clock::time_point due = start + std::chrono::nanoseconds(offset_ns);
+
+        while (!m_stop && (std::chrono::steady_clock::now() < due))
+            m_stop_cv.wait_until(lock, due);
+
+        if (m_stop)
+            return;
+
+        release(i + 1);
+    }
+}
+
+void capture_replay_imp::release(size_t count)
+{
+    uint8_t signal = 1;
+    if ((m_next == m_released) && (write(m_pipe[1], &signal, 1) != 1))
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "capture replay signal write error");
+
+    m_released = count;
+}
+}
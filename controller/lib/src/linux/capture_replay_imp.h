@@ -0,0 +1,110 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * capture_replay_imp.h
+ *
+ * Capture replay implementation class
+ */
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "capture_replay.h"
+
+namespace avdecc_lib
+{
+class capture_replay_imp : public capture_replay
+{
+public:
+    ///
+    /// Constructor for capture_replay_imp used for replaying at the recorded pace or as fast as possible.
+    ///
+    capture_replay_imp(bool recorded_pace);
+
+    ///
+    /// Destructor for capture_replay_imp used for destroying objects
+    ///
+    virtual ~capture_replay_imp();
+
+    ///
+    /// Read the received frames of the pcapng file.
+    ///
+    /// \return 0 on success, -1 if the file cannot be read or holds no frames.
+    ///
+    int load(const char * path);
+
+    void STDCALL destroy();
+    int STDCALL start();
+    size_t STDCALL frame_count();
+    size_t STDCALL frames_replayed();
+
+    uint64_t STDCALL mac_addr();
+    int STDCALL get_fd();
+    int STDCALL capture_frame(uint8_t * frame, uint16_t max_len);
+    int STDCALL send_frame(const uint8_t * frame, uint16_t frame_len);
+
+private:
+    struct replay_frame
+    {
+        uint64_t timestamp_ns;
+        std::vector<uint8_t> data;
+    };
+
+    struct capture_interface
+    {
+        uint8_t tsresol;
+        uint64_t mac;
+    };
+
+    bool m_recorded_pace;
+    uint64_t m_mac;
+    std::vector<replay_frame> m_frames;
+
+    std::mutex m_lock; // Protects all the members below
+    std::condition_variable m_stop_cv;
+    std::thread m_thread;
+    bool m_is_started;
+    bool m_stop;
+    size_t m_released; ///< Count of frames due for capture
+    size_t m_next;     ///< Index of the next frame to capture
+    int m_pipe[2];     ///< Readable while frames are due for capture
+
+    ///
+    /// Release the frames at the pace they were recorded.
+    ///
+    void pace_thread();
+
+    ///
+    /// Release the frames up to the count, and signal the pipe if none were due.
+    ///
+    void release(size_t count);
+
+    bool proc_block(uint32_t type, const uint8_t * body, uint32_t body_len, std::vector<capture_interface> & interfaces);
+    static uint64_t timestamp_to_ns(uint64_t timestamp, uint8_t tsresol);
+};
+}
@@ -32,6 +32,7 @@
 #include "avdecc_lib_os.h"
 #include <stdint.h>
 #include "log.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
@@ -71,6 +72,4 @@ public:
     ///
     void post_log_event();
 };
-
-extern log_imp * log_imp_ref;
 }
@@ -92,6 +92,10 @@ net_interface_imp::net_interface_imp()
     char ifname[256];
 
     total_devs = 0;
+    rawsock = -1;
+    transport = NULL;
+    in_fanout_group = false;
+    fanout_group_id = 0;
 
     ip_hdr_store = new ipheader;
     udp_hdr_store = new udpheader;
@@ -134,9 +138,24 @@ net_interface_imp::net_interface_imp()
     freeifaddrs(ifaddr);
 }
 
+net_interface_imp::net_interface_imp(net_transport * transport) : transport(transport)
+{
+    total_devs = 1;
+    rawsock = -1;
+    in_fanout_group = false;
+    fanout_group_id = 0;
+    mac = 0;
+    selected_dev_eui = 0;
+
+    ip_hdr_store = new ipheader;
+    udp_hdr_store = new udpheader;
+    ifnames.push_back("transport, address: <none>");
+}
+
 net_interface_imp::~net_interface_imp()
 {
-    close(rawsock);
+    if (rawsock >= 0)
+        close(rawsock);
 }
 
 void STDCALL net_interface_imp::destroy()
@@ -206,6 +225,9 @@ const char * STDCALL net_interface_imp::get_dev_ip_address_by_index(size_t dev_i
 
 int net_interface_imp::get_fd()
 {
+    if (transport)
+        return transport->get_fd();
+
     return rawsock;
 }
 
@@ -216,6 +238,18 @@ int STDCALL net_interface_imp::select_interface_by_num(uint32_t interface_num)
     const char * ifname;
     char * s;
 
+    if (transport)
+    {
+        if (interface_num != 1)
+            return -1;
+
+        mac = transport->mac_addr();
+        selected_dev_eui = ((mac & UINT64_C(0xFFFFFF000000)) << 16) |
+                           UINT64_C(0x000000FFFF000000) |
+                           (mac & UINT64_C(0xFFFFFF));
+        return 0;
+    }
+
     // adjust interface numnber since count starts at 1
     interface_num--;
 
@@ -260,6 +294,14 @@ int STDCALL net_interface_imp::select_interface_by_num(uint32_t interface_num)
     uint16_t etypes[1] = {0x22f0};
     set_capture_ether_type(etypes, 1);
 
+    if (in_fanout_group && join_fanout_group(rawsock, fanout_group_id) < 0)
+    {
+        fprintf(stderr, "socket join fanout group failed! %s\n", strerror(errno));
+        close(rawsock);
+        rawsock = -1;
+        return -1;
+    }
+
     return 0;
 }
 
@@ -267,6 +309,10 @@ int net_interface_imp::set_capture_ether_type(uint16_t * ether_type, uint32_t co
 {
     struct sock_fprog Filter;
 
+    // the transport only carries AVDECC frames
+    if (transport)
+        return 0;
+
     Filter.len = sizeof(BPF_code) / 8;
     Filter.filter = BPF_code;
 
@@ -292,7 +338,10 @@ int STDCALL net_interface_imp::capture_frame(const uint8_t ** frame, uint16_t *
     int len;
 
     *frame = &rx_buf[0];
-    len = read(rawsock, &rx_buf[0], sizeof(rx_buf));
+    if (transport)
+        len = transport->capture_frame(&rx_buf[0], sizeof(rx_buf));
+    else
+        len = read(rawsock, &rx_buf[0], sizeof(rx_buf));
     if (len < 0)
     {
         *mem_buf_len = 0;
@@ -311,6 +360,9 @@ int net_interface_imp::send_frame(uint8_t * frame, uint16_t mem_buf_len)
     // target address
     struct sockaddr_ll socket_address;
 
+    if (transport)
+        return transport->send_frame(frame, mem_buf_len);
+
     // prepare sockaddr_ll
 
     // RAW communication
@@ -372,8 +424,60 @@ int net_interface_imp::setpromiscuous(int rawsock, int ifindex)
                       PACKET_ADD_MEMBERSHIP, &mr, sizeof(mr));
 }
 
+void net_interface_imp::set_fanout_group(uint16_t group_id)
+{
+    in_fanout_group = true;
+    fanout_group_id = group_id;
+}
+
+int net_interface_imp::join_fanout_group(int rawsock, uint16_t group_id)
+{
+#ifdef PACKET_FANOUT_CBPF
+    // Return a hash of the source MAC address, which the kernel takes modulo the number of
+    // sockets in the group, so that every frame of an entity is captured by the same socket.
+    // The fanout program runs with the frame at the network header, so the Ethernet header is
+    // loaded relative to the link layer.
+    struct sock_filter fanout_code[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, (uint32_t)(SKF_LL_OFF + 8)), // source MAC address bytes 2 to 5
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_LD | BPF_H | BPF_ABS, (uint32_t)(SKF_LL_OFF + 6)), // source MAC address bytes 0 and 1
+        BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    struct sock_fprog fanout_prog;
+    int fanout_arg = group_id | (PACKET_FANOUT_CBPF << 16);
+
+    if (setsockopt(rawsock, SOL_PACKET, PACKET_FANOUT, &fanout_arg, sizeof(fanout_arg)) == -1)
+        return -1;
+
+    fanout_prog.len = sizeof(fanout_code) / sizeof(fanout_code[0]);
+    fanout_prog.filter = fanout_code;
+
+    return setsockopt(rawsock, SOL_PACKET, PACKET_FANOUT_DATA, &fanout_prog, sizeof(fanout_prog));
+#else
+    errno = ENOPROTOOPT;
+    return -1;
+#endif
+}
+
 net_interface * create_net_interface()
 {
     return (new net_interface_imp());
 }
+
+net_interface * create_net_interface_with_transport(net_transport * transport)
+{
+    if (!transport)
+        return NULL;
+
+    return (new net_interface_imp(transport));
+}
+
+net_interface * create_net_interface_in_fanout_group(uint16_t group_id)
+{
+    net_interface_imp * netif = new net_interface_imp();
+
+    netif->set_fanout_group(group_id);
+    return netif;
+}
 }
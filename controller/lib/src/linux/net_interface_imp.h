@@ -37,6 +37,7 @@
 
 #include "avdecc-lib_build.h"
 #include "net_interface.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
@@ -63,9 +64,13 @@ private:
     uint64_t selected_dev_eui;
     uint8_t buf[SIZEOF_BUFFER];
     uint8_t rx_buf[SIZEOF_BUFFER];
+    net_transport * transport;
+    bool in_fanout_group;
+    uint16_t fanout_group_id;
 
     int getifindex(int rawsock, const char * iface);
     int setpromiscuous(int rawsock, int ifindex);
+    int join_fanout_group(int rawsock, uint16_t group_id);
 
 public:
     ///
@@ -73,6 +78,16 @@ public:
     ///
     net_interface_imp();
 
+    ///
+    /// Constructor for net_interface_imp that sends and captures frames through a transport.
+    ///
+    net_interface_imp(net_transport * transport);
+
+    ///
+    /// Capture frames as one shard of a fanout group when the interface is selected.
+    ///
+    void set_fanout_group(uint16_t group_id);
+
     ///
     /// Destructor for net_interface_imp used for destroying objects
     ///
@@ -160,6 +175,4 @@ public:
     bool is_pcap() { return true; }
     bool is_Mac_Native_end_station_connected(uint64_t entity_id) { return false; }
 };
-
-extern net_interface_imp * net_interface_ref;
 }
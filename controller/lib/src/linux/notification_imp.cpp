@@ -44,12 +44,12 @@
 #include <arpa/inet.h>
 
 #include "enumeration.h"
+#include "util.h"
+#include "cmd_trace.h"
 #include "notification_imp.h"
 
 namespace avdecc_lib
 {
-notification_imp * notification_imp_ref = new notification_imp();
-
 notification_imp::notification_imp()
 {
     notification_thread_init(); // Start notification thread
@@ -58,6 +58,12 @@ notification_imp::notification_imp()
 notification_imp::~notification_imp()
 {
     post_notification_event();
+
+    // Wait for the thread to drain the queue and exit, unless it is the thread destroying the controller
+    if (pthread_equal(pthread_self(), h_thread))
+        pthread_detach(h_thread);
+    else
+        pthread_join(h_thread, NULL);
 }
 
 int notification_imp::notification_thread_init()
@@ -83,12 +89,15 @@ void * notification_imp::dispatch_thread(void * param)
 
 void * notification_imp::dispatch_callbacks(void)
 {
+    context_scope scope(m_context);
+
     while (true)
     {
         sem_wait(&notify_waiting);
 
         if ((write_index - read_index) > 0)
         {
+            cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "notification", "dispatch", read_index);
             notification_callback(user_obj,
                                   notification_buf[read_index % NOTIFICATION_BUF_COUNT].notification_type,
                                   notification_buf[read_index % NOTIFICATION_BUF_COUNT].entity_id,
@@ -98,6 +107,9 @@ void * notification_imp::dispatch_callbacks(void)
                                   notification_buf[read_index % NOTIFICATION_BUF_COUNT].desc_index,
                                   notification_buf[read_index % NOTIFICATION_BUF_COUNT].cmd_status,
                                   notification_buf[read_index % NOTIFICATION_BUF_COUNT].notification_id);
+            cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_END, "notification",
+                                            utility::notification_value_to_name(notification_buf[read_index % NOTIFICATION_BUF_COUNT].notification_type),
+                                            read_index);
             read_index++;
         }
         else
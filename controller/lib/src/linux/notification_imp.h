@@ -31,6 +31,7 @@
 
 #include "avdecc_lib_os.h"
 #include "notification.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
@@ -70,6 +71,4 @@ public:
     ///
     void post_notification_event();
 };
-
-extern notification_imp * notification_imp_ref;
 }
@@ -50,6 +50,7 @@
 #include <net/ethernet.h>
 #include <sys/un.h>
 #include <sys/eventfd.h>
+#include <poll.h>
 
 #include <vector>
 
@@ -61,21 +62,20 @@
 #include "controller_imp.h"
 #include "system_message_queue.h"
 #include "system_tx_queue.h"
+#include "cmd_completion.h"
+#include "cmd_trace.h"
 #include "system_layer2_multithreaded_callback.h"
 
 namespace avdecc_lib
 {
 
-net_interface_imp * netif_obj_in_system;
-controller_imp * controller_ref_in_system;
-system_layer2_multithreaded_callback * local_system = NULL;
-
-system_layer2_multithreaded_callback * system_layer2_multithreaded_callback::instance = NULL;
-
 size_t system_queue_tx(void * notification_id, uint32_t notification_flag, uint8_t * frame, size_t mem_buf_len)
 {
+    system_layer2_multithreaded_callback * local_system = current_context()->system_obj;
+
     if (local_system)
     {
+        cmd_completion_ref->sent(notification_id);
         return local_system->queue_tx_frame(notification_id, notification_flag, frame, mem_buf_len);
     }
     else
@@ -84,26 +84,51 @@ size_t system_queue_tx(void * notification_id, uint32_t notification_flag, uint8
     }
 }
 
+int system_set_priority_for_next_cmd(void * notification_id, uint32_t priority)
+{
+    system_layer2_multithreaded_callback * local_system = current_context()->system_obj;
+
+    if (local_system)
+    {
+        return local_system->set_priority_for_next_cmd(notification_id, priority);
+    }
+    else
+    {
+        return -1;
+    }
+}
+
+void system_clear_priority_for_next_cmd(void * notification_id)
+{
+    system_layer2_multithreaded_callback * local_system = current_context()->system_obj;
+
+    if (local_system)
+        local_system->clear_priority_for_next_cmd(notification_id);
+}
+
 system * STDCALL create_system(system::system_type type, net_interface * netif, controller * controller_obj)
 {
     (void)type;
-    local_system = new system_layer2_multithreaded_callback(netif, controller_obj);
 
-    return local_system;
+    return new system_layer2_multithreaded_callback(netif, controller_obj);
 }
 
 system_layer2_multithreaded_callback::system_layer2_multithreaded_callback(net_interface * netif, controller * controller_obj)
 {
-    instance = this;
     netif_obj_in_system = dynamic_cast<net_interface_imp *>(netif);
     controller_ref_in_system = dynamic_cast<controller_imp *>(controller_obj);
+    context = controller_ref_in_system->context();
+    context->system_obj = this;
+    controller_context::retain(context);
+    is_shut_down = false;
     pipe(tx_pipe);
+    tx_trace_seq = 0;
+    is_started = false;
+    tick_timer = -1;
+    virtual_clock_obj = NULL;
 
     wait_mgr = new cmd_wait_mgr();
-
-    waiting_sem = (sem_t *)calloc(1, sizeof(*waiting_sem));
-    if (waiting_sem)
-        sem_init(waiting_sem, 0, 0);
+    tx_cmd_queue = new tx_priority_queue();
 
     shutdown_sem = (sem_t *)calloc(1, sizeof(*shutdown_sem));
     if (shutdown_sem)
@@ -112,15 +137,29 @@ system_layer2_multithreaded_callback::system_layer2_multithreaded_callback(net_i
 
 system_layer2_multithreaded_callback::~system_layer2_multithreaded_callback()
 {
-    free(waiting_sem);
     free(shutdown_sem);
+    delete tx_cmd_queue;
+    delete wait_mgr;
 }
 
 void STDCALL system_layer2_multithreaded_callback::destroy()
 {
-    if (this == local_system)
+    if (this == context->system_obj)
+        context->system_obj = NULL;
+
+    if (virtual_clock_obj)
     {
-        local_system = NULL;
+        virtual_clock_obj->set_tick_handler(NULL, NULL);
+        context->clock_obj = NULL;
+    }
+
+    if (is_started)
+    {
+        is_shut_down = true;
+
+        // Without the interval timer nothing else may wake the thread
+        if (virtual_clock_obj)
+            virtual_tick_cb(this);
 
         // Wait for controller to have finished
         if (sem_wait(shutdown_sem) != 0)
@@ -129,7 +168,9 @@ void STDCALL system_layer2_multithreaded_callback::destroy()
         }
     }
 
+    controller_context * system_context = context;
     delete this;
+    controller_context::release(system_context);
 }
 
 int system_layer2_multithreaded_callback::queue_tx_frame(
@@ -138,7 +179,13 @@ int system_layer2_multithreaded_callback::queue_tx_frame(
     uint8_t * frame,
     size_t mem_buf_len)
 {
-    struct tx_data t;
+    struct tx_priority_queue::tx_entry t;
+    uint8_t wakeup = 0;
+
+    // The wait is active before the command is queued, so that a command failing as soon as it
+    // is taken from the queue still releases this thread.
+    bool is_waited = (notification_flag == CMD_WITH_NOTIFICATION) &&
+                     wait_mgr->set_active_state(notification_id);
 
     t.frame = new uint8_t[2048];
     if (!t.frame)
@@ -146,25 +193,22 @@ int system_layer2_multithreaded_callback::queue_tx_frame(
         perror("malloc");
         exit(EXIT_FAILURE);
     }
-    t.mem_buf_len = mem_buf_len;
+    t.frame_len = mem_buf_len;
     memcpy(t.frame, frame, mem_buf_len);
     t.notification_id = notification_id;
     t.notification_flag = notification_flag;
-    write(tx_pipe[PIPE_WR], &t, sizeof(t));
+    t.priority = tx_cmd_queue->classify(notification_id, notification_flag, is_waited);
+    t.trace_id = InterlockedExchangeAdd(&tx_trace_seq, 1);
+    cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_BEGIN, "tx_queue", "enqueue", t.trace_id, 0, (intptr_t)notification_id);
+    tx_cmd_queue->push(t);
+    write(tx_pipe[PIPE_WR], &wakeup, sizeof(wakeup));
 
     // Check for conditions that cause wait for completion.
-    if (wait_mgr->primed_state() &&
-        wait_mgr->match_id(notification_id) &&
-        (notification_flag == CMD_WITH_NOTIFICATION))
+    if (is_waited)
     {
-        int status = 0;
-
-        status = wait_mgr->set_active_state();
-        assert(status == 0);
-        sem_wait(waiting_sem);
-        resp_status_for_cmd = wait_mgr->get_completion_status();
-        status = wait_mgr->set_idle_state();
-        assert(status == 0);
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_BEGIN, "wait", "cmd_wait", (uintptr_t)notification_id);
+        int status = wait_mgr->wait_for_completion();
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_END, "wait", "cmd_wait", (uintptr_t)notification_id, 0, status);
     }
 
     return 0;
@@ -172,13 +216,35 @@ int system_layer2_multithreaded_callback::queue_tx_frame(
 
 int STDCALL system_layer2_multithreaded_callback::set_wait_for_next_cmd(void * id)
 {
-    wait_mgr->set_primed_state(id);
+    return wait_mgr->set_primed_state(id);
+}
+
+int STDCALL system_layer2_multithreaded_callback::set_priority_for_next_cmd(void * id, uint32_t priority)
+{
+    return tx_cmd_queue->set_priority_for_next_cmd(id, priority);
+}
+
+void system_layer2_multithreaded_callback::clear_priority_for_next_cmd(void * id)
+{
+    tx_cmd_queue->clear_priority_for_next_cmd(id);
+}
+
+int STDCALL system_layer2_multithreaded_callback::set_virtual_clock(virtual_clock * clock)
+{
+    if (is_started)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "The virtual clock must be set before the system is started");
+        return -1;
+    }
+
+    virtual_clock_obj = dynamic_cast<virtual_clock_imp *>(clock);
+    context->clock_obj = virtual_clock_obj;
     return 0;
 }
 
 int STDCALL system_layer2_multithreaded_callback::get_last_resp_status()
 {
-    return resp_status_for_cmd;
+    return wait_mgr->get_completion_status();
 }
 
 int system_layer2_multithreaded_callback::timer_start_interval(int timerfd)
@@ -198,17 +264,29 @@ int system_layer2_multithreaded_callback::timer_start_interval(int timerfd)
     return timerfd_settime(timerfd, 0, &itimer_new, &itimer_old);
 }
 
+void system_layer2_multithreaded_callback::virtual_tick_cb(void * context)
+{
+    system_layer2_multithreaded_callback * system = (system_layer2_multithreaded_callback *)context;
+    struct itimerspec itimer_new;
+
+    // Expire the timer once, right away
+    memset(&itimer_new, 0, sizeof(itimer_new));
+    itimer_new.it_value.tv_nsec = 1;
+
+    timerfd_settime(system->tick_timer, 0, &itimer_new, NULL);
+}
+
 int system_layer2_multithreaded_callback::fn_timer_cb(struct epoll_priv * priv)
 {
-    return instance->fn_timer(priv);
+    return priv->owner->fn_timer(priv);
 }
 int system_layer2_multithreaded_callback::fn_netif_cb(struct epoll_priv * priv)
 {
-    return instance->fn_netif(priv);
+    return priv->owner->fn_netif(priv);
 }
 int system_layer2_multithreaded_callback::fn_tx_cb(struct epoll_priv * priv)
 {
-    return instance->fn_tx(priv);
+    return priv->owner->fn_tx(priv);
 }
 
 int system_layer2_multithreaded_callback::fn_timer(struct epoll_priv * priv)
@@ -216,47 +294,66 @@ int system_layer2_multithreaded_callback::fn_timer(struct epoll_priv * priv)
     uint64_t timer_exp_count;
     read(priv->fd, &timer_exp_count, sizeof(timer_exp_count));
 
-    bool notification_id_incomplete = false;
-
-    if (wait_mgr->active_state())
+    if (virtual_clock_obj)
     {
-        if (controller_ref_in_system->is_inflight_cmd_with_notification_id(wait_mgr->get_notify_id()) ||
-            controller_ref_in_system->is_active_operation_with_notification_id(wait_mgr->get_notify_id()))
-            notification_id_incomplete = true;
+        // Process the frames delivered before the clock advanced, as they would have been
+        // received before the timer tick in real time
+        struct pollfd netif_poll;
+        netif_poll.fd = netif_obj_in_system->get_fd();
+        netif_poll.events = POLLIN;
+
+        while (poll(&netif_poll, 1, 0) > 0 && (netif_poll.revents & POLLIN))
+            fn_netif(NULL);
     }
 
-    // If waiting on a command to complete and the command was "inflight" prior to calling the
-    // timer tick update (ie notification_id_incomplete == true) AND after calling the timer tick
-    // update the command is no longer "inflight", timeout processing has removed it, so signal the
-    // waiting app thread.
+    // Release the app threads waiting for commands that timed out during the timer tick update,
+    // unless an operation started by the command is still active.
     controller_ref_in_system->time_tick_event();
 
-    bool is_timeout_for_waiting_notify_id = wait_mgr->active_state() && notification_id_incomplete &&
-                                            !controller_ref_in_system->is_inflight_cmd_with_notification_id(wait_mgr->get_notify_id()) &&
-                                            !controller_ref_in_system->is_active_operation_with_notification_id(wait_mgr->get_notify_id());
-    if (is_timeout_for_waiting_notify_id)
+    const std::vector<void *> & timed_out_ids = controller_ref_in_system->timed_out_notification_ids();
+    for (size_t i = 0; i < timed_out_ids.size(); i++)
     {
-        int status = wait_mgr->set_completion_status(AVDECC_LIB_STATUS_TICK_TIMEOUT);
-        assert(status == 0);
-        sem_post(waiting_sem);
+        void * id = timed_out_ids[i];
+
+        if (wait_mgr->active_state(id) &&
+            !controller_ref_in_system->is_inflight_cmd_with_notification_id(id) &&
+            !controller_ref_in_system->is_active_operation_with_notification_id(id))
+        {
+            wait_mgr->set_completion_status(id, AVDECC_LIB_STATUS_TICK_TIMEOUT);
+            cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "wait", "wake_timeout", (uintptr_t)id, 0, AVDECC_LIB_STATUS_TICK_TIMEOUT);
+        }
     }
 
+    if (virtual_clock_obj)
+        virtual_clock_obj->tick_done();
+
     return 0;
 }
 
 int system_layer2_multithreaded_callback::fn_tx(struct epoll_priv * priv)
 {
-    struct tx_data t;
-    int result = read(tx_pipe[PIPE_RD], &t, sizeof(t));
+    struct tx_priority_queue::tx_entry t;
+    uint8_t wakeup;
+    int result = read(tx_pipe[PIPE_RD], &wakeup, sizeof(wakeup));
 
-    if (result > 0)
+    // Each wakeup byte stands for one queued command, but not necessarily the one taken here,
+    // as commands of a higher priority class are taken first.
+    if (result > 0 && tx_cmd_queue->pop(t))
     {
         log_imp_ref->post_log_msg(LOGGING_LEVEL_DEBUG, "fn_tx");
-        controller_ref_in_system->tx_packet_event(
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_END, "tx_queue", "enqueue", t.trace_id, 0, (intptr_t)t.notification_id);
+        int tx_status = controller_ref_in_system->tx_packet_event(
             t.notification_id,
             t.notification_flag,
             t.frame,
-            t.mem_buf_len);
+            t.frame_len,
+            t.priority);
+
+        // A command that failed without being sent has no response or timeout to release the waiting app thread
+        if (tx_status != 0 && wait_mgr->set_completion_status(t.notification_id, tx_status))
+        {
+            cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "wait", "wake_failed", (uintptr_t)t.notification_id, 0, tx_status);
+        }
 
         delete[] t.frame;
     }
@@ -288,16 +385,13 @@ int system_layer2_multithreaded_callback::fn_netif(struct epoll_priv * priv)
                                                   operation_id,
                                                   is_operation_id_valid);
 
-        if (
-            wait_mgr->active_state() &&
-            is_notification_id_valid &&
-            wait_mgr->match_id(notification_id) &&
-            !controller_ref_in_system->is_inflight_cmd_with_notification_id(wait_mgr->get_notify_id()) &&
-            !controller_ref_in_system->is_active_operation_with_notification_id(wait_mgr->get_notify_id()))
+        if (is_notification_id_valid &&
+            wait_mgr->active_state(notification_id) &&
+            !controller_ref_in_system->is_inflight_cmd_with_notification_id(notification_id) &&
+            !controller_ref_in_system->is_active_operation_with_notification_id(notification_id))
         {
-            int status = wait_mgr->set_completion_status(rx_status);
-            assert(status == 0);
-            sem_post(waiting_sem);
+            wait_mgr->set_completion_status(notification_id, rx_status);
+            cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "wait", "wake_response", (uintptr_t)notification_id, 0, rx_status);
         }
     }
     return 0;
@@ -311,6 +405,7 @@ int system_layer2_multithreaded_callback::prep_evt_desc(
 {
     priv->fd = fd;
     priv->fn = fn;
+    priv->owner = this;
     ev->events = EPOLLIN;
     ev->data.ptr = priv;
     return 0;
@@ -336,7 +431,11 @@ int system_layer2_multithreaded_callback::proc_poll_loop()
     epoll_ctl(epollfd, EPOLL_CTL_ADD, fd_fns[2].fd, &ev);
 
     fcntl(fd_fns[0].fd, F_SETFL, O_NONBLOCK);
-    timer_start_interval(fd_fns[0].fd);
+    tick_timer = fd_fns[0].fd;
+    if (virtual_clock_obj)
+        virtual_clock_obj->set_tick_handler(&system_layer2_multithreaded_callback::virtual_tick_cb, this);
+    else
+        timer_start_interval(tick_timer);
 
     do
     {
@@ -344,7 +443,7 @@ int system_layer2_multithreaded_callback::proc_poll_loop()
         struct epoll_priv * priv;
         res = epoll_wait(epollfd, epoll_evt, POLL_COUNT, -1);
 
-        if (local_system == NULL)
+        if (is_shut_down)
         {
             // System has been shut down
             sem_post(shutdown_sem);
@@ -367,7 +466,10 @@ int system_layer2_multithreaded_callback::proc_poll_loop()
 
 void * system_layer2_multithreaded_callback::thread_fn(void * param)
 {
-    ((system_layer2_multithreaded_callback *)param)->proc_poll_loop();
+    system_layer2_multithreaded_callback * system_obj = (system_layer2_multithreaded_callback *)param;
+    context_scope scope(system_obj->context);
+
+    system_obj->proc_poll_loop();
 
     return 0;
 }
@@ -376,6 +478,7 @@ int STDCALL system_layer2_multithreaded_callback::process_start()
 {
     int rc;
 
+    is_started = true;
     rc = pthread_create(&h_thread, NULL, &system_layer2_multithreaded_callback::thread_fn, (void *)this);
     if (rc)
     {
@@ -30,10 +30,14 @@
 #pragma once
 
 #include <sys/epoll.h>
+#include <atomic>
 
 #include "avdecc_lib_os.h"
 #include "system.h"
 #include "cmd_wait_mgr.h"
+#include "tx_priority_queue.h"
+#include "virtual_clock_imp.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
@@ -68,6 +72,21 @@ public:
     ///
     int STDCALL set_wait_for_next_cmd(void * id);
 
+    ///
+    /// Set the priority class of the next command sent with the notification id.
+    ///
+    int STDCALL set_priority_for_next_cmd(void * id, uint32_t priority);
+
+    ///
+    /// Drop the priority set for the notification id.
+    ///
+    void clear_priority_for_next_cmd(void * id);
+
+    ///
+    /// Run the library on a virtual clock instead of the real clock.
+    ///
+    int STDCALL set_virtual_clock(virtual_clock * clock);
+
     ///
     /// Wait for the response packet with the corrsponding notification id to be received.
     ///
@@ -84,7 +103,6 @@ public:
     int STDCALL process_close();
 
 private:
-    static system_layer2_multithreaded_callback * instance;
     struct epoll_priv;
     typedef int (*handler_fn)(struct epoll_priv * priv);
 
@@ -92,14 +110,7 @@ private:
     {
         int fd;
         handler_fn fn;
-    };
-
-    struct tx_data
-    {
-        uint8_t * frame;
-        size_t mem_buf_len;
-        void * notification_id;
-        uint32_t notification_flag;
+        system_layer2_multithreaded_callback * owner;
     };
 
     enum useful_enums
@@ -111,12 +122,18 @@ private:
     };
 
     pthread_t h_thread;
+    bool is_started;
+    std::atomic<bool> is_shut_down; // Set by destroy() to end the event thread
+
+    controller_context * context; // The context of the controller, bound on the event thread
+    net_interface_imp * netif_obj_in_system;
+    controller_imp * controller_ref_in_system;
 
     //int network_fd;
-    int tx_pipe[2];
-    //int tick_timer;
+    int tx_pipe[2]; // One byte is written for each command pushed to tx_cmd_queue
+    int tick_timer;
+    virtual_clock_imp * virtual_clock_obj; // Drives the timer tick instead of the interval timer when set
 
-    sem_t * waiting_sem;
     sem_t * shutdown_sem;
 
     // Events to process:
@@ -125,7 +142,8 @@ private:
     // Timer tick - from timer
 
     cmd_wait_mgr * wait_mgr;
-    int resp_status_for_cmd;
+    tx_priority_queue * tx_cmd_queue;
+    uint32_t tx_trace_seq;
     int prep_evt_desc(int fd, handler_fn fn, struct epoll_priv * priv, struct epoll_event * ev);
     static int fn_timer_cb(struct epoll_priv * priv);
     static int fn_netif_cb(struct epoll_priv * priv);
@@ -134,6 +152,7 @@ private:
     int fn_netif(struct epoll_priv * priv);
     int fn_tx(struct epoll_priv * priv);
     int timer_start_interval(int timerfd);
+    static void virtual_tick_cb(void * context);
 
     void * proc_poll_thread(void * p);
     int proc_poll_loop();
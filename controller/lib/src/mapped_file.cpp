@@ -0,0 +1,212 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * mapped_file.cpp
+ *
+ * File mapping implementation
+ */
+
+#if defined __linux__ || defined __MACH__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "mapped_file.h"
+
+namespace avdecc_lib
+{
+#if defined _WIN32 || defined _WIN64
+
+mapped_file::mapped_file() : m_file(INVALID_HANDLE_VALUE), m_mapping(NULL), m_data(NULL), m_size(0) {}
+
+int mapped_file::open(const char * path)
+{
+    LARGE_INTEGER file_size;
+
+    close();
+
+    m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return -1;
+
+    if (!GetFileSizeEx(m_file, &file_size))
+    {
+        close();
+        return -1;
+    }
+
+    m_size = (size_t)file_size.QuadPart;
+    if (m_size == 0)
+        return 0;
+
+    m_mapping = CreateFileMapping(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_mapping)
+        m_data = (uint8_t *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!m_data)
+    {
+        close();
+        return -1;
+    }
+
+    return 0;
+}
+
+int mapped_file::create(const char * path, size_t size)
+{
+    LARGE_INTEGER file_size;
+
+    close();
+
+    m_file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return -1;
+
+    file_size.QuadPart = size;
+    if (!SetFilePointerEx(m_file, file_size, NULL, FILE_BEGIN) || !SetEndOfFile(m_file))
+    {
+        close();
+        return -1;
+    }
+
+    m_size = size;
+    if (m_size == 0)
+        return 0;
+
+    m_mapping = CreateFileMapping(m_file, NULL, PAGE_READWRITE, 0, 0, NULL);
+    if (m_mapping)
+        m_data = (uint8_t *)MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0);
+
+    if (!m_data)
+    {
+        close();
+        return -1;
+    }
+
+    return 0;
+}
+
+void mapped_file::close()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = NULL;
+    m_data = NULL;
+    m_size = 0;
+}
+
+#else
+
+mapped_file::mapped_file() : m_fd(-1), m_data(NULL), m_size(0) {}
+
+int mapped_file::open(const char * path)
+{
+    struct stat file_stat;
+
+    close();
+
+    m_fd = ::open(path, O_RDONLY);
+    if (m_fd < 0)
+        return -1;
+
+    if (fstat(m_fd, &file_stat) != 0)
+    {
+        close();
+        return -1;
+    }
+
+    m_size = (size_t)file_stat.st_size;
+    if (m_size == 0)
+        return 0;
+
+    void * data = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED)
+    {
+        close();
+        return -1;
+    }
+
+    // The image is read once from start to end
+    madvise(data, m_size, MADV_SEQUENTIAL);
+    m_data = (uint8_t *)data;
+
+    return 0;
+}
+
+int mapped_file::create(const char * path, size_t size)
+{
+    close();
+
+    m_fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0)
+        return -1;
+
+    if (ftruncate(m_fd, (off_t)size) != 0)
+    {
+        close();
+        return -1;
+    }
+
+    m_size = size;
+    if (m_size == 0)
+        return 0;
+
+    void * data = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED)
+    {
+        close();
+        return -1;
+    }
+
+    m_data = (uint8_t *)data;
+
+    return 0;
+}
+
+void mapped_file::close()
+{
+    if (m_data)
+        munmap(m_data, m_size);
+    if (m_fd >= 0)
+        ::close(m_fd);
+
+    m_fd = -1;
+    m_data = NULL;
+    m_size = 0;
+}
+
+#endif
+
+mapped_file::~mapped_file()
+{
+    close();
+}
+}
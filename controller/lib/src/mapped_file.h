@@ -0,0 +1,77 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * mapped_file.h
+ *
+ * Memory mapping of a file, such as a firmware image to be uploaded or a memory object being downloaded.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined _WIN32 || defined _WIN64
+#include <windows.h>
+#endif
+
+namespace avdecc_lib
+{
+class mapped_file
+{
+public:
+    mapped_file();
+    ~mapped_file();
+
+    ///
+    /// Map the whole of a file for reading.
+    ///
+    /// \return 0 on success, -1 if the file cannot be opened or mapped.
+    ///
+    int open(const char * path);
+
+    ///
+    /// Map a file for writing, creating it if needed and setting its size. The existing contents
+    /// of the file are kept, so that an interrupted transfer into it can continue.
+    ///
+    /// \return 0 on success, -1 if the file cannot be created, resized or mapped.
+    ///
+    int create(const char * path, size_t size);
+    void close();
+
+    const uint8_t * data() const { return m_data; }
+    uint8_t * data() { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+#if defined _WIN32 || defined _WIN64
+    HANDLE m_file;
+    HANDLE m_mapping;
+#else
+    int m_fd;
+#endif
+    uint8_t * m_data;
+    size_t m_size;
+};
+}
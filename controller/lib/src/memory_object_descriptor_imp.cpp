@@ -28,6 +28,7 @@
  */
 
 #include <mutex>
+#include <algorithm>
 
 #include "avdecc_error.h"
 #include "enumeration.h"
@@ -38,6 +39,8 @@
 #include "system_tx_queue.h"
 #include "acmp_controller_state_machine.h"
 #include "aecp_controller_state_machine.h"
+#include "memory_object_upload.h"
+#include "memory_object_download.h"
 #include "memory_object_descriptor_imp.h"
 
 namespace avdecc_lib
@@ -48,6 +51,10 @@ memory_object_descriptor_imp::~memory_object_descriptor_imp() {}
 
 memory_object_descriptor_response * STDCALL memory_object_descriptor_imp::get_memory_object_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new memory_object_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                             resp_ref->get_desc_size(), resp_ref->get_desc_pos());
@@ -55,6 +62,12 @@ memory_object_descriptor_response * STDCALL memory_object_descriptor_imp::get_me
 
 int STDCALL memory_object_descriptor_imp::start_operation_cmd(void * notification_id, uint16_t operation_type)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_start_operation aem_cmd_start_operation;
     memset(&aem_cmd_start_operation, 0, sizeof(aem_cmd_start_operation));
@@ -96,6 +109,82 @@ int STDCALL memory_object_descriptor_imp::start_operation_cmd(void * notificatio
     return 0;
 }
 
+int STDCALL memory_object_descriptor_imp::start_upload(void * notification_id, const char * file_path, size_t window)
+{
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
+    uint64_t start_address;
+
+    if (window == 0)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Invalid upload window on memory object\n");
+        return -1;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
+        memory_object_descriptor_response_imp memory_object_resp(resp_ref->get_desc_buffer(),
+                                                                 resp_ref->get_desc_size(), resp_ref->get_desc_pos());
+        start_address = memory_object_resp.start_address();
+    }
+
+    memory_object_upload * upload = new memory_object_upload(base_end_station_imp_ref, descriptor_index(), start_address,
+                                                             std::min<size_t>(window, memory_object_transfer::MAX_WINDOW),
+                                                             notification_id);
+    if (upload->open(file_path) != 0)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Unable to map upload image %s\n", file_path);
+        delete upload;
+        return -1;
+    }
+    upload->start();
+
+    return 0;
+}
+
+int STDCALL memory_object_descriptor_imp::start_download(void * notification_id, const char * file_path, size_t window, uint64_t offset)
+{
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
+    uint64_t start_address;
+    uint64_t length;
+
+    if (window == 0)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Invalid download window on memory object\n");
+        return -1;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
+        memory_object_descriptor_response_imp memory_object_resp(resp_ref->get_desc_buffer(),
+                                                                 resp_ref->get_desc_size(), resp_ref->get_desc_pos());
+        start_address = memory_object_resp.start_address();
+        length = memory_object_resp.length();
+    }
+
+    memory_object_download * download = new memory_object_download(base_end_station_imp_ref, descriptor_index(), start_address,
+                                                                   std::min<size_t>(window, memory_object_transfer::MAX_WINDOW),
+                                                                   notification_id);
+    if (download->open(file_path, length) != 0)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Unable to map download file %s\n", file_path);
+        delete download;
+        return -1;
+    }
+    download->start(offset);
+
+    return 0;
+}
+
 int memory_object_descriptor_imp::proc_start_operation_resp(void *& notification_id,
                                                             const uint8_t * frame,
                                                             size_t frame_len,
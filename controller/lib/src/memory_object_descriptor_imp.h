@@ -46,6 +46,8 @@ public:
     memory_object_descriptor_response * STDCALL get_memory_object_response();
 
     int STDCALL start_operation_cmd(void * notification_id, uint16_t operation_type);
+    int STDCALL start_upload(void * notification_id, const char * file_path, size_t window);
+    int STDCALL start_download(void * notification_id, const char * file_path, size_t window, uint64_t offset);
     int proc_start_operation_resp(void *& notification_id, const uint8_t * frame, size_t frame_len, int & status, uint16_t & operation_id, uint16_t & operation_type);
     int proc_operation_status_resp(void *& notification_id, const uint8_t * frame, size_t frame_len, int & status, uint16_t & operation_id, bool & is_operation_id_valid);
 };
@@ -0,0 +1,84 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * memory_object_download.cpp
+ *
+ * Memory object download implementation
+ */
+
+#include <string.h>
+#include "jdksavdecc_aecp_aa.h"
+#include "enumeration.h"
+#include "end_station_imp.h"
+#include "memory_object_download.h"
+
+namespace avdecc_lib
+{
+memory_object_download::memory_object_download(end_station_imp * end_station_obj, uint16_t desc_index, uint64_t start_address,
+                                               size_t window, void * notification_id, memory_object_transfer_listener * listener)
+    : memory_object_transfer(end_station_obj, desc_index, start_address, window, notification_id, listener)
+{
+}
+
+memory_object_download::~memory_object_download() {}
+
+int memory_object_download::open(const char * file_path, uint64_t size)
+{
+    if ((size_t)size != size || m_target_file.create(file_path, (size_t)size) != 0)
+        return -1;
+
+    m_size = size;
+
+    return 0;
+}
+
+int memory_object_download::send_chunk(slot & s)
+{
+    return m_end_station->send_aecp_address_access_cmd(&s, JDKSAVDECC_AECP_AA_MODE_READ, s.length,
+                                                       m_start_address + s.offset, NULL);
+}
+
+int memory_object_download::chunk_completed(slot & s, const uint8_t * frame, size_t frame_len)
+{
+    const size_t tlv_offset = ETHER_HDR_SIZE + JDKSAVDECC_AECPDU_AA_LEN;
+    const size_t data_offset = tlv_offset + JDKSAVDECC_AECPDU_AA_TLV_LEN;
+
+    if (!frame || frame_len < data_offset || jdksavdecc_aecp_aa_get_tlv_count(frame, ETHER_HDR_SIZE) < 1)
+        return AVDECC_LIB_STATUS_INVALID;
+
+    uint16_t mode_length = jdksavdecc_aecp_aa_tlv_get_mode_length(frame, tlv_offset);
+    uint64_t address = ((uint64_t)jdksavdecc_aecp_aa_tlv_get_address_upper(frame, tlv_offset) << 32) |
+                       jdksavdecc_aecp_aa_tlv_get_address_lower(frame, tlv_offset);
+
+    if (((mode_length >> 12) != JDKSAVDECC_AECP_AA_MODE_READ) || ((mode_length & 0xFFF) != s.length) ||
+        (address != m_start_address + s.offset) || (frame_len < data_offset + s.length))
+    {
+        return AVDECC_LIB_STATUS_INVALID;
+    }
+
+    memcpy(m_target_file.data() + s.offset, frame + data_offset, s.length);
+
+    return JDKSAVDECC_AECP_AA_STATUS_SUCCESS;
+}
+}
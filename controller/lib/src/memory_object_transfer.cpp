@@ -0,0 +1,270 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * memory_object_transfer.cpp
+ *
+ * Memory object transfer implementation
+ */
+
+#include <algorithm>
+#include "jdksavdecc_aecp_aa.h"
+#include "enumeration.h"
+#include "notification_imp.h"
+#include "log_imp.h"
+#include "end_station_imp.h"
+#include "rate_limiter.h"
+#include "memory_object_transfer.h"
+
+namespace avdecc_lib
+{
+memory_object_transfer::memory_object_transfer(end_station_imp * end_station_obj, uint16_t desc_index, uint64_t start_address,
+                                               size_t window, void * notification_id, memory_object_transfer_listener * listener)
+    : m_end_station(end_station_obj), m_start_address(start_address), m_size(0),
+      m_entity_id(end_station_obj->entity_id()), m_desc_index(desc_index),
+      m_notification_id(notification_id), m_listener(listener), m_limiter(NULL), m_slots(window),
+      m_next_offset(0), m_start_offset(0), m_inflight(0), m_bytes_done(0), m_percent_complete(0),
+      m_status(JDKSAVDECC_AECP_AA_STATUS_SUCCESS), m_is_starting(true)
+{
+    for (size_t i = window; i > 0; i--)
+    {
+        m_slots[i - 1].is_used = false;
+        m_free_slots.push_back(i - 1);
+    }
+    m_is_pinned = m_end_station->pin();
+}
+
+memory_object_transfer::~memory_object_transfer()
+{
+    if (m_is_pinned)
+        m_end_station->unpin();
+}
+
+void memory_object_transfer::set_rate_limiter(rate_limiter * limiter)
+{
+    m_limiter = limiter;
+}
+
+void memory_object_transfer::start(uint64_t offset)
+{
+    m_start_offset = m_next_offset = m_bytes_done = std::min(offset, m_size);
+
+    log_imp_ref->post_log_msg(LOGGING_LEVEL_NOTICE, "Starting %s of %d bytes from offset %d of memory object %d of 0x%llx",
+                              mode_name(), (int)m_size, (int)m_start_offset, m_desc_index, (unsigned long long)m_entity_id);
+
+    if (send_pending())
+        return;
+
+    if (release(m_slots.size(), JDKSAVDECC_AECP_AA_STATUS_SUCCESS))
+        finish();
+}
+
+bool memory_object_transfer::resume()
+{
+    return send_pending();
+}
+
+uint64_t memory_object_transfer::contiguous_offset()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    uint64_t offset = m_next_offset;
+
+    for (size_t i = 0; i < m_slots.size(); i++)
+    {
+        if (m_slots[i].is_used && (m_slots[i].offset < offset))
+            offset = m_slots[i].offset;
+    }
+
+    return offset;
+}
+
+void memory_object_transfer::cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len)
+{
+    slot & s = *static_cast<slot *>(notification_id);
+
+    if (status == JDKSAVDECC_AECP_AA_STATUS_SUCCESS)
+        status = chunk_completed(s, frame, frame_len);
+
+    if (release(&s - &m_slots[0], status))
+    {
+        finish();
+        return;
+    }
+
+    send_pending();
+}
+
+void memory_object_transfer::select_slots(std::vector<size_t> & to_send)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    to_send.clear();
+    while (m_status == JDKSAVDECC_AECP_AA_STATUS_SUCCESS)
+    {
+        size_t index;
+
+        if (!m_retransmits.empty())
+        {
+            index = m_retransmits.front();
+            if (m_limiter && !m_limiter->try_acquire(m_slots[index].length))
+                break;
+            m_retransmits.pop_front();
+        }
+        else if (!m_free_slots.empty() && (m_next_offset < m_size))
+        {
+            uint16_t length = (uint16_t)std::min<uint64_t>(AECP_AA_MAX_TLV_DATA_LEN, m_size - m_next_offset);
+            if (m_limiter && !m_limiter->try_acquire(length))
+                break;
+
+            index = m_free_slots.back();
+            m_free_slots.pop_back();
+            m_slots[index].offset = m_next_offset;
+            m_slots[index].length = length;
+            m_slots[index].retries = 0;
+            m_slots[index].is_used = true;
+            m_next_offset += length;
+        }
+        else
+        {
+            break;
+        }
+
+        m_inflight++;
+        cmd_completion_ref->register_id(&m_slots[index], this);
+        to_send.push_back(index);
+    }
+}
+
+bool memory_object_transfer::send_pending()
+{
+    std::vector<size_t> to_send;
+
+    for (;;)
+    {
+        select_slots(to_send);
+        if (to_send.empty())
+            return false;
+
+        for (size_t i = 0; i < to_send.size(); i++)
+        {
+            slot & s = m_slots[to_send[i]];
+
+            if (send_chunk(s) == 0)
+                continue;
+
+            cmd_completion_ref->unregister_id(&s);
+            if (release(to_send[i], AVDECC_LIB_STATUS_INVALID))
+            {
+                finish();
+                return true;
+            }
+        }
+    }
+}
+
+bool memory_object_transfer::release(size_t index, int status)
+{
+    bool is_progress = false;
+    uint32_t percent_complete = 0;
+    bool is_finished;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        if (index < m_slots.size())
+        {
+            slot & s = m_slots[index];
+
+            m_inflight--;
+            if (status == JDKSAVDECC_AECP_AA_STATUS_SUCCESS)
+            {
+                s.is_used = false;
+                m_free_slots.push_back(index);
+                m_bytes_done += s.length;
+                percent_complete = (uint32_t)(m_bytes_done * 100 / m_size);
+                is_progress = percent_complete != m_percent_complete;
+                m_percent_complete = percent_complete;
+            }
+            else if ((status == AVDECC_LIB_STATUS_TICK_TIMEOUT) && (s.retries < MAX_CHUNK_RETRIES))
+            {
+                s.retries++;
+                m_retransmits.push_back(index);
+                log_imp_ref->post_log_msg(LOGGING_LEVEL_WARNING, "Retransmitting memory object %s at offset %d",
+                                          mode_name(), (int)s.offset);
+            }
+            else if (m_status == JDKSAVDECC_AECP_AA_STATUS_SUCCESS)
+            {
+                m_status = status;
+                log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Memory object %s at offset %d failed with status %d",
+                                          mode_name(), (int)s.offset, status);
+            }
+        }
+        else
+        {
+            m_is_starting = false;
+        }
+
+        // Inflight commands are left to complete after a failure, as they are routed to this object
+        is_finished = !m_is_starting && (m_inflight == 0) &&
+                      ((m_status != JDKSAVDECC_AECP_AA_STATUS_SUCCESS) || (m_bytes_done == m_size));
+    }
+
+    if (is_progress && !is_finished)
+    {
+        if (m_listener)
+        {
+            m_listener->transfer_progress(this, percent_complete);
+        }
+        else
+        {
+            notification_imp_ref->post_notification_msg(MEMORY_OBJECT_TRANSFER_PROGRESS, m_entity_id,
+                                                        JDKSAVDECC_AECP_MESSAGE_TYPE_ADDRESS_ACCESS_COMMAND, 0,
+                                                        AEM_DESC_MEMORY_OBJECT, m_desc_index, percent_complete, m_notification_id);
+        }
+    }
+
+    return is_finished;
+}
+
+void memory_object_transfer::finish()
+{
+    if (m_listener)
+    {
+        // Nothing is done after the call, as the listener may delete this object
+        m_listener->transfer_completed(this, m_status);
+        return;
+    }
+
+    if (m_status != JDKSAVDECC_AECP_AA_STATUS_SUCCESS)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Memory object %s of 0x%llx stopped, it can be continued from offset %llu",
+                                  mode_name(), (unsigned long long)m_entity_id, (unsigned long long)contiguous_offset());
+    }
+
+    notification_imp_ref->post_notification_msg(MEMORY_OBJECT_TRANSFER_COMPLETED, m_entity_id,
+                                                JDKSAVDECC_AECP_MESSAGE_TYPE_ADDRESS_ACCESS_COMMAND, 0,
+                                                AEM_DESC_MEMORY_OBJECT, m_desc_index, m_status, m_notification_id);
+
+    delete this;
+}
+}
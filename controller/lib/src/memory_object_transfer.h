@@ -0,0 +1,172 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * memory_object_transfer.h
+ *
+ * Memory object transfer class, the base of the uploads and downloads that move a memory object
+ * in ADDRESS_ACCESS commands, keeping a window of commands inflight. Each command carries one
+ * chunk of the largest TLV that fits in an AECPDU, and chunks may complete in any order.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include "cmd_completion.h"
+
+namespace avdecc_lib
+{
+class end_station_imp;
+class rate_limiter;
+class memory_object_transfer;
+
+class memory_object_transfer_listener
+{
+public:
+    virtual ~memory_object_transfer_listener() {}
+
+    virtual void transfer_progress(memory_object_transfer * transfer, uint32_t percent_complete) = 0;
+
+    ///
+    /// Called once the transfer has finished. The listener owns the transfer and may delete it here.
+    ///
+    virtual void transfer_completed(memory_object_transfer * transfer, int status) = 0;
+};
+
+class memory_object_transfer : public cmd_completion_handler
+{
+public:
+    enum
+    {
+        MAX_WINDOW = 512,
+        MAX_CHUNK_RETRIES = 3 // Retransmissions of a timed out chunk, each after the AECP retry
+    };
+
+    ///
+    /// Without a listener the transfer posts MEMORY_OBJECT_TRANSFER notifications and deletes itself
+    /// when it finishes.
+    ///
+    memory_object_transfer(end_station_imp * end_station_obj, uint16_t desc_index, uint64_t start_address,
+                           size_t window, void * notification_id, memory_object_transfer_listener * listener);
+    virtual ~memory_object_transfer();
+
+    ///
+    /// Limit the rate of the commands. A throttled transfer continues when resume() is called.
+    ///
+    void set_rate_limiter(rate_limiter * limiter);
+
+    ///
+    /// Send the first window of commands, starting at offset bytes into the memory object to continue
+    /// an earlier transfer. The transfer may finish before this function returns.
+    ///
+    void start(uint64_t offset = 0);
+
+    ///
+    /// Send the commands held back by the rate limiter.
+    ///
+    /// \return True if the transfer finished.
+    ///
+    bool resume();
+
+    ///
+    /// \return The offset below which every chunk has completed, from which an interrupted transfer can continue.
+    ///
+    uint64_t contiguous_offset();
+
+    uint64_t entity_id() const { return m_entity_id; }
+
+    void cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len);
+
+protected:
+    struct slot
+    {
+        uint64_t offset;
+        uint16_t length;
+        uint16_t retries;
+        bool is_used;
+    };
+
+    end_station_imp * m_end_station;
+    bool m_is_pinned; // The End Station is not evicted while the operation runs
+    uint64_t m_start_address;
+    uint64_t m_size; // Set by the derived class before start()
+
+    ///
+    /// \return The name of the ADDRESS_ACCESS mode used, for logging.
+    ///
+    virtual const char * mode_name() const = 0;
+
+    ///
+    /// Send the command for a chunk, with the slot as its notification id.
+    ///
+    virtual int send_chunk(slot & s) = 0;
+
+    ///
+    /// Called when the response for a chunk is received.
+    ///
+    /// \return The status of the chunk.
+    ///
+    virtual int chunk_completed(slot & s, const uint8_t * frame, size_t frame_len) = 0;
+
+private:
+    uint64_t m_entity_id;
+    uint16_t m_desc_index;
+    void * m_notification_id;
+    memory_object_transfer_listener * m_listener;
+    rate_limiter * m_limiter;
+    std::vector<slot> m_slots; // One per command in the window, each is the notification id of its command
+
+    std::mutex m_lock;
+    std::vector<size_t> m_free_slots;
+    std::deque<size_t> m_retransmits; // Slots of timed out chunks, sent before any new chunk
+    uint64_t m_next_offset;
+    uint64_t m_start_offset;
+    size_t m_inflight;
+    uint64_t m_bytes_done;
+    uint32_t m_percent_complete;
+    int m_status; // The first failure, after which no more commands are sent
+    bool m_is_starting;
+
+    void select_slots(std::vector<size_t> & to_send);
+
+    ///
+    /// Send commands for the slots the window and rate limiter allow.
+    ///
+    /// \return True if the transfer finished.
+    ///
+    bool send_pending();
+
+    ///
+    /// Account for a completed chunk, or for the end of start() if index is the number of slots.
+    ///
+    /// \return True if the transfer has finished.
+    ///
+    bool release(size_t index, int status);
+
+    void finish();
+};
+}
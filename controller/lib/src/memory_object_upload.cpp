@@ -0,0 +1,75 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * memory_object_upload.cpp
+ *
+ * Memory object upload implementation
+ */
+
+#include "jdksavdecc_aecp_aa.h"
+#include "end_station_imp.h"
+#include "memory_object_upload.h"
+
+namespace avdecc_lib
+{
+memory_object_upload::memory_object_upload(end_station_imp * end_station_obj, uint16_t desc_index, uint64_t start_address,
+                                           size_t window, void * notification_id, memory_object_transfer_listener * listener)
+    : memory_object_transfer(end_station_obj, desc_index, start_address, window, notification_id, listener), m_image(NULL)
+{
+}
+
+memory_object_upload::~memory_object_upload() {}
+
+int memory_object_upload::open(const char * file_path)
+{
+    if (m_image_file.open(file_path) != 0)
+        return -1;
+
+    set_image(m_image_file.data(), m_image_file.size());
+
+    return 0;
+}
+
+void memory_object_upload::set_image(const uint8_t * data, uint64_t size)
+{
+    m_image = data;
+    m_size = size;
+}
+
+int memory_object_upload::send_chunk(slot & s)
+{
+    return m_end_station->send_aecp_address_access_cmd(&s, JDKSAVDECC_AECP_AA_MODE_WRITE, s.length,
+                                                       m_start_address + s.offset,
+                                                       const_cast<uint8_t *>(m_image + s.offset));
+}
+
+int memory_object_upload::chunk_completed(slot & s, const uint8_t * frame, size_t frame_len)
+{
+    (void)s;
+    (void)frame;
+    (void)frame_len;
+
+    return JDKSAVDECC_AECP_AA_STATUS_SUCCESS;
+}
+}
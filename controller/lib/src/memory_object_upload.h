@@ -0,0 +1,68 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * memory_object_upload.h
+ *
+ * Memory object upload class, which writes a memory mapped image to a memory object with
+ * ADDRESS_ACCESS commands, keeping a window of writes inflight.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "mapped_file.h"
+#include "memory_object_transfer.h"
+
+namespace avdecc_lib
+{
+class memory_object_upload : public memory_object_transfer
+{
+public:
+    memory_object_upload(end_station_imp * end_station_obj, uint16_t desc_index, uint64_t start_address,
+                         size_t window, void * notification_id, memory_object_transfer_listener * listener = NULL);
+    ~memory_object_upload();
+
+    ///
+    /// Map the image to upload.
+    ///
+    /// \return 0 on success, -1 if the file cannot be mapped.
+    ///
+    int open(const char * file_path);
+
+    ///
+    /// Upload an image mapped by the caller, which must remain mapped until the upload finishes.
+    ///
+    void set_image(const uint8_t * data, uint64_t size);
+
+protected:
+    const char * mode_name() const { return "write"; }
+    int send_chunk(slot & s);
+    int chunk_completed(slot & s, const uint8_t * frame, size_t frame_len);
+
+private:
+    mapped_file m_image_file;
+    const uint8_t * m_image;
+};
+}
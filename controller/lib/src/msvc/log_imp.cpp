@@ -33,14 +33,19 @@
 
 namespace avdecc_lib
 {
-log_imp * log_imp_ref = new log_imp();
-
 log_imp::log_imp()
 {
     logging_thread_init(); // Start log thread
 }
 
-log_imp::~log_imp() {}
+log_imp::~log_imp()
+{
+    // Wait for the thread to drain the queue and exit, unless it is the thread destroying the controller
+    SetEvent(poll_events[KILL_EVENT]);
+    if (GetCurrentThreadId() != thread_id)
+        WaitForSingleObject(h_thread, INFINITE);
+    CloseHandle(h_thread);
+}
 
 int log_imp::logging_thread_init()
 {
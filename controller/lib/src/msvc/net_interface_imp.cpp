@@ -34,6 +34,7 @@
 #include "enumeration.h"
 #include "log_imp.h"
 #include "jdksavdecc_pdu.h"
+#include "capture_replay.h"
 #include "net_interface_imp.h"
 
 namespace avdecc_lib
@@ -43,6 +44,27 @@ net_interface * STDCALL create_net_interface()
     return (new net_interface_imp());
 }
 
+net_interface * STDCALL create_net_interface_with_transport(net_transport * transport)
+{
+    // frame transports are only supported on linux
+    return NULL;
+}
+
+net_interface * STDCALL create_net_interface_in_fanout_group(uint16_t group_id)
+{
+    (void)group_id;
+
+    // PACKET_FANOUT is a linux packet socket option, so there is no fanout group to join here
+    // and the caller gets NULL, as documented for create_net_interface_in_fanout_group()
+    return NULL;
+}
+
+capture_replay * STDCALL create_capture_replay(const char * path, bool recorded_pace)
+{
+    // frame transports are only supported on linux
+    return NULL;
+}
+
 net_interface_imp::net_interface_imp()
 {
     total_devs = 0;
@@ -36,6 +36,7 @@
 #include <pcap.h>
 #include "avdecc-lib_build.h"
 #include "net_interface.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
@@ -142,6 +143,4 @@ public:
     bool is_pcap() { return true; }
     bool is_Mac_Native_end_station_connected(uint64_t entity_id) { return false; }
 };
-
-extern net_interface_imp * net_interface_ref;
 }
@@ -32,14 +32,19 @@
 
 namespace avdecc_lib
 {
-notification_acmp_imp * notification_acmp_imp_ref = new notification_acmp_imp();
-
 notification_acmp_imp::notification_acmp_imp()
 {
     notification_thread_init(); // Start notification thread
 }
 
-notification_acmp_imp::~notification_acmp_imp() {}
+notification_acmp_imp::~notification_acmp_imp()
+{
+    // Wait for the thread to drain the queue and exit, unless it is the thread destroying the controller
+    SetEvent(poll_events[KILL_EVENT]);
+    if (GetCurrentThreadId() != thread_id)
+        WaitForSingleObject(h_thread, INFINITE);
+    CloseHandle(h_thread);
+}
 
 int notification_acmp_imp::notification_thread_init()
 {
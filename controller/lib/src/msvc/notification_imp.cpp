@@ -28,18 +28,25 @@
  */
 
 #include "enumeration.h"
+#include "util.h"
+#include "cmd_trace.h"
 #include "notification_imp.h"
 
 namespace avdecc_lib
 {
-notification_imp * notification_imp_ref = new notification_imp();
-
 notification_imp::notification_imp()
 {
     notification_thread_init(); // Start notification thread
 }
 
-notification_imp::~notification_imp() {}
+notification_imp::~notification_imp()
+{
+    // Wait for the thread to drain the queue and exit, unless it is the thread destroying the controller
+    SetEvent(poll_events[KILL_EVENT]);
+    if (GetCurrentThreadId() != thread_id)
+        WaitForSingleObject(h_thread, INFINITE);
+    CloseHandle(h_thread);
+}
 
 int notification_imp::notification_thread_init()
 {
@@ -69,6 +76,7 @@ DWORD WINAPI notification_imp::proc_notification_thread(LPVOID lpParam)
 
 int notification_imp::proc_notification_thread_callback()
 {
+    context_scope scope(m_context);
     DWORD dwEvent;
 
     while (true)
@@ -79,6 +87,7 @@ int notification_imp::proc_notification_thread_callback()
         {
             if ((write_index - read_index) > 0)
             {
+                cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_INSTANT, "notification", "dispatch", read_index);
                 notification_callback(user_obj,
                                       notification_buf[read_index % NOTIFICATION_BUF_COUNT].notification_type,
                                       notification_buf[read_index % NOTIFICATION_BUF_COUNT].entity_id,
@@ -88,6 +97,9 @@ int notification_imp::proc_notification_thread_callback()
                                       notification_buf[read_index % NOTIFICATION_BUF_COUNT].desc_index,
                                       notification_buf[read_index % NOTIFICATION_BUF_COUNT].cmd_status,
                                       notification_buf[read_index % NOTIFICATION_BUF_COUNT].notification_id); // Call callback function
+                cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_END, "notification",
+                                                utility::notification_value_to_name(notification_buf[read_index % NOTIFICATION_BUF_COUNT].notification_type),
+                                                read_index);
                 read_index++;
             }
         }
@@ -32,6 +32,7 @@
 #include "avdecc_lib_os.h"
 #include <stdint.h>
 #include "notification.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
@@ -74,6 +75,4 @@ private:
     ///
     void post_notification_event();
 };
-
-extern notification_imp * notification_imp_ref;
 }
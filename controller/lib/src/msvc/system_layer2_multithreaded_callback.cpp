@@ -36,6 +36,7 @@
 #include "controller_imp.h"
 #include "system_message_queue.h"
 #include "system_tx_queue.h"
+#include "cmd_completion.h"
 #include "system_layer2_multithreaded_callback.h"
 
 namespace avdecc_lib
@@ -48,6 +49,7 @@ size_t system_queue_tx(void * notification_id, uint32_t notification_flag, uint8
 {
     if (local_system)
     {
+        cmd_completion_ref->sent(notification_id);
         return local_system->queue_tx_frame(notification_id, notification_flag, frame, frame_len);
     }
     else
@@ -56,6 +58,24 @@ size_t system_queue_tx(void * notification_id, uint32_t notification_flag, uint8
     }
 }
 
+int system_set_priority_for_next_cmd(void * notification_id, uint32_t priority)
+{
+    if (local_system)
+    {
+        return local_system->set_priority_for_next_cmd(notification_id, priority);
+    }
+    else
+    {
+        return -1;
+    }
+}
+
+void system_clear_priority_for_next_cmd(void * notification_id)
+{
+    if (local_system)
+        local_system->clear_priority_for_next_cmd(notification_id);
+}
+
 system * STDCALL create_system(system::system_type type, net_interface * netif, controller * controller_obj)
 {
     (void)type; //unused
@@ -67,6 +87,7 @@ system * STDCALL create_system(system::system_type type, net_interface * netif,
 system_layer2_multithreaded_callback::system_layer2_multithreaded_callback(net_interface * netif, controller * controller_obj)
 {
     wait_mgr = new cmd_wait_mgr();
+    tx_cmd_queue = new tx_priority_queue();
 
     netif_obj_in_system = netif;
     controller_obj_in_system = dynamic_cast<controller_imp *>(controller_obj);
@@ -82,6 +103,8 @@ system_layer2_multithreaded_callback::~system_layer2_multithreaded_callback()
 {
     delete poll_rx.rx_queue;
     delete poll_tx.tx_queue;
+    delete tx_cmd_queue;
+    delete wait_mgr;
 }
 
 void STDCALL system_layer2_multithreaded_callback::destroy()
@@ -95,46 +118,62 @@ void STDCALL system_layer2_multithreaded_callback::destroy()
 
 int system_layer2_multithreaded_callback::queue_tx_frame(void * notification_id, uint32_t notification_flag, uint8_t * frame, size_t frame_len)
 {
-    struct poll_thread_data thread_data;
+    struct tx_priority_queue::tx_entry t;
+    uint8_t wakeup = 0;
+
+    // The wait is active before the command is queued, so that a command failing as soon as it
+    // is taken from the queue still releases this thread.
+    bool is_waited = (notification_flag == CMD_WITH_NOTIFICATION) &&
+                     wait_mgr->set_active_state(notification_id);
 
     assert(frame_len < 2048);
-    thread_data.frame = new uint8_t[2048];
-    if (!thread_data.frame)
+    t.frame = new uint8_t[2048];
+    if (!t.frame)
     {
         exit(EXIT_FAILURE);
     }
-    thread_data.frame_len = frame_len;
-    memcpy(thread_data.frame, frame, frame_len);
-    thread_data.notification_id = notification_id;
-    thread_data.notification_flag = notification_flag;
-    poll_tx.tx_queue->queue_push(&thread_data);
+    t.frame_len = frame_len;
+    memcpy(t.frame, frame, frame_len);
+    t.notification_id = notification_id;
+    t.notification_flag = notification_flag;
+    t.priority = tx_cmd_queue->classify(notification_id, notification_flag, is_waited);
+    t.trace_id = 0;
+    tx_cmd_queue->push(t);
+    poll_tx.tx_queue->queue_push(&wakeup);
 
     //Check for conditions that cause wait for completion.
-    if (wait_mgr->primed_state() &&
-        wait_mgr->match_id(notification_id) &&
-        (notification_flag == CMD_WITH_NOTIFICATION))
+    if (is_waited)
     {
-        int status = 0;
-
-        status = wait_mgr->set_active_state();
-        assert(status == 0);
-        WaitForSingleObject(waiting_sem, INFINITE);
-        resp_status_for_cmd = wait_mgr->get_completion_status();
-        status = wait_mgr->set_idle_state();
-        assert(status == 0);
+        wait_mgr->wait_for_completion();
     }
     return 0;
 }
 
 int STDCALL system_layer2_multithreaded_callback::set_wait_for_next_cmd(void * id)
 {
-    wait_mgr->set_primed_state(id);
-    return 0;
+    return wait_mgr->set_primed_state(id);
+}
+
+int STDCALL system_layer2_multithreaded_callback::set_priority_for_next_cmd(void * id, uint32_t priority)
+{
+    return tx_cmd_queue->set_priority_for_next_cmd(id, priority);
+}
+
+void system_layer2_multithreaded_callback::clear_priority_for_next_cmd(void * id)
+{
+    tx_cmd_queue->clear_priority_for_next_cmd(id);
+}
+
+int STDCALL system_layer2_multithreaded_callback::set_virtual_clock(virtual_clock * clock)
+{
+    (void)clock;
+    log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Virtual clocks are not supported on this platform");
+    return -1;
 }
 
 int STDCALL system_layer2_multithreaded_callback::get_last_resp_status()
 {
-    return resp_status_for_cmd;
+    return wait_mgr->get_completion_status();
 }
 
 DWORD WINAPI system_layer2_multithreaded_callback::proc_wpcap_thread(LPVOID lpParam)
@@ -235,15 +274,13 @@ int system_layer2_multithreaded_callback::init_wpcap_thread()
         exit(EXIT_FAILURE);
     }
 
-    poll_tx.tx_queue = new system_message_queue(sizeof(struct poll_thread_data));
+    poll_tx.tx_queue = new system_message_queue(sizeof(uint8_t));
     poll_tx.queue_thread.kill_sem = CreateSemaphore(NULL, 0, 32767, NULL);
     poll_tx.timeout_event = CreateEvent(NULL, FALSE, FALSE, NULL);
     poll_events_array[WPCAP_TX_PACKET] = poll_tx.tx_queue->queue_data_available_object();
 
     poll_events_array[KILL_ALL] = CreateEvent(NULL, FALSE, FALSE, NULL);
 
-    waiting_sem = CreateSemaphore(NULL, 0, 32767, NULL);
-
     return 0;
 }
 
@@ -300,30 +337,40 @@ int system_layer2_multithreaded_callback::poll_single()
                                                   operation_id,
                                                   is_operation_id_valid);
 
-        if (
-            wait_mgr->active_state() &&
-            is_notification_id_valid &&
-            wait_mgr->match_id(thread_data.notification_id) &&
-            !controller_obj_in_system->is_inflight_cmd_with_notification_id(wait_mgr->get_notify_id()) &&
-            !controller_obj_in_system->is_active_operation_with_notification_id(wait_mgr->get_notify_id()))
+        if (is_notification_id_valid &&
+            wait_mgr->active_state(thread_data.notification_id) &&
+            !controller_obj_in_system->is_inflight_cmd_with_notification_id(thread_data.notification_id) &&
+            !controller_obj_in_system->is_active_operation_with_notification_id(thread_data.notification_id))
         {
-            int status = wait_mgr->set_completion_status(rx_status);
-            assert(status == 0);
-            ReleaseSemaphore(waiting_sem, 1, NULL);
+            wait_mgr->set_completion_status(thread_data.notification_id, rx_status);
         }
         delete[] thread_data.frame;
     }
     break;
 
     case WAIT_OBJECT_0 + WPCAP_TX_PACKET:
-        poll_tx.tx_queue->queue_pop_nowait(&thread_data);
+    {
+        struct tx_priority_queue::tx_entry t;
+        uint8_t wakeup;
 
-        controller_obj_in_system->tx_packet_event(thread_data.notification_id,
-                                                  thread_data.notification_flag,
-                                                  thread_data.frame,
-                                                  thread_data.frame_len);
-        delete[] thread_data.frame;
-        break;
+        // Each wakeup byte stands for one queued command, but not necessarily the one taken here,
+        // as commands of a higher priority class are taken first.
+        poll_tx.tx_queue->queue_pop_nowait(&wakeup);
+        if (tx_cmd_queue->pop(t))
+        {
+            int tx_status = controller_obj_in_system->tx_packet_event(t.notification_id,
+                                                                      t.notification_flag,
+                                                                      t.frame,
+                                                                      t.frame_len,
+                                                                      t.priority);
+
+            // A command that failed without being sent has no response or timeout to release the waiting app thread
+            if (tx_status != 0)
+                wait_mgr->set_completion_status(t.notification_id, tx_status);
+            delete[] t.frame;
+        }
+    }
+    break;
 
     case WAIT_OBJECT_0 + KILL_ALL: // Exit or kill event
         status = -1;
@@ -332,29 +379,21 @@ int system_layer2_multithreaded_callback::poll_single()
 
     if (tick_timer.timeout()) // Check tick timeout
     {
-        bool notification_id_incomplete = false;
-
-        if (wait_mgr->active_state())
-        {
-            if (controller_obj_in_system->is_inflight_cmd_with_notification_id(wait_mgr->get_notify_id()) ||
-                controller_obj_in_system->is_active_operation_with_notification_id(wait_mgr->get_notify_id()))
-                notification_id_incomplete = true;
-        }
-
-        // If waiting on a command to complete and the command was "inflight" prior to calling the
-        // timer tick update (ie notification_id_incomplete == true) AND after calling the timer tick
-        // update the command is no longer "inflight", timeout processing has removed it, so signal the
-        // waiting app thread.
+        // Release the app threads waiting for commands that timed out during the timer tick update,
+        // unless an operation started by the command is still active.
         controller_obj_in_system->time_tick_event();
 
-        bool is_timeout_for_waiting_notify_id = wait_mgr->active_state() && notification_id_incomplete &&
-                                                !controller_obj_in_system->is_inflight_cmd_with_notification_id(wait_mgr->get_notify_id()) &&
-                                                !controller_obj_in_system->is_active_operation_with_notification_id(wait_mgr->get_notify_id());
-        if (is_timeout_for_waiting_notify_id)
+        const std::vector<void *> & timed_out_ids = controller_obj_in_system->timed_out_notification_ids();
+        for (size_t i = 0; i < timed_out_ids.size(); i++)
         {
-            int status = wait_mgr->set_completion_status(AVDECC_LIB_STATUS_TICK_TIMEOUT);
-            assert(status == 0);
-            ReleaseSemaphore(waiting_sem, 1, NULL);
+            void * id = timed_out_ids[i];
+
+            if (wait_mgr->active_state(id) &&
+                !controller_obj_in_system->is_inflight_cmd_with_notification_id(id) &&
+                !controller_obj_in_system->is_active_operation_with_notification_id(id))
+            {
+                wait_mgr->set_completion_status(id, AVDECC_LIB_STATUS_TICK_TIMEOUT);
+            }
         }
 
         tick_timer.start(NETIF_READ_TIMEOUT_MS);
@@ -32,6 +32,7 @@
 #include "system.h"
 #include "timer.h"
 #include "cmd_wait_mgr.h"
+#include "tx_priority_queue.h"
 
 namespace avdecc_lib
 {
@@ -58,7 +59,7 @@ private:
     {
         struct thread_creation queue_thread;
         system_message_queue * rx_queue;
-        system_message_queue * tx_queue;
+        system_message_queue * tx_queue; // Holds one wakeup byte for each command pushed to tx_cmd_queue
         HANDLE timeout_event;
     };
 
@@ -75,10 +76,9 @@ private:
     struct msg_poll poll_tx;
     struct thread_creation poll_thread;
     HANDLE poll_events_array[NUM_OF_EVENTS];
-    HANDLE waiting_sem;
 
     cmd_wait_mgr * wait_mgr;
-    int resp_status_for_cmd;
+    tx_priority_queue * tx_cmd_queue;
     timer tick_timer; // A tick timer that is always running
 
 public:
@@ -105,6 +105,21 @@ public:
     ///
     int STDCALL set_wait_for_next_cmd(void * id);
 
+    ///
+    /// Set the priority class of the next command sent with the notification id.
+    ///
+    int STDCALL set_priority_for_next_cmd(void * id, uint32_t priority);
+
+    ///
+    /// Drop the priority set for the notification id.
+    ///
+    void clear_priority_for_next_cmd(void * id);
+
+    ///
+    /// Virtual clocks are not supported on this platform.
+    ///
+    int STDCALL set_virtual_clock(virtual_clock * clock);
+
     ///
     /// Wait for the response packet with the corrsponding notification id to be received.
     ///
@@ -29,6 +29,9 @@
 
 #include "avdecc_lib_os.h"
 #include "enumeration.h"
+#include "util.h"
+#include "cmd_trace.h"
+#include "controller_context.h"
 #include "notification.h"
 
 namespace avdecc_lib
@@ -55,6 +58,7 @@ notification::notification()
     notification_callback = default_notification;
     user_obj = NULL;
     missed_notification_event_cnt = 0;
+    m_context = current_context();
 }
 
 notification::~notification() {}
@@ -72,7 +76,10 @@ void notification::post_notification_msg(int32_t notification_type, uint64_t ent
     if (notification_type == NO_MATCH_FOUND || notification_type == END_STATION_CONNECTED ||
         notification_type == END_STATION_DISCONNECTED || notification_type == COMMAND_TIMEOUT ||
         notification_type == RESPONSE_RECEIVED || notification_type == END_STATION_READ_COMPLETED ||
-        notification_type == UNSOLICITED_RESPONSE_RECEIVED)
+        notification_type == UNSOLICITED_RESPONSE_RECEIVED || notification_type == MEMORY_OBJECT_TRANSFER_PROGRESS ||
+        notification_type == MEMORY_OBJECT_TRANSFER_COMPLETED || notification_type == FIRMWARE_ROLLOUT_PROGRESS ||
+        notification_type == FIRMWARE_ROLLOUT_COMPLETED || notification_type == END_STATION_DEGRADED ||
+        notification_type == END_STATION_RECOVERED || notification_type == END_STATION_EVICTED)
     {
         index = InterlockedExchangeAdd(&write_index, 1);
         notification_buf[index % NOTIFICATION_BUF_COUNT].notification_type = notification_type;
@@ -84,6 +91,8 @@ void notification::post_notification_msg(int32_t notification_type, uint64_t ent
         notification_buf[index % NOTIFICATION_BUF_COUNT].cmd_status = cmd_status;
         notification_buf[index % NOTIFICATION_BUF_COUNT].notification_id = notification_id;
 
+        cmd_trace_ref->post_trace_event(cmd_trace::TRACE_ASYNC_BEGIN, "notification",
+                                        utility::notification_value_to_name(notification_type), index, entity_id, (intptr_t)notification_id);
         post_notification_event();
     }
 }
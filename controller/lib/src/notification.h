@@ -33,6 +33,8 @@
 
 namespace avdecc_lib
 {
+class controller_context;
+
 class notification
 {
 public:
@@ -63,6 +65,7 @@ protected:
     void (*acmp_notification_callback)(void *, int32_t, uint16_t, uint64_t, uint16_t, uint64_t, uint16_t, uint32_t, void *);
     void * user_obj;
     uint32_t missed_notification_event_cnt;
+    controller_context * m_context; // The context the dispatch thread runs in
 
     enum
     {
@@ -73,7 +73,9 @@ void notification_acmp::post_acmp_notification_msg(int32_t notification_type, ui
     }
 
     if (notification_type == BROADCAST_ACMP_RESPONSE_RECEIVED ||
-        notification_type == ACMP_RESPONSE_RECEIVED)
+        notification_type == ACMP_RESPONSE_RECEIVED ||
+        notification_type == CONNECTION_ADDED ||
+        notification_type == CONNECTION_REMOVED)
     {
         index = InterlockedExchangeAdd(&write_index, 1);
         notification_buf[index % NOTIFICATION_BUF_COUNT].notification_type = notification_type;
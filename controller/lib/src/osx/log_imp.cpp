@@ -34,8 +34,6 @@
 
 namespace avdecc_lib
 {
-log_imp * log_imp_ref = new log_imp();
-
 log_imp::log_imp()
 {
     logging_thread_init(); // Start log thread
@@ -45,6 +43,12 @@ log_imp::~log_imp()
 {
     // posting to sem without data causes the thread to terminate
     post_log_event();
+
+    // Wait for the thread to drain the queue and exit, unless it is the thread destroying the controller
+    if (pthread_equal(pthread_self(), h_thread))
+        pthread_detach(h_thread);
+    else
+        pthread_join(h_thread, NULL);
     sem_unlink("/log_waiting_sem");
 }
 
@@ -238,7 +238,7 @@ bool mac_native_interface_bridge::is_end_station_connected(uint64_t entity_id)
         }
         else
         {
-            avdecc_lib::log_imp_ref->post_log_msg(
+            log_imp_ref->post_log_msg(
                                                   avdecc_lib::LOGGING_LEVEL_ERROR,
                                                   "(talker:0x%llx, listener:0x%llx, %s) Mac Native ACMP sendCommand returned error",
                                                   acmp_msg.talkerEntityID,
@@ -247,7 +247,7 @@ bool mac_native_interface_bridge::is_end_station_connected(uint64_t entity_id)
         }
     }])
     {
-        avdecc_lib::log_imp_ref->post_log_msg(
+        log_imp_ref->post_log_msg(
                                               avdecc_lib::LOGGING_LEVEL_ERROR,
                                               "(talker:0x%llx, listener:0x%llx, %s) Mac Native ACMP sendCommand error",
                                               acmp_msg.talkerEntityID,
@@ -366,7 +366,7 @@ bool mac_native_interface_bridge::is_end_station_connected(uint64_t entity_id)
             }
             else
             {
-                avdecc_lib::log_imp_ref->post_log_msg(
+                log_imp_ref->post_log_msg(
                                                       avdecc_lib::LOGGING_LEVEL_ERROR,
                                                       "(0x%llx, %s) Mac Native AECP sendCommand returned error",
                                                       aecp_msg.targetEntityID,
@@ -375,7 +375,7 @@ bool mac_native_interface_bridge::is_end_station_connected(uint64_t entity_id)
             
         }])
         {
-            avdecc_lib::log_imp_ref->post_log_msg(
+            log_imp_ref->post_log_msg(
                                                   avdecc_lib::LOGGING_LEVEL_ERROR,
                                                   "(0x%llx, %s) Mac Native AECP sendCommand error",
                                                   aecp_msg.targetEntityID,
@@ -47,6 +47,7 @@
 #include "enumeration.h"
 #include "log_imp.h"
 #include "jdksavdecc_pdu.h"
+#include "capture_replay.h"
 #include "net_interface_imp.h"
 #include "mac_native_interface_bridge.h"
 
@@ -57,6 +58,27 @@ net_interface * STDCALL create_net_interface()
     return (new net_interface_imp());
 }
 
+net_interface * STDCALL create_net_interface_with_transport(net_transport * transport)
+{
+    // frame transports are only supported on linux
+    return NULL;
+}
+
+net_interface * STDCALL create_net_interface_in_fanout_group(uint16_t group_id)
+{
+    (void)group_id;
+
+    // PACKET_FANOUT is a linux packet socket option, so there is no fanout group to join here
+    // and the caller gets NULL, as documented for create_net_interface_in_fanout_group()
+    return NULL;
+}
+
+capture_replay * STDCALL create_capture_replay(const char * path, bool recorded_pace)
+{
+    // frame transports are only supported on linux
+    return NULL;
+}
+
 net_interface_imp::net_interface_imp()
 {
     if (pcap_findalldevs(&all_devs, err_buf) == -1) // Retrieve the device list on the local machine.
@@ -34,6 +34,7 @@
 #include <pcap.h>
 #include "avdecc-lib_build.h"
 #include "net_interface.h"
+#include "controller_context.h"
 
 namespace avdecc_lib
 {
@@ -171,6 +172,4 @@ public:
     ///
     bool is_Mac_Native_end_station_connected(uint64_t entity_id);
 };
-
-extern net_interface_imp * net_interface_ref;
 }
@@ -39,8 +39,6 @@
 
 namespace avdecc_lib
 {
-notification_acmp_imp * notification_acmp_imp_ref = new notification_acmp_imp();
-
 notification_acmp_imp::notification_acmp_imp()
 {
     notification_thread_init(); // Start notification thread
@@ -49,6 +47,12 @@ notification_acmp_imp::notification_acmp_imp()
 notification_acmp_imp::~notification_acmp_imp()
 {
     post_acmp_notification_event();
+
+    // Wait for the thread to drain the queue and exit, unless it is the thread destroying the controller
+    if (pthread_equal(pthread_self(), h_thread))
+        pthread_detach(h_thread);
+    else
+        pthread_join(h_thread, NULL);
     sem_unlink("/notify_waiting_sem");
 }
 
@@ -59,6 +59,7 @@
 #include "controller_imp.h"
 #include "system_message_queue.h"
 #include "system_tx_queue.h"
+#include "cmd_completion.h"
 #include "system_rx_queue.h"
 #include "system_layer2_multithreaded_callback.h"
 
@@ -75,6 +76,7 @@ size_t system_queue_tx(void * notification_id, uint32_t notification_flag, uint8
 {
     if (local_system)
     {
+        cmd_completion_ref->sent(notification_id);
         return local_system->queue_tx_frame(notification_id, notification_flag, frame, mem_buf_len);
     }
     else
@@ -95,6 +97,24 @@ size_t system_queue_rx(const uint8_t * frame, size_t mem_buf_len)
     }
 }
 
+int system_set_priority_for_next_cmd(void * notification_id, uint32_t priority)
+{
+    if (local_system)
+    {
+        return local_system->set_priority_for_next_cmd(notification_id, priority);
+    }
+    else
+    {
+        return -1;
+    }
+}
+
+void system_clear_priority_for_next_cmd(void * notification_id)
+{
+    if (local_system)
+        local_system->clear_priority_for_next_cmd(notification_id);
+}
+
 system * STDCALL create_system(system::system_type type, net_interface * netif, controller * controller_obj)
 {
     (void)type;
@@ -112,12 +132,11 @@ system_layer2_multithreaded_callback::system_layer2_multithreaded_callback(net_i
     pipe(rx_pipe);
 
     wait_mgr = new cmd_wait_mgr();
+    tx_cmd_queue = new tx_priority_queue();
 
-    sem_unlink("/waiting_sem");
     sem_unlink("/shutdown_sem");
 
-    if (((waiting_sem = sem_open("/waiting_sem", O_CREAT | O_EXCL, 0644, 0)) == SEM_FAILED) ||
-        ((shutdown_sem = sem_open("/shutdown_sem", O_CREAT | O_EXCL, 0644, 0)) == SEM_FAILED))
+    if ((shutdown_sem = sem_open("/shutdown_sem", O_CREAT | O_EXCL, 0644, 0)) == SEM_FAILED)
     {
         perror("sem_open");
         exit(-1);
@@ -126,8 +145,9 @@ system_layer2_multithreaded_callback::system_layer2_multithreaded_callback(net_i
 
 system_layer2_multithreaded_callback::~system_layer2_multithreaded_callback()
 {
-    sem_unlink("/waiting_sem");
     sem_unlink("/shutdown_sem");
+    delete tx_cmd_queue;
+    delete wait_mgr;
 }
 
 void STDCALL system_layer2_multithreaded_callback::destroy()
@@ -152,7 +172,13 @@ int system_layer2_multithreaded_callback::queue_tx_frame(
     uint8_t * frame,
     size_t mem_buf_len)
 {
-    struct tx_data t;
+    struct tx_priority_queue::tx_entry t;
+    uint8_t wakeup = 0;
+
+    // The wait is active before the command is queued, so that a command failing as soon as it
+    // is taken from the queue still releases this thread.
+    bool is_waited = (notification_flag == CMD_WITH_NOTIFICATION) &&
+                     wait_mgr->set_active_state(notification_id);
 
     t.frame = new uint8_t[2048];
     if (!t.frame)
@@ -160,28 +186,19 @@ int system_layer2_multithreaded_callback::queue_tx_frame(
         perror("malloc");
         exit(EXIT_FAILURE);
     }
-    t.mem_buf_len = mem_buf_len;
+    t.frame_len = mem_buf_len;
     memcpy(t.frame, frame, mem_buf_len);
     t.notification_id = notification_id;
     t.notification_flag = notification_flag;
-    write(tx_pipe[PIPE_WR], &t, sizeof(t));
+    t.priority = tx_cmd_queue->classify(notification_id, notification_flag, is_waited);
+    t.trace_id = 0;
+    tx_cmd_queue->push(t);
+    write(tx_pipe[PIPE_WR], &wakeup, sizeof(wakeup));
 
     // Check for conditions that cause wait for completion.
-    if (wait_mgr->primed_state() &&
-        wait_mgr->match_id(notification_id) &&
-        (notification_flag == CMD_WITH_NOTIFICATION))
+    if (is_waited)
     {
-        int status = 0;
-
-        status = wait_mgr->set_active_state();
-        assert(status == 0);
-        if (sem_wait(waiting_sem) != 0)
-        {
-            perror("sem_wait");
-        }
-        resp_status_for_cmd = wait_mgr->get_completion_status();
-        status = wait_mgr->set_idle_state();
-        assert(status == 0);
+        wait_mgr->wait_for_completion();
     }
 
     return 0;
@@ -209,13 +226,29 @@ int system_layer2_multithreaded_callback::queue_rx_frame(
 
 int STDCALL system_layer2_multithreaded_callback::set_wait_for_next_cmd(void * id)
 {
-    wait_mgr->set_primed_state(id);
-    return 0;
+    return wait_mgr->set_primed_state(id);
+}
+
+int STDCALL system_layer2_multithreaded_callback::set_priority_for_next_cmd(void * id, uint32_t priority)
+{
+    return tx_cmd_queue->set_priority_for_next_cmd(id, priority);
+}
+
+void system_layer2_multithreaded_callback::clear_priority_for_next_cmd(void * id)
+{
+    tx_cmd_queue->clear_priority_for_next_cmd(id);
+}
+
+int STDCALL system_layer2_multithreaded_callback::set_virtual_clock(virtual_clock * clock)
+{
+    (void)clock;
+    log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "Virtual clocks are not supported on this platform");
+    return -1;
 }
 
 int STDCALL system_layer2_multithreaded_callback::get_last_resp_status()
 {
-    return resp_status_for_cmd;
+    return wait_mgr->get_completion_status();
 }
 
 int system_layer2_multithreaded_callback::fn_timer_cb(struct kevent * priv)
@@ -233,30 +266,21 @@ int system_layer2_multithreaded_callback::fn_tx_cb(struct kevent * priv)
 
 int system_layer2_multithreaded_callback::fn_timer(struct kevent * priv)
 {
-    bool notification_id_incomplete = false;
-
-    if (wait_mgr->active_state())
-    {
-        if (controller_ref_in_system->is_inflight_cmd_with_notification_id(wait_mgr->get_notify_id()) ||
-            controller_ref_in_system->is_active_operation_with_notification_id(wait_mgr->get_notify_id()))
-            notification_id_incomplete = true;
-    }
-
-    // If waiting on a command to complete and the command was "inflight" prior to calling the
-    // timer tick update (ie notification_id_incomplete == true) AND after calling the timer tick
-    // update the command is no longer "inflight", timeout processing has removed it, so signal the
-    // waiting app thread.
-
+    // Release the app threads waiting for commands that timed out during the timer tick update,
+    // unless an operation started by the command is still active.
     controller_ref_in_system->time_tick_event();
 
-    bool is_timeout_for_waiting_notify_id = wait_mgr->active_state() && notification_id_incomplete &&
-                                            !controller_ref_in_system->is_inflight_cmd_with_notification_id(wait_mgr->get_notify_id()) &&
-                                            !controller_ref_in_system->is_active_operation_with_notification_id(wait_mgr->get_notify_id());
-    if (is_timeout_for_waiting_notify_id)
+    const std::vector<void *> & timed_out_ids = controller_ref_in_system->timed_out_notification_ids();
+    for (size_t i = 0; i < timed_out_ids.size(); i++)
     {
-        int status = wait_mgr->set_completion_status(AVDECC_LIB_STATUS_TICK_TIMEOUT);
-        assert(status == 0);
-        sem_post(waiting_sem);
+        void * id = timed_out_ids[i];
+
+        if (wait_mgr->active_state(id) &&
+            !controller_ref_in_system->is_inflight_cmd_with_notification_id(id) &&
+            !controller_ref_in_system->is_active_operation_with_notification_id(id))
+        {
+            wait_mgr->set_completion_status(id, AVDECC_LIB_STATUS_TICK_TIMEOUT);
+        }
     }
 
     return 0;
@@ -264,16 +288,24 @@ int system_layer2_multithreaded_callback::fn_timer(struct kevent * priv)
 
 int system_layer2_multithreaded_callback::fn_tx(struct kevent * priv)
 {
-    struct tx_data t;
-    int result = read(tx_pipe[PIPE_RD], &t, sizeof(t));
+    struct tx_priority_queue::tx_entry t;
+    uint8_t wakeup;
+    int result = read(tx_pipe[PIPE_RD], &wakeup, sizeof(wakeup));
 
-    if (result > 0)
+    // Each wakeup byte stands for one queued command, but not necessarily the one taken here,
+    // as commands of a higher priority class are taken first.
+    if (result > 0 && tx_cmd_queue->pop(t))
     {
-        controller_ref_in_system->tx_packet_event(
+        int tx_status = controller_ref_in_system->tx_packet_event(
             t.notification_id,
             t.notification_flag,
             t.frame,
-            t.mem_buf_len);
+            t.frame_len,
+            t.priority);
+
+        // A command that failed without being sent has no response or timeout to release the waiting app thread
+        if (tx_status != 0)
+            wait_mgr->set_completion_status(t.notification_id, tx_status);
 
         delete[] t.frame;
     }
@@ -315,16 +347,12 @@ int system_layer2_multithreaded_callback::fn_netif(struct kevent * priv)
                                                   operation_id,
                                                   is_operation_id_valid);
 
-        if (
-            wait_mgr->active_state() &&
-            is_notification_id_valid &&
-            wait_mgr->match_id(notification_id) &&
-            !controller_ref_in_system->is_inflight_cmd_with_notification_id(wait_mgr->get_notify_id()) &&
-            !controller_ref_in_system->is_active_operation_with_notification_id(wait_mgr->get_notify_id()))
+        if (is_notification_id_valid &&
+            wait_mgr->active_state(notification_id) &&
+            !controller_ref_in_system->is_inflight_cmd_with_notification_id(notification_id) &&
+            !controller_ref_in_system->is_active_operation_with_notification_id(notification_id))
         {
-            int status = wait_mgr->set_completion_status(rx_status);
-            assert(status == 0);
-            sem_post(waiting_sem);
+            wait_mgr->set_completion_status(notification_id, rx_status);
         }
         
         if (!net_interface_ref->is_pcap())
@@ -32,6 +32,7 @@
 #include "avdecc_lib_os.h"
 #include "system.h"
 #include "cmd_wait_mgr.h"
+#include "tx_priority_queue.h"
 
 namespace avdecc_lib
 {
@@ -68,6 +69,21 @@ public:
     ///
     int STDCALL set_wait_for_next_cmd(void * id);
 
+    ///
+    /// Set the priority class of the next command sent with the notification id.
+    ///
+    int STDCALL set_priority_for_next_cmd(void * id, uint32_t priority);
+
+    ///
+    /// Drop the priority set for the notification id.
+    ///
+    void clear_priority_for_next_cmd(void * id);
+
+    ///
+    /// Virtual clocks are not supported on this platform.
+    ///
+    int STDCALL set_virtual_clock(virtual_clock * clock);
+
     ///
     /// Wait for the response packet with the corrsponding notification id to be received.
     ///
@@ -88,14 +104,6 @@ private:
     struct epoll_priv;
     typedef int (*handler_fn)(struct kevent * priv);
 
-    struct tx_data
-    {
-        uint8_t * frame;
-        size_t mem_buf_len;
-        void * notification_id;
-        uint32_t notification_flag;
-    };
-    
     struct rx_data
     {
         uint8_t * frame;
@@ -114,10 +122,9 @@ private:
 
     // int network_fd;
     int rx_pipe[2];
-    int tx_pipe[2];
+    int tx_pipe[2]; // One byte is written for each command pushed to tx_cmd_queue
     // int tick_timer;
 
-    sem_t * waiting_sem;
     sem_t * shutdown_sem;
 
     // Events to process:
@@ -126,7 +133,7 @@ private:
     // Timer tick - from timer
 
     cmd_wait_mgr * wait_mgr;
-    int resp_status_for_cmd;
+    tx_priority_queue * tx_cmd_queue;
     int prep_evt_desc(int fd, handler_fn fn, struct epoll_priv * priv, struct epoll_event * ev);
     static int fn_timer_cb(struct kevent * priv);
     static int fn_netif_cb(struct kevent * priv);
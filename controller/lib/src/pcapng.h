@@ -0,0 +1,81 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * pcapng.h
+ *
+ * Block types and option codes of the pcapng capture file format used to record and replay
+ * frames.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace avdecc_lib
+{
+namespace pcapng
+{
+    enum block_types
+    {
+        SECTION_HEADER_BLOCK = 0x0A0D0D0A,
+        INTERFACE_DESCRIPTION_BLOCK = 0x00000001,
+        SIMPLE_PACKET_BLOCK = 0x00000003,
+        ENHANCED_PACKET_BLOCK = 0x00000006
+    };
+
+    enum block_consts
+    {
+        BYTE_ORDER_MAGIC = 0x1A2B3C4D,
+        VERSION_MAJOR = 1,
+        VERSION_MINOR = 0,
+        LINKTYPE_ETHERNET = 1,
+        BLOCK_HDR_LEN = 8,    ///< Block type and block total length
+        BLOCK_TRAILER_LEN = 4 ///< Block total length
+    };
+
+    enum option_codes
+    {
+        OPT_ENDOFOPT = 0,
+        IF_MACADDR = 6,
+        IF_TSRESOL = 9,
+        EPB_FLAGS = 2
+    };
+
+    enum epb_flags_direction ///< The direction bits of the EPB_FLAGS option
+    {
+        DIRECTION_UNKNOWN = 0,
+        DIRECTION_INBOUND = 1,
+        DIRECTION_OUTBOUND = 2,
+        DIRECTION_MASK = 3
+    };
+
+    ///
+    /// \return The length padded to a multiple of 4 bytes, as block bodies and options are.
+    ///
+    inline uint32_t padded_len(uint32_t len)
+    {
+        return (len + 3) & ~(uint32_t)3;
+    }
+}
+}
@@ -0,0 +1,72 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * rate_limiter.cpp
+ *
+ * Token bucket rate limiter implementation
+ */
+
+#include <algorithm>
+#include "enumeration.h"
+#include "rate_limiter.h"
+
+namespace avdecc_lib
+{
+rate_limiter::rate_limiter(uint32_t max_bytes_per_sec, uint32_t max_packets_per_sec)
+    : m_max_bytes_per_sec(max_bytes_per_sec), m_max_packets_per_sec(max_packets_per_sec)
+{
+    // A burst of at least one full packet, so that a low limit still makes progress
+    m_max_burst_bytes = std::max<double>(max_bytes_per_sec / 10.0, AECP_AA_MAX_TLV_DATA_LEN);
+    m_max_burst_packets = std::max<double>(max_packets_per_sec / 10.0, 1.0);
+    m_bytes = m_max_burst_bytes;
+    m_packets = m_max_burst_packets;
+    m_last_refill_ms = m_clock.clk_convert_to_ms(m_clock.clk_monotonic());
+}
+
+rate_limiter::~rate_limiter() {}
+
+bool rate_limiter::try_acquire(size_t bytes)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if ((m_max_bytes_per_sec && (m_bytes < bytes)) || (m_max_packets_per_sec && (m_packets < 1.0)))
+        return false;
+
+    m_bytes -= bytes;
+    m_packets -= 1.0;
+
+    return true;
+}
+
+void rate_limiter::refill()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    uint32_t now_ms = m_clock.clk_convert_to_ms(m_clock.clk_monotonic());
+    uint32_t elapsed_ms = now_ms - m_last_refill_ms;
+
+    m_last_refill_ms = now_ms;
+    m_bytes = std::min(m_bytes + (double)m_max_bytes_per_sec * elapsed_ms / 1000.0, m_max_burst_bytes);
+    m_packets = std::min(m_packets + (double)m_max_packets_per_sec * elapsed_ms / 1000.0, m_max_burst_packets);
+}
+}
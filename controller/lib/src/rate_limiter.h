@@ -0,0 +1,72 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * rate_limiter.h
+ *
+ * Token bucket limiting the bytes and packets per second sent by one or more operations.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include "timer.h"
+
+namespace avdecc_lib
+{
+class rate_limiter
+{
+public:
+    ///
+    /// \param max_bytes_per_sec The payload bytes allowed per second, or 0 for no limit.
+    /// \param max_packets_per_sec The packets allowed per second, or 0 for no limit.
+    ///
+    rate_limiter(uint32_t max_bytes_per_sec, uint32_t max_packets_per_sec);
+    ~rate_limiter();
+
+    ///
+    /// Take the budget for one packet carrying the given number of payload bytes.
+    ///
+    /// \return False if the budget is used up, in which case the packet should be sent after a later refill().
+    ///
+    bool try_acquire(size_t bytes);
+
+    ///
+    /// Add the budget for the time elapsed since the last refill, up to 100 milliseconds worth.
+    ///
+    void refill();
+
+private:
+    std::mutex m_lock;
+    timer m_clock;
+    uint32_t m_max_bytes_per_sec;
+    uint32_t m_max_packets_per_sec;
+    double m_bytes;
+    double m_packets;
+    double m_max_burst_bytes;
+    double m_max_burst_packets;
+    uint32_t m_last_refill_ms;
+};
+}
@@ -0,0 +1,294 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * routing_matrix.cpp
+ *
+ * Routing matrix implementation
+ */
+
+#include <stddef.h>
+#include <map>
+#include <utility>
+#include "enumeration.h"
+#include "configuration_descriptor.h"
+#include "stream_input_descriptor.h"
+#include "end_station_imp.h"
+#include "controller_imp.h"
+#include "routing_matrix.h"
+
+namespace avdecc_lib
+{
+static const size_t no_change = (size_t)-1;
+
+routing_matrix::routing_matrix(controller_imp * controller_obj, size_t window,
+                               void (*change_callback)(void *, const routing_change *),
+                               void (*completion_callback)(void *, const routing_change *, size_t),
+                               void * user_obj)
+    : m_controller(controller_obj), m_window(window),
+      m_change_callback(change_callback), m_completion_callback(completion_callback), m_user_obj(user_obj),
+      m_inflight(0), m_remaining(1)
+{
+}
+
+routing_matrix::~routing_matrix() {}
+
+int routing_matrix::plan(const stream_connection * connections, size_t connection_count)
+{
+    typedef std::pair<uint64_t, uint16_t> stream_id;
+    typedef std::map<stream_id, const stream_connection *> listener_map;
+
+    listener_map desired;
+    for (size_t i = 0; i < connection_count; i++)
+    {
+        stream_id listener(connections[i].listener_entity_id, connections[i].listener_unique_id);
+        std::pair<listener_map::iterator, bool> inserted = desired.insert(listener_map::value_type(listener, &connections[i]));
+
+        if (!inserted.second && ((inserted.first->second->talker_entity_id != connections[i].talker_entity_id) ||
+                                 (inserted.first->second->talker_unique_id != connections[i].talker_unique_id)))
+        {
+            return -1;
+        }
+    }
+
+    std::vector<stream_connection> current(m_controller->get_connections(NULL, 0));
+    size_t current_count;
+    while ((current_count = m_controller->get_connections(current.data(), current.size())) > current.size())
+        current.resize(current_count);
+    current.resize(current_count);
+
+    // Upper bound, so that the elements are never moved once their addresses are in use
+    m_changes.reserve(current.size() + desired.size());
+    m_next.reserve(current.size() + desired.size());
+
+    for (size_t i = 0; i < current.size(); i++)
+    {
+        listener_map::iterator d = desired.find(stream_id(current[i].listener_entity_id, current[i].listener_unique_id));
+
+        if (d == desired.end())
+        {
+            add_change(current[i], false, no_change);
+        }
+        else
+        {
+            if ((d->second->talker_entity_id != current[i].talker_entity_id) ||
+                (d->second->talker_unique_id != current[i].talker_unique_id))
+            {
+                // The listener is disconnected from its current talker before connecting to the new one
+                add_change(current[i], false, no_change);
+                add_change(*d->second, true, m_changes.size() - 1);
+            }
+            desired.erase(d);
+        }
+    }
+
+    for (listener_map::iterator d = desired.begin(); d != desired.end(); ++d)
+        add_change(*d->second, true, no_change);
+
+    m_remaining = m_changes.size() + 1;
+
+    return 0;
+}
+
+void routing_matrix::add_change(const stream_connection & connection, bool connect, size_t prev)
+{
+    routing_change change;
+
+    change.connection = connection;
+    change.connect = connect;
+    change.status = AVDECC_LIB_STATUS_INVALID;
+    m_changes.push_back(change);
+    m_next.push_back(no_change);
+
+    if (prev == no_change)
+        m_ready.push_back(m_changes.size() - 1);
+    else
+        m_next[prev] = m_changes.size() - 1;
+}
+
+void routing_matrix::start()
+{
+    if (send_pending())
+        return;
+
+    if (release(m_changes.size()))
+        finish();
+}
+
+void routing_matrix::cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len)
+{
+    (void)frame;
+    (void)frame_len;
+
+    routing_change * change = static_cast<routing_change *>(notification_id);
+    change->status = status;
+
+    if (release(change - &m_changes[0]))
+    {
+        finish();
+        return;
+    }
+
+    send_pending();
+}
+
+void routing_matrix::select_changes(std::vector<size_t> & to_send)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    to_send.clear();
+    while ((m_inflight < m_window) && !m_ready.empty())
+    {
+        size_t index = m_ready.front();
+        m_ready.pop_front();
+        m_inflight++;
+
+        // Registered before sending so that the command is routed here when the lib thread sends it
+        cmd_completion_ref->register_id(&m_changes[index], this);
+        to_send.push_back(index);
+    }
+}
+
+bool routing_matrix::send_pending()
+{
+    std::vector<size_t> to_send;
+
+    for (;;)
+    {
+        select_changes(to_send);
+        if (to_send.empty())
+            return false;
+
+        for (size_t i = 0; i < to_send.size(); i++)
+        {
+            routing_change & change = m_changes[to_send[i]];
+
+            if (send_change(change) == 0)
+                continue;
+
+            // Not sent, so it completes straight away and its place in the window is reused
+            cmd_completion_ref->unregister_id(&change);
+            change.status = AVDECC_LIB_STATUS_INVALID;
+            if (release(to_send[i]))
+            {
+                finish();
+                return true;
+            }
+        }
+    }
+}
+
+int routing_matrix::send_change(routing_change & change)
+{
+    end_station_imp * end_station = m_controller->find_end_station_by_entity_id(change.connection.listener_entity_id);
+    if (!end_station)
+        return -1;
+
+    end_station_pin pin(end_station);
+    if (!pin.is_pinned())
+        return -1;
+
+    configuration_descriptor * configuration = end_station->get_current_config();
+    if (!configuration)
+        return -1;
+
+    // The listener unique id is the descriptor index of the STREAM_INPUT, which need not be its position
+    stream_input_descriptor * stream_input = NULL;
+    for (size_t i = 0; i < configuration->stream_input_desc_count(); i++)
+    {
+        stream_input_descriptor * desc = configuration->get_stream_input_desc_by_index(i);
+        if (desc && (desc->descriptor_index() == change.connection.listener_unique_id))
+        {
+            stream_input = desc;
+            break;
+        }
+    }
+    if (!stream_input)
+        return -1;
+
+    if (change.connect)
+        return stream_input->send_connect_rx_cmd(&change, change.connection.talker_entity_id, change.connection.talker_unique_id, 0);
+    else
+        return stream_input->send_disconnect_rx_cmd(&change, change.connection.talker_entity_id, change.connection.talker_unique_id);
+}
+
+bool routing_matrix::release(size_t index)
+{
+    for (;;)
+    {
+        size_t cancelled = no_change;
+
+        if (index < m_changes.size())
+        {
+            if (m_change_callback)
+                m_change_callback(m_user_obj, &m_changes[index]);
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+
+            if (index < m_changes.size())
+            {
+                m_inflight--;
+                if (m_next[index] != no_change)
+                {
+                    if (is_prerequisite_met(m_changes[index]))
+                    {
+                        m_ready.push_back(m_next[index]);
+                    }
+                    else
+                    {
+                        // Released like a sent change, without sending its command
+                        cancelled = m_next[index];
+                        m_inflight++;
+                    }
+                }
+            }
+
+            if (--m_remaining == 0)
+                return true;
+        }
+
+        if (cancelled == no_change)
+            return false;
+
+        m_changes[cancelled].status = AVDECC_LIB_STATUS_CANCELLED;
+        index = cancelled;
+    }
+}
+
+bool routing_matrix::is_prerequisite_met(const routing_change & change)
+{
+    // A listener stream that was already disconnected can still be connected to its new talker
+    return (change.status == ACMP_STATUS_SUCCESS) ||
+           (!change.connect && (change.status == ACMP_STATUS_NOT_CONNECTED));
+}
+
+void routing_matrix::finish()
+{
+    if (m_completion_callback)
+        m_completion_callback(m_user_obj, m_changes.empty() ? NULL : &m_changes[0], m_changes.size());
+
+    delete this;
+}
+}
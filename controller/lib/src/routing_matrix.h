@@ -0,0 +1,122 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * routing_matrix.h
+ *
+ * Routing matrix class, which brings the stream connections on the network to a desired
+ * set by sending the CONNECT_RX and DISCONNECT_RX commands that differ from the connection
+ * graph, pipelined within a window of inflight commands.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include "controller.h"
+#include "cmd_completion.h"
+
+namespace avdecc_lib
+{
+class controller_imp;
+
+class routing_matrix : public cmd_completion_handler
+{
+public:
+    enum
+    {
+        MAX_WINDOW = 512 // Keeps the commands queued to the lib thread well within the tx pipe
+    };
+
+    routing_matrix(controller_imp * controller_obj, size_t window,
+                   void (*change_callback)(void *, const routing_change *),
+                   void (*completion_callback)(void *, const routing_change *, size_t),
+                   void * user_obj);
+    ~routing_matrix();
+
+    ///
+    /// Compute the changes from the current connection graph to the desired connections.
+    ///
+    /// \return 0 on success, -1 if a listener stream appears with two different talker streams.
+    ///
+    int plan(const stream_connection * connections, size_t connection_count);
+
+    ///
+    /// Send the first window of commands. The object deletes itself after calling the
+    /// completion callback, which may happen before this function returns.
+    ///
+    void start();
+
+    void cmd_completed(void * notification_id, int status, const uint8_t * frame, size_t frame_len);
+
+private:
+    controller_imp * m_controller;
+    size_t m_window;
+    void (*m_change_callback)(void *, const routing_change *);
+    void (*m_completion_callback)(void *, const routing_change *, size_t);
+    void * m_user_obj;
+
+    std::vector<routing_change> m_changes; // Not resized once planned, as each element is the notification id of its command
+    std::vector<size_t> m_next;            // The change to send after each change completes, as a listener's changes are sent in turn
+
+    std::mutex m_lock;
+    std::deque<size_t> m_ready; // Changes that can be sent once the window allows
+    size_t m_inflight;
+    size_t m_remaining; // Changes not yet completed, plus one while start() is running
+
+    void add_change(const stream_connection & connection, bool connect, size_t prev);
+    void select_changes(std::vector<size_t> & to_send);
+
+    ///
+    /// Send commands for the ready changes.
+    ///
+    /// \return True if the last change completed and the object was deleted.
+    ///
+    bool send_pending();
+
+    ///
+    /// Send the CONNECT_RX or DISCONNECT_RX command for a change to the listener stream input.
+    ///
+    /// \return 0 on success, -1 if the listener End Station or STREAM_INPUT is not found.
+    ///
+    int send_change(routing_change & change);
+
+    ///
+    /// Report a completed change and account for it, or for the end of start() if index is
+    /// the number of changes. A change that depends on a failed change is reported as cancelled.
+    ///
+    /// \return True if all the changes have completed.
+    ///
+    bool release(size_t index);
+
+    ///
+    /// \return True if the change that another change depends on has succeeded.
+    ///
+    static bool is_prerequisite_met(const routing_change & change);
+
+    void finish();
+};
+}
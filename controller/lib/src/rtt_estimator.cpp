@@ -0,0 +1,208 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * rtt_estimator.cpp
+ *
+ * Round trip time estimator implementation
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include "jdksavdecc_aem_command.h"
+#include "jdksavdecc_acmp.h"
+#include "enumeration.h"
+#include "rtt_estimator.h"
+
+namespace avdecc_lib
+{
+rtt_estimator::rtt_estimator()
+{
+    m_policy.adaptive_timeouts = true;
+    m_policy.min_timeout_ms = 50;
+    m_policy.max_timeout_ms = 5000;
+    m_policy.max_retries = 1;
+    m_policy.backoff_percent = 100;
+}
+
+rtt_estimator::~rtt_estimator() {}
+
+int rtt_estimator::set_policy(const cmd_retry_policy & policy)
+{
+    if ((policy.min_timeout_ms == 0) ||
+        (policy.min_timeout_ms > policy.max_timeout_ms) ||
+        (policy.max_retries > MAX_RETRIES) ||
+        (policy.backoff_percent < 100))
+        return -1;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_policy = policy;
+    return 0;
+}
+
+uint32_t rtt_estimator::max_retries()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_policy.max_retries;
+}
+
+struct rtt_estimator::estimate & rtt_estimator::find_estimate(uint64_t entity_id, uint32_t cmd_class, uint16_t cmd_type)
+{
+    std::map<estimate_key, estimate>::iterator i = m_estimates.find(estimate_key(entity_id, cmd_class, cmd_type));
+
+    if (i == m_estimates.end())
+    {
+        struct estimate e;
+        memset(&e, 0, sizeof(e));
+        i = m_estimates.insert(std::make_pair(estimate_key(entity_id, cmd_class, cmd_type), e)).first;
+    }
+
+    return i->second;
+}
+
+uint32_t rtt_estimator::adaptive_timeout_ms(const struct estimate & e)
+{
+    // RTO = SRTT + max(G, 4 * RTTVAR), where G is the granularity of the timeout checks
+    float rto_ms = e.srtt_ms + std::max((float)CLOCK_GRANULARITY_MS, 4 * e.rttvar_ms);
+    uint32_t timeout_ms = (uint32_t)std::ceil(rto_ms);
+
+    return std::min(std::max(timeout_ms, m_policy.min_timeout_ms), m_policy.max_timeout_ms);
+}
+
+uint32_t rtt_estimator::timeout_ms(uint64_t entity_id, uint32_t cmd_class, uint16_t cmd_type, uint32_t default_timeout_ms)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    struct estimate & e = find_estimate(entity_id, cmd_class, cmd_type);
+
+    if (m_policy.adaptive_timeouts && e.sample_count)
+        e.timeout_ms = adaptive_timeout_ms(e);
+    else
+        e.timeout_ms = default_timeout_ms;
+
+    return e.timeout_ms;
+}
+
+uint32_t rtt_estimator::retry_timeout_ms(uint64_t entity_id, uint32_t cmd_class, uint16_t cmd_type, uint32_t prev_timeout_ms)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    struct estimate & e = find_estimate(entity_id, cmd_class, cmd_type);
+    uint64_t timeout_ms = (uint64_t)prev_timeout_ms * m_policy.backoff_percent / 100;
+
+    // The backoff stops at max_timeout_ms, but 1722.1 timeouts above it are not reduced
+    e.retry_count++;
+    return (uint32_t)std::min(timeout_ms, (uint64_t)std::max(prev_timeout_ms, m_policy.max_timeout_ms));
+}
+
+void rtt_estimator::sample(uint64_t entity_id, uint32_t cmd_class, uint16_t cmd_type, uint32_t rtt_ms)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    struct estimate & e = find_estimate(entity_id, cmd_class, cmd_type);
+    float r = (float)rtt_ms;
+
+    if (e.sample_count == 0)
+    {
+        e.srtt_ms = r;
+        e.rttvar_ms = r / 2;
+    }
+    else
+    {
+        e.rttvar_ms = 0.75f * e.rttvar_ms + 0.25f * std::fabs(e.srtt_ms - r);
+        e.srtt_ms = 0.875f * e.srtt_ms + 0.125f * r;
+    }
+    e.sample_count++;
+}
+
+void rtt_estimator::timed_out(uint64_t entity_id, uint32_t cmd_class, uint16_t cmd_type)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    find_estimate(entity_id, cmd_class, cmd_type).timeout_count++;
+}
+
+void rtt_estimator::remove_entity(uint64_t entity_id)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    std::map<estimate_key, estimate>::iterator i = m_estimates.lower_bound(estimate_key(entity_id, 0, 0));
+
+    while ((i != m_estimates.end()) && (i->first.entity_id == entity_id))
+        m_estimates.erase(i++);
+}
+
+size_t rtt_estimator::get_estimates(rtt_estimate * estimates, size_t max_count)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    size_t count = 0;
+
+    for (std::map<estimate_key, estimate>::iterator i = m_estimates.begin(); i != m_estimates.end(); ++i, count++)
+    {
+        if (count >= max_count)
+            continue;
+
+        estimates[count].entity_id = i->first.entity_id;
+        estimates[count].cmd_class = i->first.cmd_class;
+        estimates[count].cmd_type = i->first.cmd_type;
+        estimates[count].sample_count = i->second.sample_count;
+        estimates[count].srtt_ms = i->second.srtt_ms;
+        estimates[count].rttvar_ms = i->second.rttvar_ms;
+        estimates[count].timeout_ms = i->second.timeout_ms;
+        estimates[count].retry_count = i->second.retry_count;
+        estimates[count].timeout_count = i->second.timeout_count;
+    }
+
+    return count;
+}
+
+uint32_t rtt_estimator::aecp_cmd_class(uint32_t msg_type)
+{
+    switch (msg_type)
+    {
+    case JDKSAVDECC_AECP_MESSAGE_TYPE_ADDRESS_ACCESS_COMMAND:
+        return CMD_CLASS_ADDRESS_ACCESS;
+    case JDKSAVDECC_AECP_MESSAGE_TYPE_VENDOR_UNIQUE_COMMAND:
+        return CMD_CLASS_VENDOR_UNIQUE;
+    default:
+        return CMD_CLASS_AEM;
+    }
+}
+
+uint16_t rtt_estimator::aecp_cmd_type(uint32_t msg_type, const uint8_t * frame)
+{
+    if (msg_type != JDKSAVDECC_AECP_MESSAGE_TYPE_AEM_COMMAND)
+        return 0;
+
+    // Without the unsolicited flag
+    return jdksavdecc_aecpdu_aem_get_command_type(frame, ETHER_HDR_SIZE) & 0x7FFF;
+}
+
+uint32_t rtt_estimator::acmp_cmd_class(uint32_t msg_type)
+{
+    switch (msg_type)
+    {
+    case JDKSAVDECC_ACMP_MESSAGE_TYPE_CONNECT_RX_COMMAND:
+    case JDKSAVDECC_ACMP_MESSAGE_TYPE_DISCONNECT_RX_COMMAND:
+        return CMD_CLASS_ACMP_CONNECT_RX;
+    default:
+        return CMD_CLASS_ACMP;
+    }
+}
+}
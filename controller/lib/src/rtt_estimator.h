@@ -0,0 +1,160 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * rtt_estimator.h
+ *
+ * Round trip time estimator class, which measures the responses of each End Station and command
+ * type and computes the timeout of the next command of that type sent to it, in the way of the
+ * TCP retransmission timer (RFC 6298). Command types are estimated apart because an End Station
+ * may answer descriptor reads much faster than commands that change its state.
+ *
+ * The AEM and ACMP Controller State Machines ask for the timeout of each command they send and
+ * report responses, resends and final timeouts on the lib thread. The retry policy is set and the
+ * estimates are read by the application through the controller.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <mutex>
+#include <utility>
+#include "controller.h"
+#include "controller_context.h"
+
+namespace avdecc_lib
+{
+class rtt_estimator
+{
+public:
+    enum
+    {
+        CLOCK_GRANULARITY_MS = 25, // Inflight commands are only checked for timeouts on each tick
+        MAX_RETRIES = 8
+    };
+
+    rtt_estimator();
+    ~rtt_estimator();
+
+    ///
+    /// Replace the retry policy.
+    ///
+    /// \return 0 on success, -1 if the policy is not valid.
+    ///
+    int set_policy(const cmd_retry_policy & policy);
+
+    ///
+    /// \return The number of times a timed out command is resent before it fails.
+    ///
+    uint32_t max_retries();
+
+    ///
+    /// \return The timeout of a command about to be sent to the End Station.
+    ///
+    /// \param cmd_type The AEM command type or ACMP message type, or 0 for other commands.
+    /// \param default_timeout_ms The 1722.1 timeout of the command, used until a response is measured.
+    ///
+    uint32_t timeout_ms(uint64_t entity_id, uint32_t cmd_class, uint16_t cmd_type, uint32_t default_timeout_ms);
+
+    ///
+    /// Record a resend and return the timeout of the resent command, after backoff.
+    ///
+    uint32_t retry_timeout_ms(uint64_t entity_id, uint32_t cmd_class, uint16_t cmd_type, uint32_t prev_timeout_ms);
+
+    ///
+    /// Update the estimate with the round trip time of a response to a command that was not resent.
+    ///
+    void sample(uint64_t entity_id, uint32_t cmd_class, uint16_t cmd_type, uint32_t rtt_ms);
+
+    ///
+    /// Record a command that failed after its last resend timed out.
+    ///
+    void timed_out(uint64_t entity_id, uint32_t cmd_class, uint16_t cmd_type);
+
+    ///
+    /// Discard the estimates of an End Station that has departed or been evicted.
+    ///
+    void remove_entity(uint64_t entity_id);
+
+    ///
+    /// Copy the estimates into the array provided.
+    ///
+    /// \return The total number of estimates, which may exceed max_count.
+    ///
+    size_t get_estimates(rtt_estimate * estimates, size_t max_count);
+
+    ///
+    /// \return The cmd_classes value of an AECP command message type.
+    ///
+    static uint32_t aecp_cmd_class(uint32_t msg_type);
+
+    ///
+    /// \return The command type of an AECP command frame, the AEM command type for AEM commands and 0 otherwise.
+    ///
+    static uint16_t aecp_cmd_type(uint32_t msg_type, const uint8_t * frame);
+
+    ///
+    /// \return The cmd_classes value of an ACMP command message type.
+    ///
+    static uint32_t acmp_cmd_class(uint32_t msg_type);
+
+private:
+    struct estimate_key
+    {
+        uint64_t entity_id;
+        uint32_t cmd_class;
+        uint16_t cmd_type;
+
+        estimate_key(uint64_t id, uint32_t class_of_cmd, uint16_t type_of_cmd)
+            : entity_id(id), cmd_class(class_of_cmd), cmd_type(type_of_cmd) {}
+
+        bool operator<(const estimate_key & other) const
+        {
+            if (entity_id != other.entity_id)
+                return entity_id < other.entity_id;
+            if (cmd_class != other.cmd_class)
+                return cmd_class < other.cmd_class;
+            return cmd_type < other.cmd_type;
+        }
+    };
+
+    struct estimate
+    {
+        uint32_t sample_count;
+        float srtt_ms;
+        float rttvar_ms;
+        uint32_t timeout_ms;
+        uint32_t retry_count;
+        uint32_t timeout_count;
+    };
+
+    std::mutex m_lock; // Held by the lib thread while updating the estimates, and by the application thread
+    cmd_retry_policy m_policy;
+    std::map<estimate_key, estimate> m_estimates;
+
+    struct estimate & find_estimate(uint64_t entity_id, uint32_t cmd_class, uint16_t cmd_type);
+    uint32_t adaptive_timeout_ms(const struct estimate & e);
+};
+}
@@ -0,0 +1,133 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * segmented_array.h
+ *
+ * Append-only array of pointers that readers index without locks. Elements are stored in segments
+ * that double in size and are never moved, and a new element is published by storing the count
+ * with release semantics after the element is written.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+namespace avdecc_lib
+{
+template <class T>
+class segmented_array
+{
+public:
+    enum econsts
+    {
+        FIRST_SEGMENT_SHIFT = 4,
+        FIRST_SEGMENT_SIZE = 1 << FIRST_SEGMENT_SHIFT,
+        MAX_SEGMENTS = 24
+    };
+
+    segmented_array()
+    {
+        m_count = 0;
+        m_owns_elements = true;
+        for (uint32_t i = 0; i < MAX_SEGMENTS; i++)
+            segments[i] = NULL;
+    };
+    ~segmented_array()
+    {
+        size_t count = m_count.load(std::memory_order_acquire);
+
+        for (size_t i = 0; m_owns_elements && i < count; i++)
+            delete at(i);
+        for (uint32_t i = 0; i < MAX_SEGMENTS; i++)
+            delete[] segments[i];
+    };
+
+    ///
+    /// Find the segment holding an element. Segment n holds FIRST_SEGMENT_SIZE << n elements.
+    ///
+    /// \param i The index of the element.
+    /// \param offset The offset of the element in its segment.
+    ///
+    /// \return The segment, which is MAX_SEGMENTS or more if the index is past the last segment.
+    ///
+    static size_t segment_of(size_t i, size_t & offset)
+    {
+        size_t pos = i + FIRST_SEGMENT_SIZE;
+        size_t seg = 0;
+
+        while ((pos >> (FIRST_SEGMENT_SHIFT + seg)) > 1)
+            seg++;
+        offset = pos - ((size_t)FIRST_SEGMENT_SIZE << seg);
+        return seg;
+    };
+
+    const size_t size(void)
+    {
+        return m_count.load(std::memory_order_acquire);
+    };
+    T * at(size_t i)
+    {
+        size_t offset;
+        size_t seg;
+
+        if (i >= m_count.load(std::memory_order_acquire))
+            throw std::out_of_range("segmented_array::at");
+
+        seg = segment_of(i, offset);
+        return segments[seg][offset];
+    };
+    void push_back(T * element)
+    {
+        std::lock_guard<std::mutex> guard(writer_locker);
+        size_t count = m_count.load(std::memory_order_relaxed);
+        size_t offset;
+        size_t seg = segment_of(count, offset);
+
+        if (seg >= MAX_SEGMENTS)
+            throw std::length_error("segmented_array::push_back");
+
+        if (!segments[seg])
+            segments[seg] = new T *[(size_t)FIRST_SEGMENT_SIZE << seg];
+
+        segments[seg][offset] = element;
+        m_count.store(count + 1, std::memory_order_release);
+    };
+    /* the elements are moved to another array and are not deleted with this one */
+    void disown(void)
+    {
+        m_owns_elements = false;
+    };
+
+private:
+    std::atomic<size_t> m_count;
+    bool m_owns_elements;
+    std::mutex writer_locker;
+    T ** segments[MAX_SEGMENTS];
+};
+}
@@ -49,6 +49,10 @@ stream_input_descriptor_imp::~stream_input_descriptor_imp() {}
 
 stream_input_descriptor_response * STDCALL stream_input_descriptor_imp::get_stream_input_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new stream_input_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                            resp_ref->get_desc_size(), resp_ref->get_desc_pos());
@@ -56,6 +60,10 @@ stream_input_descriptor_response * STDCALL stream_input_descriptor_imp::get_stre
 
 stream_input_counters_response * STDCALL stream_input_descriptor_imp::get_stream_input_counters_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_COUNTERS);
     if (!resp_frame)
@@ -67,6 +75,10 @@ stream_input_counters_response * STDCALL stream_input_descriptor_imp::get_stream
 
 stream_input_get_stream_format_response * STDCALL stream_input_descriptor_imp::get_stream_input_get_stream_format_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_STREAM_FORMAT);
     if (!resp_frame)
@@ -78,6 +90,10 @@ stream_input_get_stream_format_response * STDCALL stream_input_descriptor_imp::g
 
 stream_input_get_stream_info_response * STDCALL stream_input_descriptor_imp::get_stream_input_get_stream_info_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_STREAM_INFO);
     if (!resp_frame)
@@ -89,6 +105,10 @@ stream_input_get_stream_info_response * STDCALL stream_input_descriptor_imp::get
 
 stream_input_get_rx_state_response * STDCALL stream_input_descriptor_imp::get_stream_input_get_rx_state_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(GET_RX_STATE_RESPONSE);
     if (!resp_frame)
@@ -100,6 +120,12 @@ stream_input_get_rx_state_response * STDCALL stream_input_descriptor_imp::get_st
 
 int STDCALL stream_input_descriptor_imp::send_set_stream_format_cmd(void * notification_id, uint64_t new_stream_format)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_set_stream_format aem_cmd_set_stream_format;
     ssize_t aem_cmd_set_stream_format_returned;
@@ -169,6 +195,10 @@ int stream_input_descriptor_imp::proc_set_stream_format_resp(void *& notificatio
 
     if (status == AEM_STATUS_SUCCESS)
     {
+        // Also the GET_STREAM_FORMAT result, which has the same layout, so that changes announced in
+        // unsolicited responses are seen without polling
+        store_cmd_resp_frame(AEM_CMD_GET_STREAM_FORMAT, frame, ETHER_HDR_SIZE, frame_len);
+
         uint8_t * buffer = (uint8_t *)malloc(resp_ref->get_desc_size() * sizeof(uint8_t)); //fetch current desc frame
         memcpy(buffer, resp_ref->get_desc_buffer(), resp_ref->get_desc_size());
         jdksavdecc_descriptor_stream_set_current_format(aem_cmd_set_stream_format_resp.stream_format,
@@ -185,6 +215,12 @@ int stream_input_descriptor_imp::proc_set_stream_format_resp(void *& notificatio
 
 int STDCALL stream_input_descriptor_imp::send_get_stream_format_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_stream_format aem_cmd_get_stream_format;
     memset(&aem_cmd_get_stream_format, 0, sizeof(aem_cmd_get_stream_format));
@@ -280,6 +316,12 @@ int stream_input_descriptor_imp::proc_set_stream_info_resp(void *& notification_
 
 int STDCALL stream_input_descriptor_imp::send_get_stream_info_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_stream_info aem_cmd_get_stream_info;
     ssize_t aem_cmd_get_stream_info_returned;
@@ -355,6 +397,12 @@ int stream_input_descriptor_imp::proc_get_stream_info_resp(void *& notification_
 
 int STDCALL stream_input_descriptor_imp::send_start_streaming_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_start_streaming aem_cmd_start_streaming;
     ssize_t aem_cmd_start_streaming_returned;
@@ -427,6 +475,12 @@ int stream_input_descriptor_imp::proc_start_streaming_resp(void *& notification_
 
 int STDCALL stream_input_descriptor_imp::send_stop_streaming_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_stop_streaming aem_cmd_stop_streaming;
     ssize_t aem_cmd_stop_streaming_returned;
@@ -499,6 +553,12 @@ int stream_input_descriptor_imp::proc_stop_streaming_resp(void *& notification_i
 
 int STDCALL stream_input_descriptor_imp::send_connect_rx_cmd(void * notification_id, uint64_t talker_entity_id, uint16_t talker_unique_id, uint16_t flags)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     entity_descriptor_response * entity_resp_ref = base_end_station_imp_ref->get_entity_desc_by_index(0)->get_entity_response();
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_acmpdu acmp_cmd_connect_rx;
@@ -565,6 +625,12 @@ int stream_input_descriptor_imp::proc_connect_rx_resp(void *& notification_id, c
 
 int STDCALL stream_input_descriptor_imp::send_disconnect_rx_cmd(void * notification_id, uint64_t talker_entity_id, uint16_t talker_unique_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     entity_descriptor_response * entity_resp_ref = base_end_station_imp_ref->get_entity_desc_by_index(0)->get_entity_response();
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_acmpdu acmp_cmd_disconnect_rx;
@@ -631,6 +697,17 @@ int stream_input_descriptor_imp::proc_disconnect_rx_resp(void *& notification_id
 
 int STDCALL stream_input_descriptor_imp::send_get_rx_state_cmd(void * notification_id)
 {
+    return send_get_rx_state(notification_id, CMD_WITH_NOTIFICATION);
+}
+
+int stream_input_descriptor_imp::send_get_rx_state(void * notification_id, uint32_t notification_flag)
+{
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     entity_descriptor_response * entity_resp_ref = base_end_station_imp_ref->get_entity_desc_by_index(0)->get_entity_response();
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_acmpdu acmp_cmd_get_rx_state;
@@ -664,7 +741,7 @@ int STDCALL stream_input_descriptor_imp::send_get_rx_state_cmd(void * notificati
     }
 
     acmp_controller_state_machine_ref->common_hdr_init(JDKSAVDECC_ACMP_MESSAGE_TYPE_GET_RX_STATE_COMMAND, &cmd_frame);
-    system_queue_tx(notification_id, CMD_WITH_NOTIFICATION, cmd_frame.payload, cmd_frame.length);
+    system_queue_tx(notification_id, notification_flag, cmd_frame.payload, cmd_frame.length);
 
     delete entity_resp_ref;
     return 0;
@@ -700,6 +777,12 @@ int stream_input_descriptor_imp::proc_get_rx_state_resp(void *& notification_id,
 
 int STDCALL stream_input_descriptor_imp::send_get_counters_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_counters aem_cmd_get_stream_input_counters;
     memset(&aem_cmd_get_stream_input_counters, 0, sizeof(aem_cmd_get_stream_input_counters));
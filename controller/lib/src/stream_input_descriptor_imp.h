@@ -88,6 +88,11 @@ public:
     int STDCALL send_get_rx_state_cmd(void * notification_id);
     int proc_get_rx_state_resp(void *& notification_id, const uint8_t * frame, size_t frame_len, int & status);
 
+    ///
+    /// Send a GET_RX_STATE command, optionally without notifying the application of the response.
+    ///
+    int send_get_rx_state(void * notification_id, uint32_t notification_flag);
+
     int STDCALL send_get_counters_cmd(void * notification_id);
     int proc_get_counters_resp(void *& notification_id, const uint8_t * fram, size_t frame_len, int & status);
 };
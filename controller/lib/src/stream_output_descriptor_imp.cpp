@@ -52,6 +52,10 @@ stream_output_descriptor_imp::~stream_output_descriptor_imp() {}
 
 stream_output_descriptor_response * STDCALL stream_output_descriptor_imp::get_stream_output_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new stream_output_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                             resp_ref->get_desc_size(), resp_ref->get_desc_pos());
@@ -59,6 +63,10 @@ stream_output_descriptor_response * STDCALL stream_output_descriptor_imp::get_st
 
 stream_output_get_stream_format_response * STDCALL stream_output_descriptor_imp::get_stream_output_get_stream_format_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_STREAM_FORMAT);
     if (!resp_frame)
@@ -70,6 +78,10 @@ stream_output_get_stream_format_response * STDCALL stream_output_descriptor_imp:
 
 stream_output_get_stream_info_response * STDCALL stream_output_descriptor_imp::get_stream_output_get_stream_info_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_STREAM_INFO);
     if (!resp_frame)
@@ -81,6 +93,10 @@ stream_output_get_stream_info_response * STDCALL stream_output_descriptor_imp::g
 
 stream_output_get_tx_state_response * STDCALL stream_output_descriptor_imp::get_stream_output_get_tx_state_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(GET_TX_STATE_RESPONSE);
     if (!resp_frame)
@@ -92,6 +108,10 @@ stream_output_get_tx_state_response * STDCALL stream_output_descriptor_imp::get_
 
 stream_output_get_tx_connection_response * STDCALL stream_output_descriptor_imp::get_stream_output_get_tx_connection_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(GET_TX_CONNECTION_RESPONSE);
     if (!resp_frame)
@@ -103,6 +123,12 @@ stream_output_get_tx_connection_response * STDCALL stream_output_descriptor_imp:
 
 int STDCALL stream_output_descriptor_imp::send_set_stream_format_cmd(void * notification_id, uint64_t new_stream_format)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_set_stream_format aem_cmd_set_stream_format;
     ssize_t aem_cmd_set_stream_format_returned;
@@ -172,6 +198,8 @@ int stream_output_descriptor_imp::proc_set_stream_format_resp(void *& notificati
 
     if (status == AEM_STATUS_SUCCESS)
     {
+        store_cmd_resp_frame(AEM_CMD_GET_STREAM_FORMAT, frame, ETHER_HDR_SIZE, frame_len); // Same layout as the GET_STREAM_FORMAT response
+
         uint8_t * buffer = (uint8_t *)malloc(resp_ref->get_desc_size() * sizeof(uint8_t)); //fetch current desc frame
         memcpy(buffer, resp_ref->get_desc_buffer(), resp_ref->get_desc_size());
         jdksavdecc_descriptor_stream_set_current_format(aem_cmd_set_stream_format_resp.stream_format,
@@ -188,6 +216,12 @@ int stream_output_descriptor_imp::proc_set_stream_format_resp(void *& notificati
 
 int STDCALL stream_output_descriptor_imp::send_get_stream_format_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_stream_format aem_cmd_get_stream_format;
     ssize_t aem_cmd_get_stream_format_returned;
@@ -263,6 +297,12 @@ int stream_output_descriptor_imp::proc_get_stream_format_resp(void *& notificati
 
 int STDCALL stream_output_descriptor_imp::send_set_stream_info_vlan_id_cmd(void * notification_id, uint16_t vlan_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_set_stream_info cmd;
     ssize_t write_return;
@@ -307,6 +347,12 @@ int STDCALL stream_output_descriptor_imp::send_set_stream_info_vlan_id_cmd(void
     
 int STDCALL stream_output_descriptor_imp::send_set_stream_info_msrp_accumulated_latency_cmd(void * notification_id, uint32_t msrp_accumulated_latency)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_set_stream_info cmd;
     ssize_t write_return;
@@ -382,6 +428,12 @@ int stream_output_descriptor_imp::proc_set_stream_info_resp(void *& notification
 
 int STDCALL stream_output_descriptor_imp::send_get_stream_info_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_stream_info aem_cmd_get_stream_info;
     ssize_t aem_cmd_get_stream_info_returned;
@@ -458,6 +510,12 @@ int stream_output_descriptor_imp::proc_get_stream_info_resp(void *& notification
     
 int STDCALL stream_output_descriptor_imp::send_disconnect_tx_cmd(void * notification_id, uint64_t listener_entity_id, uint16_t listener_unique_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     entity_descriptor_response * entity_resp_ref = base_end_station_imp_ref->get_entity_desc_by_index(0)->get_entity_response();
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_acmpdu acmp_cmd_disconnect_tx;
@@ -523,6 +581,12 @@ int stream_output_descriptor_imp::proc_disconnect_tx_resp(void *& notification_i
 
 int STDCALL stream_output_descriptor_imp::send_start_streaming_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_start_streaming aem_cmd_start_streaming;
     ssize_t aem_cmd_start_streaming_returned;
@@ -596,6 +660,12 @@ int stream_output_descriptor_imp::proc_start_streaming_resp(void *& notification
 
 int STDCALL stream_output_descriptor_imp::send_stop_streaming_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_stop_streaming aem_cmd_stop_streaming;
     ssize_t aem_cmd_stop_streaming_returned;
@@ -669,6 +739,12 @@ int stream_output_descriptor_imp::proc_stop_streaming_resp(void *& notification_
 
 int STDCALL stream_output_descriptor_imp::send_get_tx_state_cmd(void * notification_id)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     entity_descriptor_response * entity_resp_ref = base_end_station_imp_ref->get_entity_desc_by_index(0)->get_entity_response();
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_acmpdu acmp_cmd_get_tx_state;
@@ -738,6 +814,12 @@ int stream_output_descriptor_imp::proc_get_tx_state_resp(void *& notification_id
 
 int STDCALL stream_output_descriptor_imp::send_get_tx_connection_cmd(void * notification_id, uint16_t connection_index)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     entity_descriptor_response * entity_resp_ref = base_end_station_imp_ref->get_entity_desc_by_index(0)->get_entity_response();
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_acmpdu acmp_cmd_get_tx_connection;
@@ -27,6 +27,8 @@
  * Stream Port Output descriptor implementation
  */
 
+#include <algorithm>
+
 #include "avdecc_error.h"
 #include "enumeration.h"
 #include "log_imp.h"
@@ -34,6 +36,8 @@
 #include "system_tx_queue.h"
 #include "aecp_controller_state_machine.h"
 #include "end_station_imp.h"
+#include "audio_map_batch.h"
+#include "audio_map_reconcile.h"
 #include "stream_port_output_descriptor_imp.h"
 
 namespace avdecc_lib
@@ -44,6 +48,10 @@ stream_port_output_descriptor_imp::~stream_port_output_descriptor_imp() {}
 
 stream_port_output_descriptor_response * STDCALL stream_port_output_descriptor_imp::get_stream_port_output_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     return resp = new stream_port_output_descriptor_response_imp(resp_ref->get_desc_buffer(),
                                                                  resp_ref->get_desc_size(), resp_ref->get_desc_pos());
@@ -51,6 +59,10 @@ stream_port_output_descriptor_response * STDCALL stream_port_output_descriptor_i
 
 stream_port_output_get_audio_map_response * STDCALL stream_port_output_descriptor_imp::get_stream_port_output_audio_map_response()
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return NULL;
+
     std::lock_guard<std::mutex> guard(base_end_station_imp_ref->locker); //mutex lock end station
     struct cmd_resp_frame_info * resp_frame = resp_ref->get_cmd_resp_frame_info(AEM_CMD_GET_AUDIO_MAP);
     if (!resp_frame)
@@ -96,6 +108,12 @@ int stream_port_output_descriptor_imp::clear_pending_maps()
 
 int STDCALL stream_port_output_descriptor_imp::send_get_audio_map_cmd(void * notification_id, uint16_t mapping_index)
 {
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
     struct jdksavdecc_frame cmd_frame;
     struct jdksavdecc_aem_command_get_audio_map aem_cmd_get_audio_map;
     ssize_t aem_cmd_get_audio_map_returned;
@@ -171,77 +189,21 @@ int stream_port_output_descriptor_imp::proc_get_audio_map_resp(void *& notificat
 
 int STDCALL stream_port_output_descriptor_imp::send_add_audio_mappings_cmd(void * notification_id)
 {
-    int i = 0;
-    struct jdksavdecc_frame cmd_frame;
-    struct jdksavdecc_aem_command_add_audio_mappings aem_cmd_add_audio_mappings;
-    ssize_t aem_cmd_add_audio_mappings_returned;
-    memset(&aem_cmd_add_audio_mappings, 0, sizeof(aem_cmd_add_audio_mappings));
-
-    /******************************************** AECP Common Data *********************************************/
-    aem_cmd_add_audio_mappings.aem_header.aecpdu_header.controller_entity_id = base_end_station_imp_ref->get_adp()->get_controller_entity_id();
-    // Fill aem_cmd_get_sampling_rate.sequence_id in AEM Controller State Machine
-    aem_cmd_add_audio_mappings.aem_header.command_type = JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS;
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
 
-    /****************** AECP Message Specific Data *****************/
-    aem_cmd_add_audio_mappings.descriptor_type = descriptor_type();
-    aem_cmd_add_audio_mappings.descriptor_index = descriptor_index();
-    if (pending_maps.size() > AEM_MAX_MAPS)
-    {
-        aem_cmd_add_audio_mappings.number_of_mappings = AEM_MAX_MAPS;
-    }
-    else
-    {
-        aem_cmd_add_audio_mappings.number_of_mappings = (uint16_t)pending_maps.size();
-    }
+    size_t num_pending_maps = pending_maps.size();
+    size_t mapping_count = std::min<size_t>(num_pending_maps, AEM_MAX_MAPS);
 
-    /******************************* Fill frame payload with AECP data and send the frame **************************/
-    aecp_controller_state_machine_ref->ether_frame_init(base_end_station_imp_ref->mac(), &cmd_frame,
-                                                        ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS_COMMAND_LEN +
-                                                            (uint16_t)pending_maps.size() * JDKSAVDECC_AUDIO_MAPPING_LEN);
-    aem_cmd_add_audio_mappings_returned = jdksavdecc_aem_command_add_audio_mappings_write(&aem_cmd_add_audio_mappings,
-                                                                                          cmd_frame.payload,
-                                                                                          ETHER_HDR_SIZE,
-                                                                                          sizeof(cmd_frame.payload));
-    if (aem_cmd_add_audio_mappings_returned < 0)
+    if (audio_map_batch::send_mappings_cmd(base_end_station_imp_ref, descriptor_type(), descriptor_index(),
+                                           JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS,
+                                           num_pending_maps ? &pending_maps[0] : NULL, mapping_count, notification_id) < 0)
     {
-        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "aem_cmd_add_audio_mappings_write error\n");
-        assert(aem_cmd_add_audio_mappings_returned >= 0);
         return -1;
     }
 
-    size_t num_pending_maps = pending_maps.size();
-    std::vector<struct audio_map_mapping>::iterator it = pending_maps.begin();
-    while (it != pending_maps.end())
-    {
-        if (i >= AEM_MAX_MAPS)
-            break;
-
-        struct avdecc_lib::audio_map_mapping map = *it;
-
-        jdksavdecc_uint16_set(map.stream_index, cmd_frame.payload, ETHER_HDR_SIZE +
-                                                                       JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS_COMMAND_OFFSET_MAPPINGS + JDKSAVDECC_AUDIO_MAPPING_LEN * i +
-                                                                       JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_STREAM_INDEX);
-        jdksavdecc_uint16_set(map.stream_channel, cmd_frame.payload, ETHER_HDR_SIZE +
-                                                                         JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS_COMMAND_OFFSET_MAPPINGS +
-                                                                         (JDKSAVDECC_AUDIO_MAPPING_LEN * i + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_STREAM_CHANNEL));
-        jdksavdecc_uint16_set(map.cluster_offset, cmd_frame.payload, ETHER_HDR_SIZE +
-                                                                         JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS_COMMAND_OFFSET_MAPPINGS +
-                                                                         (JDKSAVDECC_AUDIO_MAPPING_LEN * i + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_CLUSTER_OFFSET));
-        jdksavdecc_uint16_set(map.cluster_channel, cmd_frame.payload, ETHER_HDR_SIZE +
-                                                                          JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS_COMMAND_OFFSET_MAPPINGS +
-                                                                          (JDKSAVDECC_AUDIO_MAPPING_LEN * i + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_CLUSTER_CHANNEL));
-
-        pending_maps.erase(it);
-        it = pending_maps.begin();
-        i++;
-    }
-
-    aecp_controller_state_machine_ref->common_hdr_init(JDKSAVDECC_AECP_MESSAGE_TYPE_AEM_COMMAND,
-                                                       &cmd_frame,
-                                                       base_end_station_imp_ref->entity_id(),
-                                                       JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS_COMMAND_LEN -
-                                                           JDKSAVDECC_COMMON_CONTROL_HEADER_LEN);
-    system_queue_tx(notification_id, CMD_WITH_NOTIFICATION, cmd_frame.payload, cmd_frame.length);
+    pending_maps.erase(pending_maps.begin(), pending_maps.begin() + mapping_count);
 
     if (num_pending_maps > AEM_MAX_MAPS)
     {
@@ -287,77 +249,21 @@ int stream_port_output_descriptor_imp::proc_add_audio_mappings_resp(void *& noti
 
 int STDCALL stream_port_output_descriptor_imp::send_remove_audio_mappings_cmd(void * notification_id)
 {
-    int i = 0;
-    struct jdksavdecc_frame cmd_frame;
-    struct jdksavdecc_aem_command_remove_audio_mappings aem_cmd_remove_audio_mappings;
-    ssize_t aem_cmd_remove_audio_mappings_returned;
-    memset(&aem_cmd_remove_audio_mappings, 0, sizeof(aem_cmd_remove_audio_mappings));
-
-    /******************************************** AECP Common Data *********************************************/
-    aem_cmd_remove_audio_mappings.aem_header.aecpdu_header.controller_entity_id = base_end_station_imp_ref->get_adp()->get_controller_entity_id();
-    // Fill aem_cmd_get_sampling_rate.sequence_id in AEM Controller State Machine
-    aem_cmd_remove_audio_mappings.aem_header.command_type = JDKSAVDECC_AEM_COMMAND_REMOVE_AUDIO_MAPPINGS;
-
-    /****************** AECP Message Specific Data *****************/
-    aem_cmd_remove_audio_mappings.descriptor_type = descriptor_type();
-    aem_cmd_remove_audio_mappings.descriptor_index = descriptor_index();
-    if (pending_maps.size() > AEM_MAX_MAPS)
-    {
-        aem_cmd_remove_audio_mappings.number_of_mappings = AEM_MAX_MAPS;
-    }
-    else
-    {
-        aem_cmd_remove_audio_mappings.number_of_mappings = (uint16_t)pending_maps.size();
-    }
-
-    /******************************* Fill frame payload with AECP data and send the frame **************************/
-    aecp_controller_state_machine_ref->ether_frame_init(base_end_station_imp_ref->mac(), &cmd_frame,
-                                                        ETHER_HDR_SIZE + JDKSAVDECC_AEM_COMMAND_REMOVE_AUDIO_MAPPINGS_COMMAND_LEN +
-                                                            (uint16_t)pending_maps.size() * JDKSAVDECC_AUDIO_MAPPING_LEN);
-    aem_cmd_remove_audio_mappings_returned = jdksavdecc_aem_command_remove_audio_mappings_write(&aem_cmd_remove_audio_mappings,
-                                                                                                cmd_frame.payload,
-                                                                                                ETHER_HDR_SIZE,
-                                                                                                sizeof(cmd_frame.payload));
-    if (aem_cmd_remove_audio_mappings_returned < 0)
-    {
-        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "aem_cmd_remove_audio_mappings_write error\n");
-        assert(aem_cmd_remove_audio_mappings_returned >= 0);
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
         return -1;
-    }
 
     size_t num_pending_maps = pending_maps.size();
-    std::vector<struct audio_map_mapping>::iterator it = pending_maps.begin();
-    while (it != pending_maps.end())
+    size_t mapping_count = std::min<size_t>(num_pending_maps, AEM_MAX_MAPS);
+
+    if (audio_map_batch::send_mappings_cmd(base_end_station_imp_ref, descriptor_type(), descriptor_index(),
+                                           JDKSAVDECC_AEM_COMMAND_REMOVE_AUDIO_MAPPINGS,
+                                           num_pending_maps ? &pending_maps[0] : NULL, mapping_count, notification_id) < 0)
     {
-        if (i >= AEM_MAX_MAPS)
-            break;
-
-        struct avdecc_lib::audio_map_mapping map = *it;
-
-        jdksavdecc_uint16_set(map.stream_index, cmd_frame.payload, ETHER_HDR_SIZE +
-                                                                       JDKSAVDECC_AEM_COMMAND_REMOVE_AUDIO_MAPPINGS_COMMAND_OFFSET_MAPPINGS + JDKSAVDECC_AUDIO_MAPPING_LEN * i +
-                                                                       JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_STREAM_INDEX);
-        jdksavdecc_uint16_set(map.stream_channel, cmd_frame.payload, ETHER_HDR_SIZE +
-                                                                         JDKSAVDECC_AEM_COMMAND_REMOVE_AUDIO_MAPPINGS_COMMAND_OFFSET_MAPPINGS +
-                                                                         (JDKSAVDECC_AUDIO_MAPPING_LEN * i + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_STREAM_CHANNEL));
-        jdksavdecc_uint16_set(map.cluster_offset, cmd_frame.payload, ETHER_HDR_SIZE +
-                                                                         JDKSAVDECC_AEM_COMMAND_REMOVE_AUDIO_MAPPINGS_COMMAND_OFFSET_MAPPINGS +
-                                                                         (JDKSAVDECC_AUDIO_MAPPING_LEN * i + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_CLUSTER_OFFSET));
-        jdksavdecc_uint16_set(map.cluster_channel, cmd_frame.payload, ETHER_HDR_SIZE +
-                                                                          JDKSAVDECC_AEM_COMMAND_REMOVE_AUDIO_MAPPINGS_COMMAND_OFFSET_MAPPINGS +
-                                                                          (JDKSAVDECC_AUDIO_MAPPING_LEN * i + JDKSAVDECC_AUDIO_MAPPING_OFFSET_MAPPING_CLUSTER_CHANNEL));
-
-        pending_maps.erase(it);
-        it = pending_maps.begin();
-        i++;
+        return -1;
     }
 
-    aecp_controller_state_machine_ref->common_hdr_init(JDKSAVDECC_AECP_MESSAGE_TYPE_AEM_COMMAND,
-                                                       &cmd_frame,
-                                                       base_end_station_imp_ref->entity_id(),
-                                                       JDKSAVDECC_AEM_COMMAND_REMOVE_AUDIO_MAPPINGS_COMMAND_LEN -
-                                                           JDKSAVDECC_COMMON_CONTROL_HEADER_LEN);
-    system_queue_tx(notification_id, CMD_WITH_NOTIFICATION, cmd_frame.payload, cmd_frame.length);
+    pending_maps.erase(pending_maps.begin(), pending_maps.begin() + mapping_count);
 
     if (num_pending_maps > AEM_MAX_MAPS)
     {
@@ -400,4 +306,103 @@ int stream_port_output_descriptor_imp::proc_remove_audio_mappings_resp(void *& n
 
     return 0;
 }
+
+int STDCALL stream_port_output_descriptor_imp::send_add_audio_mappings_batch(const struct audio_map_mapping * mappings, size_t mapping_count, size_t window,
+                                                                             void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                                                                             void * user_obj)
+{
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
+    if ((mapping_count && !mappings) || (window == 0))
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "send_add_audio_mappings_batch error: invalid window or mappings");
+        return -1;
+    }
+
+    audio_map_batch * batch = new audio_map_batch(base_end_station_imp_ref, descriptor_type(), descriptor_index(),
+                                                  JDKSAVDECC_AEM_COMMAND_ADD_AUDIO_MAPPINGS,
+                                                  std::min<size_t>(window, audio_map_batch::MAX_WINDOW), completion_callback, user_obj);
+    batch->set_mappings(mappings, mapping_count);
+    batch->start();
+
+    return 0;
+}
+
+int STDCALL stream_port_output_descriptor_imp::send_remove_audio_mappings_batch(const struct audio_map_mapping * mappings, size_t mapping_count, size_t window,
+                                                                                void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                                                                                void * user_obj)
+{
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
+    if ((mapping_count && !mappings) || (window == 0))
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "send_remove_audio_mappings_batch error: invalid window or mappings");
+        return -1;
+    }
+
+    audio_map_batch * batch = new audio_map_batch(base_end_station_imp_ref, descriptor_type(), descriptor_index(),
+                                                  JDKSAVDECC_AEM_COMMAND_REMOVE_AUDIO_MAPPINGS,
+                                                  std::min<size_t>(window, audio_map_batch::MAX_WINDOW), completion_callback, user_obj);
+    batch->set_mappings(mappings, mapping_count);
+    batch->start();
+
+    return 0;
+}
+
+int STDCALL stream_port_output_descriptor_imp::send_get_audio_map_batch(size_t window,
+                                                                        void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                                                                        void * user_obj)
+{
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
+    if (window == 0)
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "send_get_audio_map_batch error: invalid window");
+        return -1;
+    }
+
+    audio_map_batch * batch = new audio_map_batch(base_end_station_imp_ref, descriptor_type(), descriptor_index(),
+                                                  JDKSAVDECC_AEM_COMMAND_GET_AUDIO_MAP,
+                                                  std::min<size_t>(window, audio_map_batch::MAX_WINDOW), completion_callback, user_obj);
+    batch->start();
+
+    return 0;
+}
+
+int STDCALL stream_port_output_descriptor_imp::send_set_audio_map(const struct audio_map_mapping * mappings, size_t mapping_count, size_t window,
+                                                                  void (*completion_callback)(void *, int32_t, size_t, size_t),
+                                                                  void * user_obj)
+{
+    end_station_pin pin(base_end_station_imp_ref);
+    if (!pin.is_pinned())
+        return -1;
+
+    context_scope scope(base_end_station_imp_ref->context());
+
+    if ((mapping_count && !mappings) || (window == 0))
+    {
+        log_imp_ref->post_log_msg(LOGGING_LEVEL_ERROR, "send_set_audio_map error: invalid window or mappings");
+        return -1;
+    }
+
+    audio_map_reconcile * reconcile = new audio_map_reconcile(base_end_station_imp_ref, descriptor_type(), descriptor_index(),
+                                                              std::min<size_t>(window, audio_map_batch::MAX_WINDOW),
+                                                              completion_callback, user_obj);
+    reconcile->set_mappings(mappings, mapping_count);
+    reconcile->start();
+
+    return 0;
+}
 }
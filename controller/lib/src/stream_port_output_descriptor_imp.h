@@ -60,6 +60,19 @@ public:
     int STDCALL send_remove_audio_mappings_cmd(void * notification_id);
     int proc_remove_audio_mappings_resp(void *& notification_id, const uint8_t * frame, size_t frame_len, int & status);
 
+    int STDCALL send_add_audio_mappings_batch(const struct audio_map_mapping * mappings, size_t mapping_count, size_t window,
+                                              void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                                              void * user_obj);
+    int STDCALL send_remove_audio_mappings_batch(const struct audio_map_mapping * mappings, size_t mapping_count, size_t window,
+                                                 void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                                                 void * user_obj);
+    int STDCALL send_get_audio_map_batch(size_t window,
+                                         void (*completion_callback)(void *, int32_t, const struct audio_map_mapping *, size_t),
+                                         void * user_obj);
+    int STDCALL send_set_audio_map(const struct audio_map_mapping * mappings, size_t mapping_count, size_t window,
+                                   void (*completion_callback)(void *, int32_t, size_t, size_t),
+                                   void * user_obj);
+
     int store_pending_map(struct audio_map_mapping & map);
     size_t get_number_of_pending_maps();
     int get_pending_maps(size_t index, struct audio_map_mapping & map);
@@ -38,4 +38,14 @@ namespace avdecc_lib
 /// Store command in a queue to be transmitted.
 ///
 size_t system_queue_tx(void * notification_id, uint32_t notification_flag, uint8_t * frame, size_t frame_len);
+
+///
+/// Set the priority class of the next command queued with the notification id.
+///
+int system_set_priority_for_next_cmd(void * notification_id, uint32_t priority);
+
+///
+/// Drop the priority set for the notification id, for a command that will not be queued.
+///
+void system_clear_priority_for_next_cmd(void * notification_id);
 }
@@ -27,6 +27,7 @@
  * Timer implementation
  */
 
+#include "virtual_clock_imp.h"
 #include "timer.h"
 
 namespace avdecc_lib
@@ -37,12 +38,62 @@ timer::timer()
     elapsed = 0;
     count = 0;
     start_time = 0;
+    deadline_ms = 0;
 }
 
-timer::~timer() {}
+timer::timer(const timer & other)
+{
+    running = other.running;
+    elapsed = other.elapsed;
+    count = other.count;
+    start_time = other.start_time;
+    deadline_ms = other.deadline_ms;
+    add_deadline();
+}
+
+timer & timer::operator=(const timer & other)
+{
+    if (this != &other)
+    {
+        remove_deadline();
+        running = other.running;
+        elapsed = other.elapsed;
+        count = other.count;
+        start_time = other.start_time;
+        deadline_ms = other.deadline_ms;
+        add_deadline();
+    }
+
+    return *this;
+}
+
+timer::~timer()
+{
+    remove_deadline();
+}
+
+void timer::add_deadline()
+{
+    virtual_clock_imp * clock = virtual_clock_ref;
+
+    // A deadline that has passed has been taken by an advance, and is not added again
+    if (clock && deadline_ms && (deadline_ms > clock->now_ms()))
+        clock->add_deadline(deadline_ms);
+    else
+        deadline_ms = 0;
+}
+
+void timer::remove_deadline()
+{
+    virtual_clock_imp * clock = virtual_clock_ref;
+
+    if (clock && deadline_ms)
+        clock->remove_deadline(deadline_ms);
+    deadline_ms = 0;
+}
 
 #ifdef WIN32
-avdecc_lib_os::aTimestamp timer::clk_monotonic(void)
+static avdecc_lib_os::aTimestamp os_clk_monotonic(void)
 {
     LARGE_INTEGER count;
     QueryPerformanceCounter(&count);
@@ -50,8 +101,16 @@ avdecc_lib_os::aTimestamp timer::clk_monotonic(void)
     return count.QuadPart;
 }
 
+static avdecc_lib_os::aTimestamp ms_to_timestamp(uint64_t time_ms)
+{
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+
+    return time_ms * freq.QuadPart / 1000;
+}
+
 #elif defined __linux__
-avdecc_lib_os::aTimestamp timer::clk_monotonic(void)
+static avdecc_lib_os::aTimestamp os_clk_monotonic(void)
 {
     struct timespec tp;
     avdecc_lib_os::aTimestamp time;
@@ -66,7 +125,7 @@ avdecc_lib_os::aTimestamp timer::clk_monotonic(void)
     return time;
 }
 #elif defined __MACH__
-avdecc_lib_os::aTimestamp timer::clk_monotonic(void)
+static avdecc_lib_os::aTimestamp os_clk_monotonic(void)
 {
     struct timespec tp;
     avdecc_lib_os::aTimestamp time;
@@ -84,6 +143,23 @@ avdecc_lib_os::aTimestamp timer::clk_monotonic(void)
 }
 #endif
 
+#if defined __linux__ || defined __MACH__
+static avdecc_lib_os::aTimestamp ms_to_timestamp(uint64_t time_ms)
+{
+    return (avdecc_lib_os::aTimestamp)time_ms;
+}
+#endif
+
+avdecc_lib_os::aTimestamp timer::clk_monotonic(void)
+{
+    virtual_clock_imp * clock = virtual_clock_ref;
+
+    if (clock)
+        return ms_to_timestamp(clock->now_ms());
+
+    return os_clk_monotonic();
+}
+
 #ifdef WIN32
 uint32_t timer::clk_convert_to_ms(avdecc_lib_os::aTimestamp time_stamp)
 {
@@ -105,12 +181,22 @@ void timer::start(int duration_ms)
     elapsed = false;
     count = duration_ms;
     start_time = clk_monotonic();
+
+    // Let the virtual clock advance straight to the timeout, which is when more than the duration has elapsed
+    virtual_clock_imp * clock = virtual_clock_ref;
+    remove_deadline();
+    if (clock)
+    {
+        deadline_ms = clock->now_ms() + count + 1;
+        clock->add_deadline(deadline_ms);
+    }
 }
 
 void timer::stop()
 {
     running = false;
     elapsed = false;
+    remove_deadline();
 }
 
 bool timer::timeout()
@@ -129,4 +215,9 @@ bool timer::timeout()
 
     return elapsed;
 }
+
+uint32_t timer::elapsed_ms()
+{
+    return (uint32_t)clk_convert_to_ms(clk_monotonic() - start_time);
+}
 }
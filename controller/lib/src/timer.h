@@ -42,10 +42,25 @@ private:
     bool elapsed;
     uint32_t count;
     avdecc_lib_os::aTimestamp start_time;
+    uint64_t deadline_ms; // The deadline added to the virtual clock, or 0 if none
+
+    void add_deadline();
+    void remove_deadline();
 
 public:
     timer();
 
+    ///
+    /// A copy of a timer adds its own deadline to the virtual clock, which is removed when the
+    /// copy is stopped or destroyed, as timers are copied with the commands holding them.
+    ///
+    timer(const timer & other);
+    timer & operator=(const timer & other);
+
+    ///
+    /// Remove the deadline of the timer, so that a command erased without stopping its timer
+    /// does not leave a deadline for the virtual clock to stop at.
+    ///
     ~timer();
 
     avdecc_lib_os::aTimestamp clk_monotonic(void);
@@ -57,5 +72,10 @@ public:
     void stop();
 
     bool timeout();
+
+    ///
+    /// \return The milliseconds since the timer was started.
+    ///
+    uint32_t elapsed_ms();
 };
 }
@@ -0,0 +1,115 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * tx_priority_queue.cpp
+ *
+ * Transmit priority queue implementation
+ */
+
+#include "tx_priority_queue.h"
+
+namespace avdecc_lib
+{
+tx_priority_queue::tx_priority_queue() {}
+
+tx_priority_queue::~tx_priority_queue()
+{
+    for (uint32_t priority = 0; priority < CMD_PRIORITY_COUNT; priority++)
+    {
+        for (size_t i = 0; i < m_queues[priority].size(); i++)
+            delete[] m_queues[priority][i].frame;
+    }
+}
+
+int tx_priority_queue::set_priority_for_next_cmd(void * notification_id, uint32_t priority)
+{
+    if (priority >= CMD_PRIORITY_COUNT)
+        return -1;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_next_cmd_priorities[notification_id] = priority;
+    return 0;
+}
+
+void tx_priority_queue::clear_priority_for_next_cmd(void * notification_id)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_next_cmd_priorities.erase(notification_id);
+}
+
+uint32_t tx_priority_queue::classify(void * notification_id, uint32_t notification_flag, bool is_waited)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        std::unordered_map<void *, uint32_t>::iterator it = m_next_cmd_priorities.find(notification_id);
+
+        if (it != m_next_cmd_priorities.end())
+        {
+            uint32_t priority = it->second;
+            m_next_cmd_priorities.erase(it);
+            return priority;
+        }
+    }
+
+    if (is_waited)
+        return CMD_PRIORITY_INTERACTIVE;
+    if (notification_flag == CMD_WITHOUT_NOTIFICATION)
+        return CMD_PRIORITY_BACKGROUND;
+
+    return CMD_PRIORITY_NORMAL;
+}
+
+void tx_priority_queue::push(const struct tx_entry & entry)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_queues[entry.priority < CMD_PRIORITY_COUNT ? entry.priority : (uint32_t)CMD_PRIORITY_NORMAL].push_back(entry);
+}
+
+bool tx_priority_queue::pop(struct tx_entry & entry)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    for (uint32_t priority = 0; priority < CMD_PRIORITY_COUNT; priority++)
+    {
+        if (!m_queues[priority].empty())
+        {
+            entry = m_queues[priority].front();
+            m_queues[priority].pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t tx_priority_queue::size(uint32_t priority)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    return priority < CMD_PRIORITY_COUNT ? m_queues[priority].size() : 0;
+}
+}
@@ -0,0 +1,106 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * tx_priority_queue.h
+ *
+ * Transmit priority queue class, which holds the commands queued by system_queue_tx() in one
+ * FIFO per priority class until the lib thread sends them.
+ *
+ * The system layers keep their own wakeup mechanism and signal it once per pushed command, and
+ * the lib thread pops one command per wakeup. Since pop() always takes the oldest command of the
+ * highest priority class, interactive commands are sent ahead of any normal or background
+ * commands that were queued before them.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include "enumeration.h"
+
+namespace avdecc_lib
+{
+class tx_priority_queue
+{
+public:
+    struct tx_entry
+    {
+        uint8_t * frame;
+        size_t frame_len;
+        void * notification_id;
+        uint32_t notification_flag;
+        uint32_t priority;
+        uint32_t trace_id; // Correlates the enqueue and dequeue trace events
+    };
+
+    tx_priority_queue();
+    ~tx_priority_queue();
+
+    ///
+    /// Set the priority class of the next command queued with the notification id.
+    ///
+    /// \return 0 on success, -1 if the priority is not a cmd_priorities value.
+    ///
+    int set_priority_for_next_cmd(void * notification_id, uint32_t priority);
+
+    ///
+    /// Drop the priority set for the notification id, for a command that will not be queued.
+    ///
+    void clear_priority_for_next_cmd(void * notification_id);
+
+    ///
+    /// Deduce the priority class of a command about to be queued.
+    ///
+    /// A priority set for the notification id by set_priority_for_next_cmd() is used once.
+    /// Otherwise commands an application thread waits on are interactive, commands sent
+    /// without notification are background and all other commands are normal.
+    ///
+    uint32_t classify(void * notification_id, uint32_t notification_flag, bool is_waited);
+
+    ///
+    /// Queue a command at the back of the FIFO of its priority class.
+    ///
+    void push(const struct tx_entry & entry);
+
+    ///
+    /// Take the oldest command of the highest priority class with a queued command.
+    ///
+    /// \return True if a command was taken, false if all the FIFOs are empty.
+    ///
+    bool pop(struct tx_entry & entry);
+
+    ///
+    /// \return The number of commands queued with the priority class.
+    ///
+    size_t size(uint32_t priority);
+
+private:
+    std::mutex m_lock;
+    std::deque<struct tx_entry> m_queues[CMD_PRIORITY_COUNT];
+    std::unordered_map<void *, uint32_t> m_next_cmd_priorities; // Cleared when the command is queued
+};
+}
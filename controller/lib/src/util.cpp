@@ -311,13 +311,32 @@ namespace utility
             "COMMAND_TIMEOUT",
             "RESPONSE_RECEIVED",
             "END_STATION_READ_COMPLETED",
-            "UNSOLICITED_RESPONSE_RECEIVED"};
+            "UNSOLICITED_RESPONSE_RECEIVED",
+            "MEMORY_OBJECT_TRANSFER_PROGRESS",
+            "MEMORY_OBJECT_TRANSFER_COMPLETED",
+            "FIRMWARE_ROLLOUT_PROGRESS",
+            "FIRMWARE_ROLLOUT_COMPLETED",
+            "END_STATION_DEGRADED",
+            "END_STATION_RECOVERED",
+            "END_STATION_EVICTED"};
     
     const char * acmp_notification_names[] =
     {
         "NULL_ACMP_NOTIFICATION",
         "BROADCAST_ACMP_RESPONSE_RECEIVED",
-        "ACMP_RESPONSE_RECEIVED"};
+        "ACMP_RESPONSE_RECEIVED",
+        "CONNECTION_ADDED",
+        "CONNECTION_REMOVED"};
+
+    const char * firmware_rollout_state_names[] =
+        {
+            "PENDING",
+            "ERASING",
+            "UPLOADING",
+            "REBOOTING",
+            "DONE",
+            "FAILED",
+            "SKIPPED"};
 
     const char * logging_level_names[] =
         {
@@ -416,6 +435,14 @@ namespace utility
         {
             return "AVDECC_LIB_STATUS_TICK_TIMEOUT";
         }
+        else if (aem_cmd_status_value == avdecc_lib::AVDECC_LIB_STATUS_ENTITY_DEGRADED)
+        {
+            return "AVDECC_LIB_STATUS_ENTITY_DEGRADED";
+        }
+        else if (aem_cmd_status_value == avdecc_lib::AVDECC_LIB_STATUS_CANCELLED)
+        {
+            return "AVDECC_LIB_STATUS_CANCELLED";
+        }
 
         return "UNKNOWN";
     }
@@ -489,6 +516,16 @@ namespace utility
         return "UNKNOWN";
     }
 
+    const char * STDCALL firmware_rollout_state_value_to_name(uint16_t firmware_rollout_state_value)
+    {
+        if (firmware_rollout_state_value < avdecc_lib::TOTAL_NUM_OF_FIRMWARE_ROLLOUT_STATES)
+        {
+            return firmware_rollout_state_names[firmware_rollout_state_value];
+        }
+
+        return "UNKNOWN";
+    }
+
     const char * STDCALL logging_level_value_to_name(uint16_t logging_level_value)
     {
         if (logging_level_value < avdecc_lib::TOTAL_NUM_OF_LOGGING_LEVELS)
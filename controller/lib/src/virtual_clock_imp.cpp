@@ -0,0 +1,170 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * virtual_clock_imp.cpp
+ *
+ * Virtual clock implementation
+ */
+
+#include "timer.h"
+#include "virtual_clock_imp.h"
+
+namespace avdecc_lib
+{
+virtual_clock * STDCALL create_virtual_clock()
+{
+    return new virtual_clock_imp();
+}
+
+virtual_clock_imp::virtual_clock_imp()
+{
+    timer real_clock;
+
+    // Start at the real time, so that timers started before the clock is set keep their deadlines
+    m_now_ms.store(real_clock.clk_convert_to_ms(real_clock.clk_monotonic()));
+    m_listener = NULL;
+    m_tick_fn = NULL;
+    m_tick_context = NULL;
+    m_ticks_requested = 0;
+    m_ticks_done = 0;
+}
+
+virtual_clock_imp::~virtual_clock_imp() {}
+
+void STDCALL virtual_clock_imp::destroy()
+{
+    delete this;
+}
+
+uint64_t STDCALL virtual_clock_imp::now_ms()
+{
+    return m_now_ms.load(std::memory_order_acquire);
+}
+
+void STDCALL virtual_clock_imp::add_deadline(uint64_t deadline_ms)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_deadlines.insert(deadline_ms);
+}
+
+void virtual_clock_imp::remove_deadline(uint64_t deadline_ms)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    // A passed deadline may have been taken by an advance, and an equal one added since then belongs to another timer
+    if (deadline_ms <= m_now_ms.load(std::memory_order_relaxed))
+        return;
+
+    std::multiset<uint64_t>::iterator i = m_deadlines.find(deadline_ms);
+    if (i != m_deadlines.end())
+        m_deadlines.erase(i);
+}
+
+int64_t STDCALL virtual_clock_imp::advance_to_next_deadline()
+{
+    uint64_t start_ms;
+    uint64_t next_ms;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (m_deadlines.empty())
+            return -1;
+
+        start_ms = m_now_ms.load(std::memory_order_relaxed);
+        next_ms = *m_deadlines.begin() > start_ms ? *m_deadlines.begin() : start_ms;
+    }
+
+    advance_to(next_ms);
+    return (int64_t)(next_ms - start_ms);
+}
+
+void STDCALL virtual_clock_imp::advance(uint32_t duration_ms)
+{
+    uint64_t next_ms;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        next_ms = m_now_ms.load(std::memory_order_relaxed) + duration_ms;
+    }
+
+    advance_to(next_ms);
+}
+
+void STDCALL virtual_clock_imp::set_listener(virtual_clock_listener * listener)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_listener = listener;
+}
+
+void virtual_clock_imp::set_tick_handler(tick_handler_fn fn, void * context)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_tick_fn = fn;
+    m_tick_context = context;
+
+    if (!fn)
+    {
+        m_ticks_done = m_ticks_requested;
+        m_tick_cv.notify_all();
+    }
+}
+
+void virtual_clock_imp::tick_done()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_ticks_done = m_ticks_requested;
+    m_tick_cv.notify_all();
+}
+
+void virtual_clock_imp::advance_to(uint64_t time_ms)
+{
+    virtual_clock_listener * listener;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_now_ms.store(time_ms, std::memory_order_release);
+
+        // The timer tick handles every deadline up to now. Deadlines at the current time added
+        // by the listener or the timer tick are left for the next advance.
+        m_deadlines.erase(m_deadlines.begin(), m_deadlines.upper_bound(time_ms));
+
+        listener = m_listener;
+    }
+
+    if (listener)
+        listener->clock_advanced(time_ms);
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    if (!m_tick_fn)
+        return;
+
+    // The tick handler only signals the system thread, so it is called with the lock held to
+    // keep the system from clearing it in between.
+    uint64_t tick = ++m_ticks_requested;
+    m_tick_fn(m_tick_context);
+
+    while (m_ticks_done < tick)
+        m_tick_cv.wait(lock);
+}
+}
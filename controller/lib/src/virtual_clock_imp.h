@@ -0,0 +1,90 @@
+/*
+ * Licensed under the MIT License (MIT)
+ *
+ * Copyright (c) 2013 AudioScience Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * virtual_clock_imp.h
+ *
+ * Virtual clock implementation class. The timers of the library read the virtual time through
+ * virtual_clock_ref while a virtual clock is set on the system of their controller.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+
+#include "virtual_clock.h"
+#include "controller_context.h"
+
+namespace avdecc_lib
+{
+class virtual_clock_imp : public virtual virtual_clock
+{
+public:
+    typedef void (*tick_handler_fn)(void * context);
+
+    virtual_clock_imp();
+    virtual ~virtual_clock_imp();
+
+    void STDCALL destroy();
+    uint64_t STDCALL now_ms();
+    void STDCALL add_deadline(uint64_t deadline_ms);
+    int64_t STDCALL advance_to_next_deadline();
+    void STDCALL advance(uint32_t duration_ms);
+    void STDCALL set_listener(virtual_clock_listener * listener);
+
+    ///
+    /// Remove a deadline added for a timer that has been stopped or restarted. Deadlines that have
+    /// passed are left, as they have been or will be handled by the next advance.
+    ///
+    void remove_deadline(uint64_t deadline_ms);
+
+    ///
+    /// Set the function the system calls to run the timer tick on its thread, or NULL when the
+    /// system stops. Clearing the handler releases an advance waiting for the timer tick.
+    ///
+    void set_tick_handler(tick_handler_fn fn, void * context);
+
+    ///
+    /// Called by the system when a timer tick requested by an advance has finished.
+    ///
+    void tick_done();
+
+private:
+    std::mutex m_lock; // Held while advancing and changing the deadlines, not to read the time
+    std::condition_variable m_tick_cv;
+    std::atomic<uint64_t> m_now_ms; // Only changed with the lock held
+    std::multiset<uint64_t> m_deadlines;
+    virtual_clock_listener * m_listener;
+
+    tick_handler_fn m_tick_fn;
+    void * m_tick_context;
+    uint64_t m_ticks_requested;
+    uint64_t m_ticks_done;
+
+    void advance_to(uint64_t time_ms);
+};
+}